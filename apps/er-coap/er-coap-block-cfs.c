@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *      Block-wise transfers streamed to and from CFS files
+ */
+
+#include <string.h>
+
+#include "er-coap-block-cfs.h"
+
+#define DEBUG 0
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+/*---------------------------------------------------------------------------*/
+static int
+stream_open(coap_cfs_stream_t *stream, int flags)
+{
+  stream->fd = cfs_open(stream->name, flags);
+  stream->writing = (flags & CFS_WRITE) != 0;
+  stream->pos = 0;
+  stream->size = 0;
+#if COAP_BLOCK_CFS_READ_AHEAD
+  stream->cache_len = 0;
+#endif /* COAP_BLOCK_CFS_READ_AHEAD */
+  return stream->fd;
+}
+/*---------------------------------------------------------------------------*/
+static int
+stream_seek(coap_cfs_stream_t *stream, cfs_offset_t pos)
+{
+  if(stream->pos != pos) {
+    if(cfs_seek(stream->fd, pos, CFS_SEEK_SET) != pos) {
+      return -1;
+    }
+    stream->pos = pos;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+stream_read(coap_cfs_stream_t *stream, cfs_offset_t pos, uint8_t *dst,
+            int len)
+{
+  int n;
+
+  if(stream_seek(stream, pos) < 0) {
+    return -1;
+  }
+  n = cfs_read(stream->fd, dst, len);
+  if(n > 0) {
+    stream->pos += n;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static int
+read_block(coap_cfs_stream_t *stream, cfs_offset_t pos, uint8_t *dst,
+           int len)
+{
+#if COAP_BLOCK_CFS_READ_AHEAD
+  int n;
+
+  if(len <= COAP_BLOCK_CFS_READ_AHEAD) {
+    if(pos < stream->cache_offset ||
+       pos + len > stream->cache_offset + stream->cache_len) {
+      n = stream_read(stream, pos, stream->cache, COAP_BLOCK_CFS_READ_AHEAD);
+      if(n < 0) {
+        stream->cache_len = 0;
+        return -1;
+      }
+      PRINTF("Block CFS: read ahead %d bytes @ %ld\n", n, (long)pos);
+      stream->cache_offset = pos;
+      stream->cache_len = n;
+      if(n < len) {
+        len = n;
+      }
+    }
+    memcpy(dst, stream->cache + (pos - stream->cache_offset), len);
+    return len;
+  }
+#endif /* COAP_BLOCK_CFS_READ_AHEAD */
+  return stream_read(stream, pos, dst, len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+stream_discard(coap_cfs_stream_t *stream)
+{
+  coap_cfs_stream_close(stream);
+  cfs_remove(stream->name);
+}
+/*---------------------------------------------------------------------------*/
+/* Gives up a transfer that received no block for the idle timeout, so
+   that an abandoned upload neither blocks downloads nor leaves a partial
+   file behind */
+static void
+stream_expire(coap_cfs_stream_t *stream)
+{
+  if(stream->fd >= 0 &&
+     (clock_time_t)(clock_time() - stream->last_use) >=
+     COAP_BLOCK_CFS_IDLE_TIMEOUT) {
+    PRINTF("Block CFS: %s idle, %s\n", stream->name,
+           stream->writing ? "removed" : "closed");
+    if(stream->writing) {
+      stream_discard(stream);
+    } else {
+      coap_cfs_stream_close(stream);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_cfs_stream_close(coap_cfs_stream_t *stream)
+{
+  if(stream->fd >= 0) {
+    cfs_close(stream->fd);
+    stream->fd = -1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Block 1 support for resources that store the payload in a file
+ *
+ *        Like coap_block1_handler(), but every block is written to the
+ *        file of the stream at its offset as it arrives. The first block
+ *        replaces the file; later blocks must continue the transfer, or
+ *        the request fails with 4.08. A block that ends past max_len
+ *        fails with 4.13 and a Size1 option. The file is closed after
+ *        the last block. A transfer in progress that fails, or that
+ *        receives no block for COAP_BLOCK_CFS_IDLE_TIMEOUT, removes the
+ *        file.
+ *
+ * \param request   Request pointer from the handler
+ * \param response  Response pointer from the handler
+ * \param stream    The file to write
+ * \param max_len   Largest accepted file size
+ *
+ * \return 0 if the last block was received
+ *         1 if more blocks will follow
+ *         -1 on failure, with the error in erbium_status_code
+ */
+int
+coap_block1_cfs_handler(void *request, void *response,
+                        coap_cfs_stream_t *stream, cfs_offset_t max_len)
+{
+  coap_packet_t *const packet = (coap_packet_t *)request;
+  const uint8_t *payload = NULL;
+  cfs_offset_t pos = packet->block1_offset;
+  int len = coap_get_payload(request, &payload);
+
+  stream_expire(stream);
+
+  if(!len || !payload) {
+    erbium_status_code = BAD_REQUEST_4_00;
+    coap_error_message = "NoPayload";
+    return -1;
+  }
+
+  if(pos + len > max_len) {
+    if(stream->fd >= 0 && stream->writing) {
+      /* the file of this transfer is incomplete */
+      stream_discard(stream);
+    }
+    coap_set_header_size1(response, max_len);
+    erbium_status_code = REQUEST_ENTITY_TOO_LARGE_4_13;
+    coap_error_message = "EntityTooLarge";
+    return -1;
+  }
+
+  if(pos == 0) {
+    stream_discard(stream);
+    if(stream_open(stream, CFS_WRITE) < 0) {
+      erbium_status_code = INTERNAL_SERVER_ERROR_5_00;
+      coap_error_message = "CannotCreate";
+      return -1;
+    }
+  } else if(stream->fd < 0 || !stream->writing || pos > stream->size) {
+    /* a block that does not continue the transfer */
+    erbium_status_code = REQUEST_ENTITY_INCOMPLETE_4_08;
+    coap_error_message = "BlockOutOfOrder";
+    return -1;
+  }
+
+  PRINTF("Block CFS: write %d bytes @ %ld to %s\n", len, (long)pos,
+         stream->name);
+
+  if(stream_seek(stream, pos) < 0 ||
+     cfs_write(stream->fd, payload, len) != len) {
+    stream_discard(stream);
+    erbium_status_code = INTERNAL_SERVER_ERROR_5_00;
+    coap_error_message = "WriteFailed";
+    return -1;
+  }
+  stream->pos = pos + len;
+  if(stream->pos > stream->size) {
+    stream->size = stream->pos;
+  }
+  stream->last_use = clock_time();
+
+  if(IS_OPTION(packet, COAP_OPTION_BLOCK1)) {
+    coap_set_header_block1(response, packet->block1_num, packet->block1_more,
+                           packet->block1_size);
+    if(packet->block1_more) {
+      coap_set_status_code(response, CONTINUE_2_31);
+      return 1;
+    }
+  }
+
+  coap_cfs_stream_close(stream);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Block 2 support for resources that serve a file
+ *
+ *        Reads the block at *offset from the file of the stream into
+ *        buffer and sets it as the response payload. The first block
+ *        also carries the file size in a Size2 option, so that clients
+ *        can request the remaining blocks without waiting for each
+ *        other. With COAP_BLOCK_CFS_READ_AHEAD, the file is read in
+ *        chunks of that size and consecutive blocks are served from the
+ *        chunk in memory.
+ *
+ *        The arguments are those of the resource handler, and *offset is
+ *        advanced as the engine expects. The file is reopened for a
+ *        request at offset 0, so that a new download sees the current
+ *        file, and closed after the last block or when no block is
+ *        requested for COAP_BLOCK_CFS_IDLE_TIMEOUT. Requests fail with
+ *        5.03 while an upload to the file is in progress.
+ *
+ * \param request        Request pointer from the handler
+ * \param response       Response pointer from the handler
+ * \param buffer         Buffer pointer from the handler
+ * \param preferred_size Block size from the handler
+ * \param offset         Offset pointer from the handler
+ * \param stream         The file to serve
+ *
+ * \return The payload length, or -1 on failure with the error in
+ *         erbium_status_code
+ */
+int
+coap_block2_cfs_handler(void *request, void *response, uint8_t *buffer,
+                        uint16_t preferred_size, int32_t *offset,
+                        coap_cfs_stream_t *stream)
+{
+  cfs_offset_t pos = *offset;
+  int len;
+
+  stream_expire(stream);
+
+  if(stream->fd >= 0 && stream->writing) {
+    erbium_status_code = SERVICE_UNAVAILABLE_5_03;
+    coap_error_message = "UploadInProgress";
+    return -1;
+  }
+
+  if(pos == 0) {
+    /* a new download, possibly after an abandoned one */
+    coap_cfs_stream_close(stream);
+  }
+
+  if(stream->fd < 0) {
+    if(stream_open(stream, CFS_READ) < 0) {
+      erbium_status_code = NOT_FOUND_4_04;
+      coap_error_message = "NoFile";
+      return -1;
+    }
+    stream->size = cfs_seek(stream->fd, 0, CFS_SEEK_END);
+    stream->pos = stream->size;
+    if(stream->size < 0) {
+      coap_cfs_stream_close(stream);
+      erbium_status_code = INTERNAL_SERVER_ERROR_5_00;
+      coap_error_message = "SeekFailed";
+      return -1;
+    }
+  }
+
+  if(pos < 0 || pos > stream->size || (pos == stream->size && pos > 0)) {
+    erbium_status_code = BAD_OPTION_4_02;
+    coap_error_message = "BlockOutOfScope";
+    return -1;
+  }
+
+  len = MIN(preferred_size, stream->size - pos);
+  if(read_block(stream, pos, buffer, len) != len) {
+    coap_cfs_stream_close(stream);
+    erbium_status_code = INTERNAL_SERVER_ERROR_5_00;
+    coap_error_message = "ReadFailed";
+    return -1;
+  }
+
+  PRINTF("Block CFS: serve %d bytes @ %ld of %s\n", len, (long)pos,
+         stream->name);
+  stream->last_use = clock_time();
+
+  coap_set_payload(response, buffer, len);
+  if(pos == 0) {
+    coap_set_header_size2(response, stream->size);
+  }
+
+  if(pos + len < stream->size) {
+    *offset = pos + len;
+  } else {
+    *offset = -1;
+    coap_cfs_stream_close(stream);
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *      Block-wise transfers streamed to and from CFS files
+ */
+
+#ifndef COAP_BLOCK_CFS_H_
+#define COAP_BLOCK_CFS_H_
+
+#include <stdint.h>
+
+#include "cfs/cfs.h"
+#include "sys/clock.h"
+#include "er-coap.h"
+
+/**
+ * A file that a resource receives with Block1 or serves with Block2. The
+ * file stays open between the requests of a transfer, so that each block
+ * costs a seek and a read or write rather than an open of the file. It is
+ * closed after the last block, or once no block has arrived for
+ * COAP_BLOCK_CFS_IDLE_TIMEOUT.
+ */
+typedef struct coap_cfs_stream {
+  const char *name;
+  int fd;
+  uint8_t writing;
+  cfs_offset_t pos;             /* position of fd */
+  cfs_offset_t size;            /* file size, or bytes received so far */
+  clock_time_t last_use;        /* time of the last block */
+#if COAP_BLOCK_CFS_READ_AHEAD
+  cfs_offset_t cache_offset;    /* file offset of cache[0] */
+  uint16_t cache_len;
+  uint8_t cache[COAP_BLOCK_CFS_READ_AHEAD];
+#endif /* COAP_BLOCK_CFS_READ_AHEAD */
+} coap_cfs_stream_t;
+
+/* Declares a closed stream for the file filename. A download that starts
+   at offset 0 reopens the file. Close the stream after changing the file
+   by other means, so that a download in progress also reopens it. */
+#define COAP_CFS_STREAM(name, filename) \
+  coap_cfs_stream_t name = { (filename), -1 }
+
+int coap_block1_cfs_handler(void *request, void *response,
+                            coap_cfs_stream_t *stream, cfs_offset_t max_len);
+int coap_block2_cfs_handler(void *request, void *response, uint8_t *buffer,
+                            uint16_t preferred_size, int32_t *offset,
+                            coap_cfs_stream_t *stream);
+void coap_cfs_stream_close(coap_cfs_stream_t *stream);
+
+#endif /* COAP_BLOCK_CFS_H_ */
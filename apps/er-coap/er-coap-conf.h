@@ -53,17 +53,60 @@
 #define COAP_MAX_OPEN_TRANSACTIONS     4
 #endif /* COAP_MAX_OPEN_TRANSACTIONS */
 
+/* Adaptive retransmission timeouts (CoCoA). Instead of starting from the
+   fixed COAP_RESPONSE_TIMEOUT, confirmable messages start from an RTO
+   estimated per destination from the round-trip times of earlier
+   exchanges, and back off by a factor that depends on that RTO. */
+#ifndef COAP_CONGESTION_CONTROL
+#define COAP_CONGESTION_CONTROL        0
+#endif /* COAP_CONGESTION_CONTROL */
+
+/* The number of destinations for which round-trip state is kept */
+#ifndef COAP_CONGESTION_PEERS
+#define COAP_CONGESTION_PEERS          4
+#endif /* COAP_CONGESTION_PEERS */
+
+/* With congestion control, the number of confirmable transactions that may
+   be outstanding to a destination (NSTART). Further transactions to it wait
+   in the transaction layer. 0 lifts the limit. */
+#ifndef COAP_NSTART
+#define COAP_NSTART                    1
+#endif /* COAP_NSTART */
+
 /* Maximum number of failed request attempts before action */
 #ifndef COAP_MAX_ATTEMPTS
 #define COAP_MAX_ATTEMPTS              4
 #endif /* COAP_MAX_ATTEMPTS */
 
+/* Number of Block2 requests that a blocking request keeps in flight.
+   Blocks are still passed to the response handler in order; one that
+   arrives ahead of its predecessors is requested again. */
+#ifndef COAP_BLOCK2_PIPELINE
+#define COAP_BLOCK2_PIPELINE           1
+#endif /* COAP_BLOCK2_PIPELINE */
+
+/* Bytes read ahead from a file that is served with
+   coap_block2_cfs_handler(). 0 reads each block straight into the
+   response buffer. */
+#ifndef COAP_BLOCK_CFS_READ_AHEAD
+#define COAP_BLOCK_CFS_READ_AHEAD      256
+#endif /* COAP_BLOCK_CFS_READ_AHEAD */
+
+/* Clock ticks without a block after which the file of a block-wise
+   transfer through er-coap-block-cfs is closed. The file of an
+   unfinished upload is removed. */
+#ifndef COAP_BLOCK_CFS_IDLE_TIMEOUT
+#define COAP_BLOCK_CFS_IDLE_TIMEOUT    (60 * CLOCK_SECOND)
+#endif /* COAP_BLOCK_CFS_IDLE_TIMEOUT */
+
 /* Conservative size limit, as not all options have to be set at the same time. Check when Proxy-Uri option is used */
 #ifndef COAP_MAX_HEADER_SIZE    /*     Hdr                  CoF  If-Match         Obs Blo strings   */
 #define COAP_MAX_HEADER_SIZE           (4 + COAP_TOKEN_LEN + 3 + 1 + COAP_ETAG_LEN + 4 + 4 + 30)  /* 65 */
 #endif /* COAP_MAX_HEADER_SIZE */
 
-/* Number of observer slots (each takes abot xxx bytes) */
+/* Number of observer slots. Notifications are serialized once into a
+   shared buffer, so observers do not hold transactions and may exceed
+   COAP_MAX_OPEN_TRANSACTIONS. The default keeps the earlier RAM use. */
 #ifndef COAP_MAX_OBSERVERS
 #define COAP_MAX_OBSERVERS    COAP_MAX_OPEN_TRANSACTIONS - 1
 #endif /* COAP_MAX_OBSERVERS */
@@ -208,12 +208,14 @@ coap_receive(void)
                 /* serialize response */
             }
             if(erbium_status_code == NO_ERROR) {
-              if((transaction->packet_len = coap_serialize_message(response,
-                                                                   transaction->
-                                                                   packet)) ==
+              /* the handler wrote the payload into the packet already */
+              if((transaction->packet_len =
+                    coap_serialize_message_in_place(response,
+                                                    transaction->packet)) ==
                  0) {
                 erbium_status_code = PACKET_SERIALIZATION_ERROR;
               }
+              transaction->message = response->buffer;
             }
           } else {
             erbium_status_code = NOT_IMPLEMENTED_5_01;
@@ -233,6 +235,8 @@ coap_receive(void)
         } else if(message->type == COAP_TYPE_ACK) {
           /* transactions are closed through lookup below */
           PRINTF("Received ACK\n");
+          coap_observe_ack(&UIP_IP_BUF->srcipaddr, UIP_UDP_BUF->srcport,
+                           message->mid);
         } else if(message->type == COAP_TYPE_RST) {
           PRINTF("Received RST\n");
           /* cancel possible subscriptions */
@@ -245,6 +249,7 @@ coap_receive(void)
           restful_response_handler callback = transaction->callback;
           void *callback_data = transaction->callback_data;
 
+          coap_transaction_acked(transaction);
           coap_clear_transaction(transaction);
 
           /* check if someone registered for the response */
@@ -350,6 +355,7 @@ PROCESS_THREAD(coap_engine, ev, data)
     } else if(ev == PROCESS_EVENT_TIMER) {
       /* retransmissions are handled here */
       coap_check_transactions();
+      coap_check_notifications();
     }
   } /* while (1) */
 
@@ -358,78 +364,185 @@ PROCESS_THREAD(coap_engine, ev, data)
 /*---------------------------------------------------------------------------*/
 /*- Client Part -------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
+#define SLOT_FREE       0
+#define SLOT_SENT       1
+#define SLOT_AHEAD      2       /* arrived early, to be requested again */
+
 void
 coap_blocking_request_callback(void *callback_data, void *response)
 {
-  struct request_state_t *state = (struct request_state_t *)callback_data;
-
-  state->response = (coap_packet_t *)response;
+  struct request_slot_t *slot = (struct request_slot_t *)callback_data;
+  struct request_state_t *state = slot->state;
+  coap_packet_t *res = (coap_packet_t *)response;
+  uint32_t res_block = 0;
+  uint32_t size2 = 0;
+  uint16_t res_size = 0;
+  uint8_t more = 0;
+  int i;
+
+  slot->status = SLOT_FREE;
   process_poll(state->process);
+
+  if(!res) {
+    PRINTF("Server not responding\n");
+    state->failed = 1;
+    return;
+  }
+
+  coap_get_header_block2(res, &res_block, &more, &res_size, NULL);
+
+  PRINTF("Received #%lu%s (%u bytes)\n", res_block, more ? "+" : "",
+         res->payload_len);
+
+  if(res_block != slot->block_num) {
+    if(slot->block_num == state->block_num) {
+      PRINTF("WRONG BLOCK %lu/%lu\n", res_block, state->block_num);
+      ++state->block_error;
+    } else if(slot->block_num <= state->last_block) {
+      /* probably past the end; stop requesting ahead of it */
+      state->last_block = slot->block_num - 1;
+    }
+    return;
+  }
+  if(res_block != state->block_num) {
+    /* ahead of a missing block; requested again once that has arrived */
+    slot->status = SLOT_AHEAD;
+    return;
+  }
+
+  if(state->block_size == 0 && IS_OPTION(res, COAP_OPTION_BLOCK2)) {
+    /* continue with the block size of the server, if we can take it */
+    state->block_size = MIN(res_size, COAP_MAX_BLOCK_SIZE);
+    state->block_num = res_size / state->block_size - 1;
+    if(coap_get_header_size2(res, &size2) && size2 > 0) {
+      state->last_block = (size2 - 1) / state->block_size;
+    }
+  }
+
+  state->response = res;
+  PROCESS_CONTEXT_BEGIN(state->process);
+  state->callback(res);
+  PROCESS_CONTEXT_END(state->process);
+  ++(state->block_num);
+  state->more = more;
+
+  for(i = 0; i < COAP_BLOCK2_PIPELINE; i++) {
+    if(state->slots[i].status == SLOT_AHEAD) {
+      state->slots[i].status = SLOT_FREE;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+send_block_request(struct request_state_t *state, struct request_slot_t *slot,
+                   uint32_t block_num, uip_ipaddr_t *remote_ipaddr,
+                   uint16_t remote_port, coap_packet_t *request)
+{
+  request->mid = coap_get_mid();
+  if(!(state->transaction = coap_new_transaction(request->mid, remote_ipaddr,
+                                                 remote_port))) {
+    return 0;
+  }
+  state->transaction->callback = coap_blocking_request_callback;
+  state->transaction->callback_data = slot;
+
+  if(block_num > 0) {
+    coap_set_header_block2(request, block_num, 0, state->block_size);
+  }
+  state->transaction->packet_len = coap_serialize_message(request,
+                                                          state->
+                                                          transaction->
+                                                          packet);
+  slot->block_num = block_num;
+  slot->mid = request->mid;
+  slot->status = SLOT_SENT;
+
+  coap_send_transaction(state->transaction);
+  PRINTF("Requested #%lu (MID %u)\n", block_num, request->mid);
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
+/* Keeps up to COAP_BLOCK2_PIPELINE block requests in flight, once the
+   first response has given the block size. Blocks are passed to
+   request_callback in order from the response callback, while the
+   response is still in the buffer. */
 PT_THREAD(coap_blocking_request
             (struct request_state_t *state, process_event_t ev,
             uip_ipaddr_t *remote_ipaddr, uint16_t remote_port,
             coap_packet_t *request,
             blocking_response_handler request_callback))
 {
-  PT_BEGIN(&state->pt);
+  struct request_slot_t *slot;
+  uint32_t block_num;
+  uint32_t window;
+  int requested;
+  int sent;
+  int i;
 
-  static uint8_t more;
-  static uint32_t res_block;
-  static uint8_t block_error;
+  PT_BEGIN(&state->pt);
 
-  state->block_num = 0;
-  state->response = NULL;
   state->process = PROCESS_CURRENT();
+  state->callback = request_callback;
+  state->transaction = NULL;
+  state->response = NULL;
+  state->block_num = 0;
+  state->last_block = 0xFFFFFFFF;
+  state->block_size = 0;
+  state->more = 1;
+  state->block_error = 0;
+  state->failed = 0;
+  for(i = 0; i < COAP_BLOCK2_PIPELINE; i++) {
+    state->slots[i].state = state;
+    state->slots[i].status = SLOT_FREE;
+  }
 
-  more = 0;
-  res_block = 0;
-  block_error = 0;
-
-  do {
-    request->mid = coap_get_mid();
-    if((state->transaction = coap_new_transaction(request->mid, remote_ipaddr,
-                                                  remote_port))) {
-      state->transaction->callback = coap_blocking_request_callback;
-      state->transaction->callback_data = state;
-
-      if(state->block_num > 0) {
-        coap_set_header_block2(request, state->block_num, 0,
-                               REST_MAX_CHUNK_SIZE);
+  while(state->more && !state->failed &&
+        state->block_error < COAP_MAX_ATTEMPTS) {
+    window = state->block_size ? COAP_BLOCK2_PIPELINE : 1;
+    for(block_num = state->block_num;
+        block_num < state->block_num + window &&
+        (block_num == state->block_num || block_num <= state->last_block);
+        block_num++) {
+      slot = NULL;
+      requested = 0;
+      for(i = 0; i < COAP_BLOCK2_PIPELINE; i++) {
+        if(state->slots[i].status == SLOT_FREE) {
+          if(slot == NULL) {
+            slot = &state->slots[i];
+          }
+        } else if(state->slots[i].block_num == block_num) {
+          requested = 1;
+        }
       }
-      state->transaction->packet_len = coap_serialize_message(request,
-                                                              state->
-                                                              transaction->
-                                                              packet);
-
-      coap_send_transaction(state->transaction);
-      PRINTF("Requested #%lu (MID %u)\n", state->block_num, request->mid);
-
-      PT_YIELD_UNTIL(&state->pt, ev == PROCESS_EVENT_POLL);
-
-      if(!state->response) {
-        PRINTF("Server not responding\n");
-        PT_EXIT(&state->pt);
+      if(requested) {
+        continue;
+      }
+      if(slot == NULL ||
+         !send_block_request(state, slot, block_num, remote_ipaddr,
+                             remote_port, request)) {
+        break;
       }
+    }
 
-      coap_get_header_block2(state->response, &res_block, &more, NULL, NULL);
+    sent = 0;
+    for(i = 0; i < COAP_BLOCK2_PIPELINE; i++) {
+      sent |= state->slots[i].status == SLOT_SENT;
+    }
+    if(!sent) {
+      PRINTF("Could not allocate transaction buffer");
+      break;
+    }
 
-      PRINTF("Received #%lu%s (%u bytes)\n", res_block, more ? "+" : "",
-             state->response->payload_len);
+    PT_YIELD_UNTIL(&state->pt, ev == PROCESS_EVENT_POLL);
+  }
 
-      if(res_block == state->block_num) {
-        request_callback(state->response);
-        ++(state->block_num);
-      } else {
-        PRINTF("WRONG BLOCK %lu/%lu\n", res_block, state->block_num);
-        ++block_error;
-      }
-    } else {
-      PRINTF("Could not allocate transaction buffer");
-      PT_EXIT(&state->pt);
+  /* drop requests that are no longer needed */
+  for(i = 0; i < COAP_BLOCK2_PIPELINE; i++) {
+    if(state->slots[i].status == SLOT_SENT) {
+      coap_clear_transaction(coap_get_transaction_by_mid(state->slots[i].mid));
     }
-  } while(more && block_error < COAP_MAX_ATTEMPTS);
+    state->slots[i].status = SLOT_FREE;
+  }
 
   PT_END(&state->pt);
 }
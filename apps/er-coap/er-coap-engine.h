@@ -51,21 +51,40 @@
 typedef coap_packet_t rest_request_t;
 typedef coap_packet_t rest_response_t;
 
+PROCESS_NAME(coap_engine);
+
 void coap_init_engine(void);
 
 /*---------------------------------------------------------------------------*/
 /*- Client Part -------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
+typedef void (*blocking_response_handler)(void *response);
+
+struct request_state_t;
+
+/* A Block2 request in flight */
+struct request_slot_t {
+  struct request_state_t *state;
+  uint32_t block_num;
+  uint16_t mid;
+  uint8_t status;
+};
+
 struct request_state_t {
   struct pt pt;
   struct process *process;
   coap_transaction_t *transaction;
   coap_packet_t *response;
-  uint32_t block_num;
+  blocking_response_handler callback;
+  uint32_t block_num;           /* next block for the callback */
+  uint32_t last_block;          /* from Size2, if the server sent it */
+  uint16_t block_size;
+  uint8_t more;
+  uint8_t block_error;
+  uint8_t failed;
+  struct request_slot_t slots[COAP_BLOCK2_PIPELINE];
 };
 
-typedef void (*blocking_response_handler)(void *response);
-
 PT_THREAD(coap_blocking_request
             (struct request_state_t *state, process_event_t ev,
             uip_ipaddr_t *remote_ipaddr, uint16_t remote_port,
@@ -39,6 +39,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "er-coap-observe.h"
+#include "er-coap-engine.h"
 
 #define DEBUG 0
 #if DEBUG
@@ -55,12 +56,29 @@
 /*---------------------------------------------------------------------------*/
 MEMB(observers_memb, coap_observer_t, COAP_MAX_OBSERVERS);
 LIST(observers_list);
+
+/* The last notification, serialized once without Token and with a
+   fixed-width Observe value, so that only the header, Token and
+   Observe value are patched per observer. The space in front of the
+   header takes the Token. */
+static struct {
+  resource_t *resource;
+  char url[COAP_OBSERVER_URL_LEN];
+  int url_len;
+  int res_url_len;
+  uint16_t start;       /* offset of the header in buffer */
+  uint16_t len;         /* options and payload */
+  uint16_t observe;     /* offset of the Observe value, 0 if none */
+  uint8_t code;
+  uint8_t buffer[COAP_TOKEN_LEN + COAP_MAX_PACKET_SIZE + 1];
+} shared;
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 static coap_observer_t *
-add_observer(uip_ipaddr_t *addr, uint16_t port, const uint8_t *token,
-             size_t token_len, const char *uri, int uri_len)
+add_observer(resource_t *resource, uip_ipaddr_t *addr, uint16_t port,
+             const uint8_t *token, size_t token_len, const char *uri,
+             int uri_len)
 {
   /* Remove existing observe relationship, if any. */
   coap_remove_observer_by_uri(addr, port, uri);
@@ -74,6 +92,9 @@ add_observer(uip_ipaddr_t *addr, uint16_t port, const uint8_t *token,
     }
     memcpy(o->url, uri, max);
     o->url[max] = 0;
+    o->resource = resource;
+    o->con_pending = 0;
+    o->retrans_counter = 0;
     uip_ipaddr_copy(&o->addr, addr);
     o->port = port;
     o->token_len = token_len;
@@ -89,6 +110,12 @@ add_observer(uip_ipaddr_t *addr, uint16_t port, const uint8_t *token,
   return o;
 }
 /*---------------------------------------------------------------------------*/
+list_t
+coap_get_observers(void)
+{
+  return observers_list;
+}
+/*---------------------------------------------------------------------------*/
 /*- Removal -----------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 void
@@ -97,6 +124,7 @@ coap_remove_observer(coap_observer_t *o)
   PRINTF("Removing observer for /%s [0x%02X%02X]\n", o->url, o->token[0],
          o->token[1]);
 
+  etimer_stop(&o->retrans_timer);
   memb_free(&observers_memb, o);
   list_remove(observers_list, o);
 }
@@ -185,15 +213,134 @@ coap_notify_observers(resource_t *resource)
 {
   coap_notify_observers_sub(resource, NULL);
 }
-void
-coap_notify_observers_sub(resource_t *resource, const char *subpath)
+/*---------------------------------------------------------------------------*/
+static int
+observer_matches(coap_observer_t *obs, resource_t *resource,
+                 const char *url, int url_len, int res_url_len)
+{
+  int obs_url_len;
+
+  /* Observers are bound to the resource that accepted them, so only
+     the sub-resource part of the URL is left to compare. */
+  if(obs->resource != resource) {
+    return 0;
+  }
+  obs_url_len = strlen(obs->url);
+
+  /* Do a match based on the parent/sub-resource match so that it is
+     possible to do parent-node observe */
+  return (obs_url_len == url_len
+          || (obs_url_len > url_len
+              && (resource->flags & HAS_SUB_RESOURCES)
+              && obs->url[url_len] == '/'))
+         && memcmp(&url[res_url_len], &obs->url[res_url_len],
+                   url_len - res_url_len) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+prepare_notification(resource_t *resource, const char *url)
 {
-  /* build notification */
   coap_packet_t notification[1]; /* this way the packet can be treated as pointer as usual */
   coap_packet_t request[1]; /* this way the packet can be treated as pointer as usual */
+  uint8_t *packet = &shared.buffer[COAP_TOKEN_LEN];
+  coap_option_iterator_t it;
+  unsigned int number;
+  const uint8_t *value;
+  size_t len;
+  int packet_len;
+
+  shared.resource = NULL;
+  shared.url_len = strlen(url);
+  memcpy(shared.url, url, shared.url_len + 1);
+  shared.res_url_len = strlen(resource->url);
+  if(shared.res_url_len > shared.url_len) {
+    shared.res_url_len = shared.url_len;
+  }
+
+  coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
+  /* create a "fake" request for the URI */
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_uri_path(request, shared.url);
+
+  resource->get_handler(request, notification,
+                        packet + COAP_MAX_HEADER_SIZE,
+                        REST_MAX_CHUNK_SIZE, NULL);
+
+  if(notification->code < BAD_REQUEST_4_00) {
+    /* any value above 16 bits takes the full three bytes */
+    coap_set_header_observe(notification, 0x10000);
+  }
+  packet_len = coap_serialize_message_in_place(notification, packet);
+  if(packet_len == 0) {
+    PRINTF("Observe: cannot serialize notification for %s\n", url);
+    return 0;
+  }
+  shared.start = notification->buffer - shared.buffer;
+  shared.code = notification->code;
+  shared.len = packet_len - COAP_HEADER_LEN;
+
+  /* Find the Observe value among the options */
+  shared.observe = 0;
+  coap_option_iterator_init(&it, notification);
+  while(coap_option_next(&it, &number, &value, &len)
+        && number <= COAP_OPTION_OBSERVE) {
+    if(number == COAP_OPTION_OBSERVE) {
+      shared.observe = value - notification->buffer;
+    }
+  }
+
+  shared.resource = resource;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_notification(coap_observer_t *obs, coap_message_type_t type)
+{
+  uint8_t *packet = &shared.buffer[shared.start - obs->token_len];
+  uint32_t observe;
+
+  PRINTF("           Observer ");
+  PRINT6ADDR(&obs->addr);
+  PRINTF(":%u, MID %u%s\n", obs->port, obs->last_mid,
+         type == COAP_TYPE_CON ? ", CON" : "");
+
+  /* The Token goes in front of the shared options and payload, the
+     header in front of the Token. */
+  packet[0] = COAP_HEADER_VERSION_MASK & (1 << COAP_HEADER_VERSION_POSITION);
+  packet[0] |= COAP_HEADER_TYPE_MASK & (type << COAP_HEADER_TYPE_POSITION);
+  packet[0] |= COAP_HEADER_TOKEN_LEN_MASK
+    & (obs->token_len << COAP_HEADER_TOKEN_LEN_POSITION);
+  packet[1] = shared.code;
+  packet[2] = (uint8_t)(obs->last_mid >> 8);
+  packet[3] = (uint8_t)(obs->last_mid);
+  memcpy(&packet[COAP_HEADER_LEN], obs->token, obs->token_len);
+
+  if(shared.observe) {
+    observe = obs->obs_counter - 1;
+    shared.buffer[shared.start + shared.observe] = (uint8_t)(observe >> 16);
+    shared.buffer[shared.start + shared.observe + 1] = (uint8_t)(observe >> 8);
+    shared.buffer[shared.start + shared.observe + 2] = (uint8_t)(observe);
+  }
+
+  coap_send_message(&obs->addr, obs->port, packet,
+                    COAP_HEADER_LEN + obs->token_len + shared.len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_retransmission_timer(coap_observer_t *obs, clock_time_t interval)
+{
+  PROCESS_CONTEXT_BEGIN(&coap_engine);
+  etimer_set(&obs->retrans_timer, interval);
+  PROCESS_CONTEXT_END(&coap_engine);
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_notify_observers_sub(resource_t *resource, const char *subpath)
+{
   coap_observer_t *obs = NULL;
-  int url_len, obs_url_len;
+  int url_len, res_url_len;
   char url[COAP_OBSERVER_URL_LEN];
+  uint8_t prepared = 0;
 
   url_len = strlen(resource->url);
   strncpy(url, resource->url, COAP_OBSERVER_URL_LEN - 1);
@@ -205,59 +352,114 @@ coap_notify_observers_sub(resource_t *resource, const char *subpath)
   /* url now contains the notify URL that needs to match the observer */
   PRINTF("Observe: Notification from %s\n", url);
 
-  coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
-  /* create a "fake" request for the URI */
-  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
-  coap_set_header_uri_path(request, url);
-
   /* iterate over observers */
+  res_url_len = url_len;
   url_len = strlen(url);
+  if(res_url_len > url_len) {
+    res_url_len = url_len;
+  }
   for(obs = (coap_observer_t *)list_head(observers_list); obs;
       obs = obs->next) {
-    obs_url_len = strlen(obs->url);
-
-    /* Do a match based on the parent/sub-resource match so that it is
-       possible to do parent-node observe */
-    if((obs_url_len == url_len
-        || (obs_url_len > url_len
-            && (resource->flags & HAS_SUB_RESOURCES)
-            && obs->url[url_len] == '/'))
-       && strncmp(url, obs->url, url_len) == 0) {
-      coap_transaction_t *transaction = NULL;
-
-      /*TODO implement special transaction for CON, sharing the same buffer to allow for more observers */
-
-      if((transaction = coap_new_transaction(coap_get_mid(), &obs->addr, obs->port))) {
-        if(obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0) {
-          PRINTF("           Force Confirmable for\n");
-          notification->type = COAP_TYPE_CON;
-        }
+    if(!observer_matches(obs, resource, url, url_len, res_url_len)) {
+      continue;
+    }
+
+    /* The representation is built and serialized once, for the first
+       matching observer, and shared by all the others. */
+    if(!prepared) {
+      if(!prepare_notification(resource, url)) {
+        return;
+      }
+      prepared = 1;
+    }
 
-        PRINTF("           Observer ");
-        PRINT6ADDR(&obs->addr);
-        PRINTF(":%u\n", obs->port);
+    /* update last MID for RST and ACK matching */
+    obs->last_mid = coap_get_mid();
 
-        /* update last MID for RST matching */
-        obs->last_mid = transaction->mid;
+    if(obs->con_pending) {
+      /* Replace the unacknowledged notification, keeping its
+         retransmission counter and timer. */
+      PRINTF("           Replacing pending CON\n");
+    } else if(obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0) {
+      PRINTF("           Force Confirmable for\n");
+      obs->con_pending = 1;
+      obs->retrans_counter = 0;
+      set_retransmission_timer(obs,
+                               coap_get_initial_timeout(&obs->addr,
+                                                        &obs->backoff));
+    }
+#if COAP_CONGESTION_CONTROL
+    obs->con_sent = clock_time();
+#endif /* COAP_CONGESTION_CONTROL */
+
+    if(shared.observe) {
+      (obs->obs_counter)++;
+    }
+    send_notification(obs, obs->con_pending ? COAP_TYPE_CON : COAP_TYPE_NON);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_observe_ack(uip_ipaddr_t *addr, uint16_t port, uint16_t mid)
+{
+  coap_observer_t *obs = NULL;
 
-        /* prepare response */
-        notification->mid = transaction->mid;
+  for(obs = (coap_observer_t *)list_head(observers_list); obs;
+      obs = obs->next) {
+    if(obs->con_pending && obs->last_mid == mid
+       && uip_ipaddr_cmp(&obs->addr, addr) && obs->port == port) {
+      PRINTF("Observe: notification %u acknowledged\n", mid);
+      obs->con_pending = 0;
+      etimer_stop(&obs->retrans_timer);
+#if COAP_CONGESTION_CONTROL
+      /* only a notification that was sent once gives an unambiguous RTT */
+      if(obs->con_sent != 0) {
+        coap_update_rtt(addr, clock_time() - obs->con_sent, 0);
+      }
+#endif /* COAP_CONGESTION_CONTROL */
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_check_notifications(void)
+{
+  coap_observer_t *obs = NULL;
 
-        resource->get_handler(request, notification,
-                              transaction->packet + COAP_MAX_HEADER_SIZE,
-                              REST_MAX_CHUNK_SIZE, NULL);
+  obs = (coap_observer_t *)list_head(observers_list);
+  while(obs) {
+    if(!obs->con_pending || !etimer_expired(&obs->retrans_timer)) {
+      obs = obs->next;
+      continue;
+    }
 
-        if(notification->code < BAD_REQUEST_4_00) {
-          coap_set_header_observe(notification, (obs->obs_counter)++);
-        }
-        coap_set_token(notification, obs->token, obs->token_len);
+    if(obs->retrans_counter == COAP_MAX_RETRANSMIT) {
+      PRINTF("Observe: notification %u timed out\n", obs->last_mid);
+      coap_remove_observer_by_client(&obs->addr, obs->port);
+      /* start over, as observers have been removed */
+      obs = (coap_observer_t *)list_head(observers_list);
+      continue;
+    }
 
-        transaction->packet_len =
-          coap_serialize_message(notification, transaction->packet);
+    ++(obs->retrans_counter);
+    PRINTF("Observe: retransmitting %u (%u)\n", obs->last_mid,
+           obs->retrans_counter);
+    set_retransmission_timer(obs, obs->retrans_timer.timer.interval
+                             * obs->backoff / 2);
+#if COAP_CONGESTION_CONTROL
+    obs->con_sent = 0;
+#endif /* COAP_CONGESTION_CONTROL */
 
-        coap_send_transaction(transaction);
-      }
+    /* The shared notification may have been built for another URL in
+       the meantime; if so, rebuild it for this observer. */
+    if(shared.resource == obs->resource
+       && observer_matches(obs, shared.resource, shared.url,
+                           shared.url_len, shared.res_url_len)) {
+      send_notification(obs, COAP_TYPE_CON);
+    } else if(prepare_notification(obs->resource, obs->url)) {
+      send_notification(obs, COAP_TYPE_CON);
     }
+    obs = obs->next;
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -267,13 +469,17 @@ coap_observe_handler(resource_t *resource, void *request, void *response)
   coap_packet_t *const coap_req = (coap_packet_t *)request;
   coap_packet_t *const coap_res = (coap_packet_t *)response;
   coap_observer_t * obs;
+  const char *uri_path = NULL;
+  int uri_path_len;
 
   if(coap_req->code == COAP_GET && coap_res->code < 128) { /* GET request and response without error code */
     if(IS_OPTION(coap_req, COAP_OPTION_OBSERVE)) {
       if(coap_req->observe == 0) {
-        obs = add_observer(&UIP_IP_BUF->srcipaddr, UIP_UDP_BUF->srcport,
+        uri_path_len = coap_get_header_uri_path(coap_req, &uri_path);
+        obs = add_observer(resource,
+                           &UIP_IP_BUF->srcipaddr, UIP_UDP_BUF->srcport,
                            coap_req->token, coap_req->token_len,
-                           coap_req->uri_path, coap_req->uri_path_len);
+                           uri_path, uri_path_len);
        if(obs) {
           coap_set_header_observe(coap_res, (obs->obs_counter)++);
           /*
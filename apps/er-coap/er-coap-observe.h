@@ -56,6 +56,7 @@ typedef struct coap_observable {
 typedef struct coap_observer {
   struct coap_observer *next;   /* for LIST */
 
+  resource_t *resource;          /* resource that accepted the observe */
   char url[COAP_OBSERVER_URL_LEN];
   uip_ipaddr_t addr;
   uint16_t port;
@@ -65,8 +66,14 @@ typedef struct coap_observer {
 
   int32_t obs_counter;
 
+  /* retransmission state of a confirmable notification */
   struct etimer retrans_timer;
   uint8_t retrans_counter;
+  uint8_t backoff;
+  uint8_t con_pending;
+#if COAP_CONGESTION_CONTROL
+  clock_time_t con_sent;        /* 0 once retransmitted */
+#endif /* COAP_CONGESTION_CONTROL */
 } coap_observer_t;
 
 list_t coap_get_observers(void);
@@ -82,6 +89,9 @@ int coap_remove_observer_by_mid(uip_ipaddr_t *addr, uint16_t port,
 void coap_notify_observers(resource_t *resource);
 void coap_notify_observers_sub(resource_t *resource, const char *subpath);
 
+void coap_observe_ack(uip_ipaddr_t *addr, uint16_t port, uint16_t mid);
+void coap_check_notifications(void);
+
 void coap_observe_handler(resource_t *resource, void *request,
                           void *response);
 
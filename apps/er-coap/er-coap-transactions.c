@@ -59,9 +59,170 @@ LIST(transactions_list);
 
 static struct process *transaction_handler_process = NULL;
 
+#if COAP_CONGESTION_CONTROL
+/* CoCoA starts from an RTO of 2 s. The lower bound keeps the RTO from
+   collapsing on very short paths, the upper one follows the maximum
+   timeout of CoAP. */
+#define INITIAL_RTO  (2 * CLOCK_SECOND)
+#define MIN_RTO      (CLOCK_SECOND / 10)
+#define MAX_RTO      (32 * CLOCK_SECOND)
+#define K_STRONG     4
+#define K_WEAK       1
+
+#define FLAG_COUNTED  0x01 /* counts as outstanding for its destination */
+#define FLAG_QUEUED   0x02 /* waits for COAP_NSTART */
+#define FLAG_RELEASED 0x04 /* may be sent by coap_check_transactions() */
+
+MEMB(peers_memb, coap_peer_t, COAP_CONGESTION_PEERS);
+LIST(peers_list);
+
+struct coap_transaction_stats coap_transaction_stats;
+#endif /* COAP_CONGESTION_CONTROL */
+
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
+#if COAP_CONGESTION_CONTROL
+static coap_peer_t *
+find_peer(const uip_ipaddr_t *addr, int create)
+{
+  coap_peer_t *p;
+  coap_peer_t *victim = NULL;
+
+  for(p = list_head(peers_list); p != NULL; p = p->next) {
+    if(uip_ipaddr_cmp(&p->addr, addr)) {
+      return p;
+    }
+    /* the least recently used destination is at the tail */
+    if(p->outstanding == 0) {
+      victim = p;
+    }
+  }
+  if(!create) {
+    return NULL;
+  }
+
+  p = memb_alloc(&peers_memb);
+  if(p == NULL) {
+    p = victim;
+    if(p == NULL) {
+      return NULL;
+    }
+    list_remove(peers_list, p);
+  }
+  memset(p, 0, sizeof(*p));
+  uip_ipaddr_copy(&p->addr, addr);
+  p->rto = INITIAL_RTO;
+  p->updated = clock_time();
+  list_push(peers_list, p);
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+/* RFC 6298 estimator, in 1/8 clock ticks, returning SRTT + k * RTTVAR */
+static clock_time_t
+estimate(uint32_t *srtt, uint32_t *rttvar, clock_time_t rtt, uint8_t k)
+{
+  uint32_t r = (uint32_t)rtt << 3;
+  uint32_t delta;
+
+  if(*srtt == 0 && *rttvar == 0) {
+    *srtt = r;
+    *rttvar = r / 2;
+  } else {
+    delta = *srtt > r ? *srtt - r : r - *srtt;
+    *rttvar = *rttvar - *rttvar / 4 + delta / 4;
+    *srtt = *srtt - *srtt / 8 + r / 8;
+  }
+  return (*srtt + k * *rttvar) >> 3;
+}
+/*---------------------------------------------------------------------------*/
+const coap_peer_t *
+coap_get_peer(const uip_ipaddr_t *addr)
+{
+  return find_peer(addr, 0);
+}
+/*---------------------------------------------------------------------------*/
+list_t
+coap_get_peers(void)
+{
+  return peers_list;
+}
+#endif /* COAP_CONGESTION_CONTROL */
+/*---------------------------------------------------------------------------*/
+clock_time_t
+coap_get_initial_timeout(const uip_ipaddr_t *addr, uint8_t *backoff)
+{
+#if COAP_CONGESTION_CONTROL
+  coap_peer_t *p;
+  clock_time_t now;
+
+  p = find_peer(addr, 1);
+  if(p != NULL) {
+    /* keep recently used destinations at the head */
+    list_remove(peers_list, p);
+    list_push(peers_list, p);
+
+    /* Age an RTO that has not been updated for a while towards the
+       initial one. */
+    now = clock_time();
+    if(p->rto < CLOCK_SECOND && now - p->updated > 16 * p->rto) {
+      p->rto *= 2;
+      p->updated = now;
+    } else if(p->rto > 3 * CLOCK_SECOND && now - p->updated > 4 * p->rto) {
+      p->rto = (INITIAL_RTO + p->rto) / 2;
+      p->updated = now;
+    }
+
+    /* variable backoff factor: 3 below 1 s, 1.5 above 3 s, 2 otherwise */
+    if(p->rto < CLOCK_SECOND) {
+      *backoff = 6;
+    } else if(p->rto > 3 * CLOCK_SECOND) {
+      *backoff = 3;
+    } else {
+      *backoff = 4;
+    }
+    return p->rto + random_rand() % (p->rto / 2 + 1);
+  }
+#endif /* COAP_CONGESTION_CONTROL */
+
+  *backoff = 4;
+  return COAP_RESPONSE_TIMEOUT_TICKS +
+         (random_rand() % (clock_time_t)COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_update_rtt(const uip_ipaddr_t *addr, clock_time_t rtt,
+                uint8_t retransmissions)
+{
+#if COAP_CONGESTION_CONTROL
+  coap_peer_t *p;
+  clock_time_t rto;
+
+  /* after more retransmissions, the sample tells too little */
+  if(retransmissions > 2 || (p = find_peer(addr, 0)) == NULL) {
+    return;
+  }
+
+  if(retransmissions == 0) {
+    rto = estimate(&p->strong_srtt, &p->strong_rttvar, rtt, K_STRONG);
+    p->rto = rto / 2 + p->rto / 2;
+    coap_transaction_stats.strong_rtts++;
+  } else {
+    rto = estimate(&p->weak_srtt, &p->weak_rttvar, rtt, K_WEAK);
+    p->rto = rto / 4 + p->rto - p->rto / 4;
+    coap_transaction_stats.weak_rtts++;
+  }
+  if(p->rto < MIN_RTO) {
+    p->rto = MIN_RTO;
+  } else if(p->rto > MAX_RTO) {
+    p->rto = MAX_RTO;
+  }
+  p->updated = clock_time();
+  PRINTF("RTT %lu after %u retransmissions, RTO %lu\n", (unsigned long)rtt,
+         retransmissions, (unsigned long)p->rto);
+#endif /* COAP_CONGESTION_CONTROL */
+}
+/*---------------------------------------------------------------------------*/
 void
 coap_register_as_transaction_handler()
 {
@@ -75,6 +236,10 @@ coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr, uint16_t port)
   if(t) {
     t->mid = mid;
     t->retrans_counter = 0;
+    t->message = t->packet;
+#if COAP_CONGESTION_CONTROL
+    t->flags = 0;
+#endif /* COAP_CONGESTION_CONTROL */
 
     /* save client address */
     uip_ipaddr_copy(&t->addr, addr);
@@ -91,25 +256,46 @@ coap_send_transaction(coap_transaction_t *t)
 {
   PRINTF("Sending transaction %u\n", t->mid);
 
-  coap_send_message(&t->addr, t->port, t->packet, t->packet_len);
-
   if(COAP_TYPE_CON ==
-     ((COAP_HEADER_TYPE_MASK & t->packet[0]) >> COAP_HEADER_TYPE_POSITION)) {
+     ((COAP_HEADER_TYPE_MASK & t->message[0]) >> COAP_HEADER_TYPE_POSITION)) {
+#if COAP_CONGESTION_CONTROL
+    if(t->retrans_counter == 0) {
+      coap_peer_t *p = find_peer(&t->addr, 1);
+
+      if(p != NULL && !(t->flags & FLAG_COUNTED)) {
+        if(COAP_NSTART && p->outstanding >= COAP_NSTART) {
+          PRINTF("Queueing transaction %u\n", t->mid);
+          if(!(t->flags & FLAG_QUEUED)) {
+            t->flags |= FLAG_QUEUED;
+            coap_transaction_stats.queued++;
+          }
+          return;
+        }
+        t->flags = FLAG_COUNTED;
+        p->outstanding++;
+      }
+      t->start = clock_time();
+      coap_transaction_stats.transmissions++;
+    } else {
+      coap_transaction_stats.retransmissions++;
+    }
+#endif /* COAP_CONGESTION_CONTROL */
+
+    coap_send_message(&t->addr, t->port, t->message, t->packet_len);
+
     if(t->retrans_counter < COAP_MAX_RETRANSMIT) {
       /* not timed out yet */
       PRINTF("Keeping transaction %u\n", t->mid);
 
       if(t->retrans_counter == 0) {
         t->retrans_timer.timer.interval =
-          COAP_RESPONSE_TIMEOUT_TICKS + (random_rand()
-                                         %
-                                         (clock_time_t)
-                                         COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
+          coap_get_initial_timeout(&t->addr, &t->backoff);
         PRINTF("Initial interval %f\n",
                (float)t->retrans_timer.timer.interval / CLOCK_SECOND);
       } else {
-        t->retrans_timer.timer.interval <<= 1;  /* double */
-        PRINTF("Doubled (%u) interval %f\n", t->retrans_counter,
+        t->retrans_timer.timer.interval =
+          t->retrans_timer.timer.interval * t->backoff / 2;
+        PRINTF("Backed off (%u) interval %f\n", t->retrans_counter,
                (float)t->retrans_timer.timer.interval / CLOCK_SECOND);
       }
 
@@ -124,6 +310,10 @@ coap_send_transaction(coap_transaction_t *t)
       restful_response_handler callback = t->callback;
       void *callback_data = t->callback_data;
 
+#if COAP_CONGESTION_CONTROL
+      coap_transaction_stats.timeouts++;
+#endif /* COAP_CONGESTION_CONTROL */
+
       /* handle observers */
       coap_remove_observer_by_client(&t->addr, t->port);
 
@@ -134,6 +324,7 @@ coap_send_transaction(coap_transaction_t *t)
       }
     }
   } else {
+    coap_send_message(&t->addr, t->port, t->message, t->packet_len);
     coap_clear_transaction(t);
   }
 }
@@ -141,12 +332,44 @@ coap_send_transaction(coap_transaction_t *t)
 void
 coap_clear_transaction(coap_transaction_t *t)
 {
+#if COAP_CONGESTION_CONTROL
+  coap_transaction_t *next = NULL;
+#endif /* COAP_CONGESTION_CONTROL */
+
   if(t) {
     PRINTF("Freeing transaction %u: %p\n", t->mid, t);
 
+#if COAP_CONGESTION_CONTROL
+    if(t->flags & FLAG_COUNTED) {
+      coap_peer_t *p = find_peer(&t->addr, 0);
+
+      if(p != NULL && p->outstanding > 0) {
+        p->outstanding--;
+      }
+      /* the next transaction waiting for this destination */
+      for(next = list_head(transactions_list); next; next = next->next) {
+        if((next->flags & FLAG_QUEUED)
+           && uip_ipaddr_cmp(&next->addr, &t->addr)) {
+          break;
+        }
+      }
+    }
+#endif /* COAP_CONGESTION_CONTROL */
+
     etimer_stop(&t->retrans_timer);
     list_remove(transactions_list, t);
     memb_free(&transactions_memb, t);
+
+#if COAP_CONGESTION_CONTROL
+    if(next != NULL) {
+      /* Not sent from here, as uip_buf may still hold the response that
+         completed t; the zero timer has the engine send it next. */
+      next->flags = FLAG_RELEASED;
+      PROCESS_CONTEXT_BEGIN(transaction_handler_process);
+      etimer_set(&next->retrans_timer, 0);
+      PROCESS_CONTEXT_END(transaction_handler_process);
+    }
+#endif /* COAP_CONGESTION_CONTROL */
   }
 }
 coap_transaction_t *
@@ -164,11 +387,33 @@ coap_get_transaction_by_mid(uint16_t mid)
 }
 /*---------------------------------------------------------------------------*/
 void
+coap_transaction_acked(coap_transaction_t *t)
+{
+#if COAP_CONGESTION_CONTROL
+  if(t->flags & FLAG_COUNTED) {
+    coap_update_rtt(&t->addr, clock_time() - t->start, t->retrans_counter);
+  }
+#endif /* COAP_CONGESTION_CONTROL */
+}
+/*---------------------------------------------------------------------------*/
+void
 coap_check_transactions()
 {
   coap_transaction_t *t = NULL;
 
   for(t = (coap_transaction_t *)list_head(transactions_list); t; t = t->next) {
+#if COAP_CONGESTION_CONTROL
+    if(t->flags & FLAG_QUEUED) {
+      continue;
+    }
+    if(t->flags & FLAG_RELEASED) {
+      if(etimer_expired(&t->retrans_timer)) {
+        t->flags = 0;
+        coap_send_transaction(t);
+      }
+      continue;
+    }
+#endif /* COAP_CONGESTION_CONTROL */
     if(etimer_expired(&t->retrans_timer)) {
       ++(t->retrans_counter);
       PRINTF("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
@@ -55,6 +55,11 @@ typedef struct coap_transaction {
   uint16_t mid;
   struct etimer retrans_timer;
   uint8_t retrans_counter;
+  uint8_t backoff;              /* timeout multiplier, in halves */
+#if COAP_CONGESTION_CONTROL
+  uint8_t flags;
+  clock_time_t start;           /* first transmission */
+#endif /* COAP_CONGESTION_CONTROL */
 
   uip_ipaddr_t addr;
   uint16_t port;
@@ -63,17 +68,68 @@ typedef struct coap_transaction {
   void *callback_data;
 
   uint16_t packet_len;
+  uint8_t *message;             /* start of the message in packet */
   uint8_t packet[COAP_MAX_PACKET_SIZE + 1];     /* +1 for the terminating '\0' which will not be sent
                                                  * Use snprintf(buf, len+1, "", ...) to completely fill payload */
 } coap_transaction_t;
 
+#if COAP_CONGESTION_CONTROL
+/* round-trip state of a destination */
+typedef struct coap_peer {
+  struct coap_peer *next;       /* for LIST */
+
+  uip_ipaddr_t addr;
+  clock_time_t rto;             /* overall RTO */
+  clock_time_t updated;         /* last RTO update, for aging */
+  /* RTT estimators from exchanges without retransmissions (strong) and
+     with one or two retransmissions (weak), in 1/8 clock ticks */
+  uint32_t strong_srtt;
+  uint32_t strong_rttvar;
+  uint32_t weak_srtt;
+  uint32_t weak_rttvar;
+  uint8_t outstanding;          /* confirmable transactions in progress */
+} coap_peer_t;
+
+struct coap_transaction_stats {
+  uint32_t transmissions;       /* first transmissions of CON messages */
+  uint32_t retransmissions;
+  uint32_t timeouts;
+  uint32_t strong_rtts;         /* RTT samples taken */
+  uint32_t weak_rtts;
+  uint32_t queued;              /* transactions delayed by COAP_NSTART */
+};
+
+extern struct coap_transaction_stats coap_transaction_stats;
+
+/* Returns the round-trip state of a destination, or NULL if none */
+const coap_peer_t *coap_get_peer(const uip_ipaddr_t *addr);
+list_t coap_get_peers(void);
+#endif /* COAP_CONGESTION_CONTROL */
+
 void coap_register_as_transaction_handler(void);
 
+/*
+ * Returns the timeout for the first transmission of a confirmable message
+ * to addr, and sets *backoff to the factor, in halves, by which the timeout
+ * grows with each retransmission. Without COAP_CONGESTION_CONTROL, this is
+ * the randomized COAP_RESPONSE_TIMEOUT with a factor of 2.
+ */
+clock_time_t coap_get_initial_timeout(const uip_ipaddr_t *addr,
+                                      uint8_t *backoff);
+/*
+ * Updates the RTO of addr with the time between the first transmission of
+ * a confirmable message and its acknowledgement, after the given number of
+ * retransmissions. Does nothing without COAP_CONGESTION_CONTROL.
+ */
+void coap_update_rtt(const uip_ipaddr_t *addr, clock_time_t rtt,
+                     uint8_t retransmissions);
+
 coap_transaction_t *coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr,
                                          uint16_t port);
 void coap_send_transaction(coap_transaction_t *t);
 void coap_clear_transaction(coap_transaction_t *t);
 coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid);
+void coap_transaction_acked(coap_transaction_t *t);
 
 void coap_check_transactions(void);
 
@@ -82,7 +82,7 @@ coap_log_2(uint16_t value)
 }
 /*---------------------------------------------------------------------------*/
 static uint32_t
-coap_parse_int_option(uint8_t *bytes, size_t length)
+coap_parse_int_option(const uint8_t *bytes, size_t length)
 {
   uint32_t var = 0;
   int i = 0;
@@ -217,27 +217,155 @@ coap_serialize_array_option(unsigned int number, unsigned int current_number,
   return i;
 }
 /*---------------------------------------------------------------------------*/
+static int
+coap_option_extended(const uint8_t **pos, const uint8_t *end,
+                     unsigned int *value)
+{
+  if(*value == 13) {
+    if(end - *pos < 1) {
+      return 0;
+    }
+    *value += (*pos)[0];
+    *pos += 1;
+  } else if(*value == 14) {
+    if(end - *pos < 2) {
+      return 0;
+    }
+    *value += 255 + ((*pos)[0] << 8) + (*pos)[1];
+    *pos += 2;
+  } else if(*value == 15) {
+    return 0;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static inline int
+coap_next_option(coap_option_iterator_t *it, unsigned int *number,
+                 const uint8_t **value, size_t *length)
+{
+  const uint8_t *pos = it->pos;
+  unsigned int delta;
+  unsigned int len;
+
+  /* payload marker 0xFF, currently only checking for 0xF* because rest is reserved */
+  if(pos == NULL || pos >= it->end || (pos[0] & 0xF0) == 0xF0) {
+    return 0;
+  }
+
+  delta = pos[0] >> 4;
+  len = pos[0] & 0x0F;
+  ++pos;
+  /* deltas and lengths below 13 need no extended bytes */
+  if((delta >= 13 || len >= 13)
+     && (!coap_option_extended(&pos, it->end, &delta)
+         || !coap_option_extended(&pos, it->end, &len))) {
+    it->pos = NULL;
+    return 0;
+  }
+  if(len > it->end - pos) {
+    it->pos = NULL;
+    return 0;
+  }
+
+  it->number += delta;
+  it->pos = pos + len;
+  *number = it->number;
+  *value = pos;
+  *length = len;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
 static void
-coap_merge_multi_option(char **dst, size_t *dst_len, uint8_t *option,
-                        size_t option_len, char separator)
+coap_merge_multi_option(coap_packet_t *coap_pkt, unsigned int number,
+                        const char **dst, size_t *dst_len,
+                        const uint8_t *option, size_t option_len)
 {
   /* merge multiple options */
   if(*dst_len > 0) {
-    /* dst already contains an option: concatenate */
-    (*dst)[*dst_len] = separator;
-    *dst_len += 1;
-
-    /* memmove handles 2-byte option headers */
-    memmove((*dst) + (*dst_len), option, option_len);
-
-    *dst_len += option_len;
+    /* only account for the separator now; the values are joined in place
+       when the option is first requested, starting from the header that
+       follows the first value */
+    if(coap_pkt->split_option == NULL) {
+      coap_pkt->split_option = (const uint8_t *)*dst + *dst_len;
+      coap_pkt->split_number = number;
+    }
+    *dst_len += 1 + option_len;
   } else {
     /* dst is empty: set to option */
-    *dst = (char *)option;
+    *dst = (const char *)option;
     *dst_len = option_len;
   }
 }
 /*---------------------------------------------------------------------------*/
+static char
+coap_option_separator(unsigned int number)
+{
+  switch(number) {
+  case COAP_OPTION_URI_PATH:
+  case COAP_OPTION_LOCATION_PATH:
+    return '/';
+  case COAP_OPTION_URI_QUERY:
+  case COAP_OPTION_LOCATION_QUERY:
+    return '&';
+  default:
+    return '\0';
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+coap_join_split_options(coap_packet_t *coap_pkt)
+{
+  coap_option_iterator_t it;
+  unsigned int number;
+  unsigned int last;
+  const uint8_t *value;
+  size_t length;
+  char *dst;
+  size_t dst_len;
+  char separator;
+
+  /* Start behind the first value of the first repeated option */
+  last = coap_pkt->split_number;
+  switch(last) {
+  case COAP_OPTION_LOCATION_PATH:
+    dst = (char *)coap_pkt->location_path;
+    break;
+  case COAP_OPTION_URI_PATH:
+    dst = (char *)coap_pkt->uri_path;
+    break;
+  case COAP_OPTION_URI_QUERY:
+    dst = (char *)coap_pkt->uri_query;
+    break;
+  default:
+    dst = (char *)coap_pkt->location_query;
+    break;
+  }
+  dst_len = coap_pkt->split_option - (const uint8_t *)dst;
+
+  /* Moving each value down over its own option header never reaches the
+     header of the next option, so the walk can go on behind the joining. */
+  coap_option_iterator_init(&it, coap_pkt);
+  it.pos = coap_pkt->split_option;
+  it.number = last;
+  while(coap_next_option(&it, &number, &value, &length)
+        && number <= COAP_OPTION_LOCATION_QUERY) {
+    separator = coap_option_separator(number);
+    if(separator == '\0') {
+      continue;
+    }
+    if(number != last || dst_len == 0) {
+      dst = (char *)value;
+      dst_len = length;
+      last = number;
+    } else {
+      dst[dst_len++] = separator;
+      memmove(dst + dst_len, value, length);
+      dst_len += length;
+    }
+  }
+  coap_pkt->split_option = NULL;
+}
+/*---------------------------------------------------------------------------*/
 static int
 coap_get_variable(const char *buffer, size_t length, const char *name,
                   const char **output)
@@ -307,13 +435,38 @@ coap_init_message(void *packet, coap_message_type_t type, uint8_t code,
   coap_pkt->mid = mid;
 }
 /*---------------------------------------------------------------------------*/
-size_t
-coap_serialize_message(void *packet, uint8_t *buffer)
+void
+coap_option_iterator_init(coap_option_iterator_t *it, void *packet)
 {
   coap_packet_t *const coap_pkt = (coap_packet_t *)packet;
+
+  if(coap_pkt->buffer == NULL) {
+    it->pos = it->end = NULL;
+  } else {
+    it->pos = coap_pkt->buffer + COAP_HEADER_LEN + coap_pkt->token_len;
+    it->end = it->pos + coap_pkt->options_len;
+  }
+  it->number = 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_option_next(coap_option_iterator_t *it, unsigned int *number,
+                 const uint8_t **value, size_t *length)
+{
+  return coap_next_option(it, number, value, length);
+}
+/*---------------------------------------------------------------------------*/
+/* writes the header, Token and options, and returns their length */
+static size_t
+coap_serialize_header(coap_packet_t *coap_pkt, uint8_t *buffer)
+{
   uint8_t *option;
   unsigned int current_number = 0;
 
+  if(coap_pkt->split_option) {
+    coap_join_split_options(coap_pkt);
+  }
+
   /* Initialize */
   coap_pkt->buffer = buffer;
   coap_pkt->version = 1;
@@ -335,6 +488,7 @@ coap_serialize_message(void *packet, uint8_t *buffer)
   /* empty packet, dont need to do more stuff */
   if(!coap_pkt->code) {
     PRINTF("-Done serializing empty message at %p-\n", coap_pkt->buffer);
+    coap_pkt->options_len = 0;
     return 4;
   }
 
@@ -390,36 +544,83 @@ coap_serialize_message(void *packet, uint8_t *buffer)
 
   PRINTF("-Done serializing at %p----\n", option);
 
-  /* Pack payload */
-  if((option - coap_pkt->buffer) <= COAP_MAX_HEADER_SIZE) {
-    /* Payload marker */
-    if(coap_pkt->payload_len) {
-      *option = 0xFF;
-      ++option;
-    }
-    memmove(option, coap_pkt->payload, coap_pkt->payload_len);
-  } else {
+  if((option - coap_pkt->buffer) > COAP_MAX_HEADER_SIZE) {
     /* an error occurred: caller must check for !=0 */
     coap_pkt->buffer = NULL;
     coap_error_message = "Serialized header exceeds COAP_MAX_HEADER_SIZE";
     return 0;
   }
+  coap_pkt->options_len = option - coap_pkt->buffer - COAP_HEADER_LEN
+    - coap_pkt->token_len;
+
+  return option - coap_pkt->buffer;
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+coap_serialize_payload(coap_packet_t *coap_pkt, uint8_t *buffer,
+                       size_t header_len)
+{
+  /* empty messages carry no payload */
+  if(!coap_pkt->code || !coap_pkt->payload_len) {
+    return header_len;
+  }
+
+  /* Payload marker */
+  buffer[header_len++] = 0xFF;
+  memmove(&buffer[header_len], coap_pkt->payload, coap_pkt->payload_len);
 
   PRINTF("-Done %u B (header len %u, payload len %u)-\n",
-         (unsigned int)(coap_pkt->payload_len + option - buffer),
-         (unsigned int)(option - buffer),
-         (unsigned int)coap_pkt->payload_len);
+         (unsigned int)(header_len + coap_pkt->payload_len),
+         (unsigned int)header_len, (unsigned int)coap_pkt->payload_len);
 
-  PRINTF("Dump [0x%02X %02X %02X %02X  %02X %02X %02X %02X]\n",
-         coap_pkt->buffer[0],
-         coap_pkt->buffer[1],
-         coap_pkt->buffer[2],
-         coap_pkt->buffer[3],
-         coap_pkt->buffer[4],
-         coap_pkt->buffer[5], coap_pkt->buffer[6], coap_pkt->buffer[7]
-         );
+  return header_len + coap_pkt->payload_len; /* packet length */
+}
+/*---------------------------------------------------------------------------*/
+size_t
+coap_serialize_message(void *packet, uint8_t *buffer)
+{
+  coap_packet_t *const coap_pkt = (coap_packet_t *)packet;
+  size_t header_len;
 
-  return (option - buffer) + coap_pkt->payload_len; /* packet length */
+  header_len = coap_serialize_header(coap_pkt, buffer);
+  if(header_len == 0) {
+    return 0;
+  }
+  return coap_serialize_payload(coap_pkt, buffer, header_len);
+}
+/*---------------------------------------------------------------------------*/
+size_t
+coap_serialize_message_in_place(void *packet, uint8_t *buffer)
+{
+  coap_packet_t *const coap_pkt = (coap_packet_t *)packet;
+  size_t header_len;
+  uint8_t *start;
+
+  header_len = coap_serialize_header(coap_pkt, buffer);
+  if(header_len == 0) {
+    return 0;
+  }
+
+  /* A payload that the resource handler wrote into buffer behind the
+     header space stays where it is; if it is longer than the header, the
+     header moves up against it instead. */
+  if(!coap_pkt->code || coap_pkt->payload_len <= header_len
+     || coap_pkt->payload < buffer + header_len + 1
+     || coap_pkt->payload > buffer + COAP_MAX_PACKET_SIZE) {
+    return coap_serialize_payload(coap_pkt, buffer, header_len);
+  }
+
+  start = coap_pkt->payload - header_len - 1;
+  memmove(start, buffer, header_len);
+  start[header_len] = 0xFF;
+  coap_pkt->buffer = start;
+
+  PRINTF("-Done %u B at +%u (header len %u, payload len %u)-\n",
+         (unsigned int)(header_len + 1 + coap_pkt->payload_len),
+         (unsigned int)(start - buffer), (unsigned int)header_len,
+         (unsigned int)coap_pkt->payload_len);
+
+  return header_len + 1 + coap_pkt->payload_len; /* packet length */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -470,72 +671,36 @@ coap_parse_message(void *packet, uint8_t *data, uint16_t data_len)
     return BAD_REQUEST_4_00;
   }
 
-  uint8_t *current_option = data + COAP_HEADER_LEN;
+  if(data_len < COAP_HEADER_LEN + coap_pkt->token_len) {
+    coap_error_message = "Message shorter than its Token";
+    return BAD_REQUEST_4_00;
+  }
 
-  memcpy(coap_pkt->token, current_option, coap_pkt->token_len);
+  memcpy(coap_pkt->token, data + COAP_HEADER_LEN, coap_pkt->token_len);
   PRINTF("Token (len %u) [0x%02X%02X%02X%02X%02X%02X%02X%02X]\n",
          coap_pkt->token_len, coap_pkt->token[0], coap_pkt->token[1],
          coap_pkt->token[2], coap_pkt->token[3], coap_pkt->token[4],
          coap_pkt->token[5], coap_pkt->token[6], coap_pkt->token[7]
          );                     /*FIXME always prints 8 bytes */
 
-  /* parse options */
-  memset(coap_pkt->options, 0, sizeof(coap_pkt->options));
-  current_option += coap_pkt->token_len;
+  /* parse options in a single pass, without touching the message */
+  coap_option_iterator_t it;
+  const uint8_t *current_option;
+  unsigned int option_number;
+  size_t option_length;
 
-  unsigned int option_number = 0;
-  unsigned int option_delta = 0;
-  size_t option_length = 0;
-
-  while(current_option < data + data_len) {
-    /* payload marker 0xFF, currently only checking for 0xF* because rest is reserved */
-    if((current_option[0] & 0xF0) == 0xF0) {
-      coap_pkt->payload = ++current_option;
-      coap_pkt->payload_len = data_len - (coap_pkt->payload - data);
-
-      /* also for receiving, the Erbium upper bound is REST_MAX_CHUNK_SIZE */
-      if(coap_pkt->payload_len > REST_MAX_CHUNK_SIZE) {
-        coap_pkt->payload_len = REST_MAX_CHUNK_SIZE;
-        /* null-terminate payload */
-      }
-      coap_pkt->payload[coap_pkt->payload_len] = '\0';
-
-      break;
-    }
+  it.pos = data + COAP_HEADER_LEN + coap_pkt->token_len;
+  it.end = data + data_len;
+  it.number = 0;
 
-    option_delta = current_option[0] >> 4;
-    option_length = current_option[0] & 0x0F;
-    ++current_option;
-
-    if(option_delta == 13) {
-      option_delta += current_option[0];
-      ++current_option;
-    } else if(option_delta == 14) {
-      option_delta += 255;
-      option_delta += current_option[0] << 8;
-      ++current_option;
-      option_delta += current_option[0];
-      ++current_option;
-    }
+  while(coap_next_option(&it, &option_number, &current_option,
+                         &option_length)) {
+    PRINTF("OPTION %u (len %zu): ", option_number, option_length);
 
-    if(option_length == 13) {
-      option_length += current_option[0];
-      ++current_option;
-    } else if(option_length == 14) {
-      option_length += 255;
-      option_length += current_option[0] << 8;
-      ++current_option;
-      option_length += current_option[0];
-      ++current_option;
+    if(option_number <= COAP_OPTION_SIZE1) {
+      SET_OPTION(coap_pkt, option_number);
     }
 
-    option_number += option_delta;
-
-    PRINTF("OPTION %u (delta %u, len %zu): ", option_number, option_delta,
-           option_length);
-
-    SET_OPTION(coap_pkt, option_number);
-
     switch(option_number) {
     case COAP_OPTION_CONTENT_FORMAT:
       coap_pkt->content_format = coap_parse_int_option(current_option,
@@ -579,7 +744,7 @@ coap_parse_message(void *packet, uint8_t *data, uint16_t data_len)
 
     case COAP_OPTION_PROXY_URI:
 #if COAP_PROXY_OPTION_PROCESSING
-      coap_pkt->proxy_uri = (char *)current_option;
+      coap_pkt->proxy_uri = (const char *)current_option;
       coap_pkt->proxy_uri_len = option_length;
 #endif
       PRINTF("Proxy-Uri NOT IMPLEMENTED [%.*s]\n", (int)coap_pkt->proxy_uri_len,
@@ -589,7 +754,7 @@ coap_parse_message(void *packet, uint8_t *data, uint16_t data_len)
       break;
     case COAP_OPTION_PROXY_SCHEME:
 #if COAP_PROXY_OPTION_PROCESSING
-      coap_pkt->proxy_scheme = (char *)current_option;
+      coap_pkt->proxy_scheme = (const char *)current_option;
       coap_pkt->proxy_scheme_len = option_length;
 #endif
       PRINTF("Proxy-Scheme NOT IMPLEMENTED [%.*s]\n",
@@ -599,7 +764,7 @@ coap_parse_message(void *packet, uint8_t *data, uint16_t data_len)
       break;
 
     case COAP_OPTION_URI_HOST:
-      coap_pkt->uri_host = (char *)current_option;
+      coap_pkt->uri_host = (const char *)current_option;
       coap_pkt->uri_host_len = option_length;
       PRINTF("Uri-Host [%.*s]\n", (int)coap_pkt->uri_host_len,
 	     coap_pkt->uri_host);
@@ -610,36 +775,33 @@ coap_parse_message(void *packet, uint8_t *data, uint16_t data_len)
       PRINTF("Uri-Port [%u]\n", coap_pkt->uri_port);
       break;
     case COAP_OPTION_URI_PATH:
-      /* coap_merge_multi_option() operates in-place on the IPBUF, but final packet field should be const string -> cast to string */
-      coap_merge_multi_option((char **)&(coap_pkt->uri_path),
+      coap_merge_multi_option(coap_pkt, option_number,
+                              &(coap_pkt->uri_path),
                               &(coap_pkt->uri_path_len), current_option,
-                              option_length, '/');
-      PRINTF("Uri-Path [%.*s]\n", (int)coap_pkt->uri_path_len, coap_pkt->uri_path);
+                              option_length);
+      PRINTF("Uri-Path [%.*s]\n", (int)option_length, current_option);
       break;
     case COAP_OPTION_URI_QUERY:
-      /* coap_merge_multi_option() operates in-place on the IPBUF, but final packet field should be const string -> cast to string */
-      coap_merge_multi_option((char **)&(coap_pkt->uri_query),
+      coap_merge_multi_option(coap_pkt, option_number,
+                              &(coap_pkt->uri_query),
                               &(coap_pkt->uri_query_len), current_option,
-                              option_length, '&');
-      PRINTF("Uri-Query [%.*s]\n", (int)coap_pkt->uri_query_len,
-             coap_pkt->uri_query);
+                              option_length);
+      PRINTF("Uri-Query [%.*s]\n", (int)option_length, current_option);
       break;
 
     case COAP_OPTION_LOCATION_PATH:
-      /* coap_merge_multi_option() operates in-place on the IPBUF, but final packet field should be const string -> cast to string */
-      coap_merge_multi_option((char **)&(coap_pkt->location_path),
+      coap_merge_multi_option(coap_pkt, option_number,
+                              &(coap_pkt->location_path),
                               &(coap_pkt->location_path_len), current_option,
-                              option_length, '/');
-      PRINTF("Location-Path [%.*s]\n", (int)coap_pkt->location_path_len,
-             coap_pkt->location_path);
+                              option_length);
+      PRINTF("Location-Path [%.*s]\n", (int)option_length, current_option);
       break;
     case COAP_OPTION_LOCATION_QUERY:
-      /* coap_merge_multi_option() operates in-place on the IPBUF, but final packet field should be const string -> cast to string */
-      coap_merge_multi_option((char **)&(coap_pkt->location_query),
+      coap_merge_multi_option(coap_pkt, option_number,
+                              &(coap_pkt->location_query),
                               &(coap_pkt->location_query_len), current_option,
-                              option_length, '&');
-      PRINTF("Location-Query [%.*s]\n", (int)coap_pkt->location_query_len,
-             coap_pkt->location_query);
+                              option_length);
+      PRINTF("Location-Query [%.*s]\n", (int)option_length, current_option);
       break;
 
     case COAP_OPTION_OBSERVE:
@@ -687,9 +849,27 @@ coap_parse_message(void *packet, uint8_t *data, uint16_t data_len)
         return BAD_OPTION_4_02;
       }
     }
+  }                             /* while */
 
-    current_option += option_length;
-  }                             /* for */
+  if(it.pos == NULL) {
+    coap_error_message = "Option exceeds message";
+    return BAD_REQUEST_4_00;
+  }
+  coap_pkt->options_len = it.pos - data - COAP_HEADER_LEN
+    - coap_pkt->token_len;
+
+  /* payload marker 0xFF, currently only checking for 0xF* because rest is reserved */
+  if(it.pos < it.end) {
+    coap_pkt->payload = (uint8_t *)it.pos + 1;
+    coap_pkt->payload_len = data_len - (coap_pkt->payload - data);
+
+    /* also for receiving, the Erbium upper bound is REST_MAX_CHUNK_SIZE */
+    if(coap_pkt->payload_len > REST_MAX_CHUNK_SIZE) {
+      coap_pkt->payload_len = REST_MAX_CHUNK_SIZE;
+      /* null-terminate payload */
+    }
+    coap_pkt->payload[coap_pkt->payload_len] = '\0';
+  }
   PRINTF("-Done parsing-------\n");
 
   return NO_ERROR;
@@ -703,6 +883,9 @@ coap_get_query_variable(void *packet, const char *name, const char **output)
   coap_packet_t *const coap_pkt = (coap_packet_t *)packet;
 
   if(IS_OPTION(coap_pkt, COAP_OPTION_URI_QUERY)) {
+    if(coap_pkt->split_option) {
+      coap_join_split_options(coap_pkt);
+    }
     return coap_get_variable(coap_pkt->uri_query, coap_pkt->uri_query_len,
                              name, output);
   }
@@ -923,6 +1106,9 @@ coap_get_header_uri_path(void *packet, const char **path)
   if(!IS_OPTION(coap_pkt, COAP_OPTION_URI_PATH)) {
     return 0;
   }
+  if(coap_pkt->split_option) {
+    coap_join_split_options(coap_pkt);
+  }
   *path = coap_pkt->uri_path;
   return coap_pkt->uri_path_len;
 }
@@ -949,6 +1135,9 @@ coap_get_header_uri_query(void *packet, const char **query)
   if(!IS_OPTION(coap_pkt, COAP_OPTION_URI_QUERY)) {
     return 0;
   }
+  if(coap_pkt->split_option) {
+    coap_join_split_options(coap_pkt);
+  }
   *query = coap_pkt->uri_query;
   return coap_pkt->uri_query_len;
 }
@@ -975,6 +1164,9 @@ coap_get_header_location_path(void *packet, const char **path)
   if(!IS_OPTION(coap_pkt, COAP_OPTION_LOCATION_PATH)) {
     return 0;
   }
+  if(coap_pkt->split_option) {
+    coap_join_split_options(coap_pkt);
+  }
   *path = coap_pkt->location_path;
   return coap_pkt->location_path_len;
 }
@@ -1009,6 +1201,9 @@ coap_get_header_location_query(void *packet, const char **query)
   if(!IS_OPTION(coap_pkt, COAP_OPTION_LOCATION_QUERY)) {
     return 0;
   }
+  if(coap_pkt->split_option) {
+    coap_join_split_options(coap_pkt);
+  }
   *query = coap_pkt->location_query;
   return coap_pkt->location_query_len;
 }
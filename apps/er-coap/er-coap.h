@@ -130,8 +130,19 @@ typedef struct {
 
   uint16_t payload_len;
   uint8_t *payload;
+
+  uint16_t options_len; /* options as received or serialized, after the Token */
+  const uint8_t *split_option; /* first repeated Uri-Path, Uri-Query, Location-Path or Location-Query not joined yet */
+  uint8_t split_number;
 } coap_packet_t;
 
+/* walks the options of a message in place */
+typedef struct {
+  const uint8_t *pos; /* NULL once a malformed option was found */
+  const uint8_t *end;
+  unsigned int number;
+} coap_option_iterator_t;
+
 /* option format serialization */
 #define COAP_SERIALIZE_INT_OPTION(number, field, text) \
   if(IS_OPTION(coap_pkt, number)) { \
@@ -182,11 +193,24 @@ uint16_t coap_get_mid(void);
 void coap_init_message(void *packet, coap_message_type_t type, uint8_t code,
                        uint16_t mid);
 size_t coap_serialize_message(void *packet, uint8_t *buffer);
+size_t coap_serialize_message_in_place(void *packet, uint8_t *buffer); /* message starts at packet->buffer. */
 void coap_send_message(uip_ipaddr_t *addr, uint16_t port, uint8_t *data,
                        uint16_t length);
 coap_status_t coap_parse_message(void *request, uint8_t *data,
                                  uint16_t data_len);
 
+/*
+ * Walks the options of a parsed or serialized message without copying
+ * them. coap_option_next() returns 0 after the last option, and leaves
+ * it->pos NULL if an option runs past the end of the message. The getters
+ * for Uri-Path, Uri-Query, Location-Path and Location-Query join repeated
+ * options in place the first time they are called; the options can no
+ * longer be walked after that.
+ */
+void coap_option_iterator_init(coap_option_iterator_t *it, void *packet);
+int coap_option_next(coap_option_iterator_t *it, unsigned int *number,
+                     const uint8_t **value, size_t *length);
+
 int coap_get_query_variable(void *packet, const char *name,
                             const char **output);
 int coap_get_post_variable(void *packet, const char *name,
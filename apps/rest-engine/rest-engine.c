@@ -59,6 +59,122 @@ PROCESS(rest_engine_process, "REST Engine");
 LIST(restful_services);
 LIST(restful_periodic_services);
 /*---------------------------------------------------------------------------*/
+#if REST_ENGINE_TRIE
+/* One node per distinct path segment. Siblings are chained through
+   next, and segment points into the path of the resource that created
+   the node, which stays valid as resources are never deactivated. */
+struct rest_trie_node {
+  struct rest_trie_node *next;
+  struct rest_trie_node *child;
+  resource_t *resource;
+  const char *segment;
+  uint16_t len;
+  /* activation order of resource, for first-match semantics */
+  uint16_t order;
+};
+
+MEMB(rest_trie_memb, struct rest_trie_node, REST_ENGINE_TRIE_NODES);
+static struct rest_trie_node *trie_root;
+static uint16_t trie_order;
+static uint8_t trie_incomplete;
+/*---------------------------------------------------------------------------*/
+static int
+segment_end(const char *url, int pos, int url_len)
+{
+  while(pos < url_len && url[pos] != '/') {
+    pos++;
+  }
+  return pos;
+}
+/*---------------------------------------------------------------------------*/
+static struct rest_trie_node *
+trie_find_child(struct rest_trie_node *n, const char *segment, int len)
+{
+  for(; n != NULL; n = n->next) {
+    if(n->len == len
+       && (len == 0 || memcmp(n->segment, segment, len) == 0)) {
+      return n;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+trie_insert(resource_t *resource)
+{
+  struct rest_trie_node **list;
+  struct rest_trie_node *n;
+  const char *url;
+  int url_len;
+  int pos;
+  int end;
+
+  url = resource->url;
+  url_len = strlen(url);
+  list = &trie_root;
+  for(pos = 0;; pos = end + 1) {
+    end = segment_end(url, pos, url_len);
+    n = trie_find_child(*list, &url[pos], end - pos);
+    if(n == NULL) {
+      n = memb_alloc(&rest_trie_memb);
+      if(n == NULL) {
+        PRINTF("Out of trie nodes for %s, using linear dispatch\n", url);
+        trie_incomplete = 1;
+        return;
+      }
+      n->child = NULL;
+      n->resource = NULL;
+      n->segment = &url[pos];
+      n->len = end - pos;
+      n->next = *list;
+      *list = n;
+    }
+    if(end == url_len) {
+      break;
+    }
+    list = &n->child;
+  }
+
+  /* Keep the first resource activated under a path. */
+  if(n->resource == NULL) {
+    n->resource = resource;
+    n->order = trie_order++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static resource_t *
+trie_lookup(const char *url, int url_len, int *res_url_len)
+{
+  struct rest_trie_node *n;
+  struct rest_trie_node *best;
+  int pos;
+  int end;
+
+  best = NULL;
+  n = trie_root;
+  for(pos = 0;; pos = end + 1) {
+    end = segment_end(url, pos, url_len);
+    n = trie_find_child(n, &url[pos], end - pos);
+    if(n == NULL) {
+      break;
+    }
+    /* A parent resource matches as soon as the path continues with a
+       '/', a plain resource only at the end of the path. */
+    if(n->resource != NULL
+       && (end == url_len || (n->resource->flags & HAS_SUB_RESOURCES))
+       && (best == NULL || n->order < best->order)) {
+      best = n;
+      *res_url_len = end;
+    }
+    if(end == url_len) {
+      break;
+    }
+    n = n->child;
+  }
+  return best != NULL ? best->resource : NULL;
+}
+#endif /* REST_ENGINE_TRIE */
+/*---------------------------------------------------------------------------*/
 /*- REST Engine API ---------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 /**
@@ -104,6 +220,9 @@ rest_activate_resource(resource_t *resource, char *path)
 {
   resource->url = path;
   list_add(restful_services, resource);
+#if REST_ENGINE_TRIE
+  trie_insert(resource);
+#endif /* REST_ENGINE_TRIE */
 
   PRINTF("Activating: %s\n", resource->url);
 
@@ -124,18 +243,22 @@ rest_get_resources(void)
   return restful_services;
 }
 /*---------------------------------------------------------------------------*/
-int
-rest_invoke_restful_service(void *request, void *response, uint8_t *buffer,
-                            uint16_t buffer_size, int32_t *offset)
+resource_t *
+rest_find_resource(const char *url, int url_len, const char **subpath)
 {
-  uint8_t found = 0;
-  uint8_t allowed = 1;
+  resource_t *resource;
+  int res_url_len;
 
-  resource_t *resource = NULL;
-  const char *url = NULL;
-  int url_len, res_url_len;
+#if REST_ENGINE_TRIE
+  if(!trie_incomplete) {
+    resource = trie_lookup(url, url_len, &res_url_len);
+    if(resource != NULL && subpath != NULL) {
+      *subpath = &url[res_url_len];
+    }
+    return resource;
+  }
+#endif /* REST_ENGINE_TRIE */
 
-  url_len = REST.get_url(request, &url);
   for(resource = (resource_t *)list_head(restful_services);
       resource; resource = resource->next) {
 
@@ -146,42 +269,60 @@ rest_invoke_restful_service(void *request, void *response, uint8_t *buffer,
             && (resource->flags & HAS_SUB_RESOURCES)
             && url[res_url_len] == '/'))
        && strncmp(resource->url, url, res_url_len) == 0) {
-      found = 1;
-      rest_resource_flags_t method = REST.get_method_type(request);
-
-      PRINTF("/%s, method %u, resource->flags %u\n", resource->url,
-             (uint16_t)method, resource->flags);
-
-      if((method & METHOD_GET) && resource->get_handler != NULL) {
-        /* call handler function */
-        resource->get_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_POST) && resource->post_handler != NULL) {
-        /* call handler function */
-        resource->post_handler(request, response, buffer, buffer_size,
-                               offset);
-      } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
-        /* call handler function */
-        resource->put_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
-        /* call handler function */
-        resource->delete_handler(request, response, buffer, buffer_size,
-                                 offset);
-      } else {
-        allowed = 0;
-        REST.set_response_status(response, REST.status.METHOD_NOT_ALLOWED);
+      if(subpath != NULL) {
+        *subpath = &url[res_url_len];
       }
-      break;
+      return resource;
     }
   }
-  if(!found) {
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+int
+rest_invoke_restful_service(void *request, void *response, uint8_t *buffer,
+                            uint16_t buffer_size, int32_t *offset)
+{
+  uint8_t allowed = 1;
+
+  resource_t *resource = NULL;
+  const char *url = NULL;
+  int url_len;
+
+  url_len = REST.get_url(request, &url);
+  resource = rest_find_resource(url, url_len, NULL);
+  if(resource == NULL) {
     REST.set_response_status(response, REST.status.NOT_FOUND);
-  } else if(allowed) {
-    /* final handler for special flags */
-    if(resource->flags & IS_OBSERVABLE) {
-      REST.subscription_handler(resource, request, response);
-    }
+    return 0;
+  }
+
+  rest_resource_flags_t method = REST.get_method_type(request);
+
+  PRINTF("/%s, method %u, resource->flags %u\n", resource->url,
+         (uint16_t)method, resource->flags);
+
+  if((method & METHOD_GET) && resource->get_handler != NULL) {
+    /* call handler function */
+    resource->get_handler(request, response, buffer, buffer_size, offset);
+  } else if((method & METHOD_POST) && resource->post_handler != NULL) {
+    /* call handler function */
+    resource->post_handler(request, response, buffer, buffer_size, offset);
+  } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
+    /* call handler function */
+    resource->put_handler(request, response, buffer, buffer_size, offset);
+  } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
+    /* call handler function */
+    resource->delete_handler(request, response, buffer, buffer_size,
+                             offset);
+  } else {
+    allowed = 0;
+    REST.set_response_status(response, REST.status.METHOD_NOT_ALLOWED);
+  }
+
+  /* final handler for special flags */
+  if(allowed && (resource->flags & IS_OBSERVABLE)) {
+    REST.subscription_handler(resource, request, response);
   }
-  return found & allowed;
+  return allowed;
 }
 /*-----------------------------------------------------------------------------------*/
 PROCESS_THREAD(rest_engine_process, ev, data)
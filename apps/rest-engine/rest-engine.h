@@ -62,6 +62,25 @@
 #define REST_MAX_CHUNK_SIZE     64
 #endif
 
+/*
+ * Path-segment trie for resource dispatch. When enabled, the trie is
+ * extended in rest_activate_resource() and rest_find_resource() walks
+ * the request path once instead of comparing it against every
+ * registered resource. Each distinct path segment takes one node; if
+ * the nodes run out, dispatch falls back to the linear resource list.
+ */
+#ifdef REST_ENGINE_CONF_TRIE
+#define REST_ENGINE_TRIE REST_ENGINE_CONF_TRIE
+#else /* REST_ENGINE_CONF_TRIE */
+#define REST_ENGINE_TRIE 0
+#endif /* REST_ENGINE_CONF_TRIE */
+
+#ifdef REST_ENGINE_CONF_TRIE_NODES
+#define REST_ENGINE_TRIE_NODES REST_ENGINE_CONF_TRIE_NODES
+#else /* REST_ENGINE_CONF_TRIE_NODES */
+#define REST_ENGINE_TRIE_NODES 32
+#endif /* REST_ENGINE_CONF_TRIE_NODES */
+
 struct resource_s;
 struct periodic_resource_s;
 
@@ -254,5 +273,23 @@ void rest_activate_resource(resource_t *resource, char *path);
  */
 list_t rest_get_resources(void);
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief      Finds the resource that handles a URI path.
+ * \param url  The URI path, not necessarily null-terminated.
+ * \param url_len
+ *             The length of the URI path.
+ * \param subpath
+ *             If not NULL, set to the part of the path that follows the
+ *             resource path: empty, or starting with '/' for a
+ *             sub-resource of a parent resource.
+ * \return     The resource, or NULL if no resource matches.
+ *
+ * A resource matches if its path equals the URI path, or if it has
+ * sub-resources and its path is followed by a '/' in the URI path. If
+ * several resources match, the one activated first is returned.
+ */
+resource_t *rest_find_resource(const char *url, int url_len,
+                               const char **subpath);
+/*---------------------------------------------------------------------------*/
 
 #endif /*REST_ENGINE_H_ */
@@ -59,9 +59,30 @@ PROCESS_THREAD(shell_ps_process, ev, data)
   for(p = PROCESS_LIST(); p != NULL; p = p->next) {
     char namebuf[30];
     strncpy(namebuf, PROCESS_NAME_STRING(p), sizeof(namebuf));
+#if PROCESS_WITH_PRIORITIES
+    if(p->priority >= PROCESS_PRIO_HIGH) {
+      shell_output_str(&ps_command, namebuf, " (high priority)");
+      continue;
+    }
+#endif /* PROCESS_WITH_PRIORITIES */
     shell_output_str(&ps_command, namebuf, "");
   }
 
+#if PROCESS_CONF_STATS
+  {
+    char buf[60];
+    snprintf(buf, sizeof(buf), "%d queued, max %d, %u dropped",
+             process_nevents(), process_maxevents,
+             process_droppedevents);
+    shell_output_str(&ps_command, "Events: ", buf);
+#if PROCESS_WITH_PRIORITIES
+    snprintf(buf, sizeof(buf), "max %d of %d",
+             process_maxevents_high, PROCESS_CONF_NUMEVENTS_HIGH);
+    shell_output_str(&ps_command, "High priority events: ", buf);
+#endif /* PROCESS_WITH_PRIORITIES */
+  }
+#endif /* PROCESS_CONF_STATS */
+
   PROCESS_END();
 }
 /*---------------------------------------------------------------------------*/
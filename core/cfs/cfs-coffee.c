@@ -55,6 +55,8 @@
 #endif
 
 #include "contiki-conf.h"
+#include "sys/process.h"
+#include "sys/etimer.h"
 #include "cfs/cfs.h"
 #include "cfs-coffee-arch.h"
 #include "cfs/cfs-coffee.h"
@@ -84,6 +86,50 @@
 #define COFFEE_EXTENDED_WEAR_LEVELLING  1
 #endif
 
+/*
+ * The number of entries in a RAM index from file names to the pages
+ * of their headers. The index is built by scanning the file system on
+ * the first lookup and is then kept up to date when files are reserved
+ * and removed, so that opening a file needs a single header read
+ * instead of a scan of the flash memory. Zero disables the index.
+ */
+#ifndef COFFEE_NAME_INDEX_SIZE
+#define COFFEE_NAME_INDEX_SIZE  0
+#endif
+
+#if COFFEE_NAME_INDEX_SIZE & (COFFEE_NAME_INDEX_SIZE - 1)
+#error COFFEE_NAME_INDEX_SIZE must be a power of two.
+#endif
+
+/*
+ * Incremental garbage collection moves the erasure of sectors out of
+ * file removals and reservations into a background process that works
+ * in short slices and lets other processes run in between.
+ */
+#ifndef COFFEE_INCREMENTAL_GC
+#define COFFEE_INCREMENTAL_GC  0
+#endif
+
+/* The work of one slice of incremental garbage collection: the number
+   of sectors examined, of which at most one is erased. Each slice
+   resumes at the sector where the previous one stopped. */
+#ifndef COFFEE_GC_SLICE_SECTORS
+#define COFFEE_GC_SLICE_SECTORS  4
+#endif
+
+/* The time to wait between two slices of incremental garbage
+   collection. Zero only yields to pending events. */
+#ifndef COFFEE_GC_INTERVAL
+#define COFFEE_GC_INTERVAL  0
+#endif
+
+/* The incremental garbage collector is started when a file is reserved
+   in one of the last COFFEE_GC_WATERMARK sectors, so that free sectors
+   are available before a reservation fails. */
+#ifndef COFFEE_GC_WATERMARK
+#define COFFEE_GC_WATERMARK  2
+#endif
+
 #if COFFEE_START & (COFFEE_SECTOR_SIZE - 1)
 #error COFFEE_START must point to the first byte in a sector.
 #endif
@@ -158,6 +204,9 @@ struct sector_status {
   coffee_page_t active;
   coffee_page_t obsolete;
   coffee_page_t free;
+  /* Obsolete pages at the start of the sector, belonging to a file
+     whose header is in an earlier sector. */
+  coffee_page_t obsolete_head;
 };
 
 /* The structure of cached file objects. */
@@ -168,6 +217,7 @@ struct file {
   int16_t record_count;
   uint8_t references;
   uint8_t flags;
+  uint8_t eof_hint;
 };
 
 /* The file descriptor structure. */
@@ -185,11 +235,22 @@ struct file_header {
   uint16_t log_records;
   uint16_t log_record_size;
   coffee_page_t max_pages;
-  uint8_t deprecated_eof_hint;
+  uint8_t eof_hint;
   uint8_t flags;
   char name[COFFEE_NAME_LENGTH];
 };
 
+/*
+ * The EOF hint in the file header bounds the extent of the data in the
+ * file, so that file_end() does not need to read the whole file. Since
+ * bits can be set without erasing the flash memory, the hint is a bit
+ * mask that only grows: if bit k is the highest bit set, the data fits
+ * in the first EOF_HINT_PAGES(k, max_pages) pages of the file. Files
+ * without a hint are scanned completely.
+ */
+#define EOF_HINT_PAGES(k, max_pages) \
+  ((coffee_page_t)((((uint32_t)(max_pages) << (k)) + 127) >> 7))
+
 /* This is needed because of a buggy compiler. */
 struct log_param {
   cfs_offset_t offset;
@@ -206,6 +267,34 @@ static struct file_desc coffee_fd_set[COFFEE_FD_SET_SIZE];
 static coffee_page_t next_free;
 static char gc_wait;
 
+#if COFFEE_INCREMENTAL_GC
+PROCESS(coffee_gc_process, "Coffee GC");
+/* The sector that get_sector_status() continues with if called again. */
+static coffee_page_t status_next;
+/* The sector where the next slice of collection starts, whether the
+   sector before it was erased, and the number of sectors examined
+   since a sector was last erased. */
+static coffee_page_t gc_cursor;
+static char gc_erased;
+static coffee_page_t gc_clean;
+#endif /* COFFEE_INCREMENTAL_GC */
+
+#if COFFEE_NAME_INDEX_SIZE
+/* Name index entries; the page is INVALID_PAGE in unused entries. */
+struct name_index_entry {
+  coffee_page_t page;
+  uint16_t hash;
+};
+
+#define NAME_INDEX_INVALID    0 /* Must be rebuilt before use. */
+#define NAME_INDEX_COMPLETE   1 /* Contains all files. */
+#define NAME_INDEX_PARTIAL    2 /* Overflowed; a miss requires a scan. */
+
+static struct name_index_entry name_index[COFFEE_NAME_INDEX_SIZE];
+static uint16_t name_index_count;
+static uint8_t name_index_state;
+#endif /* COFFEE_NAME_INDEX_SIZE */
+
 /*---------------------------------------------------------------------------*/
 static void
 write_header(struct file_header *hdr, coffee_page_t page)
@@ -251,6 +340,9 @@ get_sector_status(coffee_page_t sector, struct sector_status *stats)
     skip_pages = 0;
     last_pages_are_active = 0;
   }
+#if COFFEE_INCREMENTAL_GC
+  status_next = sector + 1;
+#endif /* COFFEE_INCREMENTAL_GC */
 
   sector_start = sector * COFFEE_PAGES_PER_SECTOR;
   sector_end = sector_start + COFFEE_PAGES_PER_SECTOR;
@@ -270,10 +362,12 @@ get_sector_status(coffee_page_t sector, struct sector_status *stats)
   } else {
     if(skip_pages >= COFFEE_PAGES_PER_SECTOR) {
       stats->obsolete = COFFEE_PAGES_PER_SECTOR;
+      stats->obsolete_head = COFFEE_PAGES_PER_SECTOR;
       skip_pages -= COFFEE_PAGES_PER_SECTOR;
       return skip_pages >= COFFEE_PAGES_PER_SECTOR ? 0 : skip_pages;
     }
     obsolete = skip_pages;
+    stats->obsolete_head = skip_pages;
   }
 
   /* Determine the amount of pages of each type that have not been
@@ -348,12 +442,57 @@ isolate_pages(coffee_page_t start, coffee_page_t skip_pages)
          (unsigned)skip_pages, (int)start / COFFEE_PAGES_PER_SECTOR);
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * With incremental garbage collection, a sector whose first pages
+ * belong to an obsolete file can be erased only if the sector with the
+ * header of that file has been erased before it, or if the file ends in
+ * this sector. In the latter case, the erased pages of the file are
+ * isolated so that a file reserved there is not skipped by scans that
+ * jump over the obsolete file.
+ */
+static int
+sector_erasable(struct sector_status *stats, int previous_erased)
+{
+#if COFFEE_INCREMENTAL_GC
+  return stats->active == 0 &&
+    (previous_erased || stats->obsolete_head < COFFEE_PAGES_PER_SECTOR);
+#else /* COFFEE_INCREMENTAL_GC */
+  return stats->active == 0;
+#endif /* COFFEE_INCREMENTAL_GC */
+}
+/*---------------------------------------------------------------------------*/
+static void
+erase_sector(coffee_page_t sector, struct sector_status *stats,
+             coffee_page_t isolation_count, int previous_erased)
+{
+  coffee_page_t first_page;
+
+  first_page = sector * COFFEE_PAGES_PER_SECTOR;
+  if(first_page < next_free) {
+    next_free = first_page;
+  }
+
+  if(isolation_count > 0) {
+    isolate_pages(first_page + COFFEE_PAGES_PER_SECTOR, isolation_count);
+  }
+
+  COFFEE_ERASE(sector);
+  PRINTF("Coffee: Erased sector %d!\n", sector);
+
+#if COFFEE_INCREMENTAL_GC
+  if(!previous_erased && stats->obsolete_head > 0) {
+    isolate_pages(first_page, stats->obsolete_head);
+  }
+#endif /* COFFEE_INCREMENTAL_GC */
+}
+/*---------------------------------------------------------------------------*/
 static void
 collect_garbage(int mode)
 {
   coffee_page_t sector;
   struct sector_status stats;
-  coffee_page_t first_page, isolation_count;
+  coffee_page_t isolation_count;
+  int erased;
 
   PRINTF("Coffee: Running the garbage collector in %s mode\n",
          mode == GC_RELUCTANT ? "reluctant" : "greedy");
@@ -361,37 +500,126 @@ collect_garbage(int mode)
    * The garbage collector erases as many sectors as possible. A sector is
    * erasable if there are only free or obsolete pages in it.
    */
+  erased = 0;
   for(sector = 0; sector < COFFEE_SECTOR_COUNT; sector++) {
     isolation_count = get_sector_status(sector, &stats);
     PRINTF("Coffee: Sector %u has %u active, %u obsolete, and %u free pages.\n",
            (unsigned)sector, (unsigned)stats.active,
            (unsigned)stats.obsolete, (unsigned)stats.free);
 
-    if(stats.active > 0) {
+    if(!sector_erasable(&stats, erased)) {
+      erased = 0;
       continue;
     }
 
     if((mode == GC_RELUCTANT && stats.free == 0) ||
        (mode == GC_GREEDY && stats.obsolete > 0)) {
-      first_page = sector * COFFEE_PAGES_PER_SECTOR;
-      if(first_page < next_free) {
-        next_free = first_page;
-      }
-
-      if(isolation_count > 0) {
-        isolate_pages(first_page + COFFEE_PAGES_PER_SECTOR, isolation_count);
-      }
-
-      COFFEE_ERASE(sector);
-      PRINTF("Coffee: Erased sector %d!\n", sector);
+      erase_sector(sector, &stats, isolation_count, erased);
+      erased = 1;
 
       if(mode == GC_RELUCTANT && isolation_count > 0) {
         break;
       }
+    } else {
+      erased = 0;
     }
   }
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_INCREMENTAL_GC
+/*
+ * Examines at most COFFEE_GC_SLICE_SECTORS sectors, starting where the
+ * previous slice stopped, and stops after erasing one of them. Returns
+ * nonzero once a whole round of sectors has been examined without
+ * erasing any.
+ */
+static int
+collect_garbage_slice(void)
+{
+  coffee_page_t sector;
+  struct sector_status stats;
+  coffee_page_t isolation_count;
+  int examined;
+
+  /*
+   * get_sector_status() carries state from one sector to the next. If
+   * it has been called by someone else since the previous slice, the
+   * state does not belong to the cursor and the scan starts over.
+   */
+  if(gc_cursor != 0 && gc_cursor != status_next) {
+    gc_cursor = 0;
+  }
+  if(gc_cursor == 0) {
+    gc_erased = 0;
+  }
+
+  for(examined = 0; examined < COFFEE_GC_SLICE_SECTORS; examined++) {
+    sector = gc_cursor;
+    isolation_count = get_sector_status(sector, &stats);
+    PRINTF("Coffee: Sector %u has %u active, %u obsolete, and %u free pages.\n",
+           (unsigned)sector, (unsigned)stats.active,
+           (unsigned)stats.obsolete, (unsigned)stats.free);
+
+    gc_cursor = sector + 1 < COFFEE_SECTOR_COUNT ? sector + 1 : 0;
+
+    if(stats.obsolete > 0 && sector_erasable(&stats, gc_erased)) {
+      erase_sector(sector, &stats, isolation_count, gc_erased);
+      gc_erased = 1;
+      gc_clean = 0;
+      return 0;
+    }
+
+    gc_erased = 0;
+    if(++gc_clean >= COFFEE_SECTOR_COUNT) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_gc_process(void)
+{
+  if(gc_wait) {
+    /* Nothing has been removed since the last collection. */
+    return;
+  }
+  gc_clean = 0;
+  if(!process_is_running(&coffee_gc_process)) {
+    process_start(&coffee_gc_process, NULL);
+  }
+  process_poll(&coffee_gc_process);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coffee_gc_process, ev, data)
+{
+#if COFFEE_GC_INTERVAL
+  static struct etimer et;
+#endif /* COFFEE_GC_INTERVAL */
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    while(!gc_wait && !collect_garbage_slice()) {
+#if COFFEE_GC_INTERVAL
+      etimer_set(&et, COFFEE_GC_INTERVAL);
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+#else
+      PROCESS_PAUSE();
+#endif /* COFFEE_GC_INTERVAL */
+    }
+
+    /* Nothing more to collect until another file is removed. */
+    gc_wait = 1;
+  }
+
+  PROCESS_END();
+}
+#endif /* COFFEE_INCREMENTAL_GC */
+/*---------------------------------------------------------------------------*/
 static coffee_page_t
 next_file(coffee_page_t page, struct file_header *hdr)
 {
@@ -446,12 +674,110 @@ load_file(coffee_page_t start, struct file_header *hdr)
   file->end = UNKNOWN_OFFSET;
   file->max_pages = hdr->max_pages;
   file->flags = HDR_MODIFIED(*hdr) ? COFFEE_FILE_MODIFIED : 0;
+  file->eof_hint = hdr->eof_hint;
   /* We don't know the amount of records yet. */
   file->record_count = -1;
 
   return file;
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_NAME_INDEX_SIZE
+static uint16_t
+name_hash(const char *name)
+{
+  uint16_t hash;
+  int i;
+
+  /* Names are truncated to COFFEE_NAME_LENGTH - 1 characters in the
+     file header, so only that many characters are hashed. */
+  hash = 0;
+  for(i = 0; i < COFFEE_NAME_LENGTH - 1 && name[i] != '\0'; i++) {
+    hash = (hash << 5) + hash + (uint8_t)name[i];
+  }
+  return hash;
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_add(const char *name, coffee_page_t page)
+{
+  int i;
+  uint16_t hash;
+
+  if(name_index_state == NAME_INDEX_INVALID) {
+    /* Will be picked up when the index is built. */
+    return;
+  }
+
+  /* Keep at least one entry free to terminate the probing. */
+  if(name_index_count >= COFFEE_NAME_INDEX_SIZE - 1) {
+    name_index_state = NAME_INDEX_PARTIAL;
+    return;
+  }
+
+  hash = name_hash(name);
+  for(i = hash & (COFFEE_NAME_INDEX_SIZE - 1);
+      name_index[i].page != INVALID_PAGE;
+      i = (i + 1) & (COFFEE_NAME_INDEX_SIZE - 1));
+  name_index[i].page = page;
+  name_index[i].hash = hash;
+  name_index_count++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_remove(const char *name, coffee_page_t page)
+{
+  int i, j, k;
+
+  if(name_index_state == NAME_INDEX_INVALID) {
+    return;
+  }
+
+  for(i = name_hash(name) & (COFFEE_NAME_INDEX_SIZE - 1);
+      name_index[i].page != page;
+      i = (i + 1) & (COFFEE_NAME_INDEX_SIZE - 1)) {
+    if(name_index[i].page == INVALID_PAGE) {
+      return;
+    }
+  }
+
+  /* Shift back the following entries of the probe sequence so that
+     no tombstones are needed. */
+  for(j = (i + 1) & (COFFEE_NAME_INDEX_SIZE - 1);
+      name_index[j].page != INVALID_PAGE;
+      j = (j + 1) & (COFFEE_NAME_INDEX_SIZE - 1)) {
+    k = name_index[j].hash & (COFFEE_NAME_INDEX_SIZE - 1);
+    if((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) {
+      continue;
+    }
+    name_index[i] = name_index[j];
+    i = j;
+  }
+  name_index[i].page = INVALID_PAGE;
+  name_index_count--;
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_build(void)
+{
+  struct file_header hdr;
+  coffee_page_t page;
+  int i;
+
+  for(i = 0; i < COFFEE_NAME_INDEX_SIZE; i++) {
+    name_index[i].page = INVALID_PAGE;
+  }
+  name_index_count = 0;
+  name_index_state = NAME_INDEX_COMPLETE;
+
+  for(page = 0; page < COFFEE_PAGE_COUNT; page = next_file(page, &hdr)) {
+    read_header(&hdr, page);
+    if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr)) {
+      name_index_add(hdr.name, page);
+    }
+  }
+}
+#endif /* COFFEE_NAME_INDEX_SIZE */
+/*---------------------------------------------------------------------------*/
 static struct file *
 find_file(const char *name)
 {
@@ -459,6 +785,37 @@ find_file(const char *name)
   struct file_header hdr;
   coffee_page_t page;
 
+#if COFFEE_NAME_INDEX_SIZE
+  uint16_t hash;
+
+  if(name_index_state == NAME_INDEX_INVALID) {
+    name_index_build();
+  }
+
+  hash = name_hash(name);
+  for(i = hash & (COFFEE_NAME_INDEX_SIZE - 1);
+      name_index[i].page != INVALID_PAGE;
+      i = (i + 1) & (COFFEE_NAME_INDEX_SIZE - 1)) {
+    if(name_index[i].hash != hash) {
+      continue;
+    }
+    page = name_index[i].page;
+    read_header(&hdr, page);
+    if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr) && strcmp(name, hdr.name) == 0) {
+      for(i = 0; i < COFFEE_MAX_OPEN_FILES; i++) {
+        if(!FILE_FREE(&coffee_files[i]) && coffee_files[i].page == page) {
+          return &coffee_files[i];
+        }
+      }
+      return load_file(page, &hdr);
+    }
+  }
+
+  if(name_index_state == NAME_INDEX_COMPLETE) {
+    return NULL;
+  }
+#endif /* COFFEE_NAME_INDEX_SIZE */
+
   /* First check if the file metadata is cached. */
   for(i = 0; i < COFFEE_MAX_OPEN_FILES; i++) {
     if(FILE_FREE(&coffee_files[i])) {
@@ -482,33 +839,79 @@ find_file(const char *name)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+static coffee_page_t
+eof_hint_pages(uint8_t eof_hint, coffee_page_t max_pages)
+{
+  int k;
+
+  if(eof_hint == 0) {
+    return max_pages;
+  }
+
+  for(k = 7; !(eof_hint & (1 << k)); k--);
+  return EOF_HINT_PAGES(k, max_pages);
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_eof_hint(struct file *file, cfs_offset_t end)
+{
+  struct file_header hdr;
+  coffee_page_t pages;
+  int k;
+
+  pages = (end + sizeof(hdr) + COFFEE_PAGE_SIZE - 1) / COFFEE_PAGE_SIZE;
+  if(pages <= eof_hint_pages(file->eof_hint, file->max_pages)) {
+    return;
+  }
+
+  /* The hint is written before the data, so that it always covers the
+     data in the file. */
+  for(k = 0; EOF_HINT_PAGES(k, file->max_pages) < pages; k++);
+  read_header(&hdr, file->page);
+  hdr.eof_hint |= 1 << k;
+  write_header(&hdr, file->page);
+  file->eof_hint = hdr.eof_hint;
+}
+/*---------------------------------------------------------------------------*/
 static cfs_offset_t
 file_end(coffee_page_t start)
 {
   struct file_header hdr;
-  unsigned char buf[COFFEE_PAGE_SIZE];
+  union {
+    uint32_t words[(COFFEE_PAGE_SIZE + 3) / 4];
+    unsigned char bytes[COFFEE_PAGE_SIZE];
+  } buf;
+  unsigned char *bytes;
   coffee_page_t page;
+  cfs_offset_t end;
   int i;
 
   read_header(&hdr, start);
 
   /*
-   * Move from the end of the range towards the beginning and look for
-   * a byte that has been modified.
+   * Move from the end of the range covered by the EOF hint towards the
+   * beginning and look for a byte that has been modified. Unmodified
+   * words are skipped before looking at the individual bytes.
    *
    * An important implication of this is that if the last written bytes
    * are zeroes, then these are skipped from the calculation.
    */
 
-  for(page = hdr.max_pages - 1; page >= 0; page--) {
-    COFFEE_READ(buf, sizeof(buf), (start + page) * COFFEE_PAGE_SIZE);
-    for(i = COFFEE_PAGE_SIZE - 1; i >= 0; i--) {
-      if(buf[i] != 0) {
-        if(page == 0 && i < sizeof(hdr)) {
-          return 0;
-        }
-        return 1 + i + (page * COFFEE_PAGE_SIZE) - sizeof(hdr);
+  bytes = (unsigned char *)buf.words;
+  for(page = eof_hint_pages(hdr.eof_hint, hdr.max_pages); page > 0;) {
+    page--;
+    buf.words[sizeof(buf.words) / sizeof(buf.words[0]) - 1] = 0;
+    COFFEE_READ(buf.bytes, COFFEE_PAGE_SIZE, (start + page) * COFFEE_PAGE_SIZE);
+    for(i = sizeof(buf.words) / sizeof(buf.words[0]) - 1;
+        i >= 0 && buf.words[i] == 0;
+        i--);
+    if(i >= 0) {
+      for(i = i * 4 + 3; bytes[i] == 0; i--);
+      end = (cfs_offset_t)page * COFFEE_PAGE_SIZE + i + 1;
+      if(end <= sizeof(hdr)) {
+        return 0;
       }
+      return end - sizeof(hdr);
     }
   }
 
@@ -573,6 +976,12 @@ remove_by_page(coffee_page_t page, int remove_log,
   hdr.flags |= HDR_FLAG_OBSOLETE;
   write_header(&hdr, page);
 
+#if COFFEE_NAME_INDEX_SIZE
+  if(!HDR_LOG(hdr)) {
+    name_index_remove(hdr.name, page);
+  }
+#endif /* COFFEE_NAME_INDEX_SIZE */
+
   gc_wait = 0;
 
   /* Close all file descriptors that reference the removed file. */
@@ -593,7 +1002,11 @@ remove_by_page(coffee_page_t page, int remove_log,
   }
 
   if(!COFFEE_EXTENDED_WEAR_LEVELLING && gc_allowed) {
+#if COFFEE_INCREMENTAL_GC
+    start_gc_process();
+#else
     collect_garbage(GC_RELUCTANT);
+#endif /* COFFEE_INCREMENTAL_GC */
   }
 
   return 0;
@@ -623,6 +1036,8 @@ reserve(const char *name, coffee_page_t pages,
     if(gc_wait) {
       return NULL;
     }
+    /* This is the last resort also with incremental garbage collection,
+       which should normally have freed sectors before they are needed. */
     collect_garbage(GC_GREEDY);
     page = find_contiguous_pages(pages);
     if(page == INVALID_PAGE) {
@@ -635,8 +1050,28 @@ reserve(const char *name, coffee_page_t pages,
   strncpy(hdr.name, name, sizeof(hdr.name) - 1);
   hdr.max_pages = pages;
   hdr.flags = HDR_FLAG_ALLOCATED | flags;
+  hdr.eof_hint = 1;
   write_header(&hdr, page);
 
+#if COFFEE_INCREMENTAL_GC
+  if(page < gc_cursor * COFFEE_PAGES_PER_SECTOR &&
+     page + pages > gc_cursor * COFFEE_PAGES_PER_SECTOR) {
+    /* The state carried to the sector that the collector examines next
+       was computed before this file extended into it. */
+    gc_cursor = 0;
+  }
+  if(page + pages > COFFEE_PAGE_COUNT -
+     COFFEE_GC_WATERMARK * COFFEE_PAGES_PER_SECTOR) {
+    start_gc_process();
+  }
+#endif /* COFFEE_INCREMENTAL_GC */
+
+#if COFFEE_NAME_INDEX_SIZE
+  if(!HDR_LOG(hdr)) {
+    name_index_add(hdr.name, page);
+  }
+#endif /* COFFEE_NAME_INDEX_SIZE */
+
   PRINTF("Coffee: Reserved %u pages starting from %u for file %s\n",
          (unsigned)pages, (unsigned)page, name);
 
@@ -805,6 +1240,8 @@ merge_log(coffee_page_t file_page, int extend)
     return -1;
   }
 
+  update_eof_hint(new_file, coffee_fd_set[fd].file->end);
+
   offset = 0;
   do {
     char buf[hdr.log_record_size == 0 ? COFFEE_PAGE_SIZE : hdr.log_record_size];
@@ -1209,6 +1646,7 @@ cfs_write(int fd, const void *buf, unsigned size)
        * corresponding end offset in the original extent to ensure that
        * the correct file size is calculated when opening the file again.
        */
+      update_eof_hint(file, fdp->offset);
       COFFEE_WRITE(dummy, 1, absolute_offset(file->page, fdp->offset - 1));
     }
   } else {
@@ -1217,6 +1655,7 @@ cfs_write(int fd, const void *buf, unsigned size)
       return -1;
     }
 
+    update_eof_hint(file, fdp->offset + size);
     COFFEE_WRITE(buf, size, absolute_offset(file->page, fdp->offset));
     fdp->offset += size;
 #if COFFEE_MICRO_LOGS
@@ -1247,14 +1686,17 @@ cfs_readdir(struct cfs_dir *dir, struct cfs_dirent *record)
   struct file_header hdr;
   coffee_page_t page;
   coffee_page_t next_page;
+  size_t name_len;
 
   memcpy(&page, dir->state, sizeof(coffee_page_t));
 
   while(page < COFFEE_PAGE_COUNT) {
     read_header(&hdr, page);
     if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr)) {
-      memcpy(record->name, hdr.name, sizeof(record->name));
-      record->name[sizeof(record->name) - 1] = '\0';
+      name_len = sizeof(hdr.name) < sizeof(record->name) ?
+        sizeof(hdr.name) : sizeof(record->name) - 1;
+      memcpy(record->name, hdr.name, name_len);
+      record->name[name_len] = '\0';
       record->size = file_end(page);
 
       next_page = next_file(page, &hdr);
@@ -1340,6 +1782,12 @@ cfs_coffee_format(void)
   memset(&coffee_fd_set, 0, sizeof(coffee_fd_set));
   next_free = 0;
   gc_wait = 1;
+#if COFFEE_INCREMENTAL_GC
+  gc_cursor = 0;
+#endif /* COFFEE_INCREMENTAL_GC */
+#if COFFEE_NAME_INDEX_SIZE
+  name_index_state = NAME_INDEX_INVALID;
+#endif /* COFFEE_NAME_INDEX_SIZE */
 
   PRINTF(" done!\n");
 
@@ -47,31 +47,94 @@
 #include "contiki.h"
 #include "lib/memb.h"
 
+#if MEMB_WITH_BITMAP
+#ifdef __GNUC__
+#define first_set_bit(x) __builtin_ctz(x)
+#else /* __GNUC__ */
+static int
+first_set_bit(memb_bitmap_t x)
+{
+  int n = 0;
+  while((x & 1) == 0) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+}
+#endif /* __GNUC__ */
+#endif /* MEMB_WITH_BITMAP */
 /*---------------------------------------------------------------------------*/
 void
 memb_init(struct memb *m)
 {
   memset(m->count, 0, m->num);
   memset(m->mem, 0, m->size * m->num);
+#if MEMB_WITH_BITMAP
+  memset(m->bitmap, 0, MEMB_BITMAP_WORDS(m->num) * sizeof(memb_bitmap_t));
+  m->first_free_word = 0;
+#endif /* MEMB_WITH_BITMAP */
+#if MEMB_WITH_BITMAP || MEMB_WITH_STATS
+  m->used = 0;
+#endif /* MEMB_WITH_BITMAP || MEMB_WITH_STATS */
+#if MEMB_WITH_STATS
+  m->max_used = 0;
+  m->failed = 0;
+#endif /* MEMB_WITH_STATS */
+}
+/*---------------------------------------------------------------------------*/
+static void *
+use_block(struct memb *m, int i)
+{
+  /* The block was unused, we increase the reference count to
+     indicate that it now is used and return a pointer to the memory
+     block. */
+  ++(m->count[i]);
+#if MEMB_WITH_BITMAP || MEMB_WITH_STATS
+  ++(m->used);
+#endif /* MEMB_WITH_BITMAP || MEMB_WITH_STATS */
+#if MEMB_WITH_STATS
+  if(m->used > m->max_used) {
+    m->max_used = m->used;
+  }
+#endif /* MEMB_WITH_STATS */
+  return (void *)((char *)m->mem + (i * m->size));
 }
 /*---------------------------------------------------------------------------*/
 void *
 memb_alloc(struct memb *m)
 {
   int i;
+#if MEMB_WITH_BITMAP
+  unsigned short word;
+  memb_bitmap_t free_bits;
 
+  for(word = m->first_free_word; word < MEMB_BITMAP_WORDS(m->num); ++word) {
+    free_bits = ~m->bitmap[word];
+    if(free_bits != 0) {
+      i = word * MEMB_BITMAP_BITS + first_set_bit(free_bits);
+      if(i >= m->num) {
+        /* Only the unused bits past the last block are clear. */
+        break;
+      }
+      m->first_free_word = word;
+      m->bitmap[word] |= (memb_bitmap_t)1 << (i % MEMB_BITMAP_BITS);
+      return use_block(m, i);
+    }
+  }
+  m->first_free_word = word;
+#else /* MEMB_WITH_BITMAP */
   for(i = 0; i < m->num; ++i) {
     if(m->count[i] == 0) {
-      /* If this block was unused, we increase the reference count to
-	 indicate that it now is used and return a pointer to the
-	 memory block. */
-      ++(m->count[i]);
-      return (void *)((char *)m->mem + (i * m->size));
+      return use_block(m, i);
     }
   }
+#endif /* MEMB_WITH_BITMAP */
 
   /* No free block was found, so we return NULL to indicate failure to
      allocate block. */
+#if MEMB_WITH_STATS
+  ++(m->failed);
+#endif /* MEMB_WITH_STATS */
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
@@ -79,6 +142,32 @@ char
 memb_free(struct memb *m, void *ptr)
 {
   int i;
+#if MEMB_WITH_BITMAP
+  unsigned long offset;
+
+  /* Find the block from the pointer offset instead of walking
+     through the blocks. */
+  if(!memb_inmemb(m, ptr)) {
+    return -1;
+  }
+  offset = (char *)ptr - (char *)m->mem;
+  if(offset % m->size != 0) {
+    return -1;
+  }
+  i = offset / m->size;
+  if(m->count[i] > 0) {
+    /* Make sure that we don't deallocate free memory. */
+    if(--(m->count[i]) == 0) {
+      m->bitmap[i / MEMB_BITMAP_BITS] &=
+        ~((memb_bitmap_t)1 << (i % MEMB_BITMAP_BITS));
+      if(i / MEMB_BITMAP_BITS < m->first_free_word) {
+        m->first_free_word = i / MEMB_BITMAP_BITS;
+      }
+      --(m->used);
+    }
+  }
+  return m->count[i];
+#else /* MEMB_WITH_BITMAP */
   char *ptr2;
 
   /* Walk through the list of blocks and try to find the block to
@@ -92,12 +181,18 @@ memb_free(struct memb *m, void *ptr)
       if(m->count[i] > 0) {
 	/* Make sure that we don't deallocate free memory. */
 	--(m->count[i]);
+#if MEMB_WITH_STATS
+        if(m->count[i] == 0) {
+          --(m->used);
+        }
+#endif /* MEMB_WITH_STATS */
       }
       return m->count[i];
     }
     ptr2 += m->size;
   }
   return -1;
+#endif /* MEMB_WITH_BITMAP */
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -110,6 +205,9 @@ memb_inmemb(struct memb *m, void *ptr)
 int
 memb_numfree(struct memb *m)
 {
+#if MEMB_WITH_BITMAP || MEMB_WITH_STATS
+  return m->num - m->used;
+#else /* MEMB_WITH_BITMAP || MEMB_WITH_STATS */
   int i;
   int num_free = 0;
 
@@ -120,5 +218,17 @@ memb_numfree(struct memb *m)
   }
 
   return num_free;
+#endif /* MEMB_WITH_BITMAP || MEMB_WITH_STATS */
+}
+/*---------------------------------------------------------------------------*/
+#if MEMB_WITH_STATS
+void
+memb_get_stats(struct memb *m, struct memb_stats *stats)
+{
+  stats->num = m->num;
+  stats->used = m->used;
+  stats->max_used = m->max_used;
+  stats->failed = m->failed;
 }
+#endif /* MEMB_WITH_STATS */
 /** @} */
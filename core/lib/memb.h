@@ -65,6 +65,34 @@
 
 #include "sys/cc.h"
 
+/**
+ * When enabled, each memory block keeps a bitmap of its allocated
+ * blocks, so that memb_alloc() finds a free block a machine word at a
+ * time and memb_free() locates the block from the pointer offset,
+ * instead of both walking through every block.
+ */
+#ifdef MEMB_CONF_WITH_BITMAP
+#define MEMB_WITH_BITMAP MEMB_CONF_WITH_BITMAP
+#else /* MEMB_CONF_WITH_BITMAP */
+#define MEMB_WITH_BITMAP 0
+#endif /* MEMB_CONF_WITH_BITMAP */
+
+/**
+ * When enabled, each memory block keeps track of its high-water mark
+ * and of the number of failed allocations, see memb_get_stats().
+ */
+#ifdef MEMB_CONF_WITH_STATS
+#define MEMB_WITH_STATS MEMB_CONF_WITH_STATS
+#else /* MEMB_CONF_WITH_STATS */
+#define MEMB_WITH_STATS 0
+#endif /* MEMB_CONF_WITH_STATS */
+
+#if MEMB_WITH_BITMAP
+typedef unsigned int memb_bitmap_t;
+#define MEMB_BITMAP_BITS (sizeof(memb_bitmap_t) * 8)
+#define MEMB_BITMAP_WORDS(num) (((num) + MEMB_BITMAP_BITS - 1) / MEMB_BITMAP_BITS)
+#endif /* MEMB_WITH_BITMAP */
+
 /**
  * Declare a memory block.
  *
@@ -86,18 +114,55 @@ MEMB(connections, struct connection, 16);
  * \param num The total number of memory chunks in the block.
  *
  */
+#if MEMB_WITH_BITMAP
+#define MEMB(name, structure, num) \
+        static char CC_CONCAT(name,_memb_count)[num]; \
+        static structure CC_CONCAT(name,_memb_mem)[num]; \
+        static memb_bitmap_t CC_CONCAT(name,_memb_bitmap)[MEMB_BITMAP_WORDS(num)]; \
+        static struct memb name = {sizeof(structure), num, \
+                                          CC_CONCAT(name,_memb_count), \
+                                          (void *)CC_CONCAT(name,_memb_mem), \
+                                          CC_CONCAT(name,_memb_bitmap)}
+#else /* MEMB_WITH_BITMAP */
 #define MEMB(name, structure, num) \
         static char CC_CONCAT(name,_memb_count)[num]; \
         static structure CC_CONCAT(name,_memb_mem)[num]; \
         static struct memb name = {sizeof(structure), num, \
                                           CC_CONCAT(name,_memb_count), \
                                           (void *)CC_CONCAT(name,_memb_mem)}
+#endif /* MEMB_WITH_BITMAP */
 
 struct memb {
   unsigned short size;
   unsigned short num;
   char *count;
   void *mem;
+#if MEMB_WITH_BITMAP
+  memb_bitmap_t *bitmap;
+  /* No word before this one in the bitmap has a free block */
+  unsigned short first_free_word;
+#endif /* MEMB_WITH_BITMAP */
+#if MEMB_WITH_BITMAP || MEMB_WITH_STATS
+  unsigned short used;
+#endif /* MEMB_WITH_BITMAP || MEMB_WITH_STATS */
+#if MEMB_WITH_STATS
+  unsigned short max_used;
+  unsigned short failed;
+#endif /* MEMB_WITH_STATS */
+};
+
+/**
+ * Usage statistics of a memory block, see memb_get_stats().
+ */
+struct memb_stats {
+  /** The total number of blocks. */
+  unsigned short num;
+  /** The number of blocks currently allocated. */
+  unsigned short used;
+  /** The highest number of blocks allocated at the same time. */
+  unsigned short max_used;
+  /** The number of allocations that failed because no block was free. */
+  unsigned short failed;
 };
 
 /**
@@ -132,6 +197,18 @@ int memb_inmemb(struct memb *m, void *ptr);
 
 int  memb_numfree(struct memb *m);
 
+#if MEMB_WITH_STATS
+/**
+ * Get the usage statistics of a memory block. The statistics are
+ * reset by memb_init().
+ *
+ * \param m A memory block previously declared with MEMB().
+ *
+ * \param stats A pointer to the structure that is filled in.
+ */
+void memb_get_stats(struct memb *m, struct memb_stats *stats);
+#endif /* MEMB_WITH_STATS */
+
 /** @} */
 /** @} */
 
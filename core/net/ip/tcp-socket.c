@@ -60,24 +60,50 @@ senddata(struct tcp_socket *s)
 {
   int len = MIN(s->output_data_max_seg, uip_mss());
 
+#if UIP_TCP_WINDOW > 1
+  /* The data from output_data_send_nxt onwards has not been sent yet,
+     and we send as much of it as the window allows. */
+  len = MIN(len, uip_window_avail());
+  len = MIN(len, s->output_data_len - s->output_data_send_nxt);
+  if(len > 0) {
+    uip_send(&s->output_data_ptr[s->output_data_send_nxt], len);
+    s->output_data_send_nxt += len;
+  }
+#else /* UIP_TCP_WINDOW > 1 */
   if(s->output_senddata_len > 0) {
     len = MIN(s->output_senddata_len, len);
     s->output_data_send_nxt = len;
     uip_send(s->output_data_ptr, len);
   }
+#endif /* UIP_TCP_WINDOW > 1 */
 }
 /*---------------------------------------------------------------------------*/
 static void
 acked(struct tcp_socket *s)
 {
+#if UIP_TCP_WINDOW > 1
+  uint16_t len;
+
+  /* Only the data still in flight is left unacknowledged. */
+  len = s->output_data_send_nxt - uip_outstanding(uip_conn);
+  if(len > 0) {
+    memmove(&s->output_data_ptr[0], &s->output_data_ptr[len],
+            s->output_data_len - len);
+    s->output_data_len -= len;
+    s->output_data_send_nxt -= len;
+    s->output_senddata_len = s->output_data_len;
+
+    call_event(s, TCP_SOCKET_DATA_SENT);
+  }
+#else /* UIP_TCP_WINDOW > 1 */
   if(s->output_senddata_len > 0) {
     /* Copy the data in the outputbuf down and update outputbufptr and
        outputbuf_lastsent */
 
     if(s->output_data_send_nxt > 0) {
-      memcpy(&s->output_data_ptr[0],
-             &s->output_data_ptr[s->output_data_send_nxt],
-             s->output_data_maxlen - s->output_data_send_nxt);
+      memmove(&s->output_data_ptr[0],
+              &s->output_data_ptr[s->output_data_send_nxt],
+              s->output_data_maxlen - s->output_data_send_nxt);
     }
     if(s->output_data_len < s->output_data_send_nxt) {
       printf("tcp: acked assertion failed s->output_data_len (%d) < s->output_data_send_nxt (%d)\n",
@@ -95,40 +121,87 @@ acked(struct tcp_socket *s)
 
     call_event(s, TCP_SOCKET_DATA_SENT);
   }
+#endif /* UIP_TCP_WINDOW > 1 */
+}
+/*---------------------------------------------------------------------------*/
+static void
+deliver(struct tcp_socket *s)
+{
+  int bytesleft;
+
+  /* The input callback returns the number of bytes that should be
+     retained in the buffer, or zero if all data should be consumed.
+     If there is data to be retained, the highest bytes of data are
+     copied down into the input buffer, and new data is added after
+     them. */
+  s->flags &= ~TCP_SOCKET_FLAGS_INPUT_PENDING;
+  if(s->input_data_len == 0) {
+    return;
+  }
+  if(s->input_callback) {
+    bytesleft = s->input_callback(s, s->ptr,
+                                  s->input_data_ptr, s->input_data_len);
+  } else {
+    bytesleft = 0;
+  }
+  if(bytesleft <= 0) {
+    s->input_data_len = 0;
+  } else if(bytesleft < s->input_data_len) {
+    memmove(&s->input_data_ptr[0],
+            &s->input_data_ptr[s->input_data_len - bytesleft],
+            bytesleft);
+    s->input_data_len = bytesleft;
+  }
 }
 /*---------------------------------------------------------------------------*/
 static void
 newdata(struct tcp_socket *s)
 {
-  uint16_t len, copylen, bytesleft;
+  uint16_t len, copylen;
   uint8_t *dataptr;
   len = uip_datalen();
   dataptr = uip_appdata;
 
-  /* We have a segment with data coming in. We copy as much data as
-     possible into the input buffer and call the input callback
-     function. The input callback returns the number of bytes that
-     should be retained in the buffer, or zero if all data should be
-     consumed. If there is data to be retained, the highest bytes of
-     data are copied down into the input buffer. */
+  /* We have a segment with data coming in. We add as much data as
+     possible to the input buffer and call the input callback
+     function. */
   do {
-    copylen = MIN(len, s->input_data_maxlen);
-    memcpy(s->input_data_ptr, dataptr, copylen);
-    if(s->input_callback) {
-      bytesleft = s->input_callback(s, s->ptr,
-				    s->input_data_ptr, copylen);
-    } else {
-      bytesleft = 0;
-    }
-    if(bytesleft > 0) {
-      printf("tcp: newdata, bytesleft > 0 (%d) not implemented\n", bytesleft);
+    if(s->input_data_len == s->input_data_maxlen) {
+      /* The buffer is full of retained data. With UIP_CONF_TCP_RCV_WND,
+         our window keeps this from happening. */
+      printf("tcp: newdata, input buffer full, dropping %d bytes\n",
+             s->input_data_len);
+      s->input_data_len = 0;
     }
+    copylen = MIN(len, s->input_data_maxlen - s->input_data_len);
+    memcpy(&s->input_data_ptr[s->input_data_len], dataptr, copylen);
+    s->input_data_len += copylen;
+    deliver(s);
     dataptr += copylen;
     len -= copylen;
 
   } while(len > 0);
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_TCP_RCV_WND
+static void
+update_window(struct tcp_socket *s)
+{
+  uint16_t wnd;
+  uint16_t threshold;
+
+  /* We advertise the free space in the input buffer. When the window
+     opens again after having been less than a segment, or half the
+     buffer, we send the new window right away. */
+  wnd = s->input_data_maxlen - s->input_data_len;
+  threshold = MIN(UIP_TCP_MSS, s->input_data_maxlen / 2);
+  if(uip_conn->rcv_wnd < threshold && wnd >= threshold) {
+    uip_restart();
+  }
+  uip_set_rcv_wnd(wnd);
+}
+#endif /* UIP_TCP_RCV_WND */
+/*---------------------------------------------------------------------------*/
 static void
 relisten(struct tcp_socket *s)
 {
@@ -175,9 +248,17 @@ appcall(void *state)
     if(s == NULL) {
       uip_abort();
     } else {
+#if UIP_TCP_WINDOW > 1
+      uip_window_enable();
+      s->output_data_send_nxt = 0;
+#endif /* UIP_TCP_WINDOW > 1 */
+      s->input_data_len = 0;
       if(uip_newdata()) {
         newdata(s);
       }
+#if UIP_TCP_RCV_WND
+      update_window(s);
+#endif /* UIP_TCP_RCV_WND */
       senddata(s);
     }
     return;
@@ -205,7 +286,12 @@ appcall(void *state)
   }
   if(uip_newdata()) {
     newdata(s);
+  } else if(s->flags & TCP_SOCKET_FLAGS_INPUT_PENDING) {
+    deliver(s);
   }
+#if UIP_TCP_RCV_WND
+  update_window(s);
+#endif /* UIP_TCP_RCV_WND */
 
   if(uip_rexmit() ||
      uip_newdata() ||
@@ -273,6 +359,7 @@ tcp_socket_register(struct tcp_socket *s, void *ptr,
   s->ptr = ptr;
   s->input_data_ptr = input_databuf;
   s->input_data_maxlen = input_databuf_len;
+  s->input_data_len = 0;
   s->output_data_len = 0;
   s->output_data_ptr = output_databuf;
   s->output_data_maxlen = output_databuf_len;
@@ -367,6 +454,24 @@ tcp_socket_send_str(struct tcp_socket *s,
 }
 /*---------------------------------------------------------------------------*/
 int
+tcp_socket_input_resume(struct tcp_socket *s)
+{
+  if(s == NULL) {
+    return -1;
+  }
+
+  if(s->c == NULL) {
+    /* The remote host has closed the connection, but the application
+       may still read what is left in the buffer. */
+    deliver(s);
+  } else {
+    s->flags |= TCP_SOCKET_FLAGS_INPUT_PENDING;
+    tcpip_poll_tcp(s->c);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
 tcp_socket_close(struct tcp_socket *s)
 {
   if(s == NULL) {
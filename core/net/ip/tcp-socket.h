@@ -59,6 +59,11 @@ typedef enum {
  *             function must return the amount of data to leave in the
  *             buffer. I.e., if the callback function consumes all
  *             incoming data, it should return 0.
+ *
+ *             The data that is left in the buffer is kept at the
+ *             start of the buffer and passed to the callback again,
+ *             followed by the next data that comes in, or when the
+ *             application calls tcp_socket_input_resume().
  */
 typedef int (* tcp_socket_data_callback_t)(struct tcp_socket *s,
                                            void *ptr,
@@ -109,6 +114,7 @@ enum {
   TCP_SOCKET_FLAGS_NONE      = 0x00,
   TCP_SOCKET_FLAGS_LISTENING = 0x01,
   TCP_SOCKET_FLAGS_CLOSING   = 0x02,
+  TCP_SOCKET_FLAGS_INPUT_PENDING = 0x04,
 };
 
 /**
@@ -144,7 +150,9 @@ enum {
  *             TCP throttles incoming data so that if the input buffer
  *             is filled, the connection will halt until the
  *             application has read out the data from the input
- *             buffer.
+ *             buffer. This requires UIP_CONF_TCP_RCV_WND, with which
+ *             the free space in the input buffer is advertised as the
+ *             TCP window.
  *
  */
 int tcp_socket_register(struct tcp_socket *s, void *ptr,
@@ -243,6 +251,24 @@ int tcp_socket_send(struct tcp_socket *s,
 int tcp_socket_send_str(struct tcp_socket *s,
                         const char *strptr);
 
+/**
+ * \brief      Call the input callback again with the retained data
+ * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
+ * \retval -1  If an error occurs
+ * \retval 1   If the operation succeeds.
+ *
+ *             This function is for applications that leave data in
+ *             the input buffer because they cannot process it right
+ *             away. When the application is ready for more data, it
+ *             calls this function and the input callback is called
+ *             again, from the TCP socket process, with the data left
+ *             in the input buffer. If the remote host has closed the
+ *             connection in the meantime, the callback is called
+ *             right away.
+ *
+ */
+int tcp_socket_input_resume(struct tcp_socket *s);
+
 /**
  * \brief      Close a connected TCP socket
  * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
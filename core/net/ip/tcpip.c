@@ -813,6 +813,9 @@ PROCESS_THREAD(tcpip_process, ev, data)
 {
   PROCESS_BEGIN();
 
+  /* Keep network events ahead of application events. */
+  process_set_priority(&tcpip_process, PROCESS_PRIO_HIGH);
+
 #if UIP_TCP
   {
     unsigned char i;
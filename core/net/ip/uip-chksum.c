@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2001-2003, Adam Dunkels.
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \addtogroup uip
+ * @{
+ */
+
+/**
+ * \file
+ *         Internet checksum computation (RFC 1071) and incremental
+ *         checksum updates (RFC 1624)
+ */
+
+#include "net/ip/uip.h"
+#include "net/ip/uip-chksum.h"
+
+#include <string.h>
+
+#if UIP_CHKSUM_WORDS && UIP_CHKSUM_SIMD && defined(__SSE2__)
+#include <emmintrin.h>
+#define CHKSUM_SSE2 1
+#elif UIP_CHKSUM_WORDS && UIP_CHKSUM_SIMD && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CHKSUM_NEON 1
+#endif
+
+/* Blocks shorter than this are not worth the SIMD setup */
+#define SIMD_MIN_LEN 64
+/*---------------------------------------------------------------------------*/
+/* One's complement addition of two 16-bit words */
+static uint16_t
+add16(uint16_t a, uint16_t b)
+{
+  a += b;
+  return a + (a < b);
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_CHKSUM_WORDS
+/*
+ * The one's complement sum does not depend on the byte order
+ * (RFC 1071, section 2(B)), so the data is summed as native words and
+ * the result is byte-swapped on little-endian CPUs. The words are
+ * read with memcpy() since the data may be unaligned.
+ */
+#if CHKSUM_SSE2
+/* Sum 16-byte blocks, widening the 16-bit words to 32-bit lanes.
+   Each lane grows by at most 0xffff per block, so it cannot overflow
+   for any 16-bit length. */
+static uint64_t
+sum_simd(const uint8_t *data, uint16_t len)
+{
+  __m128i zero = _mm_setzero_si128();
+  __m128i acc = zero;
+  __m128i v;
+  uint32_t lanes[4];
+
+  while(len >= 16) {
+    v = _mm_loadu_si128((const __m128i *)data);
+    acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v, zero));
+    acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v, zero));
+    data += 16;
+    len -= 16;
+  }
+  _mm_storeu_si128((__m128i *)lanes, acc);
+  return (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+#elif CHKSUM_NEON
+static uint64_t
+sum_simd(const uint8_t *data, uint16_t len)
+{
+  uint32x4_t acc = vdupq_n_u32(0);
+
+  while(len >= 16) {
+    acc = vpadalq_u16(acc, vreinterpretq_u16_u8(vld1q_u8(data)));
+    data += 16;
+    len -= 16;
+  }
+  return (uint64_t)vgetq_lane_u32(acc, 0) + vgetq_lane_u32(acc, 1)
+    + vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+}
+#endif /* CHKSUM_SSE2 */
+/*---------------------------------------------------------------------------*/
+static uint16_t
+sum_words(const uint8_t *data, uint16_t len)
+{
+  uint64_t acc;
+  uint32_t w[4];
+  uint16_t h;
+
+  acc = 0;
+#if CHKSUM_SSE2 || CHKSUM_NEON
+  if(len >= SIMD_MIN_LEN) {
+    acc = sum_simd(data, len);
+    data += len & ~15;
+    len &= 15;
+  }
+#endif /* CHKSUM_SSE2 || CHKSUM_NEON */
+
+  while(len >= 16) {
+    memcpy(w, data, 16);
+    acc += (uint64_t)w[0] + w[1] + w[2] + w[3];
+    data += 16;
+    len -= 16;
+  }
+  while(len >= 4) {
+    memcpy(w, data, 4);
+    acc += w[0];
+    data += 4;
+    len -= 4;
+  }
+  if(len >= 2) {
+    memcpy(&h, data, 2);
+    acc += h;
+    data += 2;
+    len -= 2;
+  }
+  if(len > 0) {
+    /* The odd byte is the high byte of a big-endian word */
+#if UIP_BYTE_ORDER == UIP_BIG_ENDIAN
+    acc += (uint16_t)data[0] << 8;
+#else /* UIP_BYTE_ORDER == UIP_BIG_ENDIAN */
+    acc += data[0];
+#endif /* UIP_BYTE_ORDER == UIP_BIG_ENDIAN */
+  }
+
+  /* Fold the carries back in */
+  acc = (acc >> 32) + (acc & 0xffffffff);
+  acc = (acc >> 32) + (acc & 0xffffffff);
+  acc = (acc >> 16) + (acc & 0xffff);
+  acc = (acc >> 16) + (acc & 0xffff);
+  acc = (acc >> 16) + (acc & 0xffff);
+
+#if UIP_BYTE_ORDER == UIP_BIG_ENDIAN
+  return (uint16_t)acc;
+#else /* UIP_BYTE_ORDER == UIP_BIG_ENDIAN */
+  return (uint16_t)((acc << 8) | (acc >> 8));
+#endif /* UIP_BYTE_ORDER == UIP_BIG_ENDIAN */
+}
+#endif /* UIP_CHKSUM_WORDS */
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_add(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+#if UIP_CHKSUM_WORDS
+  return add16(sum, sum_words(data, len));
+#else /* UIP_CHKSUM_WORDS */
+  uint16_t t;
+  const uint8_t *dataptr;
+  const uint8_t *last_byte;
+
+  dataptr = data;
+  last_byte = data + len - 1;
+
+  while(dataptr < last_byte) {   /* At least two more bytes */
+    t = (dataptr[0] << 8) + dataptr[1];
+    sum += t;
+    if(sum < t) {
+      sum++;      /* carry */
+    }
+    dataptr += 2;
+  }
+
+  if(dataptr == last_byte) {
+    t = (dataptr[0] << 8) + 0;
+    sum += t;
+    if(sum < t) {
+      sum++;      /* carry */
+    }
+  }
+
+  /* Return sum in host byte order. */
+  return sum;
+#endif /* UIP_CHKSUM_WORDS */
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_update16(uint16_t chksum, uint16_t old_value, uint16_t new_value)
+{
+  uint16_t sum;
+
+  /* HC' = ~(~HC + ~m + m') */
+  sum = add16(~uip_ntohs(chksum), ~uip_ntohs(old_value));
+  sum = add16(sum, uip_ntohs(new_value));
+  return uip_htons(~sum);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_update(uint16_t chksum,
+                  const void *old_data, uint16_t old_len,
+                  const void *new_data, uint16_t new_len)
+{
+  uint16_t sum;
+
+  sum = add16(~uip_ntohs(chksum), ~uip_chksum_add(0, old_data, old_len));
+  sum = uip_chksum_add(sum, new_data, new_len);
+  return uip_htons(~sum);
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2001-2003, Adam Dunkels.
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \addtogroup uip
+ * @{
+ */
+
+/**
+ * \file
+ *         Internet checksum computation (RFC 1071) and incremental
+ *         checksum updates (RFC 1624)
+ */
+
+#ifndef UIP_CHKSUM_H_
+#define UIP_CHKSUM_H_
+
+#include "contiki-conf.h"
+#include <stdint.h>
+
+/**
+ * Sum the data 32 bits at a time in a 64-bit accumulator instead of
+ * 16 bits at a time. Only pays off on CPUs with 32-bit registers, so
+ * it is disabled by default on 8-bit and 16-bit CPUs.
+ */
+#ifdef UIP_CONF_CHKSUM_WORDS
+#define UIP_CHKSUM_WORDS UIP_CONF_CHKSUM_WORDS
+#elif defined(UINTPTR_MAX) && UINTPTR_MAX > 0xffff
+#define UIP_CHKSUM_WORDS 1
+#else
+#define UIP_CHKSUM_WORDS 0
+#endif /* UIP_CONF_CHKSUM_WORDS */
+
+/**
+ * Sum longer blocks with SSE2 or NEON when the compiler targets
+ * them. Requires UIP_CHKSUM_WORDS. Disabled by default, since
+ * optimizing compilers vectorize the word loop well enough on x86-64
+ * and the intrinsics are slow in unoptimized builds.
+ */
+#ifdef UIP_CONF_CHKSUM_SIMD
+#define UIP_CHKSUM_SIMD UIP_CONF_CHKSUM_SIMD
+#else
+#define UIP_CHKSUM_SIMD 0
+#endif /* UIP_CONF_CHKSUM_SIMD */
+
+/**
+ * Add data to a partial Internet checksum.
+ *
+ * The data is summed as 16-bit big-endian words, regardless of its
+ * alignment. Blocks of a longer message can be summed one after the
+ * other as long as all but the last one have an even length.
+ *
+ * \param sum The partial checksum so far, in host byte order.
+ * \param data Pointer to the data.
+ * \param len Length of the data, in bytes.
+ * \return The updated partial checksum, in host byte order.
+ */
+uint16_t uip_chksum_add(uint16_t sum, const uint8_t *data, uint16_t len);
+
+/**
+ * Update a checksum field after changing a 16-bit word of the
+ * data it covers (RFC 1624, equation 3).
+ *
+ * \param chksum The checksum field, as found in the packet.
+ * \param old_value The old word, as found in the packet.
+ * \param new_value The new word, as found in the packet.
+ * \return The new checksum field, ready to be stored in the packet.
+ */
+uint16_t uip_chksum_update16(uint16_t chksum, uint16_t old_value,
+                             uint16_t new_value);
+
+/**
+ * Update a checksum field after replacing a block of the data it
+ * covers (or of the pseudo-header) with another one. The blocks need
+ * not have the same length, which allows e.g. swapping an IPv6
+ * pseudo-header address pair for an IPv4 one, but both must have an
+ * even length and start at an even offset.
+ *
+ * \param chksum The checksum field, as found in the packet.
+ * \param old_data The data that was covered by the checksum.
+ * \param old_len Length of old_data, in bytes.
+ * \param new_data The data that replaces it.
+ * \param new_len Length of new_data, in bytes.
+ * \return The new checksum field, ready to be stored in the packet.
+ */
+uint16_t uip_chksum_update(uint16_t chksum,
+                           const void *old_data, uint16_t old_len,
+                           const void *new_data, uint16_t new_len);
+
+#endif /* UIP_CHKSUM_H_ */
+
+/** @} */
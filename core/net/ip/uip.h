@@ -713,6 +713,49 @@ CCIF void uip_send(const void *data, int len);
     uip_conn->tcpstateflags &= ~UIP_STOPPED;                    \
   } while(0)
 
+#if UIP_TCP_RCV_WND
+/**
+ * Set the receiver's window that we advertise for the current
+ * connection, typically to the free space in the application's input
+ * buffer.
+ *
+ * The window takes effect with the next segment that we send. To
+ * send it right away, for example when the window opens again after
+ * the application has read out its buffer, call uip_restart() as
+ * well.
+ *
+ * \hideinitializer
+ */
+#define uip_set_rcv_wnd(wnd) (uip_conn->rcv_wnd = (wnd))
+#endif /* UIP_TCP_RCV_WND */
+
+#if UIP_TCP_WINDOW > 1
+/**
+ * Let the current connection have several segments in flight.
+ *
+ * Once enabled, uip_send() always sends new data following the data
+ * already sent, uIP keeps a copy of each segment until it has been
+ * acknowledged and retransmits lost segments itself, so the
+ * application is never called with uip_rexmit() set. When
+ * uip_acked() is set, uip_outstanding() tells how much of the data
+ * sent is still unacknowledged. After sending a segment, uIP polls
+ * the application again while the window is open. This must only be
+ * called for established connections.
+ *
+ * \hideinitializer
+ */
+#define uip_window_enable() (uip_conn->tcpflags |= UIP_TCP_WINDOWED)
+
+/**
+ * The amount of new data that the application may send on the current
+ * connection, once uip_window_enable() has been called.
+ *
+ * \return The number of bytes that fit in the send window, at most
+ * uip_mss(), or zero if no more segments may be sent right now.
+ */
+uint16_t uip_window_avail(void);
+#endif /* UIP_TCP_WINDOW > 1 */
+
 
 /* uIP tests that can be made to determine in what state the current
    connection is, and what the application function should do. */
@@ -1370,6 +1413,16 @@ struct uip_conn {
   uint8_t timer;         /**< The retransmission timer. */
   uint8_t nrtx;          /**< The number of retransmissions for the last
                               segment sent. */
+#if UIP_TCP_WINDOW > 1
+  uint16_t snd_wnd;      /**< The window advertised by the remote host. */
+  uint8_t dupacks;       /**< The number of duplicate ACKs in a row. */
+#endif /* UIP_TCP_WINDOW > 1 */
+#if UIP_TCP_WINDOW > 1 || UIP_TCP_DELAYED_ACK
+  uint8_t tcpflags;      /**< Send window and delayed ACK state. */
+#endif /* UIP_TCP_WINDOW > 1 || UIP_TCP_DELAYED_ACK */
+#if UIP_TCP_RCV_WND
+  uint16_t rcv_wnd;      /**< The window we advertise to the remote host. */
+#endif /* UIP_TCP_RCV_WND */
 
   uip_tcp_appstate_t appstate; /** The application state. */
 };
@@ -1617,6 +1670,12 @@ void uip_process(uint8_t flag);
 
 #define UIP_STOPPED      16
 
+/* The flags used in uip_conn->tcpflags. */
+#define UIP_TCP_WINDOWED       1  /* Several segments may be in flight */
+#define UIP_TCP_RECOVERY       2  /* Retransmitting lost segments */
+#define UIP_TCP_CLOSE_PENDING  4  /* Send a FIN once all data is acked */
+#define UIP_TCP_ACK_PENDING    8  /* An ACK has been delayed */
+
 /* The TCP and IP headers. */
 struct uip_tcpip_hdr {
 #if NETSTACK_CONF_WITH_IPV6
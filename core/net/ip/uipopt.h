@@ -500,6 +500,21 @@ void uip_log(char *msg);
 #define UIP_RECEIVE_WINDOW (UIP_CONF_RECEIVE_WINDOW)
 #endif
 
+/**
+ * Let the application set the receiver's window of each connection
+ * with uip_set_rcv_wnd(), for example to the free space in its input
+ * buffer. Connections start with UIP_RECEIVE_WINDOW, and segments
+ * that do not fit in the window are not accepted. Only supported
+ * with IPv6.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_RCV_WND
+#define UIP_TCP_RCV_WND (UIP_CONF_TCP_RCV_WND)
+#else /* UIP_CONF_TCP_RCV_WND */
+#define UIP_TCP_RCV_WND 0
+#endif /* UIP_CONF_TCP_RCV_WND */
+
 /**
  * How long a connection should stay in the TIME_WAIT state.
  *
@@ -511,6 +526,68 @@ void uip_log(char *msg);
 #define UIP_TIME_WAIT_TIMEOUT UIP_CONF_WAIT_TIMEOUT
 #endif
 
+/**
+ * The maximum number of unacknowledged segments a TCP connection may
+ * have in flight.
+ *
+ * With the default of 1, uIP sends one segment per round trip and
+ * the application regenerates lost data when uip_rexmit() is set.
+ * With a larger window, connections on which the application has
+ * called uip_window_enable() send up to this many segments before
+ * waiting for an ACK. uIP then keeps a copy of each segment in flight
+ * and retransmits lost segments itself. Only supported with IPv6.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_WINDOW
+#define UIP_TCP_WINDOW (UIP_CONF_TCP_WINDOW)
+#else /* UIP_CONF_TCP_WINDOW */
+#define UIP_TCP_WINDOW 1
+#endif /* UIP_CONF_TCP_WINDOW */
+
+/**
+ * The number of retransmission buffers shared by all connections with
+ * a send window. Each buffer holds one segment of UIP_TCP_MSS bytes.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_RTX_BUFS
+#define UIP_TCP_RTX_BUFS (UIP_CONF_TCP_RTX_BUFS)
+#else /* UIP_CONF_TCP_RTX_BUFS */
+#define UIP_TCP_RTX_BUFS UIP_TCP_WINDOW
+#endif /* UIP_CONF_TCP_RTX_BUFS */
+
+/**
+ * The number of duplicate ACKs after which a connection with a send
+ * window retransmits its first unacknowledged segment without waiting
+ * for the retransmission timer. Set to 0 to disable.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_FAST_RETRANSMIT
+#define UIP_TCP_FAST_RETRANSMIT (UIP_CONF_TCP_FAST_RETRANSMIT)
+#else /* UIP_CONF_TCP_FAST_RETRANSMIT */
+#define UIP_TCP_FAST_RETRANSMIT 3
+#endif /* UIP_CONF_TCP_FAST_RETRANSMIT */
+
+/**
+ * Delay ACKs for incoming data: every second segment is acknowledged
+ * right away and a single segment when the periodic TCP timer fires,
+ * unless the application has data to send in the meantime.
+ *
+ * This halves the number of ACKs for bulk transfers, but stalls
+ * senders that wait for an ACK after each segment (such as uIP
+ * without a send window), so it is disabled by default. Only
+ * supported with IPv6.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_DELAYED_ACK
+#define UIP_TCP_DELAYED_ACK (UIP_CONF_TCP_DELAYED_ACK)
+#else /* UIP_CONF_TCP_DELAYED_ACK */
+#define UIP_TCP_DELAYED_ACK 0
+#endif /* UIP_CONF_TCP_DELAYED_ACK */
+
 /** @} */
 /*------------------------------------------------------------------------------*/
 /**
@@ -69,6 +69,11 @@
 #include "net/rime/rime.h"
 #include "net/ipv6/sicslowpan.h"
 #include "net/netstack.h"
+#include "net/mac/csma.h"
+#if UIP_CONF_IPV6_RPL
+#include "net/rpl/rpl-private.h"
+#include "net/rpl/rpl-dag-root.h"
+#endif /* UIP_CONF_IPV6_RPL */
 
 #include <stdio.h>
 
@@ -251,6 +256,72 @@ static uint16_t my_tag;
 /* Assuming that the worst growth for uncompression is 38 bytes */
 #define SICSLOWPAN_FIRST_FRAGMENT_SIZE (SICSLOWPAN_FRAGMENT_SIZE + 38)
 
+/* The number of hash buckets used to find a reassembly context from
+   the (sender, tag) pair of a fragment. Must be a power of two. */
+#ifdef SICSLOWPAN_CONF_REASS_HASH_SIZE
+#define SICSLOWPAN_REASS_HASH_SIZE SICSLOWPAN_CONF_REASS_HASH_SIZE
+#else
+#define SICSLOWPAN_REASS_HASH_SIZE 8
+#endif
+
+/* Per-sender quotas, so that a single neighbor sending many large
+   packets cannot starve the others. The defaults impose no limit. */
+#ifdef SICSLOWPAN_CONF_REASS_SENDER_CONTEXTS
+#define SICSLOWPAN_REASS_SENDER_CONTEXTS SICSLOWPAN_CONF_REASS_SENDER_CONTEXTS
+#else
+#define SICSLOWPAN_REASS_SENDER_CONTEXTS SICSLOWPAN_REASS_CONTEXTS
+#endif
+
+#ifdef SICSLOWPAN_CONF_REASS_SENDER_BUFFERS
+#define SICSLOWPAN_REASS_SENDER_BUFFERS SICSLOWPAN_CONF_REASS_SENDER_BUFFERS
+#else
+#define SICSLOWPAN_REASS_SENDER_BUFFERS SICSLOWPAN_FRAGMENT_BUFFERS
+#endif
+
+#define SICSLOWPAN_REASS_QUOTAS                                         \
+  (SICSLOWPAN_REASS_SENDER_CONTEXTS < SICSLOWPAN_REASS_CONTEXTS ||      \
+   SICSLOWPAN_REASS_SENDER_BUFFERS < SICSLOWPAN_FRAGMENT_BUFFERS)
+
+/* A context that has not received a fragment while this many
+   fragments were received in total is considered stalled. A stalled
+   context does not count towards the sender quotas, and may be taken
+   over by a new packet when all contexts are in use. */
+#ifdef SICSLOWPAN_CONF_REASS_STALL_FRAGMENTS
+#define SICSLOWPAN_REASS_STALL_FRAGMENTS SICSLOWPAN_CONF_REASS_STALL_FRAGMENTS
+#else
+#define SICSLOWPAN_REASS_STALL_FRAGMENTS (4 * SICSLOWPAN_REASS_CONTEXTS)
+#endif
+
+/* Fragment forwarding: relay the fragments of packets that are not
+   for us hop by hop instead of reassembling them */
+#ifdef SICSLOWPAN_CONF_FRAG_FORWARDING
+#define SICSLOWPAN_FRAG_FORWARDING SICSLOWPAN_CONF_FRAG_FORWARDING
+#else
+#define SICSLOWPAN_FRAG_FORWARDING 0
+#endif
+
+/* The number of packets that can be forwarded at the same time */
+#ifdef SICSLOWPAN_CONF_FRAG_FORWARDING_ENTRIES
+#define SICSLOWPAN_FRAG_FORWARDING_ENTRIES SICSLOWPAN_CONF_FRAG_FORWARDING_ENTRIES
+#else
+#define SICSLOWPAN_FRAG_FORWARDING_ENTRIES 4
+#endif
+
+/* Index used to terminate the context and buffer chains */
+#define FRAG_NONE -1
+
+/* Contexts and buffers are chained through int8_t indices */
+#if SICSLOWPAN_FRAGMENT_BUFFERS > 127 || SICSLOWPAN_REASS_CONTEXTS > 127
+#error "SICSLOWPAN_CONF_FRAGMENT_BUFFERS and SICSLOWPAN_CONF_REASS_CONTEXTS must not exceed 127"
+#endif
+
+#if SICSLOWPAN_FRAG_STATS
+struct sicslowpan_frag_stats sicslowpan_frag_stats;
+#define FRAG_STATS_ADD(x) sicslowpan_frag_stats.x++
+#else /* SICSLOWPAN_FRAG_STATS */
+#define FRAG_STATS_ADD(x)
+#endif /* SICSLOWPAN_FRAG_STATS */
+
 /* all information needed for reassembly */
 struct sicslowpan_frag_info {
   /** When reassembling, the source address of the fragments being merged */
@@ -265,8 +336,16 @@ struct sicslowpan_frag_info {
   uint16_t reassembled_len;
   /** Reassembly %process %timer. */
   struct timer reass_timer;
-
-  /** Fragment size of first fragment */
+  /** Next context in the same hash bucket */
+  int8_t hash_next;
+  /** First fragment buffer of this context */
+  int8_t first_buf;
+  /** Number of fragment buffers held by this context */
+  uint8_t nbufs;
+  /** Value of frag_clock when the last fragment was added */
+  uint16_t last_seen;
+
+  /** Fragment size of first fragment (zero until it has been received) */
   uint16_t first_frag_len;
   /** First fragment - needs a larger buffer since the size is uncompressed size
    and we need to know total size to know when we have received last fragment. */
@@ -276,8 +355,8 @@ struct sicslowpan_frag_info {
 static struct sicslowpan_frag_info frag_info[SICSLOWPAN_REASS_CONTEXTS];
 
 struct sicslowpan_frag_buf {
-  /* the index of the frag_info */
-  uint8_t index;
+  /* the next buffer of the same context, or in the free list */
+  int8_t next;
   /* Fragment offset */
   uint8_t offset;
   /* Length of this fragment (if zero this buffer is not allocated) */
@@ -287,20 +366,70 @@ struct sicslowpan_frag_buf {
 
 static struct sicslowpan_frag_buf frag_buf[SICSLOWPAN_FRAGMENT_BUFFERS];
 
+/* Hash buckets of contexts, and the list of unused fragment buffers */
+static int8_t reass_hash[SICSLOWPAN_REASS_HASH_SIZE];
+static int8_t free_buf;
+
+/* Counts received fragments, used to find stalled contexts */
+static uint16_t frag_clock;
+#define CONTEXT_IDLE(i) ((uint16_t)(frag_clock - frag_info[i].last_seen))
+#define CONTEXT_STALLED(i) (CONTEXT_IDLE(i) > SICSLOWPAN_REASS_STALL_FRAGMENTS)
+
+/*---------------------------------------------------------------------------*/
+static uint8_t
+reass_hash_index(uint16_t tag, const linkaddr_t *sender)
+{
+  return (tag ^ (tag >> 8) ^ sender->u8[LINKADDR_SIZE - 1]) &
+    (SICSLOWPAN_REASS_HASH_SIZE - 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+reass_init(void)
+{
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_REASS_HASH_SIZE; i++) {
+    reass_hash[i] = FRAG_NONE;
+  }
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    frag_info[i].len = 0;
+  }
+  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
+    frag_buf[i].len = 0;
+    frag_buf[i].next = i + 1 < SICSLOWPAN_FRAGMENT_BUFFERS ? i + 1 : FRAG_NONE;
+  }
+  free_buf = 0;
+}
 /*---------------------------------------------------------------------------*/
 static int
 clear_fragments(uint8_t frag_info_index)
 {
-  int i, clear_count;
+  struct sicslowpan_frag_info *info = &frag_info[frag_info_index];
+  int8_t *pp;
+  int8_t i, next;
+  int clear_count;
+
+  /* Unlink the context from its hash bucket */
+  pp = &reass_hash[reass_hash_index(info->tag, &info->sender)];
+  while(*pp != FRAG_NONE && *pp != frag_info_index) {
+    pp = &frag_info[*pp].hash_next;
+  }
+  if(*pp == frag_info_index) {
+    *pp = info->hash_next;
+  }
+
+  /* Return the buffers of the context to the free list */
   clear_count = 0;
-  frag_info[frag_info_index].len = 0;
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    if(frag_buf[i].len > 0 && frag_buf[i].index == frag_info_index) {
-      /* deallocate the buffer */
-      frag_buf[i].len = 0;
-      clear_count++;
-    }
+  for(i = info->first_buf; i != FRAG_NONE; i = next) {
+    next = frag_buf[i].next;
+    frag_buf[i].len = 0;
+    frag_buf[i].next = free_buf;
+    free_buf = i;
+    clear_count++;
   }
+  info->first_buf = FRAG_NONE;
+  info->nbufs = 0;
+  info->len = 0;
   return clear_count;
 }
 /*---------------------------------------------------------------------------*/
@@ -314,88 +443,218 @@ timeout_fragments(int not_context)
        timer_expired(&frag_info[i].reass_timer)) {
       /* This context can be freed */
       count += clear_fragments(i);
+      FRAG_STATS_ADD(timeouts);
     }
   }
   return count;
 }
 /*---------------------------------------------------------------------------*/
+static int8_t
+find_context(uint16_t tag, const linkaddr_t *sender)
+{
+  int8_t i;
+
+  for(i = reass_hash[reass_hash_index(tag, sender)]; i != FRAG_NONE;
+      i = frag_info[i].hash_next) {
+    if(frag_info[i].tag == tag && linkaddr_cmp(&frag_info[i].sender, sender)) {
+      return i;
+    }
+  }
+  return FRAG_NONE;
+}
+/*---------------------------------------------------------------------------*/
+#if SICSLOWPAN_REASS_QUOTAS
+/* Counts what the sender holds by walking all contexts, which is cheap
+   for the few contexts that there are. This runs for every fragment
+   that is stored, and only when quotas are configured. */
 static int
-store_fragment(uint8_t index, uint8_t offset)
+sender_over_quota(const linkaddr_t *sender, int new_context)
 {
   int i;
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    if(frag_buf[i].len == 0) {
-      /* copy over the data from packetbuf into the fragment buffer and store offset and len */
-      frag_buf[i].offset = offset; /* frag offset */
-      frag_buf[i].len = packetbuf_datalen() - packetbuf_hdr_len;
-      frag_buf[i].index = index;
-      memcpy(frag_buf[i].data, packetbuf_ptr + packetbuf_hdr_len,
-             packetbuf_datalen() - packetbuf_hdr_len);
-
-      PRINTF("Fragsize: %d\n", frag_buf[i].len);
-      /* return the length of the stored fragment */
-      return frag_buf[i].len;
+  int contexts = 0;
+  int bufs = 0;
+
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    if(frag_info[i].len > 0 && !CONTEXT_STALLED(i) &&
+       linkaddr_cmp(&frag_info[i].sender, sender)) {
+      contexts++;
+      bufs += frag_info[i].nbufs;
     }
   }
-  /* failed */
-  return -1;
+  if(new_context) {
+    return contexts >= SICSLOWPAN_REASS_SENDER_CONTEXTS;
+  }
+  return bufs >= SICSLOWPAN_REASS_SENDER_BUFFERS;
+}
+#endif /* SICSLOWPAN_REASS_QUOTAS */
+/*---------------------------------------------------------------------------*/
+static int8_t
+new_context(uint16_t tag, uint16_t frag_size, const linkaddr_t *sender)
+{
+  int i;
+  int8_t found = FRAG_NONE;
+  int8_t stalled = FRAG_NONE;
+  uint8_t h;
+
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    /* clear all fragment info with expired timer to free all fragment buffers */
+    if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
+      clear_fragments(i);
+      FRAG_STATS_ADD(timeouts);
+    }
+
+    /* We use len as indication on used or not used */
+    if(found < 0 && frag_info[i].len == 0) {
+      /* We remember the first free fragment info but must continue
+         the loop to free any other expired fragment buffers. */
+      found = i;
+    }
+
+    /* Remember the context that has been idle the longest */
+    if(frag_info[i].len > 0 && CONTEXT_STALLED(i) &&
+       (stalled < 0 || CONTEXT_IDLE(i) > CONTEXT_IDLE(stalled))) {
+      stalled = i;
+    }
+  }
+
+#if SICSLOWPAN_REASS_QUOTAS
+  /* Checked before evicting, so that a sender over its quota cannot
+     take a stalled context away from another sender */
+  if(sender_over_quota(sender, 1)) {
+    PRINTF("*** Sender over reassembly context quota - tag: %d\n", tag);
+    FRAG_STATS_ADD(quota);
+    return FRAG_NONE;
+  }
+#endif /* SICSLOWPAN_REASS_QUOTAS */
+
+  if(found < 0 && stalled >= 0) {
+    /* Take over a context that has seen no fragment for a long while:
+       the rest of its packet was lost, or it holds late duplicates of
+       a packet that has already been reassembled. */
+    clear_fragments(stalled);
+    FRAG_STATS_ADD(evicted);
+    found = stalled;
+  }
+
+  if(found < 0) {
+    PRINTF("*** Failed to store new fragment session - tag: %d\n", tag);
+    FRAG_STATS_ADD(no_context);
+    return FRAG_NONE;
+  }
+
+  /* Found a free fragment info to store data in */
+  frag_info[found].len = frag_size;
+  frag_info[found].tag = tag;
+  frag_info[found].reassembled_len = 0;
+  frag_info[found].first_frag_len = 0;
+  frag_info[found].first_buf = FRAG_NONE;
+  frag_info[found].nbufs = 0;
+  frag_info[found].last_seen = frag_clock;
+  linkaddr_copy(&frag_info[found].sender, sender);
+  timer_set(&frag_info[found].reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+
+  h = reass_hash_index(tag, sender);
+  frag_info[found].hash_next = reass_hash[h];
+  reass_hash[h] = found;
+  return found;
+}
+/*---------------------------------------------------------------------------*/
+static int
+store_fragment(uint8_t index, uint8_t offset)
+{
+  int8_t i;
+  int len;
+
+  len = packetbuf_datalen() - packetbuf_hdr_len;
+  if(len <= 0 || len > SICSLOWPAN_FRAGMENT_SIZE) {
+    return -1;
+  }
+
+  i = free_buf;
+  if(i == FRAG_NONE) {
+    /* failed */
+    return -1;
+  }
+  free_buf = frag_buf[i].next;
+
+  /* copy over the data from packetbuf into the fragment buffer and store offset and len */
+  frag_buf[i].offset = offset; /* frag offset */
+  frag_buf[i].len = len;
+  frag_buf[i].next = frag_info[index].first_buf;
+  frag_info[index].first_buf = i;
+  frag_info[index].nbufs++;
+  memcpy(frag_buf[i].data, packetbuf_ptr + packetbuf_hdr_len, len);
+
+  PRINTF("Fragsize: %d\n", frag_buf[i].len);
+  /* return the length of the stored fragment */
+  return frag_buf[i].len;
 }
 /*---------------------------------------------------------------------------*/
 /* add a new fragment to the buffer */
 static int8_t
 add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
 {
-  int i;
+  const linkaddr_t *sender = packetbuf_addr(PACKETBUF_ADDR_SENDER);
+  int8_t i;
+  int8_t b;
   int len;
-  int8_t found = -1;
+
+  frag_clock++;
+  i = find_context(tag, sender);
+  if(i >= 0 && frag_info[i].len != frag_size) {
+    /* The sender has reused the tag for another packet; the old one
+       will never complete. */
+    clear_fragments(i);
+    i = FRAG_NONE;
+  }
 
   if(offset == 0) {
     /* This is a first fragment - check if we can add this */
-    for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-      /* clear all fragment info with expired timer to free all fragment buffers */
-      if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
-	clear_fragments(i);
-      }
-
-      /* We use len as indication on used or not used */
-      if(found < 0 && frag_info[i].len == 0) {
-        /* We remember the first free fragment info but must continue
-           the loop to free any other expired fragment buffers. */
-        found = i;
-      }
-    }
-
-    if(found < 0) {
-      PRINTF("*** Failed to store new fragment session - tag: %d\n", tag);
+    if(i < 0) {
+      i = new_context(tag, frag_size, sender);
+    } else if(frag_info[i].first_frag_len > 0) {
+      PRINTF("*** Duplicate first fragment - tag: %d\n", tag);
+      FRAG_STATS_ADD(duplicates);
       return -1;
     }
-
-    /* Found a free fragment info to store data in */
-    frag_info[found].len = frag_size;
-    frag_info[found].tag = tag;
-    linkaddr_copy(&frag_info[found].sender,
-                  packetbuf_addr(PACKETBUF_ADDR_SENDER));
-    timer_set(&frag_info[found].reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+    if(i >= 0) {
+      frag_info[i].last_seen = frag_clock;
+    }
     /* first fragment can not be stored immediately but is moved into
        the buffer while uncompressing */
-    return found;
+    return i;
   }
 
   /* This is a N-fragment - should find the info */
-  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-    if(frag_info[i].tag == tag && frag_info[i].len > 0 &&
-       linkaddr_cmp(&frag_info[i].sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
-      /* Tag and Sender match - this must be the correct info to store in */
-      found = i;
-      break;
+  if(i < 0) {
+    /* The first fragment has not arrived yet - keep the fragment
+       until it does. */
+    i = new_context(tag, frag_size, sender);
+    if(i < 0) {
+      PRINTF("*** Failed to store N-fragment - could not find session - tag: %d offset: %d\n", tag, offset);
+      return -1;
+    }
+    FRAG_STATS_ADD(out_of_order);
+  } else {
+    for(b = frag_info[i].first_buf; b != FRAG_NONE; b = frag_buf[b].next) {
+      if(frag_buf[b].offset == offset) {
+        PRINTF("*** Duplicate fragment - tag: %d offset: %d\n", tag, offset);
+        FRAG_STATS_ADD(duplicates);
+        return -1;
+      }
+    }
+    if(frag_info[i].first_frag_len == 0) {
+      FRAG_STATS_ADD(out_of_order);
     }
   }
 
-  if(found < 0) {
-    /* no entry found for storing the new fragment */
-    PRINTF("*** Failed to store N-fragment - could not find session - tag: %d offset: %d\n", tag, offset);
+#if SICSLOWPAN_REASS_QUOTAS
+  if(sender_over_quota(sender, 0)) {
+    PRINTF("*** Sender over reassembly buffer quota - tag: %d\n", tag);
+    FRAG_STATS_ADD(quota);
     return -1;
   }
+#endif /* SICSLOWPAN_REASS_QUOTAS */
 
   /* i is the index of the reassembly context */
   len = store_fragment(i, offset);
@@ -404,11 +663,13 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
   }
   if(len > 0) {
     frag_info[i].reassembled_len += len;
+    frag_info[i].last_seen = frag_clock;
     return i;
   } else {
     /* should we also clear all fragments since we failed to store
        this fragment? */
     PRINTF("*** Failed to store fragment - packet reassembly will fail tag:%d l\n", frag_info[i].tag);
+    FRAG_STATS_ADD(no_buffer);
     return -1;
   }
 }
@@ -418,20 +679,21 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
 static void
 copy_frags2uip(int context)
 {
-  int i;
+  int8_t i;
 
   /* Copy from the fragment context info buffer first */
   memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)frag_info[context].first_frag,
 	 frag_info[context].first_frag_len);
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    /* And also copy all matching fragments */
-    if(frag_buf[i].len > 0 && frag_buf[i].index == context) {
+  for(i = frag_info[context].first_buf; i != FRAG_NONE; i = frag_buf[i].next) {
+    /* And also copy all fragments of the context */
+    if((uint16_t)(frag_buf[i].offset << 3) + frag_buf[i].len <= UIP_BUFSIZE - UIP_LLH_LEN) {
       memcpy((uint8_t *)UIP_IP_BUF + (uint16_t)(frag_buf[i].offset << 3),
-	     (uint8_t *)frag_buf[i].data, frag_buf[i].len);
+             (uint8_t *)frag_buf[i].data, frag_buf[i].len);
     }
   }
   /* deallocate all the fragments for this context */
   clear_fragments(context);
+  FRAG_STATS_ADD(reassembled);
 }
 #endif /* SICSLOWPAN_CONF_FRAG */
 
@@ -454,26 +716,61 @@ rime_sniffer_remove(struct rime_sniffer *s)
   callback = NULL;
 }
 
+/* Set the attributes that classify the packet of len bytes in uip_buf */
 static void
-set_packet_attrs(void)
+set_packet_attrs(uint16_t len)
 {
   int c = 0;
-  /* set protocol in NETWORK_ID */
-  packetbuf_set_attr(PACKETBUF_ATTR_NETWORK_ID, UIP_IP_BUF->proto);
+  uint8_t proto;
+  uint16_t offset, end;
+#if CSMA_WITH_TRAFFIC_CLASSES
+  struct uip_ext_hdr *ext;
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
+  struct uip_udp_hdr *udp;
+  struct uip_tcp_hdr *tcp;
+  struct uip_icmp_hdr *icmp;
+
+  proto = UIP_IP_BUF->proto;
+  offset = UIP_LLIPH_LEN;
+  end = UIP_LLIPH_LEN + (UIP_IP_BUF->len[0] << 8) + UIP_IP_BUF->len[1];
+  if(end > UIP_LLH_LEN + len) {
+    end = UIP_LLH_LEN + len;
+  }
+  if(end > UIP_BUFSIZE) {
+    end = UIP_BUFSIZE;
+  }
+#if CSMA_WITH_TRAFFIC_CLASSES
+  /* Skip the extension headers, such as the RPL hop-by-hop option and
+     source routing header, so that CSMA classifies the packet by its
+     upper-layer protocol */
+  while((proto == UIP_PROTO_HBHO || proto == UIP_PROTO_DESTO ||
+         proto == UIP_PROTO_ROUTING || proto == UIP_PROTO_FRAG) &&
+        offset + sizeof(struct uip_ext_hdr) <= end) {
+    ext = (struct uip_ext_hdr *)&uip_buf[offset];
+    offset += proto == UIP_PROTO_FRAG ? UIP_FRAGH_LEN : (ext->len + 1) << 3;
+    proto = ext->next;
+  }
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
+
+  /* set the upper-layer protocol in NETWORK_ID */
+  packetbuf_set_attr(PACKETBUF_ATTR_NETWORK_ID, proto);
 
   /* assign values to the channel attribute (port or type + code) */
-  if(UIP_IP_BUF->proto == UIP_PROTO_UDP) {
-    c = UIP_UDP_BUF->srcport;
-    if(UIP_UDP_BUF->destport < c) {
-      c = UIP_UDP_BUF->destport;
+  if(proto == UIP_PROTO_UDP && offset + UIP_UDPH_LEN <= end) {
+    udp = (struct uip_udp_hdr *)&uip_buf[offset];
+    c = udp->srcport;
+    if(udp->destport < c) {
+      c = udp->destport;
     }
-  } else if(UIP_IP_BUF->proto == UIP_PROTO_TCP) {
-    c = UIP_TCP_BUF->srcport;
-    if(UIP_TCP_BUF->destport < c) {
-      c = UIP_TCP_BUF->destport;
+  } else if(proto == UIP_PROTO_TCP && offset + UIP_TCPH_LEN <= end) {
+    tcp = (struct uip_tcp_hdr *)&uip_buf[offset];
+    c = tcp->srcport;
+    if(tcp->destport < c) {
+      c = tcp->destport;
     }
-  } else if(UIP_IP_BUF->proto == UIP_PROTO_ICMP6) {
-    c = UIP_ICMP_BUF->type << 8 | UIP_ICMP_BUF->icode;
+  } else if(proto == UIP_PROTO_ICMP6 && offset + UIP_ICMPH_LEN <= end) {
+    icmp = (struct uip_icmp_hdr *)&uip_buf[offset];
+    c = icmp->type << 8 | icmp->icode;
   }
 
   packetbuf_set_attr(PACKETBUF_ATTR_CHANNEL, c);
@@ -1288,10 +1585,10 @@ output(const uip_lladdr_t *localdest)
   packetbuf_clear();
   packetbuf_ptr = packetbuf_dataptr();
 
-  if(callback) {
+  if(callback != NULL || CSMA_WITH_TRAFFIC_CLASSES) {
     /* call the attribution when the callback comes, but set attributes
-       here ! */
-    set_packet_attrs();
+       here! CSMA traffic classes also classify the packet by them. */
+    set_packet_attrs(uip_len);
   }
 
 #if PACKETBUF_WITH_PACKET_TYPE
@@ -1487,6 +1784,324 @@ output(const uip_lladdr_t *localdest)
   return 1;
 }
 
+#if SICSLOWPAN_CONF_FRAG && SICSLOWPAN_FRAG_FORWARDING
+/*--------------------------------------------------------------------*/
+/** \name Fragment forwarding
+ *
+ * A packet that is only passing through this node is not reassembled.
+ * Its first fragment is decompressed, the hop limit decremented and
+ * the header compressed again for the next hop; the following
+ * fragments are relayed as they arrive, with a tag of our own. Packets
+ * that need more processing (routing header, last hop, no known next
+ * hop) are reassembled as usual. An RPL hop-by-hop option is checked
+ * and updated as for a reassembled packet. The RPL root reassembles
+ * everything, as it rewrites the extension headers and with them the
+ * size of the datagram.
+ * @{
+ */
+#if UIP_CONF_IPV6_RPL
+#define UIP_FWD_HBHO_BUF    (&uip_buf[UIP_LLIPH_LEN])
+#define UIP_FWD_RPL_OPT_BUF ((struct uip_ext_hdr_opt_rpl *)&uip_buf[UIP_LLIPH_LEN + 2])
+#endif /* UIP_CONF_IPV6_RPL */
+
+struct sicslowpan_fwd_entry {
+  /** Link-layer source and tag of the incoming fragments */
+  linkaddr_t sender;
+  uint16_t tag;
+  /** Where to and with which tag the fragments are relayed */
+  linkaddr_t next_hop;
+  uint16_t out_tag;
+  /** Datagram size, zero if the entry is unused */
+  uint16_t len;
+  /** Bytes of the datagram relayed so far, and the offsets (in units
+      of 8 bytes) of the fragments relayed, so that duplicates are not
+      counted twice */
+  uint16_t forwarded_len;
+  uint8_t forwarded[32];
+  /** The attributes that classify the packet, for the MAC layer */
+  packetbuf_attr_t network_id;
+  packetbuf_attr_t channel;
+  struct timer lifetime;
+};
+
+static struct sicslowpan_fwd_entry fwd_table[SICSLOWPAN_FRAG_FORWARDING_ENTRIES];
+static uint8_t fwd_frame[MAC_MAX_PAYLOAD];
+
+/*--------------------------------------------------------------------*/
+static struct sicslowpan_fwd_entry *
+fwd_lookup(uint16_t tag, const linkaddr_t *sender)
+{
+  struct sicslowpan_fwd_entry *e;
+
+  for(e = fwd_table; e < &fwd_table[SICSLOWPAN_FRAG_FORWARDING_ENTRIES]; e++) {
+    if(e->len > 0 && timer_expired(&e->lifetime)) {
+      e->len = 0;
+    }
+    if(e->len > 0 && e->tag == tag && linkaddr_cmp(&e->sender, sender)) {
+      return e;
+    }
+  }
+  return NULL;
+}
+/*--------------------------------------------------------------------*/
+static struct sicslowpan_fwd_entry *
+fwd_alloc(void)
+{
+  struct sicslowpan_fwd_entry *e;
+
+  for(e = fwd_table; e < &fwd_table[SICSLOWPAN_FRAG_FORWARDING_ENTRIES]; e++) {
+    if(e->len == 0 || timer_expired(&e->lifetime)) {
+      return e;
+    }
+  }
+  return NULL;
+}
+/*--------------------------------------------------------------------*/
+/* Send a FRAGN with the given payload to the next hop of the entry,
+   unless a fragment at that offset has already been sent */
+static void
+fwd_send(struct sicslowpan_fwd_entry *e, uint8_t offset,
+         const uint8_t *data, uint8_t len)
+{
+  if(e->forwarded[offset >> 3] & (1 << (offset & 7))) {
+    FRAG_STATS_ADD(duplicates);
+    return;
+  }
+  e->forwarded[offset >> 3] |= 1 << (offset & 7);
+
+  packetbuf_clear();
+  packetbuf_ptr = packetbuf_dataptr();
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAGN << 8) | e->len));
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, e->out_tag);
+  PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_OFFSET] = offset;
+  memcpy(packetbuf_ptr + SICSLOWPAN_FRAGN_HDR_LEN, data, len);
+  packetbuf_set_datalen(SICSLOWPAN_FRAGN_HDR_LEN + len);
+  packetbuf_set_attr(PACKETBUF_ATTR_NETWORK_ID, e->network_id);
+  packetbuf_set_attr(PACKETBUF_ATTR_CHANNEL, e->channel);
+  send_packet(&e->next_hop);
+
+  e->forwarded_len += len;
+  if(e->forwarded_len >= e->len) {
+    /* The whole datagram has been relayed */
+    e->len = 0;
+  }
+}
+/*--------------------------------------------------------------------*/
+/* Relay a FRAGN in packetbuf if its datagram is being forwarded.
+   Returns non-zero if the fragment has been taken care of. */
+static int
+fwd_fragment(uint16_t tag, uint8_t offset)
+{
+  struct sicslowpan_fwd_entry *e;
+  int len;
+
+  e = fwd_lookup(tag, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  if(e == NULL) {
+    return 0;
+  }
+
+  len = packetbuf_datalen() - packetbuf_hdr_len;
+  if(len > 0 && len <= sizeof(fwd_frame) - SICSLOWPAN_FRAGN_HDR_LEN) {
+    memcpy(fwd_frame, packetbuf_ptr + packetbuf_hdr_len, len);
+    fwd_send(e, offset, fwd_frame, len);
+  }
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+/* Look up the link-layer address of the next hop towards the
+   destination of the packet in uip_buf */
+static const uip_lladdr_t *
+fwd_next_hop(void)
+{
+  uip_ipaddr_t *nexthop;
+  uip_ds6_route_t *route;
+
+  if(uip_ds6_is_addr_onlink(&UIP_IP_BUF->destipaddr)) {
+    nexthop = &UIP_IP_BUF->destipaddr;
+  } else {
+    route = uip_ds6_route_lookup(&UIP_IP_BUF->destipaddr);
+    if(route != NULL) {
+      nexthop = uip_ds6_route_nexthop(route);
+    } else {
+      nexthop = uip_ds6_defrt_choose();
+    }
+  }
+  if(nexthop == NULL) {
+    return NULL;
+  }
+  return uip_ds6_nbr_lladdr_from_ipaddr(nexthop);
+}
+/*--------------------------------------------------------------------*/
+/* Check whether the extension headers of the packet in uip_buf, of which
+   len bytes have been received, include a routing header. A chain that
+   continues past the received bytes is assumed to include one. */
+static int
+fwd_has_routing_header(uint16_t len)
+{
+  struct uip_ext_hdr *ext;
+  uint16_t offset;
+  uint8_t proto;
+
+  proto = UIP_IP_BUF->proto;
+  offset = UIP_LLIPH_LEN;
+  while(proto == UIP_PROTO_HBHO || proto == UIP_PROTO_DESTO) {
+    if(offset + sizeof(struct uip_ext_hdr) > UIP_LLH_LEN + len) {
+      return 1;
+    }
+    ext = (struct uip_ext_hdr *)&uip_buf[offset];
+    offset += (ext->len + 1) << 3;
+    proto = ext->next;
+  }
+  return proto == UIP_PROTO_ROUTING;
+}
+/*--------------------------------------------------------------------*/
+/* Decide whether the first fragment, decompressed in uip_buf, is to be
+   forwarded and if so send it, along with any later fragments that
+   overtook it. Returns non-zero if the fragment was forwarded. */
+static int
+fwd_first_fragment(uint16_t tag, uint16_t frag_size, uint16_t first_len)
+{
+  struct sicslowpan_fwd_entry *e;
+  const uip_lladdr_t *lladdr;
+  linkaddr_t next_hop;
+  int framer_hdrlen;
+  int len;
+  int8_t context;
+  int8_t b;
+  uint8_t saved_hdr_len, saved_uncomp_hdr_len;
+#if UIP_CONF_IPV6_RPL
+  uint8_t saved_hbh[RPL_HOP_BY_HOP_LEN];
+#endif /* UIP_CONF_IPV6_RPL */
+
+  /* Same conditions as for forwarding in uip6.c */
+  if(uip_ds6_is_my_addr(&UIP_IP_BUF->destipaddr) ||
+     uip_is_addr_mcast(&UIP_IP_BUF->destipaddr) ||
+     uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr) ||
+     uip_is_addr_linklocal(&UIP_IP_BUF->srcipaddr) ||
+     uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr) ||
+     uip_is_addr_loopback(&UIP_IP_BUF->destipaddr) ||
+     UIP_IP_BUF->ttl <= 1 ||
+     first_len < UIP_IPH_LEN + UIP_UDPH_LEN ||
+     fwd_has_routing_header(first_len)) {
+    return 0;
+  }
+#if UIP_CONF_IPV6_RPL
+  if(rpl_dag_root_is_root() ||
+     (UIP_IP_BUF->proto == UIP_PROTO_HBHO &&
+      (first_len < UIP_IPH_LEN + RPL_HOP_BY_HOP_LEN ||
+       UIP_FWD_RPL_OPT_BUF->opt_type != UIP_EXT_HDR_OPT_RPL))) {
+    return 0;
+  }
+#endif /* UIP_CONF_IPV6_RPL */
+
+  lladdr = fwd_next_hop();
+  if(lladdr == NULL ||
+     linkaddr_cmp((const linkaddr_t *)lladdr,
+                  packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
+    return 0;
+  }
+  linkaddr_copy(&next_hop, (const linkaddr_t *)lladdr);
+
+  e = fwd_alloc();
+  if(e == NULL) {
+    return 0;
+  }
+
+#if UIP_CONF_IPV6_RPL
+  /* Check and update the RPL option as uip_process() and
+     tcpip_ipv6_output() would; a packet that fails is dropped */
+  uip_ext_len = 0;
+  if(UIP_IP_BUF->proto == UIP_PROTO_HBHO) {
+    memcpy(saved_hbh, UIP_FWD_HBHO_BUF, RPL_HOP_BY_HOP_LEN);
+    if(!rpl_verify_hbh_header(2)) {
+      return 1;
+    }
+  }
+  if(!rpl_update_header()) {
+    return 1;
+  }
+#endif /* UIP_CONF_IPV6_RPL */
+
+  /* Compress the header for the next hop in place; the received
+     payload has already been copied to uip_buf. */
+  saved_hdr_len = packetbuf_hdr_len;
+  saved_uncomp_hdr_len = uncomp_hdr_len;
+  packetbuf_hdr_len = 0;
+  uncomp_hdr_len = 0;
+  UIP_IP_BUF->ttl--;
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+  compress_hdr_iphc(&next_hop);
+#else /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+  compress_hdr_ipv6(&next_hop);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+
+#ifndef SICSLOWPAN_USE_FIXED_HDRLEN
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &next_hop);
+  framer_hdrlen = NETSTACK_FRAMER.length();
+  if(framer_hdrlen < 0) {
+    framer_hdrlen = SICSLOWPAN_FIXED_HDRLEN;
+  }
+#else /* USE_FRAMER_HDRLEN */
+  framer_hdrlen = SICSLOWPAN_FIXED_HDRLEN;
+#endif /* USE_FRAMER_HDRLEN */
+
+  len = SICSLOWPAN_FRAG1_HDR_LEN + packetbuf_hdr_len + first_len - uncomp_hdr_len;
+  if(first_len < uncomp_hdr_len || len > MAC_MAX_PAYLOAD - framer_hdrlen) {
+    /* Does not fit in a frame to the next hop: reassemble instead */
+    UIP_IP_BUF->ttl++;
+#if UIP_CONF_IPV6_RPL
+    if(UIP_IP_BUF->proto == UIP_PROTO_HBHO) {
+      memcpy(UIP_FWD_HBHO_BUF, saved_hbh, RPL_HOP_BY_HOP_LEN);
+    }
+#endif /* UIP_CONF_IPV6_RPL */
+    packetbuf_hdr_len = saved_hdr_len;
+    uncomp_hdr_len = saved_uncomp_hdr_len;
+    return 0;
+  }
+
+  linkaddr_copy(&e->sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  linkaddr_copy(&e->next_hop, &next_hop);
+  e->tag = tag;
+  e->out_tag = my_tag++;
+  e->len = frag_size;
+  e->forwarded_len = first_len;
+  memset(e->forwarded, 0, sizeof(e->forwarded));
+  e->forwarded[0] = 1;
+  timer_set(&e->lifetime, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+
+  SET16(fwd_frame, PACKETBUF_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAG1 << 8) | frag_size));
+  SET16(fwd_frame, PACKETBUF_FRAG_TAG, e->out_tag);
+  memcpy(fwd_frame + SICSLOWPAN_FRAG1_HDR_LEN, packetbuf_ptr, packetbuf_hdr_len);
+  memcpy(fwd_frame + SICSLOWPAN_FRAG1_HDR_LEN + packetbuf_hdr_len,
+         (uint8_t *)UIP_IP_BUF + uncomp_hdr_len, first_len - uncomp_hdr_len);
+
+  /* Later fragments that overtook the first one are waiting in a
+     reassembly context */
+  context = find_context(tag, &e->sender);
+
+  packetbuf_copyfrom(fwd_frame, len);
+  if(callback != NULL || CSMA_WITH_TRAFFIC_CLASSES) {
+    set_packet_attrs(first_len);
+  }
+  e->network_id = packetbuf_attr(PACKETBUF_ATTR_NETWORK_ID);
+  e->channel = packetbuf_attr(PACKETBUF_ATTR_CHANNEL);
+  send_packet(&next_hop);
+  FRAG_STATS_ADD(forwarded);
+
+  if(context >= 0) {
+    for(b = frag_info[context].first_buf; b != FRAG_NONE && e->len > 0;
+        b = frag_buf[b].next) {
+      fwd_send(e, frag_buf[b].offset, frag_buf[b].data, frag_buf[b].len);
+    }
+    clear_fragments(context);
+  }
+  return 1;
+}
+/** @} */
+#endif /* SICSLOWPAN_CONF_FRAG && SICSLOWPAN_FRAG_FORWARDING */
+
 /*--------------------------------------------------------------------*/
 /** \brief Process a received 6lowpan packet.
  *
@@ -1555,6 +2170,18 @@ input(void)
       first_fragment = 1;
       is_fragment = 1;
 
+#if SICSLOWPAN_FRAG_FORWARDING
+      if(fwd_lookup(frag_tag, packetbuf_addr(PACKETBUF_ADDR_SENDER)) != NULL) {
+        /* Duplicate of a first fragment that we have forwarded */
+        FRAG_STATS_ADD(duplicates);
+        return;
+      }
+      /* Decompress into uip_buf; whether the packet is forwarded or
+         reassembled is decided once the header is known. */
+      frag_context = FRAG_NONE;
+      break;
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
       /* Add the fragment to the fragmentation context */
       frag_context = add_fragment(frag_tag, frag_size, frag_offset);
 
@@ -1583,6 +2210,12 @@ input(void)
       PRINTFI("last_fragment?: packetbuf_payload_len %d frag_size %d\n",
               packetbuf_datalen() - packetbuf_hdr_len, frag_size);
 
+#if SICSLOWPAN_FRAG_FORWARDING
+      if(fwd_fragment(frag_tag, frag_offset)) {
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
       /* Add the fragment to the fragmentation context (this will also
          copy the payload) */
       frag_context = add_fragment(frag_tag, frag_size, frag_offset);
@@ -1595,7 +2228,8 @@ input(void)
          we should not store more */
       buffer = NULL;
 
-      if(frag_info[frag_context].reassembled_len >= frag_size) {
+      if(frag_info[frag_context].first_frag_len > 0 &&
+         frag_info[frag_context].reassembled_len >= frag_size) {
         last_fragment = 1;
       }
       is_fragment = 1;
@@ -1675,11 +2309,33 @@ input(void)
   /* update processed_ip_in_len if fragment, sicslowpan_len otherwise */
 
 #if SICSLOWPAN_CONF_FRAG
+#if SICSLOWPAN_FRAG_FORWARDING
+  if(first_fragment != 0) {
+    if(fwd_first_fragment(frag_tag, frag_size,
+                          uncomp_hdr_len + packetbuf_payload_len)) {
+      return;
+    }
+    /* Not forwarded - reassemble the packet */
+    if(uncomp_hdr_len + packetbuf_payload_len > SICSLOWPAN_FIRST_FRAGMENT_SIZE) {
+      return;
+    }
+    frag_context = add_fragment(frag_tag, frag_size, frag_offset);
+    if(frag_context == -1) {
+      return;
+    }
+    memcpy(frag_info[frag_context].first_frag, (uint8_t *)UIP_IP_BUF,
+           uncomp_hdr_len + packetbuf_payload_len);
+  }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
   if(frag_size > 0) {
     /* Add the size of the header only for the first fragment. */
     if(first_fragment != 0) {
-      frag_info[frag_context].reassembled_len = uncomp_hdr_len + packetbuf_payload_len;
+      /* Fragments that overtook the first one may already be stored. */
+      frag_info[frag_context].reassembled_len += uncomp_hdr_len + packetbuf_payload_len;
       frag_info[frag_context].first_frag_len = uncomp_hdr_len + packetbuf_payload_len;
+      if(frag_info[frag_context].reassembled_len >= frag_size) {
+        last_fragment = 1;
+      }
     }
     /* For the last fragment, we are OK if there is extrenous bytes at
        the end of the packet. */
@@ -1721,7 +2377,7 @@ input(void)
 
     /* if callback is set then set attributes and call */
     if(callback) {
-      set_packet_attrs();
+      set_packet_attrs(uip_len);
       callback->input_callback();
     }
 
@@ -1745,6 +2401,10 @@ sicslowpan_init(void)
 
   tcpip_set_outputfunc(output);
 
+#if SICSLOWPAN_CONF_FRAG
+  reass_init();
+#endif /* SICSLOWPAN_CONF_FRAG */
+
 #if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
 /* Preinitialize any address contexts for better header compression
  * (Saves up to 13 bytes per 6lowpan packet)
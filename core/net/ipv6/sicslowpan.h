@@ -319,6 +319,44 @@ struct sicslowpan_nh_compressor {
 
 };
 
+/**
+ * \name Fragment reassembly statistics
+ *
+ * Enabled with SICSLOWPAN_CONF_FRAG_STATS.
+ * @{
+ */
+#ifdef SICSLOWPAN_CONF_FRAG_STATS
+#define SICSLOWPAN_FRAG_STATS SICSLOWPAN_CONF_FRAG_STATS
+#else
+#define SICSLOWPAN_FRAG_STATS 0
+#endif
+
+struct sicslowpan_frag_stats {
+  /** Packets successfully reassembled */
+  uint16_t reassembled;
+  /** Reassembly contexts discarded after SICSLOWPAN_REASS_MAXAGE */
+  uint16_t timeouts;
+  /** Fragments dropped because no reassembly context was free */
+  uint16_t no_context;
+  /** Fragments dropped because no fragment buffer was free */
+  uint16_t no_buffer;
+  /** Stalled contexts taken over by a new packet */
+  uint16_t evicted;
+  /** Fragments dropped because the sender exceeded its quota */
+  uint16_t quota;
+  /** Packets relayed fragment by fragment (SICSLOWPAN_CONF_FRAG_FORWARDING) */
+  uint16_t forwarded;
+  /** Duplicate fragments that were ignored */
+  uint16_t duplicates;
+  /** Fragments received before the first fragment of their packet */
+  uint16_t out_of_order;
+};
+
+#if SICSLOWPAN_FRAG_STATS
+extern struct sicslowpan_frag_stats sicslowpan_frag_stats;
+#endif
+/** @} */
+
 int sicslowpan_get_last_rssi(void);
 
 extern const struct network_driver sicslowpan_driver;
@@ -75,6 +75,21 @@ MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 static int num_routes = 0;
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 
+#if UIP_DS6_ROUTE_TRIE
+/* Nodes of the longest-prefix-match trie. A node either holds a
+   route whose prefix is exactly the node prefix, or is a branch node
+   without route that always has two children. Hence a trie holding N
+   routes never needs more than 2N - 1 nodes. */
+struct route_trie_node {
+  struct route_trie_node *child[2];
+  uip_ds6_route_t *route;
+  uip_ipaddr_t prefix;
+  uint8_t length;
+};
+MEMB(trienodememb, struct route_trie_node, UIP_DS6_ROUTE_NB * 2);
+static struct route_trie_node *trie_root;
+#endif /* UIP_DS6_ROUTE_TRIE */
+
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
 
 /* Default routes are held on the defaultrouterlist and their
@@ -119,6 +134,185 @@ assert_nbr_routes_list_sane(void)
 }
 #endif /* DEBUG != DEBUG_NONE */
 /*---------------------------------------------------------------------------*/
+#if (UIP_CONF_MAX_ROUTES != 0) && UIP_DS6_ROUTE_TRIE
+static uint8_t
+trie_bit(const uip_ipaddr_t *addr, uint8_t pos)
+{
+  return (addr->u8[pos >> 3] >> (7 - (pos & 7))) & 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the number of leading bits, at most limit, that a and b
+   have in common. The first start bits are known to be equal. */
+static uint8_t
+trie_common_length(const uip_ipaddr_t *a, const uip_ipaddr_t *b,
+                   uint8_t start, uint8_t limit)
+{
+  uint8_t i;
+  uint8_t len;
+  uint8_t diff;
+
+  for(i = start >> 3; i < sizeof(uip_ipaddr_t) && i * 8 < limit; i++) {
+    diff = a->u8[i] ^ b->u8[i];
+    if(diff != 0) {
+      len = i * 8;
+      while((diff & 0x80) == 0) {
+        diff <<= 1;
+        len++;
+      }
+      return len < limit ? len : limit;
+    }
+  }
+  return limit;
+}
+/*---------------------------------------------------------------------------*/
+static struct route_trie_node *
+trie_node_new(const uip_ipaddr_t *prefix, uint8_t length,
+              uip_ds6_route_t *route)
+{
+  struct route_trie_node *n;
+
+  n = memb_alloc(&trienodememb);
+  if(n != NULL) {
+    n->child[0] = n->child[1] = NULL;
+    n->route = route;
+    uip_ipaddr_copy(&n->prefix, prefix);
+    n->length = length;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+trie_lookup(const uip_ipaddr_t *addr)
+{
+  struct route_trie_node *n;
+  uip_ds6_route_t *found;
+  uint8_t matched;
+
+  found = NULL;
+  matched = 0;
+  n = trie_root;
+  while(n != NULL &&
+        trie_common_length(addr, &n->prefix, matched, n->length) == n->length) {
+    if(n->route != NULL) {
+      found = n->route;
+    }
+    if(n->length == 128) {
+      break;
+    }
+    matched = n->length;
+    n = n->child[trie_bit(addr, n->length)];
+  }
+  return found;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the route currently indexed for exactly prefix/length. */
+static uip_ds6_route_t *
+trie_lookup_exact(const uip_ipaddr_t *prefix, uint8_t length)
+{
+  struct route_trie_node *n;
+
+  n = trie_root;
+  while(n != NULL && n->length <= length &&
+        trie_common_length(prefix, &n->prefix, 0, n->length) == n->length) {
+    if(n->length == length) {
+      return n->route;
+    }
+    n = n->child[trie_bit(prefix, n->length)];
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+trie_insert(uip_ds6_route_t *r)
+{
+  struct route_trie_node **link;
+  struct route_trie_node *n;
+  struct route_trie_node *leaf;
+  struct route_trie_node *branch;
+  uint8_t common;
+
+  link = &trie_root;
+  while((n = *link) != NULL) {
+    common = trie_common_length(&r->ipaddr, &n->prefix, 0,
+                                MIN(r->length, n->length));
+    if(common == n->length) {
+      if(n->length == r->length) {
+        n->route = r;
+        return 1;
+      }
+      link = &n->child[trie_bit(&r->ipaddr, n->length)];
+      continue;
+    }
+
+    /* The new prefix diverges from, or is a prefix of, the node. */
+    leaf = trie_node_new(&r->ipaddr, r->length, r);
+    if(leaf == NULL) {
+      return 0;
+    }
+    if(common == r->length) {
+      leaf->child[trie_bit(&n->prefix, common)] = n;
+      *link = leaf;
+      return 1;
+    }
+    branch = trie_node_new(&r->ipaddr, common, NULL);
+    if(branch == NULL) {
+      memb_free(&trienodememb, leaf);
+      return 0;
+    }
+    branch->child[trie_bit(&r->ipaddr, common)] = leaf;
+    branch->child[trie_bit(&n->prefix, common)] = n;
+    *link = branch;
+    return 1;
+  }
+
+  *link = trie_node_new(&r->ipaddr, r->length, r);
+  return *link != NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+trie_remove(uip_ds6_route_t *r)
+{
+  struct route_trie_node **link;
+  struct route_trie_node **parent_link;
+  struct route_trie_node *n;
+  struct route_trie_node *parent;
+
+  parent_link = NULL;
+  link = &trie_root;
+  while((n = *link) != NULL && n->length <= r->length &&
+        trie_common_length(&r->ipaddr, &n->prefix, 0, n->length) == n->length) {
+    if(n->length == r->length) {
+      break;
+    }
+    parent_link = link;
+    link = &n->child[trie_bit(&r->ipaddr, n->length)];
+  }
+
+  if(n == NULL || n->length != r->length || n->route != r) {
+    return;
+  }
+
+  n->route = NULL;
+  if(n->child[0] != NULL && n->child[1] != NULL) {
+    /* Still needed as a branch node. */
+    return;
+  }
+  *link = n->child[0] != NULL ? n->child[0] : n->child[1];
+  memb_free(&trienodememb, n);
+
+  /* A branch node left with a single child is merged away. */
+  if(parent_link != NULL) {
+    parent = *parent_link;
+    if(parent->route == NULL &&
+       (parent->child[0] == NULL || parent->child[1] == NULL)) {
+      *parent_link = parent->child[0] != NULL ?
+        parent->child[0] : parent->child[1];
+      memb_free(&trienodememb, parent);
+    }
+  }
+}
+#endif /* (UIP_CONF_MAX_ROUTES != 0) && UIP_DS6_ROUTE_TRIE */
+/*---------------------------------------------------------------------------*/
 #if UIP_DS6_NOTIFICATIONS
 static void
 call_route_callback(int event, uip_ipaddr_t *route,
@@ -162,6 +356,10 @@ uip_ds6_route_init(void)
 #if (UIP_CONF_MAX_ROUTES != 0)
   memb_init(&routememb);
   list_init(routelist);
+#if UIP_DS6_ROUTE_TRIE
+  memb_init(&trienodememb);
+  trie_root = NULL;
+#endif /* UIP_DS6_ROUTE_TRIE */
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
@@ -254,15 +452,20 @@ uip_ds6_route_t *
 uip_ds6_route_lookup(uip_ipaddr_t *addr)
 {
 #if (UIP_CONF_MAX_ROUTES != 0)
-  uip_ds6_route_t *r;
   uip_ds6_route_t *found_route;
+#if !UIP_DS6_ROUTE_TRIE
+  uip_ds6_route_t *r;
   uint8_t longestmatch;
+#endif /* !UIP_DS6_ROUTE_TRIE */
 
   PRINTF("uip-ds6-route: Looking up route for ");
   PRINT6ADDR(addr);
   PRINTF("\n");
 
 
+#if UIP_DS6_ROUTE_TRIE
+  found_route = trie_lookup(addr);
+#else /* UIP_DS6_ROUTE_TRIE */
   found_route = NULL;
   longestmatch = 0;
   for(r = uip_ds6_route_head();
@@ -278,6 +481,7 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
       }
     }
   }
+#endif /* UIP_DS6_ROUTE_TRIE */
 
   if(found_route != NULL) {
     PRINTF("uip-ds6-route: Found route: ");
@@ -289,6 +493,10 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     PRINTF("uip-ds6-route: No route found\n");
   }
 
+#if UIP_DS6_ROUTE_TRIE && !UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
+  /* The list order only matters for LRU eviction. Reordering it
+     would cost a walk of the route list on every lookup. */
+#else
   if(found_route != NULL && found_route != list_head(routelist)) {
     /* If we found a route, we put it at the start of the routeslist
        list. The list is ordered by how recently we looked them up:
@@ -298,6 +506,7 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     list_remove(routelist, found_route);
     list_push(routelist, found_route);
   }
+#endif
 
   return found_route;
 #else /* (UIP_CONF_MAX_ROUTES != 0) */
@@ -343,6 +552,14 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 
     uip_ds6_route_rm(r);
   }
+#if UIP_DS6_ROUTE_TRIE
+  /* The trie indexes a single route per prefix, so an entry with the
+     exact same prefix and length is replaced. */
+  r = trie_lookup_exact(ipaddr, length);
+  if(r != NULL) {
+    uip_ds6_route_rm(r);
+  }
+#endif /* UIP_DS6_ROUTE_TRIE */
   {
     struct uip_ds6_route_neighbor_routes *routes;
     /* If there is no routing entry, create one. We first need to
@@ -437,6 +654,15 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
 
+#if UIP_DS6_ROUTE_TRIE
+  if(!trie_insert(r)) {
+    /* Cannot happen as the trie node pool is sized for the table. */
+    PRINTF("uip_ds6_route_add: could not index route\n");
+    uip_ds6_route_rm(r);
+    return NULL;
+  }
+#endif /* UIP_DS6_ROUTE_TRIE */
+
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
 #endif
@@ -479,6 +705,9 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
 
     /* Remove the route from the route list */
     list_remove(routelist, route);
+#if UIP_DS6_ROUTE_TRIE
+    trie_remove(route);
+#endif /* UIP_DS6_ROUTE_TRIE */
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
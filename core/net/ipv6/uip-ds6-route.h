@@ -88,6 +88,17 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB 4
 #endif /* UIP_CONF_MAX_ROUTES */
 
+/* Longest-prefix-match index for the routing table. When enabled,
+   uip_ds6_route_lookup() walks a path-compressed binary trie instead
+   of the whole route list, so the lookup cost depends on the prefix
+   length rather than on the number of routes. Recommended for border
+   routers holding a large number of storing-mode routes. */
+#ifdef UIP_CONF_DS6_ROUTE_TRIE
+#define UIP_DS6_ROUTE_TRIE UIP_CONF_DS6_ROUTE_TRIE
+#else /* UIP_CONF_DS6_ROUTE_TRIE */
+#define UIP_DS6_ROUTE_TRIE 0
+#endif /* UIP_CONF_DS6_ROUTE_TRIE */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -74,7 +74,9 @@
 #include "sys/cc.h"
 #include "net/ip/uip.h"
 #include "net/ip/uip_arch.h"
+#include "net/ip/uip-chksum.h"
 #include "net/ip/uipopt.h"
+#include "net/ip/tcpip.h"
 #include "net/ipv6/uip-icmp6.h"
 #include "net/ipv6/uip-nd6.h"
 #include "net/ipv6/uip-ds6.h"
@@ -85,6 +87,9 @@
 #include "rpl/rpl-private.h"
 #endif
 
+#include "lib/list.h"
+#include "lib/memb.h"
+
 #include <string.h>
 
 /*---------------------------------------------------------------------------*/
@@ -253,6 +258,24 @@ static uint8_t iss[4];
 
 /* Temporary variables. */
 uint8_t uip_acc32[4];
+
+#if UIP_TCP_WINDOW > 1
+/* A copy of a segment in flight, kept for retransmission. */
+struct tcp_rtx {
+  struct tcp_rtx *next;
+  struct uip_conn *conn;
+  uint32_t seqno;
+  uint16_t len;
+  uint8_t data[UIP_TCP_MSS];
+};
+
+MEMB(tcp_rtx_memb, struct tcp_rtx, UIP_TCP_RTX_BUFS);
+/* The segments in flight on all connections, oldest first. */
+LIST(tcp_rtx_list);
+
+/* Set while uip_process() retransmits rather than sends new data. */
+static uint8_t tcp_rexmit;
+#endif /* UIP_TCP_WINDOW > 1 */
 #endif /* UIP_TCP */
 /** @} */
 
@@ -314,45 +337,134 @@ uip_add32(uint8_t *op32, uint16_t op16)
   }
 }
 #endif /* UIP_ARCH_ADD32 */
-#endif /* UIP_TCP */
 
-#if ! UIP_ARCH_CHKSUM
+#if UIP_TCP_WINDOW > 1
 /*---------------------------------------------------------------------------*/
-static uint16_t
-chksum(uint16_t sum, const uint8_t *data, uint16_t len)
+static uint32_t
+get_seqno(const uint8_t *seqno)
+{
+  return ((uint32_t)seqno[0] << 24) | ((uint32_t)seqno[1] << 16) |
+    ((uint32_t)seqno[2] << 8) | seqno[3];
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_seqno(uint8_t *seqno, uint32_t value)
 {
-  uint16_t t;
-  const uint8_t *dataptr;
-  const uint8_t *last_byte;
-
-  dataptr = data;
-  last_byte = data + len - 1;
-
-  while(dataptr < last_byte) {   /* At least two more bytes */
-    t = (dataptr[0] << 8) + dataptr[1];
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
+  seqno[0] = value >> 24;
+  seqno[1] = value >> 16;
+  seqno[2] = value >> 8;
+  seqno[3] = value;
+}
+/*---------------------------------------------------------------------------*/
+static struct tcp_rtx *
+rtx_first(struct uip_conn *conn)
+{
+  struct tcp_rtx *rtx;
+
+  for(rtx = list_head(tcp_rtx_list); rtx != NULL; rtx = list_item_next(rtx)) {
+    if(rtx->conn == conn) {
+      return rtx;
     }
-    dataptr += 2;
   }
-
-  if(dataptr == last_byte) {
-    t = (dataptr[0] << 8) + 0;
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Drop the data below conn->snd_nxt, which has been acknowledged. */
+static void
+rtx_acked(struct uip_conn *conn)
+{
+  struct tcp_rtx *rtx;
+  struct tcp_rtx *next;
+  uint32_t acked;
+
+  for(rtx = list_head(tcp_rtx_list); rtx != NULL; rtx = next) {
+    next = list_item_next(rtx);
+    if(rtx->conn != conn) {
+      continue;
+    }
+    acked = get_seqno(conn->snd_nxt) - rtx->seqno;
+    if((int32_t)acked <= 0) {
+      /* The connection's later segments are not acked either */
+      return;
+    }
+    if(acked < rtx->len) {
+      memmove(rtx->data, &rtx->data[acked], rtx->len - acked);
+      rtx->len -= acked;
+      rtx->seqno += acked;
+      return;
     }
+    list_remove(tcp_rtx_list, rtx);
+    memb_free(&tcp_rtx_memb, rtx);
   }
+}
+/*---------------------------------------------------------------------------*/
+static void
+rtx_free(struct uip_conn *conn)
+{
+  struct tcp_rtx *rtx;
+  struct tcp_rtx *next;
+
+  for(rtx = list_head(tcp_rtx_list); rtx != NULL; rtx = next) {
+    next = list_item_next(rtx);
+    if(rtx->conn == conn) {
+      list_remove(tcp_rtx_list, rtx);
+      memb_free(&tcp_rtx_memb, rtx);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_window_avail(void)
+{
+  struct tcp_rtx *rtx;
+  int segments;
 
-  /* Return sum in host byte order. */
-  return sum;
+  if(!(uip_conn->tcpflags & UIP_TCP_WINDOWED)) {
+    return uip_outstanding(uip_conn) ? 0 : uip_conn->mss;
+  }
+  if(tcp_rexmit || memb_numfree(&tcp_rtx_memb) == 0) {
+    return 0;
+  }
+  if(uip_conn->len == 0) {
+    /* One segment may always be sent, which also probes a zero window */
+    return uip_conn->mss;
+  }
+  /* No new data until the lost segments have been recovered */
+  if((uip_conn->tcpflags & UIP_TCP_RECOVERY) ||
+     uip_conn->len >= uip_conn->snd_wnd) {
+    return 0;
+  }
+  segments = 0;
+  for(rtx = list_head(tcp_rtx_list); rtx != NULL; rtx = list_item_next(rtx)) {
+    if(rtx->conn == uip_conn && ++segments == UIP_TCP_WINDOW) {
+      return 0;
+    }
+  }
+  return MIN(uip_conn->mss, uip_conn->snd_wnd - uip_conn->len);
 }
+#endif /* UIP_TCP_WINDOW > 1 */
+#if UIP_TCP_WINDOW > 1 || UIP_TCP_DELAYED_ACK
+/*---------------------------------------------------------------------------*/
+static void
+init_tcpflags(struct uip_conn *conn)
+{
+#if UIP_TCP_WINDOW > 1
+  /* Segments left over from a connection closed by tcpip.c */
+  rtx_free(conn);
+  conn->snd_wnd = 0;
+  conn->dupacks = 0;
+#endif /* UIP_TCP_WINDOW > 1 */
+  conn->tcpflags = 0;
+}
+#endif /* UIP_TCP_WINDOW > 1 || UIP_TCP_DELAYED_ACK */
+#endif /* UIP_TCP */
+
+#if ! UIP_ARCH_CHKSUM
 /*---------------------------------------------------------------------------*/
 uint16_t
 uip_chksum(uint16_t *data, uint16_t len)
 {
-  return uip_htons(chksum(0, (uint8_t *)data, len));
+  return uip_htons(uip_chksum_add(0, (uint8_t *)data, len));
 }
 /*---------------------------------------------------------------------------*/
 #ifndef UIP_ARCH_IPCHKSUM
@@ -361,7 +473,7 @@ uip_ipchksum(void)
 {
   uint16_t sum;
 
-  sum = chksum(0, &uip_buf[UIP_LLH_LEN], UIP_IPH_LEN);
+  sum = uip_chksum_add(0, &uip_buf[UIP_LLH_LEN], UIP_IPH_LEN);
   PRINTF("uip_ipchksum: sum 0x%04x\n", sum);
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
@@ -391,10 +503,10 @@ upper_layer_chksum(uint8_t proto)
   /* IP protocol and length fields. This addition cannot carry. */
   sum = upper_layer_len + proto;
   /* Sum IP source and destination addresses. */
-  sum = chksum(sum, (uint8_t *)&UIP_IP_BUF->srcipaddr, 2 * sizeof(uip_ipaddr_t));
+  sum = uip_chksum_add(sum, (uint8_t *)&UIP_IP_BUF->srcipaddr, 2 * sizeof(uip_ipaddr_t));
 
   /* Sum TCP header and data. */
-  sum = chksum(sum, &uip_buf[UIP_IPH_LEN + UIP_LLH_LEN + uip_ext_len],
+  sum = uip_chksum_add(sum, &uip_buf[UIP_IPH_LEN + UIP_LLH_LEN + uip_ext_len],
                upper_layer_len);
 
   return (sum == 0) ? 0xffff : uip_htons(sum);
@@ -440,6 +552,10 @@ uip_init(void)
   for(c = 0; c < UIP_CONNS; ++c) {
     uip_conns[c].tcpstateflags = UIP_CLOSED;
   }
+#if UIP_TCP_WINDOW > 1
+  memb_init(&tcp_rtx_memb);
+  list_init(tcp_rtx_list);
+#endif /* UIP_TCP_WINDOW > 1 */
 #endif /* UIP_TCP */
 
 #if UIP_ACTIVE_OPEN || UIP_UDP
@@ -524,6 +640,12 @@ uip_connect(const uip_ipaddr_t *ripaddr, uint16_t rport)
   conn->lport = uip_htons(lastport);
   conn->rport = rport;
   uip_ipaddr_copy(&conn->ripaddr, ripaddr);
+#if UIP_TCP_WINDOW > 1 || UIP_TCP_DELAYED_ACK
+  init_tcpflags(conn);
+#endif /* UIP_TCP_WINDOW > 1 || UIP_TCP_DELAYED_ACK */
+#if UIP_TCP_RCV_WND
+  conn->rcv_wnd = UIP_RECEIVE_WINDOW;
+#endif /* UIP_TCP_RCV_WND */
 
   return conn;
 }
@@ -936,6 +1058,24 @@ ext_hdr_options_process(void)
 }
 
 
+#if UIP_TCP
+/*---------------------------------------------------------------------------*/
+static void
+update_rto(struct uip_conn *conn)
+{
+  signed char m;
+  m = conn->rto - conn->timer;
+  /* This is taken directly from VJs original code in his paper */
+  m = m - (conn->sa >> 3);
+  conn->sa += m;
+  if(m < 0) {
+    m = -m;
+  }
+  m = m - (conn->sv >> 2);
+  conn->sv += m;
+  conn->rto = (conn->sa >> 3) + conn->sv;
+}
+#endif /* UIP_TCP */
 /*---------------------------------------------------------------------------*/
 void
 uip_process(uint8_t flag)
@@ -945,6 +1085,14 @@ uip_process(uint8_t flag)
   uint16_t tmp16;
   uint8_t opt;
   register struct uip_conn *uip_connr = uip_conn;
+#if UIP_TCP_WINDOW > 1
+  uint32_t acked;
+  /* Where the outgoing data segment starts, relative to snd_nxt */
+  uint16_t seqoff = 0;
+  struct tcp_rtx *rtx;
+
+  tcp_rexmit = 0;
+#endif /* UIP_TCP_WINDOW > 1 */
 #endif /* UIP_TCP */
 #if UIP_UDP
   if(flag == UIP_UDP_SEND_CONN) {
@@ -958,8 +1106,14 @@ uip_process(uint8_t flag)
   if(flag == UIP_POLL_REQUEST) {
 #if UIP_TCP
     if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
-       !uip_outstanding(uip_connr)) {
+#if UIP_TCP_WINDOW > 1
+       uip_window_avail() > 0
+#else /* UIP_TCP_WINDOW > 1 */
+       !uip_outstanding(uip_connr)
+#endif /* UIP_TCP_WINDOW > 1 */
+       ) {
       uip_flags = UIP_POLL;
+      uip_slen = 0;
       UIP_APPCALL();
       goto appsend;
 #if UIP_ACTIVE_OPEN
@@ -1012,6 +1166,9 @@ uip_process(uint8_t flag)
                uip_connr->tcpstateflags == UIP_SYN_RCVD) &&
               uip_connr->nrtx == UIP_MAXSYNRTX)) {
             uip_connr->tcpstateflags = UIP_CLOSED;
+#if UIP_TCP_WINDOW > 1
+            rtx_free(uip_connr);
+#endif /* UIP_TCP_WINDOW > 1 */
 
             /*
              * We call UIP_APPCALL() with uip_flags set to
@@ -1054,6 +1211,15 @@ uip_process(uint8_t flag)
 #endif /* UIP_ACTIVE_OPEN */
 
           case UIP_ESTABLISHED:
+#if UIP_TCP_WINDOW > 1
+            if(uip_connr->tcpflags & UIP_TCP_WINDOWED) {
+              /* We keep the segments in flight, so we resend the
+                 first one ourselves. */
+              uip_connr->tcpflags |= UIP_TCP_RECOVERY;
+              uip_connr->dupacks = 0;
+              goto tcp_send_rtx;
+            }
+#endif /* UIP_TCP_WINDOW > 1 */
             /*
              * In the ESTABLISHED state, we call upon the application
              * to do the actual retransmit after which we jump into
@@ -1080,6 +1246,11 @@ uip_process(uint8_t flag)
         UIP_APPCALL();
         goto appsend;
       }
+#if UIP_TCP_DELAYED_ACK
+      if(uip_connr->tcpflags & UIP_TCP_ACK_PENDING) {
+        goto tcp_send_ack;
+      }
+#endif /* UIP_TCP_DELAYED_ACK */
     }
     goto drop;
 #endif /* UIP_TCP */
@@ -1732,6 +1903,12 @@ uip_process(uint8_t flag)
   uip_connr->rport = UIP_TCP_BUF->srcport;
   uip_ipaddr_copy(&uip_connr->ripaddr, &UIP_IP_BUF->srcipaddr);
   uip_connr->tcpstateflags = UIP_SYN_RCVD;
+#if UIP_TCP_WINDOW > 1 || UIP_TCP_DELAYED_ACK
+  init_tcpflags(uip_connr);
+#endif /* UIP_TCP_WINDOW > 1 || UIP_TCP_DELAYED_ACK */
+#if UIP_TCP_RCV_WND
+  uip_connr->rcv_wnd = UIP_RECEIVE_WINDOW;
+#endif /* UIP_TCP_RCV_WND */
 
   uip_connr->snd_nxt[0] = iss[0];
   uip_connr->snd_nxt[1] = iss[1];
@@ -1812,6 +1989,9 @@ uip_process(uint8_t flag)
      before we accept the reset. */
   if(UIP_TCP_BUF->flags & TCP_RST) {
     uip_connr->tcpstateflags = UIP_CLOSED;
+#if UIP_TCP_WINDOW > 1
+    rtx_free(uip_connr);
+#endif /* UIP_TCP_WINDOW > 1 */
     UIP_LOG("tcp: got reset, aborting connection.");
     uip_flags = UIP_ABORT;
     UIP_APPCALL();
@@ -1857,6 +2037,47 @@ uip_process(uint8_t flag)
      data. If so, we update the sequence number, reset the length of
      the outstanding data, calculate RTT estimations, and reset the
      retransmission timer. */
+#if UIP_TCP_WINDOW > 1
+  if((UIP_TCP_BUF->flags & TCP_ACK) && uip_outstanding(uip_connr) &&
+     (uip_connr->tcpflags & UIP_TCP_WINDOWED)) {
+    /* With several segments in flight, the ACK may cover only some of
+       them. We drop the acknowledged data and, if we are recovering
+       from a loss, retransmit the next segment right away. Repeated
+       ACKs for the same data mean that a segment has been lost. */
+    acked = get_seqno(UIP_TCP_BUF->ackno) - get_seqno(uip_connr->snd_nxt);
+    if(acked > 0 && acked <= uip_connr->len) {
+      set_seqno(uip_connr->snd_nxt, get_seqno(uip_connr->snd_nxt) + acked);
+      uip_connr->len -= acked;
+      rtx_acked(uip_connr);
+
+      if(uip_connr->nrtx == 0 &&
+         !(uip_connr->tcpflags & UIP_TCP_RECOVERY)) {
+        update_rto(uip_connr);
+      }
+      uip_flags = UIP_ACKDATA;
+      uip_connr->timer = uip_connr->rto;
+      uip_connr->dupacks = 0;
+      if(uip_connr->len == 0) {
+        uip_connr->tcpflags &= ~UIP_TCP_RECOVERY;
+        uip_connr->nrtx = 0;
+      } else if(uip_connr->tcpflags & UIP_TCP_RECOVERY) {
+        tcp_rexmit = 1;
+      } else {
+        uip_connr->nrtx = 0;
+      }
+    } else if(acked == 0 && uip_len == 0 &&
+              (UIP_TCP_BUF->flags & (TCP_SYN | TCP_FIN)) == 0 &&
+              ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) + UIP_TCP_BUF->wnd[1] ==
+              uip_connr->snd_wnd) {
+      if(++uip_connr->dupacks == UIP_TCP_FAST_RETRANSMIT &&
+         !(uip_connr->tcpflags & UIP_TCP_RECOVERY)) {
+        UIP_STAT(++uip_stat.tcp.rexmit);
+        uip_connr->tcpflags |= UIP_TCP_RECOVERY;
+        tcp_rexmit = 1;
+      }
+    }
+  } else
+#endif /* UIP_TCP_WINDOW > 1 */
   if((UIP_TCP_BUF->flags & TCP_ACK) && uip_outstanding(uip_connr)) {
     uip_add32(uip_connr->snd_nxt, uip_connr->len);
 
@@ -1872,18 +2093,7 @@ uip_process(uint8_t flag)
 
       /* Do RTT estimation, unless we have done retransmissions. */
       if(uip_connr->nrtx == 0) {
-        signed char m;
-        m = uip_connr->rto - uip_connr->timer;
-        /* This is taken directly from VJs original code in his paper */
-        m = m - (uip_connr->sa >> 3);
-        uip_connr->sa += m;
-        if(m < 0) {
-          m = -m;
-        }
-        m = m - (uip_connr->sv >> 2);
-        uip_connr->sv += m;
-        uip_connr->rto = (uip_connr->sa >> 3) + uip_connr->sv;
-
+        update_rto(uip_connr);
       }
       /* Set the acknowledged flag. */
       uip_flags = UIP_ACKDATA;
@@ -1966,6 +2176,10 @@ uip_process(uint8_t flag)
         }
       }
       uip_connr->tcpstateflags = UIP_ESTABLISHED;
+#if UIP_TCP_WINDOW > 1
+      uip_connr->snd_wnd = ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) +
+        UIP_TCP_BUF->wnd[1];
+#endif /* UIP_TCP_WINDOW > 1 */
       uip_connr->rcv_nxt[0] = UIP_TCP_BUF->seqno[0];
       uip_connr->rcv_nxt[1] = UIP_TCP_BUF->seqno[1];
       uip_connr->rcv_nxt[2] = UIP_TCP_BUF->seqno[2];
@@ -1998,6 +2212,19 @@ uip_process(uint8_t flag)
          state. We require that there is no outstanding data; otherwise the
          sequence numbers will be screwed up. */
 
+#if UIP_TCP_RCV_WND
+    /* We do not accept data beyond the window we have advertised, and
+       neither a FIN that follows it. The remote host learns our
+       current window from the ACK. */
+    if(uip_len > uip_connr->rcv_wnd) {
+      uip_len = 0;
+      UIP_TCP_BUF->flags &= ~TCP_FIN;
+      if(!(uip_flags & UIP_ACKDATA)) {
+        goto tcp_send_ack;
+      }
+    }
+#endif /* UIP_TCP_RCV_WND */
+
     if(UIP_TCP_BUF->flags & TCP_FIN && !(uip_connr->tcpstateflags & UIP_STOPPED)) {
       if(uip_outstanding(uip_connr)) {
         goto drop;
@@ -2008,6 +2235,9 @@ uip_process(uint8_t flag)
         uip_flags |= UIP_NEWDATA;
       }
       UIP_APPCALL();
+#if UIP_TCP_WINDOW > 1
+      uip_connr->tcpflags &= ~(UIP_TCP_WINDOWED | UIP_TCP_CLOSE_PENDING);
+#endif /* UIP_TCP_WINDOW > 1 */
       uip_connr->len = 1;
       uip_connr->tcpstateflags = UIP_LAST_ACK;
       uip_connr->nrtx = 0;
@@ -2060,6 +2290,9 @@ uip_process(uint8_t flag)
          "persistent timer" and uses the retransmission mechanim.
      */
     tmp16 = ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) + (uint16_t)UIP_TCP_BUF->wnd[1];
+#if UIP_TCP_WINDOW > 1
+    uip_connr->snd_wnd = tmp16;
+#endif /* UIP_TCP_WINDOW > 1 */
     if(tmp16 > uip_connr->initialmss ||
         tmp16 == 0) {
       tmp16 = uip_connr->initialmss;
@@ -2091,11 +2324,32 @@ uip_process(uint8_t flag)
       if(uip_flags & UIP_ABORT) {
         uip_slen = 0;
         uip_connr->tcpstateflags = UIP_CLOSED;
+#if UIP_TCP_WINDOW > 1
+        rtx_free(uip_connr);
+#endif /* UIP_TCP_WINDOW > 1 */
         UIP_TCP_BUF->flags = TCP_RST | TCP_ACK;
         goto tcp_send_nodata;
       }
 
+#if UIP_TCP_WINDOW > 1
+      if(uip_connr->tcpflags & UIP_TCP_WINDOWED) {
+        /* The FIN must follow all data in flight, so we wait until
+           everything has been acknowledged before closing. */
+        if(uip_connr->tcpflags & UIP_TCP_CLOSE_PENDING) {
+          uip_flags |= UIP_CLOSE;
+        }
+        if((uip_flags & UIP_CLOSE) && uip_outstanding(uip_connr)) {
+          uip_connr->tcpflags |= UIP_TCP_CLOSE_PENDING;
+          uip_flags &= ~UIP_CLOSE;
+          uip_slen = 0;
+        }
+      }
+#endif /* UIP_TCP_WINDOW > 1 */
+
       if(uip_flags & UIP_CLOSE) {
+#if UIP_TCP_WINDOW > 1
+        uip_connr->tcpflags &= ~(UIP_TCP_WINDOWED | UIP_TCP_CLOSE_PENDING);
+#endif /* UIP_TCP_WINDOW > 1 */
         uip_slen = 0;
         uip_connr->len = 1;
         uip_connr->tcpstateflags = UIP_FIN_WAIT_1;
@@ -2104,6 +2358,35 @@ uip_process(uint8_t flag)
         goto tcp_send_nodata;
       }
 
+#if UIP_TCP_WINDOW > 1
+      if(uip_connr->tcpflags & UIP_TCP_WINDOWED) {
+        /* New data goes after the data in flight, and we keep a copy
+           of it until it has been acknowledged. */
+        tmp16 = uip_window_avail();
+        if(uip_slen > tmp16) {
+          uip_slen = tmp16;
+        }
+        if(uip_slen > 0) {
+          rtx = memb_alloc(&tcp_rtx_memb);
+          rtx->conn = uip_connr;
+          rtx->seqno = get_seqno(uip_connr->snd_nxt) + uip_connr->len;
+          rtx->len = uip_slen;
+          memcpy(rtx->data, uip_sappdata, uip_slen);
+          list_add(tcp_rtx_list, rtx);
+
+          if(uip_connr->len == 0) {
+            uip_connr->timer = uip_connr->rto;
+          }
+          seqoff = uip_connr->len;
+          uip_connr->len += uip_slen;
+
+          /* Keep the window full by asking the application for more */
+          if(uip_window_avail() > 0) {
+            tcpip_poll_tcp(uip_connr);
+          }
+        }
+      } else
+#endif /* UIP_TCP_WINDOW > 1 */
       /* If uip_slen > 0, the application has data to be sent. */
       if(uip_slen > 0) {
 
@@ -2136,20 +2419,51 @@ uip_process(uint8_t flag)
           uip_slen = uip_connr->len;
         }
       }
+#if UIP_TCP_WINDOW > 1
+      /* With a window, nrtx is reset by the ACKs */
+      if(!(uip_connr->tcpflags & UIP_TCP_WINDOWED)) {
+        uip_connr->nrtx = 0;
+      }
+#else /* UIP_TCP_WINDOW > 1 */
       uip_connr->nrtx = 0;
+#endif /* UIP_TCP_WINDOW > 1 */
       apprexmit:
       uip_appdata = uip_sappdata;
 
+#if UIP_TCP_WINDOW > 1
+      if(tcp_rexmit) {
+        goto tcp_send_rtx;
+      }
+#endif /* UIP_TCP_WINDOW > 1 */
+
       /* If the application has data to be sent, or if the incoming
            packet had new data in it, we must send out a packet. */
       if(uip_slen > 0 && uip_connr->len > 0) {
         /* Add the length of the IP and TCP headers. */
+#if UIP_TCP_WINDOW > 1
+        if(uip_connr->tcpflags & UIP_TCP_WINDOWED) {
+          uip_len = uip_slen + UIP_TCPIP_HLEN;
+        } else
+#endif /* UIP_TCP_WINDOW > 1 */
         uip_len = uip_connr->len + UIP_TCPIP_HLEN;
         /* We always set the ACK flag in response packets. */
         UIP_TCP_BUF->flags = TCP_ACK | TCP_PSH;
         /* Send the packet. */
         goto tcp_send_noopts;
       }
+#if UIP_TCP_DELAYED_ACK
+      /* Acknowledge every second segment right away, and leave a
+           single one to the periodic timer. Window updates from
+           uip_restart() carry no data and are sent at once. */
+      if((uip_flags & UIP_NEWDATA) && uip_len > 0 &&
+         !(uip_connr->tcpflags & UIP_TCP_ACK_PENDING)) {
+        uip_connr->tcpflags |= UIP_TCP_ACK_PENDING;
+        goto drop;
+      }
+      if(uip_connr->tcpflags & UIP_TCP_ACK_PENDING) {
+        uip_flags |= UIP_NEWDATA;
+      }
+#endif /* UIP_TCP_DELAYED_ACK */
       /* If there is no data to send, just send out a pure ACK if
            there is newdata. */
       if(uip_flags & UIP_NEWDATA) {
@@ -2158,7 +2472,26 @@ uip_process(uint8_t flag)
         goto tcp_send_noopts;
       }
     }
+#if UIP_TCP_WINDOW > 1
+    if(tcp_rexmit) {
+      goto tcp_send_rtx;
+    }
+#endif /* UIP_TCP_WINDOW > 1 */
     goto drop;
+#if UIP_TCP_WINDOW > 1
+    tcp_send_rtx:
+    /* Resend the first segment in flight, which starts at snd_nxt. */
+    rtx = rtx_first(uip_connr);
+    if(rtx == NULL) {
+      goto drop;
+    }
+    UIP_STAT(++uip_stat.tcp.rexmit);
+    memcpy(&uip_buf[UIP_LLH_LEN + UIP_TCPIP_HLEN], rtx->data, rtx->len);
+    uip_len = rtx->len + UIP_TCPIP_HLEN;
+    seqoff = rtx->seqno - get_seqno(uip_connr->snd_nxt);
+    UIP_TCP_BUF->flags = TCP_ACK | TCP_PSH;
+    goto tcp_send_noopts;
+#endif /* UIP_TCP_WINDOW > 1 */
   case UIP_LAST_ACK:
     /* We can close this connection if the peer has acknowledged our
          FIN. This is indicated by the UIP_ACKDATA flag. */
@@ -2249,10 +2582,25 @@ uip_process(uint8_t flag)
   UIP_TCP_BUF->ackno[2] = uip_connr->rcv_nxt[2];
   UIP_TCP_BUF->ackno[3] = uip_connr->rcv_nxt[3];
 
-  UIP_TCP_BUF->seqno[0] = uip_connr->snd_nxt[0];
-  UIP_TCP_BUF->seqno[1] = uip_connr->snd_nxt[1];
-  UIP_TCP_BUF->seqno[2] = uip_connr->snd_nxt[2];
-  UIP_TCP_BUF->seqno[3] = uip_connr->snd_nxt[3];
+#if UIP_TCP_WINDOW > 1
+  if(uip_connr->tcpflags & UIP_TCP_WINDOWED) {
+    /* Segments without data carry the next new sequence number. */
+    if(uip_len == UIP_TCPIP_HLEN) {
+      seqoff = uip_connr->len;
+    }
+    set_seqno(UIP_TCP_BUF->seqno, get_seqno(uip_connr->snd_nxt) + seqoff);
+  } else
+#endif /* UIP_TCP_WINDOW > 1 */
+  {
+    UIP_TCP_BUF->seqno[0] = uip_connr->snd_nxt[0];
+    UIP_TCP_BUF->seqno[1] = uip_connr->snd_nxt[1];
+    UIP_TCP_BUF->seqno[2] = uip_connr->snd_nxt[2];
+    UIP_TCP_BUF->seqno[3] = uip_connr->snd_nxt[3];
+  }
+#if UIP_TCP_DELAYED_ACK
+  /* Every segment we send acknowledges the data received so far. */
+  uip_connr->tcpflags &= ~UIP_TCP_ACK_PENDING;
+#endif /* UIP_TCP_DELAYED_ACK */
 
   UIP_TCP_BUF->srcport  = uip_connr->lport;
   UIP_TCP_BUF->destport = uip_connr->rport;
@@ -2270,8 +2618,13 @@ uip_process(uint8_t flag)
        window so that the remote host will stop sending data. */
     UIP_TCP_BUF->wnd[0] = UIP_TCP_BUF->wnd[1] = 0;
   } else {
+#if UIP_TCP_RCV_WND
+    UIP_TCP_BUF->wnd[0] = uip_connr->rcv_wnd >> 8;
+    UIP_TCP_BUF->wnd[1] = uip_connr->rcv_wnd & 0xff;
+#else /* UIP_TCP_RCV_WND */
     UIP_TCP_BUF->wnd[0] = ((UIP_RECEIVE_WINDOW) >> 8);
     UIP_TCP_BUF->wnd[1] = ((UIP_RECEIVE_WINDOW) & 0xff);
+#endif /* UIP_TCP_RCV_WND */
   }
 
   tcp_send_noconn:
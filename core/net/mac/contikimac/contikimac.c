@@ -905,15 +905,22 @@ qsend_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
 
     if(ret == MAC_TX_OK) {
       if(next != NULL) {
+#if RDC_WITH_BURST
+        /* We're in a burst, no need to wake the receiver up again,
+           unless the frame was secured as the last one of an earlier
+           list and told the receiver to go back to sleep */
+        is_receiver_awake = pending;
+#else /* RDC_WITH_BURST */
         /* We're in a burst, no need to wake the receiver up again */
         is_receiver_awake = 1;
+#endif /* RDC_WITH_BURST */
         curr = next;
       }
     } else {
       /* The transmission failed, we stop the burst */
       next = NULL;
     }
-  } while((next != NULL) && pending);
+  } while((next != NULL) && (pending || RDC_WITH_BURST));
 }
 /*---------------------------------------------------------------------------*/
 /* Timer callback triggered when receiving a burst, after having
@@ -93,11 +93,37 @@
 #define CSMA_MAX_MAX_FRAME_RETRIES 7
 #endif
 
+/* Serve the neighbors that are ready to transmit in deficit round-robin
+   order, instead of in the order in which their backoff timers expire. */
+#ifdef CSMA_CONF_WITH_DRR
+#define CSMA_WITH_DRR CSMA_CONF_WITH_DRR
+#else
+#define CSMA_WITH_DRR 0
+#endif
+
+/* The number of bytes a neighbor may send in each round. A neighbor may
+   send all its queued packets at once, so the deficit can become
+   negative, and is then made up for in the following rounds. */
+#ifdef CSMA_CONF_DRR_QUANTUM
+#define CSMA_DRR_QUANTUM CSMA_CONF_DRR_QUANTUM
+#else
+#define CSMA_DRR_QUANTUM PACKETBUF_SIZE
+#endif
+
+/* Traffic classification, based on the attributes set by sicslowpan,
+   which hold the upper-layer protocol behind any extension headers */
+#define NETWORK_ID_ICMP6    58
+#define ICMP6_ECHO_REQUEST  128
+#define ICMP6_ECHO_REPLY    129
+
 /* Packet metadata */
 struct qbuf_metadata {
   mac_callback_t sent;
   void *cptr;
   uint8_t max_transmissions;
+#if CSMA_WITH_TRAFFIC_CLASSES
+  uint8_t traffic_class;
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
 };
 
 /* Every neighbor has its own packet queue */
@@ -107,6 +133,11 @@ struct neighbor_queue {
   struct ctimer transmit_timer;
   uint8_t transmissions;
   uint8_t collisions;
+#if CSMA_WITH_DRR
+  struct neighbor_queue *ready_next;
+  int16_t deficit;
+  uint8_t ready;
+#endif /* CSMA_WITH_DRR */
   LIST_STRUCT(queued_packet_list);
 };
 
@@ -130,6 +161,36 @@ MEMB(packet_memb, struct rdc_buf_list, MAX_QUEUED_PACKETS);
 MEMB(metadata_memb, struct qbuf_metadata, MAX_QUEUED_PACKETS);
 LIST(neighbor_list);
 
+#if CSMA_STATS
+struct csma_stats csma_stats;
+#define STATS_ADD(x) csma_stats.x++
+#else /* CSMA_STATS */
+#define STATS_ADD(x)
+#endif /* CSMA_STATS */
+
+#if CSMA_WITH_TRAFFIC_CLASSES
+/* The neighbor whose queue is being handed to the RDC layer. Its queue
+   must not be modified by the drop policy. */
+static struct neighbor_queue *sending_neighbor;
+
+/* The senders of dropped data packets are notified from a timer, so
+   that the notification does not appear as the result of sending the
+   control packet that replaced them. */
+#define MAX_EVICTED 4
+static struct {
+  mac_callback_t sent;
+  void *cptr;
+} evicted[MAX_EVICTED];
+static uint8_t evicted_count;
+static struct ctimer evicted_timer;
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
+
+#if CSMA_WITH_DRR
+/* Neighbors whose backoff has expired, in the order they got ready */
+static struct neighbor_queue *ready_head, *ready_tail;
+static struct ctimer dispatch_timer;
+#endif /* CSMA_WITH_DRR */
+
 static void packet_sent(void *ptr, int status, int num_transmissions);
 static void transmit_packet_list(void *ptr);
 /*---------------------------------------------------------------------------*/
@@ -173,12 +234,148 @@ transmit_packet_list(void *ptr)
       PRINTF("csma: preparing number %d %p, queue len %d\n", n->transmissions, q,
           list_length(n->queued_packet_list));
       /* Send packets in the neighbor's list */
+#if CSMA_WITH_TRAFFIC_CLASSES
+      sending_neighbor = n;
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
       NETSTACK_RDC.send_list(packet_sent, n, q);
+#if CSMA_WITH_TRAFFIC_CLASSES
+      sending_neighbor = NULL;
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if CSMA_WITH_TRAFFIC_CLASSES
+static uint8_t
+packet_class(void)
+{
+  uint8_t icmp_type;
+
+#if PACKETBUF_WITH_PACKET_TYPE
+  if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
+     PACKETBUF_ATTR_PACKET_TYPE_ACK) {
+    return CSMA_CLASS_CONTROL;
+  }
+#endif
+
+  /* All ICMPv6 messages except echo requests and replies */
+  if(packetbuf_attr(PACKETBUF_ATTR_NETWORK_ID) == NETWORK_ID_ICMP6) {
+    icmp_type = packetbuf_attr(PACKETBUF_ATTR_CHANNEL) >> 8;
+    if(icmp_type != ICMP6_ECHO_REQUEST && icmp_type != ICMP6_ECHO_REPLY) {
+      return CSMA_CLASS_CONTROL;
+    }
+  }
+  return CSMA_CLASS_DATA;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+queued_class(struct rdc_buf_list *q)
+{
+  return ((struct qbuf_metadata *)q->ptr)->traffic_class;
+}
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
+/*---------------------------------------------------------------------------*/
+#if CSMA_WITH_DRR
+static void
+remove_ready(struct neighbor_queue *n)
+{
+  struct neighbor_queue *prev;
+
+  if(!n->ready) {
+    return;
+  }
+  n->ready = 0;
+
+  if(ready_head == n) {
+    ready_head = n->ready_next;
+    prev = NULL;
+  } else {
+    for(prev = ready_head; prev->ready_next != n; prev = prev->ready_next);
+    prev->ready_next = n->ready_next;
+  }
+  if(ready_tail == n) {
+    ready_tail = prev;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct neighbor_queue *
+next_ready(void)
+{
+  struct neighbor_queue *n;
+
+#if CSMA_WITH_TRAFFIC_CLASSES
+  /* Control packets go first, regardless of the deficits */
+  for(n = ready_head; n != NULL; n = n->ready_next) {
+    if(queued_class(list_head(n->queued_packet_list)) == CSMA_CLASS_CONTROL) {
+      return n;
+    }
+  }
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
+
+  /* Visit the neighbors in turn, adding a quantum to the deficit of each,
+     until one of them has a positive deficit. */
+  while(1) {
+    n = ready_head;
+    if(n->deficit <= 0) {
+      n->deficit += CSMA_DRR_QUANTUM;
+    }
+    if(n->deficit > 0) {
+      return n;
+    }
+    if(n->ready_next != NULL) {
+      ready_head = n->ready_next;
+      ready_tail->ready_next = n;
+      ready_tail = n;
+      n->ready_next = NULL;
     }
   }
 }
 /*---------------------------------------------------------------------------*/
 static void
+dispatch(void *ptr)
+{
+  struct neighbor_queue *n;
+
+  if(ready_head == NULL) {
+    return;
+  }
+
+  n = next_ready();
+  remove_ready(n);
+  transmit_packet_list(n);
+
+  /* Let other processes run before serving the next neighbor. */
+  if(ready_head != NULL) {
+    ctimer_set(&dispatch_timer, 0, dispatch, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+neighbor_ready(void *ptr)
+{
+  struct neighbor_queue *n = ptr;
+
+  if(n->ready) {
+    return;
+  }
+  n->ready = 1;
+  n->ready_next = NULL;
+  if(ready_tail != NULL) {
+    ready_tail->ready_next = n;
+  } else {
+    ready_head = n;
+  }
+  ready_tail = n;
+
+  /* The dispatch is deferred, so that all neighbors whose backoff expires
+     at the same time compete for the channel. */
+  if(ctimer_expired(&dispatch_timer)) {
+    ctimer_set(&dispatch_timer, 0, dispatch, NULL);
+  }
+}
+#endif /* CSMA_WITH_DRR */
+/*---------------------------------------------------------------------------*/
+static void
 schedule_transmission(struct neighbor_queue *n)
 {
   clock_time_t delay;
@@ -195,7 +392,12 @@ schedule_transmission(struct neighbor_queue *n)
 
   PRINTF("csma: scheduling transmission in %u ticks, NB=%u, BE=%u\n",
       (unsigned)delay, n->collisions, backoff_exponent);
+#if CSMA_WITH_DRR
+  remove_ready(n);
+  ctimer_set(&n->transmit_timer, delay, neighbor_ready, n);
+#else /* CSMA_WITH_DRR */
   ctimer_set(&n->transmit_timer, delay, transmit_packet_list, n);
+#endif /* CSMA_WITH_DRR */
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -219,6 +421,9 @@ free_packet(struct neighbor_queue *n, struct rdc_buf_list *p, int status)
     } else {
       /* This was the last packet in the queue, we free the neighbor */
       ctimer_stop(&n->transmit_timer);
+#if CSMA_WITH_DRR
+      remove_ready(n);
+#endif /* CSMA_WITH_DRR */
       list_remove(neighbor_list, n);
       memb_free(&neighbor_memb, n);
     }
@@ -342,6 +547,13 @@ packet_sent(void *ptr, int status, int num_transmissions)
     return;
   }
 
+#if CSMA_WITH_DRR
+  if(status != MAC_TX_DEFERRED) {
+    /* Charge the neighbor for the use of the channel */
+    n->deficit -= queuebuf_datalen(q->buf);
+  }
+#endif /* CSMA_WITH_DRR */
+
   switch(status) {
   case MAC_TX_OK:
     tx_ok(q, n, num_transmissions);
@@ -360,6 +572,90 @@ packet_sent(void *ptr, int status, int num_transmissions)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if CSMA_WITH_TRAFFIC_CLASSES
+static struct rdc_buf_list *
+last_data_packet(struct neighbor_queue *n)
+{
+  struct rdc_buf_list *q, *last;
+
+  last = NULL;
+  for(q = list_head(n->queued_packet_list); q != NULL; q = list_item_next(q)) {
+    if(queued_class(q) == CSMA_CLASS_DATA) {
+      last = q;
+    }
+  }
+  return last;
+}
+/*---------------------------------------------------------------------------*/
+static void
+notify_evicted(void *ptr)
+{
+  int i;
+
+  for(i = 0; i < evicted_count; i++) {
+    mac_call_sent_callback(evicted[i].sent, evicted[i].cptr, MAC_TX_ERR, 1);
+  }
+  evicted_count = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Drops the most recently queued data packet of the given neighbor, or
+   of the neighbor with the longest queue if none is given, provided that
+   the queue is longer than min_len. Returns 1 if a packet was dropped. */
+static int
+evict_data_packet(struct neighbor_queue *preferred, int min_len)
+{
+  struct neighbor_queue *n, *victim;
+  struct rdc_buf_list *q, *victim_packet;
+  struct qbuf_metadata *metadata;
+  int len, max_len;
+
+  if(evicted_count == MAX_EVICTED) {
+    return 0;
+  }
+
+  victim = NULL;
+  victim_packet = NULL;
+  max_len = min_len;
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    if(n == sending_neighbor || (preferred != NULL && n != preferred)) {
+      continue;
+    }
+    q = last_data_packet(n);
+    len = list_length(n->queued_packet_list);
+    if(q != NULL && len > max_len) {
+      victim = n;
+      victim_packet = q;
+      max_len = len;
+    }
+  }
+
+  if(victim == NULL) {
+    return 0;
+  }
+
+  PRINTF("csma: dropping a data packet to make room for another packet\n");
+  STATS_ADD(evicted);
+
+  metadata = (struct qbuf_metadata *)victim_packet->ptr;
+  evicted[evicted_count].sent = metadata->sent;
+  evicted[evicted_count].cptr = metadata->cptr;
+  if(evicted_count++ == 0) {
+    ctimer_set(&evicted_timer, 0, notify_evicted, NULL);
+  }
+
+  if(victim_packet == list_head(victim->queued_packet_list)) {
+    /* Also schedules the next packet or frees the neighbor */
+    free_packet(victim, victim_packet, MAC_TX_ERR);
+  } else {
+    list_remove(victim->queued_packet_list, victim_packet);
+    queuebuf_free(victim_packet->buf);
+    memb_free(&metadata_memb, victim_packet->ptr);
+    memb_free(&packet_memb, victim_packet);
+  }
+  return 1;
+}
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
+/*---------------------------------------------------------------------------*/
 static void
 send_packet(mac_callback_t sent, void *ptr)
 {
@@ -368,6 +664,10 @@ send_packet(mac_callback_t sent, void *ptr)
   static uint8_t initialized = 0;
   static uint16_t seqno;
   const linkaddr_t *addr = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+#if CSMA_WITH_TRAFFIC_CLASSES
+  uint8_t traffic_class;
+  int len;
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
 
   if(!initialized) {
     initialized = 1;
@@ -382,6 +682,29 @@ send_packet(mac_callback_t sent, void *ptr)
   }
   packetbuf_set_attr(PACKETBUF_ATTR_MAC_SEQNO, seqno++);
 
+#if CSMA_WITH_TRAFFIC_CLASSES
+  /*
+   * If the packet does not fit, a queued data packet is dropped instead
+   * if the packet is a control packet, or if it is a data packet and
+   * another neighbor has a longer queue, so that the neighbors get a
+   * fair share of the buffers. This is done before the neighbor lookup
+   * below, since it may free the neighbor.
+   */
+  traffic_class = packet_class();
+  n = neighbor_queue_from_addr(addr);
+  len = n != NULL ? list_length(n->queued_packet_list) : 0;
+  if(len >= CSMA_MAX_PACKET_PER_NEIGHBOR) {
+    if(traffic_class == CSMA_CLASS_CONTROL) {
+      evict_data_packet(n, 0);
+    }
+  } else if(memb_numfree(&packet_memb) == 0 ||
+            memb_numfree(&metadata_memb) == 0 ||
+            queuebuf_numfree() == 0) {
+    evict_data_packet(NULL,
+                      traffic_class == CSMA_CLASS_CONTROL ? 0 : len + 1);
+  }
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
+
   /* Look for the neighbor entry */
   n = neighbor_queue_from_addr(addr);
   if(n == NULL) {
@@ -392,6 +715,10 @@ send_packet(mac_callback_t sent, void *ptr)
       linkaddr_copy(&n->addr, addr);
       n->transmissions = 0;
       n->collisions = CSMA_MIN_BE;
+#if CSMA_WITH_DRR
+      n->ready = 0;
+      n->deficit = 0;
+#endif /* CSMA_WITH_DRR */
       /* Init packet list for this neighbor */
       LIST_STRUCT_INIT(n, queued_packet_list);
       /* Add neighbor to the list */
@@ -425,9 +752,35 @@ send_packet(mac_callback_t sent, void *ptr)
               list_push(n->queued_packet_list, q);
             } else
 #endif
+#if CSMA_WITH_TRAFFIC_CLASSES
+            if(traffic_class == CSMA_CLASS_CONTROL &&
+               list_head(n->queued_packet_list) != NULL) {
+              /* Queue behind the first packet, which may be in transmission,
+                 and the control packets that are already queued. */
+              struct rdc_buf_list *prev = list_head(n->queued_packet_list);
+              while(list_item_next(prev) != NULL &&
+                    queued_class(list_item_next(prev)) == CSMA_CLASS_CONTROL) {
+                prev = list_item_next(prev);
+              }
+              list_insert(n->queued_packet_list, prev, q);
+            } else
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
             {
               list_add(n->queued_packet_list, q);
             }
+#if CSMA_WITH_TRAFFIC_CLASSES
+            metadata->traffic_class = traffic_class;
+            STATS_ADD(queued[traffic_class]);
+#else /* CSMA_WITH_TRAFFIC_CLASSES */
+            STATS_ADD(queued[CSMA_CLASS_DATA]);
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
+#if CSMA_STATS
+            if(MAX_QUEUED_PACKETS - memb_numfree(&packet_memb) >
+               csma_stats.max_queued) {
+              csma_stats.max_queued =
+                MAX_QUEUED_PACKETS - memb_numfree(&packet_memb);
+            }
+#endif /* CSMA_STATS */
 
             PRINTF("csma: send_packet, queue length %d, free packets %d\n",
                    list_length(n->queued_packet_list), memb_numfree(&packet_memb));
@@ -455,6 +808,11 @@ send_packet(mac_callback_t sent, void *ptr)
   } else {
     PRINTF("csma: could not allocate neighbor, dropping packet\n");
   }
+#if CSMA_WITH_TRAFFIC_CLASSES
+  STATS_ADD(dropped[traffic_class]);
+#else /* CSMA_WITH_TRAFFIC_CLASSES */
+  STATS_ADD(dropped[CSMA_CLASS_DATA]);
+#endif /* CSMA_WITH_TRAFFIC_CLASSES */
   mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 1);
 }
 /*---------------------------------------------------------------------------*/
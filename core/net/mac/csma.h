@@ -44,6 +44,42 @@
 #include "net/mac/mac.h"
 #include "dev/radio.h"
 
+/* Separate control traffic (RPL, ND) from data traffic. Control
+   packets are queued ahead of data packets and may replace queued data
+   packets when the queues are full. */
+#ifdef CSMA_CONF_WITH_TRAFFIC_CLASSES
+#define CSMA_WITH_TRAFFIC_CLASSES CSMA_CONF_WITH_TRAFFIC_CLASSES
+#else
+#define CSMA_WITH_TRAFFIC_CLASSES 0
+#endif
+
+/* Traffic classes, used with CSMA_WITH_TRAFFIC_CLASSES */
+#define CSMA_CLASS_DATA     0
+#define CSMA_CLASS_CONTROL  1
+#define CSMA_CLASS_NUM      2
+
+#ifdef CSMA_CONF_STATS
+#define CSMA_STATS CSMA_CONF_STATS
+#else
+#define CSMA_STATS 0
+#endif
+
+/* Queue statistics, indexed by traffic class */
+struct csma_stats {
+  /* Packets added to a neighbor queue */
+  uint16_t queued[CSMA_CLASS_NUM];
+  /* Packets dropped because they could not be queued */
+  uint16_t dropped[CSMA_CLASS_NUM];
+  /* Queued data packets dropped to make room for other packets */
+  uint16_t evicted;
+  /* The largest number of packets queued at once */
+  uint8_t max_queued;
+};
+
+#if CSMA_STATS
+extern struct csma_stats csma_stats;
+#endif
+
 extern const struct mac_driver csma_driver;
 
 const struct mac_driver *csma_init(const struct mac_driver *r);
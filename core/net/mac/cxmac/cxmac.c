@@ -216,6 +216,12 @@ static linkaddr_t is_streaming_to, is_streaming_to_too;
 static rtimer_clock_t stream_until;
 #define DEFAULT_STREAM_TIME (RTIMER_ARCH_SECOND)
 
+/* Set while sending a burst, after a frame with the pending bit set
+   was acknowledged by burst_to: the receiver is still awake, so the
+   next frame to it does not need to be strobed. */
+static uint8_t burst_pending;
+static linkaddr_t burst_to;
+
 /*---------------------------------------------------------------------------*/
 static void
 on(void)
@@ -422,6 +428,7 @@ send_packet(void)
   struct encounter *e;
   struct queuebuf *packet;
   int is_already_streaming = 0;
+  int is_burst = 0;
   uint8_t collisions;
 
 
@@ -490,6 +497,11 @@ send_packet(void)
   }
 #endif /* WITH_STREAMING */
 
+  if(!is_broadcast && burst_pending &&
+     linkaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), &burst_to)) {
+    is_burst = 1;
+  }
+
   off();
 
 #if WITH_ENCOUNTER_OPTIMIZATION
@@ -545,7 +557,7 @@ send_packet(void)
   /* Turn on the radio to listen for the strobe ACK. */
   on();
   collisions = 0;
-  if(!is_already_streaming) {
+  if(!is_already_streaming && !is_burst) {
     watchdog_stop();
     got_strobe_ack = 0;
     t = RTIMER_NOW();
@@ -643,10 +655,18 @@ send_packet(void)
   queuebuf_free(packet);
 
   /* Send the data packet. */
-  if((is_broadcast || got_strobe_ack || is_streaming) && collisions == 0) {
+  if((is_broadcast || got_strobe_ack || is_streaming || is_burst) &&
+     collisions == 0) {
     NETSTACK_RADIO.send(packetbuf_hdrptr(), packetbuf_totlen());
   }
 
+  /* The receiver stays awake after a frame with the pending bit set */
+  burst_pending = (got_strobe_ack || is_burst) && collisions == 0 &&
+    packetbuf_attr(PACKETBUF_ATTR_PENDING);
+  if(burst_pending) {
+    linkaddr_copy(&burst_to, packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+  }
+
 #if WITH_ENCOUNTER_OPTIMIZATION
   if(got_strobe_ack && !is_streaming) {
     register_encounter(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), encounter_time);
@@ -676,7 +696,7 @@ send_packet(void)
 
   LEDS_OFF(LEDS_BLUE);
   if(collisions == 0) {
-    if(!is_broadcast && !got_strobe_ack) {
+    if(!is_broadcast && !got_strobe_ack && !is_burst) {
       return MAC_TX_NOACK;
     } else {
       return MAC_TX_OK;
@@ -688,11 +708,11 @@ send_packet(void)
 
 }
 /*---------------------------------------------------------------------------*/
-static void
-qsend_packet(mac_callback_t sent, void *ptr)
+static int
+qsend_one_packet(mac_callback_t sent, void *ptr)
 {
   int ret;
-  if(someone_is_sending) {
+  if(someone_is_sending && !burst_pending) {
     PRINTF("cxmac: should queue packet, now just dropping %d %d %d %d.\n",
 	   waiting_for_packet, someone_is_sending, we_are_sending, radio_is_on);
     RIMESTATS_ADD(sendingdrop);
@@ -703,15 +723,33 @@ qsend_packet(mac_callback_t sent, void *ptr)
   }
 
   mac_call_sent_callback(sent, ptr, ret, 1);
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+static void
+qsend_packet(mac_callback_t sent, void *ptr)
+{
+  packetbuf_set_attr(PACKETBUF_ATTR_PENDING, 0);
+  qsend_one_packet(sent, ptr);
 }
 /*---------------------------------------------------------------------------*/
 static void
 qsend_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
 {
-  if(buf_list != NULL) {
+  while(buf_list != NULL) {
+    /* We backup the next pointer, as it may be nullified by
+     * mac_call_sent_callback() */
+    struct rdc_buf_list *next = buf_list->next;
+
     queuebuf_to_packetbuf(buf_list->buf);
-    qsend_packet(sent, ptr);
+    packetbuf_set_attr(PACKETBUF_ATTR_PENDING, RDC_WITH_BURST &&
+                       next != NULL && !packetbuf_holds_broadcast());
+    if(qsend_one_packet(sent, ptr) != MAC_TX_OK || !RDC_WITH_BURST) {
+      break;
+    }
+    buf_list = next;
   }
+  burst_pending = 0;
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -731,9 +769,15 @@ input_packet(void)
 	/* This is a regular packet that is destined to us or to the
 	   broadcast address. */
 
-	/* We have received the final packet, so we can go back to being
-	   asleep. */
-	off();
+	if(packetbuf_attr(PACKETBUF_ATTR_PENDING)) {
+	  /* The sender has more frames for us: stay awake for them. The
+	     power cycle turns the radio off if they do not arrive. */
+	  on();
+	} else {
+	  /* We have received the final packet, so we can go back to being
+	     asleep. */
+	  off();
+	}
 
 #if CXMAC_CONF_COMPOWER
 	/* Accumulate the power consumption for the packet reception. */
@@ -749,7 +793,7 @@ input_packet(void)
 	compower_clear(&current_packet);
 #endif /* CXMAC_CONF_COMPOWER */
 
-	waiting_for_packet = 0;
+	waiting_for_packet = packetbuf_attr(PACKETBUF_ATTR_PENDING) ? 1 : 0;
 
         PRINTDEBUG("cxmac: data(%u)\n", packetbuf_datalen());
 	NETSTACK_MAC.input();
@@ -44,8 +44,8 @@
 #include <string.h>
 
 /*---------------------------------------------------------------------------*/
-static void
-send_packet(mac_callback_t sent, void *ptr)
+static int
+send_one_packet(mac_callback_t sent, void *ptr)
 {
   int ret;
   if(NETSTACK_RADIO.send(packetbuf_hdrptr(), packetbuf_totlen()) == RADIO_TX_OK) {
@@ -54,14 +54,28 @@ send_packet(mac_callback_t sent, void *ptr)
     ret =  MAC_TX_ERR;
   }
   mac_call_sent_callback(sent, ptr, ret, 1);
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  send_one_packet(sent, ptr);
 }
 /*---------------------------------------------------------------------------*/
 static void
 send_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
 {
-  if(buf_list != NULL) {
+  while(buf_list != NULL) {
+    /* We backup the next pointer, as it may be nullified by
+     * mac_call_sent_callback() */
+    struct rdc_buf_list *next = buf_list->next;
+
     queuebuf_to_packetbuf(buf_list->buf);
-    send_packet(sent, ptr);
+    if(send_one_packet(sent, ptr) != MAC_TX_OK || !RDC_WITH_BURST) {
+      return;
+    }
+    buf_list = next;
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -250,6 +250,12 @@ send_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
     int last_sent_ok;
 
     queuebuf_to_packetbuf(buf_list->buf);
+#if RDC_WITH_BURST
+    /* Tell the receiver whether more frames follow. The attribute is
+       set on every attempt, as a frame that was last in an earlier list
+       may be followed by others now. */
+    packetbuf_set_attr(PACKETBUF_ATTR_PENDING, next != NULL);
+#endif /* RDC_WITH_BURST */
     last_sent_ok = send_one_packet(sent, ptr);
 
     /* If packet transmission was not successful, we should back off and let
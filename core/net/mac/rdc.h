@@ -55,6 +55,18 @@
 #define RDC_WITH_DUPLICATE_DETECTION !LLSEC802154_ENABLED
 #endif /* RDC_CONF_WITH_DUPLICATE_DETECTION */
 
+#ifdef RDC_CONF_WITH_BURST
+#define RDC_WITH_BURST RDC_CONF_WITH_BURST
+#else /* RDC_CONF_WITH_BURST */
+/* When sending a list of frames to the same neighbor, send them
+   back-to-back while the neighbor is awake, with the frame pending
+   bit set in all but the last one. When disabled, each driver keeps
+   its own behavior: nullrdc sends the list without the pending bit,
+   contikimac uses its own bursts and the others send the first frame
+   only, leaving the next one to the MAC layer. */
+#define RDC_WITH_BURST 0
+#endif /* RDC_CONF_WITH_BURST */
+
 /* List of packets to be sent by RDC layer */
 struct rdc_buf_list {
   struct rdc_buf_list *next;
@@ -74,7 +86,8 @@ struct rdc_driver {
   /** Send a packet from the Rime buffer  */
   void (* send)(mac_callback_t sent_callback, void *ptr);
 
-  /** Send a packet list */
+  /** Send a list of packets to the same neighbor, as a burst if
+      RDC_WITH_BURST is set. Stops at the first failed transmission. */
   void (* send_list)(mac_callback_t sent_callback, void *ptr, struct rdc_buf_list *list);
 
   /** Callback for getting notified of incoming packet. */
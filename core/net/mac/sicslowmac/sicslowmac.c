@@ -93,11 +93,12 @@ is_broadcast_addr(uint8_t mode, uint8_t *addr)
   return 1;
 }
 /*---------------------------------------------------------------------------*/
-static void
-send_packet(mac_callback_t sent, void *ptr)
+static int
+send_one_packet(mac_callback_t sent, void *ptr)
 {
   frame802154_t params;
   uint8_t len;
+  int ret = MAC_TX_ERR;
 
   /* init to zeros */
   memset(&params, 0, sizeof(params));
@@ -105,7 +106,7 @@ send_packet(mac_callback_t sent, void *ptr)
   /* Build the FCF. */
   params.fcf.frame_type = FRAME802154_DATAFRAME;
   params.fcf.security_enabled = 0;
-  params.fcf.frame_pending = 0;
+  params.fcf.frame_pending = packetbuf_attr(PACKETBUF_ATTR_PENDING);
 #if NETSTACK_CONF_WITH_RIME
   params.fcf.ack_required = packetbuf_attr(PACKETBUF_ATTR_RELIABLE);
 #endif
@@ -154,16 +155,19 @@ send_packet(mac_callback_t sent, void *ptr)
   params.payload_len = packetbuf_datalen();
   len = frame802154_hdrlen(&params);
   if(packetbuf_hdralloc(len)) {
-    int ret;
+    int radio_ret;
     frame802154_create(&params, packetbuf_hdrptr());
 
     PRINTF("6MAC-UT: %2X", params.fcf.frame_type);
     PRINTADDR(params.dest_addr);
     PRINTF("%u %u (%u)\n", len, packetbuf_datalen(), packetbuf_totlen());
 
-    ret = NETSTACK_RADIO.send(packetbuf_hdrptr(), packetbuf_totlen());
+    radio_ret = NETSTACK_RADIO.send(packetbuf_hdrptr(), packetbuf_totlen());
+    if(radio_ret == RADIO_TX_OK) {
+      ret = MAC_TX_OK;
+    }
     if(sent) {
-      switch(ret) {
+      switch(radio_ret) {
       case RADIO_TX_OK:
         sent(ptr, MAC_TX_OK, 1);
         break;
@@ -175,14 +179,31 @@ send_packet(mac_callback_t sent, void *ptr)
   } else {
     PRINTF("6MAC-UT: too large header: %u\n", len);
   }
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  packetbuf_set_attr(PACKETBUF_ATTR_PENDING, 0);
+  send_one_packet(sent, ptr);
 }
 /*---------------------------------------------------------------------------*/
 void
 send_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
 {
-  if(buf_list != NULL) {
+  while(buf_list != NULL) {
+    /* We backup the next pointer, as it may be nullified by
+     * mac_call_sent_callback() */
+    struct rdc_buf_list *next = buf_list->next;
+
     queuebuf_to_packetbuf(buf_list->buf);
-    send_packet(sent, ptr);
+    packetbuf_set_attr(PACKETBUF_ATTR_PENDING,
+                       RDC_WITH_BURST && next != NULL);
+    if(send_one_packet(sent, ptr) != MAC_TX_OK || !RDC_WITH_BURST) {
+      return;
+    }
+    buf_list = next;
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -68,15 +68,149 @@
 #error TSCH_QUEUE_NUM_PER_NEIGHBOR must be power of two
 #endif
 
+/* The signal ringbuf holds each unicast neighbor at most once. Its size
+ * must be a power of two, and it holds one element less than its size */
+#if TSCH_QUEUE_MAX_NEIGHBOR_QUEUES < 8
+#define SIGNAL_RINGBUF_SIZE 8
+#elif TSCH_QUEUE_MAX_NEIGHBOR_QUEUES < 16
+#define SIGNAL_RINGBUF_SIZE 16
+#elif TSCH_QUEUE_MAX_NEIGHBOR_QUEUES < 32
+#define SIGNAL_RINGBUF_SIZE 32
+#elif TSCH_QUEUE_MAX_NEIGHBOR_QUEUES < 64
+#define SIGNAL_RINGBUF_SIZE 64
+#elif TSCH_QUEUE_MAX_NEIGHBOR_QUEUES < 128
+#define SIGNAL_RINGBUF_SIZE 128
+#else
+#error TSCH_QUEUE_MAX_NEIGHBOR_QUEUES must be less than 128
+#endif
+
+/* Number of buckets of the neighbor address hash. Must be power of two */
+#define NBR_HASH_SIZE 8
+#define NOT_IN_SET 0xff
+
 /* We have as many packets are there are queuebuf in the system */
 MEMB(packet_memb, struct tsch_packet, QUEUEBUF_NUM);
 MEMB(neighbor_memb, struct tsch_neighbor, TSCH_QUEUE_MAX_NEIGHBOR_QUEUES);
 LIST(neighbor_list);
 
+/* Neighbors by address hash */
+static struct tsch_neighbor *nbr_hash[NBR_HASH_SIZE];
+
+/* Unicast neighbors that have no Tx link, a non-empty queue and an expired
+ * backoff, i.e. that may send over any shared link. Only modified from the
+ * slot operation or with the lock held. Neighbors that are no longer ready
+ * are removed lazily, when tsch_queue_get_unicast_packet_for_any() finds
+ * them. Neighbors that become ready outside of the slot operation, e.g. when
+ * a packet is added, are signaled through a lockfree ringbuf, with the same
+ * implementation as the packet queues. */
+static struct tsch_neighbor *ready_array[TSCH_QUEUE_MAX_NEIGHBOR_QUEUES];
+static uint8_t ready_count;
+static struct tsch_neighbor *signal_array[SIGNAL_RINGBUF_SIZE];
+static struct ringbufindex signal_ringbuf;
+
+/* Neighbors with a non-zero backoff window. Only modified from the slot
+ * operation or with the lock held. */
+static struct tsch_neighbor *backoff_array[TSCH_QUEUE_MAX_NEIGHBOR_QUEUES];
+static uint8_t backoff_count;
+
 /* Broadcast and EB virtual neighbors */
 struct tsch_neighbor *n_broadcast;
 struct tsch_neighbor *n_eb;
 
+#if TSCH_QUEUE_STATS
+struct tsch_queue_stats tsch_queue_stats;
+#endif /* TSCH_QUEUE_STATS */
+
+/*---------------------------------------------------------------------------*/
+static uint8_t
+nbr_hash_index(const linkaddr_t *addr)
+{
+  uint8_t h = 0;
+  int i;
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    h ^= addr->u8[i];
+  }
+  return h & (NBR_HASH_SIZE - 1);
+}
+/*---------------------------------------------------------------------------*/
+/* The ready and backoff sets are stored as arrays, with each neighbor
+ * holding its position. On removal, the last neighbor of the array takes
+ * the position of the removed one. */
+static void
+ready_add(struct tsch_neighbor *n)
+{
+  if(n->ready_index == NOT_IN_SET) {
+    n->ready_index = ready_count;
+    ready_array[ready_count++] = n;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+ready_remove(struct tsch_neighbor *n)
+{
+  if(n->ready_index != NOT_IN_SET) {
+    struct tsch_neighbor *last = ready_array[--ready_count];
+    ready_array[n->ready_index] = last;
+    last->ready_index = n->ready_index;
+    n->ready_index = NOT_IN_SET;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+backoff_add(struct tsch_neighbor *n)
+{
+  if(n->backoff_index == NOT_IN_SET) {
+    n->backoff_index = backoff_count;
+    backoff_array[backoff_count++] = n;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+backoff_remove(struct tsch_neighbor *n)
+{
+  if(n->backoff_index != NOT_IN_SET) {
+    struct tsch_neighbor *last = backoff_array[--backoff_count];
+    backoff_array[n->backoff_index] = last;
+    last->backoff_index = n->backoff_index;
+    n->backoff_index = NOT_IN_SET;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* May the neighbor send its next packet over any shared link? */
+static int
+is_ready(const struct tsch_neighbor *n)
+{
+  return !n->is_broadcast && n->tx_links_count == 0 && n->backoff_window == 0
+         && !ringbufindex_empty(&n->tx_ringbuf);
+}
+/*---------------------------------------------------------------------------*/
+/* Adds or removes a neighbor from the ready set. Only call from the slot
+ * operation or with the lock held */
+static void
+update_ready(struct tsch_neighbor *n)
+{
+  if(is_ready(n)) {
+    ready_add(n);
+  } else {
+    ready_remove(n);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Processes the neighbors signaled from outside of the slot operation */
+static void
+process_signaled_nbrs(void)
+{
+  int16_t get_index;
+  while((get_index = ringbufindex_peek_get(&signal_ringbuf)) != -1) {
+    struct tsch_neighbor *n = signal_array[get_index];
+    ringbufindex_get(&signal_ringbuf);
+    /* Clear the flag before looking at the queue, so that a packet added
+     * meanwhile results in a new signal */
+    n->ready_signaled = 0;
+    update_ready(n);
+  }
+}
+
 /*---------------------------------------------------------------------------*/
 /* Add a TSCH neighbor */
 struct tsch_neighbor *
@@ -96,9 +230,13 @@ tsch_queue_add_nbr(const linkaddr_t *addr)
         linkaddr_copy(&n->addr, addr);
         n->is_broadcast = linkaddr_cmp(addr, &tsch_eb_address)
           || linkaddr_cmp(addr, &tsch_broadcast_address);
+        n->ready_index = NOT_IN_SET;
+        n->backoff_index = NOT_IN_SET;
         tsch_queue_backoff_reset(n);
-        /* Add neighbor to the list */
+        /* Add neighbor to the list and to the hash */
         list_add(neighbor_list, n);
+        n->hash_next = nbr_hash[nbr_hash_index(addr)];
+        nbr_hash[nbr_hash_index(addr)] = n;
       }
       tsch_release_lock();
     }
@@ -111,12 +249,12 @@ struct tsch_neighbor *
 tsch_queue_get_nbr(const linkaddr_t *addr)
 {
   if(!tsch_is_locked()) {
-    struct tsch_neighbor *n = list_head(neighbor_list);
+    struct tsch_neighbor *n = nbr_hash[nbr_hash_index(addr)];
     while(n != NULL) {
       if(linkaddr_cmp(&n->addr, addr)) {
         return n;
       }
-      n = list_item_next(n);
+      n = n->hash_next;
     }
   }
   return NULL;
@@ -204,10 +342,25 @@ tsch_queue_remove_nbr(struct tsch_neighbor *n)
 {
   if(n != NULL) {
     if(tsch_get_lock()) {
+      struct tsch_neighbor **prev;
 
       /* Remove neighbor from list */
       list_remove(neighbor_list, n);
 
+      /* Remove neighbor from the hash */
+      prev = &nbr_hash[nbr_hash_index(&n->addr)];
+      while(*prev != NULL && *prev != n) {
+        prev = &(*prev)->hash_next;
+      }
+      if(*prev != NULL) {
+        *prev = n->hash_next;
+      }
+
+      /* Make sure the neighbor is no longer referenced by any set */
+      process_signaled_nbrs();
+      ready_remove(n);
+      backoff_remove(n);
+
       tsch_release_lock();
 
       /* Flush queue */
@@ -243,9 +396,14 @@ tsch_queue_add_packet(const linkaddr_t *addr, mac_callback_t sent, void *ptr)
             p->ptr = ptr;
             p->ret = MAC_TX_DEFERRED;
             p->transmissions = 0;
+#if TSCH_QUEUE_STATS
+            p->enqueue_asn = current_asn;
+#endif /* TSCH_QUEUE_STATS */
             /* Add to ringbuf (actual add committed through atomic operation) */
             n->tx_array[put_index] = p;
             ringbufindex_put(&n->tx_ringbuf);
+            /* The neighbor may now be ready to send over shared links */
+            tsch_queue_signal_nbr(n);
             return p;
           } else {
             memb_free(&packet_memb, p);
@@ -281,6 +439,14 @@ tsch_queue_remove_packet_from_queue(struct tsch_neighbor *n)
       /* Get and remove packet from ringbuf (remove committed through an atomic operation */
       int16_t get_index = ringbufindex_get(&n->tx_ringbuf);
       if(get_index != -1) {
+#if TSCH_QUEUE_STATS
+        uint32_t wait_slots = ASN_DIFF(current_asn, n->tx_array[get_index]->enqueue_asn);
+        tsch_queue_stats.dequeued++;
+        tsch_queue_stats.wait_slots += wait_slots;
+        if(wait_slots > tsch_queue_stats.wait_slots_max) {
+          tsch_queue_stats.wait_slots_max = wait_slots;
+        }
+#endif /* TSCH_QUEUE_STATS */
         return n->tx_array[get_index];
       } else {
         return NULL;
@@ -311,8 +477,14 @@ tsch_queue_reset(void)
       struct tsch_neighbor *next_n = list_item_next(n);
       /* Flush queue */
       tsch_queue_flush_nbr_queue(n);
-      /* Reset backoff exponent */
-      tsch_queue_backoff_reset(n);
+      /* Reset backoff exponent. The slot operation also updates the
+         ready and backoff sets, so this is done under the lock. */
+      if(tsch_get_lock()) {
+        tsch_queue_backoff_reset(n);
+        tsch_release_lock();
+      } else {
+        PRINTF("TSCH-queue:! reset couldn't take lock, backoff not reset\n");
+      }
       n = next_n;
     }
   }
@@ -389,25 +561,52 @@ struct tsch_packet *
 tsch_queue_get_unicast_packet_for_any(struct tsch_neighbor **n, struct tsch_link *link)
 {
   if(!tsch_is_locked()) {
-    struct tsch_neighbor *curr_nbr = list_head(neighbor_list);
-    struct tsch_packet *p = NULL;
-    while(curr_nbr != NULL) {
-      if(!curr_nbr->is_broadcast && curr_nbr->tx_links_count == 0) {
-        /* Only look up for non-broadcast neighbors we do not have a tx link to */
-        p = tsch_queue_get_packet_for_nbr(curr_nbr, link);
+    uint8_t i = 0;
+#if TSCH_QUEUE_STATS
+    tsch_queue_stats.shared_lookups++;
+#endif /* TSCH_QUEUE_STATS */
+    process_signaled_nbrs();
+    /* Only look up for non-broadcast neighbors we do not have a tx link to,
+     * with a packet and an expired backoff */
+    while(i < ready_count) {
+      struct tsch_neighbor *curr_nbr = ready_array[i];
+      if(!is_ready(curr_nbr)) {
+        /* The last neighbor takes its position */
+        ready_remove(curr_nbr);
+      } else {
+        struct tsch_packet *p = tsch_queue_get_packet_for_nbr(curr_nbr, link);
         if(p != NULL) {
+#if TSCH_QUEUE_STATS
+          tsch_queue_stats.shared_lookups_found++;
+#endif /* TSCH_QUEUE_STATS */
           if(n != NULL) {
             *n = curr_nbr;
           }
           return p;
         }
+        i++;
       }
-      curr_nbr = list_item_next(curr_nbr);
     }
   }
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+/* Signals that a neighbor may have become ready to transmit over shared
+ * links, from outside of the slot operation */
+void
+tsch_queue_signal_nbr(struct tsch_neighbor *n)
+{
+  if(n != NULL && !n->is_broadcast && !n->ready_signaled) {
+    int16_t put_index = ringbufindex_peek_put(&signal_ringbuf);
+    /* The ringbuf holds every neighbor once, so it cannot be full */
+    if(put_index != -1) {
+      n->ready_signaled = 1;
+      signal_array[put_index] = n;
+      ringbufindex_put(&signal_ringbuf);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
 /* May the neighbor transmit over a shared link? */
 int
 tsch_queue_backoff_expired(const struct tsch_neighbor *n)
@@ -421,6 +620,8 @@ tsch_queue_backoff_reset(struct tsch_neighbor *n)
 {
   n->backoff_window = 0;
   n->backoff_exponent = TSCH_MAC_MIN_BE;
+  backoff_remove(n);
+  update_ready(n);
 }
 /*---------------------------------------------------------------------------*/
 /* Increment backoff exponent, pick a new window */
@@ -436,6 +637,8 @@ tsch_queue_backoff_inc(struct tsch_neighbor *n)
   /* Add one to the window as we will decrement it at the end of the current slot
    * through tsch_queue_update_all_backoff_windows */
   n->backoff_window++;
+  backoff_add(n);
+  update_ready(n);
 }
 /*---------------------------------------------------------------------------*/
 /* Decrement backoff window for all queues directed at dest_addr */
@@ -444,14 +647,21 @@ tsch_queue_update_all_backoff_windows(const linkaddr_t *dest_addr)
 {
   if(!tsch_is_locked()) {
     int is_broadcast = linkaddr_cmp(dest_addr, &tsch_broadcast_address);
-    struct tsch_neighbor *n = list_head(neighbor_list);
-    while(n != NULL) {
-      if(n->backoff_window != 0 /* Is the queue in backoff state? */
-         && ((n->tx_links_count == 0 && is_broadcast)
-             || (n->tx_links_count > 0 && linkaddr_cmp(dest_addr, &n->addr)))) {
+    uint8_t i = 0;
+    /* Only look at queues in backoff state */
+    while(i < backoff_count) {
+      struct tsch_neighbor *n = backoff_array[i];
+      if((n->tx_links_count == 0 && is_broadcast)
+         || (n->tx_links_count > 0 && linkaddr_cmp(dest_addr, &n->addr))) {
         n->backoff_window--;
+        if(n->backoff_window == 0) {
+          /* The last neighbor takes its position */
+          backoff_remove(n);
+          update_ready(n);
+          continue;
+        }
       }
-      n = list_item_next(n);
+      i++;
     }
   }
 }
@@ -463,6 +673,10 @@ tsch_queue_init(void)
   list_init(neighbor_list);
   memb_init(&neighbor_memb);
   memb_init(&packet_memb);
+  memset(nbr_hash, 0, sizeof(nbr_hash));
+  ready_count = 0;
+  backoff_count = 0;
+  ringbufindex_init(&signal_ringbuf, SIGNAL_RINGBUF_SIZE);
   /* Add virtual EB and the broadcast neighbors */
   n_eb = tsch_queue_add_nbr(&tsch_eb_address);
   n_broadcast = tsch_queue_add_nbr(&tsch_broadcast_address);
@@ -38,6 +38,7 @@
 #include "contiki.h"
 #include "lib/ringbufindex.h"
 #include "net/linkaddr.h"
+#include "net/mac/tsch/tsch-asn.h"
 #include "net/mac/tsch/tsch-schedule.h"
 #include "net/mac/mac.h"
 
@@ -77,6 +78,13 @@
 #define TSCH_QUEUE_MAX_NEIGHBOR_QUEUES ((NBR_TABLE_CONF_MAX_NEIGHBORS) + 2)
 #endif
 
+/* Keep statistics on slot utilization and queue wait times */
+#ifdef TSCH_QUEUE_CONF_STATS
+#define TSCH_QUEUE_STATS TSCH_QUEUE_CONF_STATS
+#else
+#define TSCH_QUEUE_STATS 0
+#endif
+
 /* TSCH CSMA-CA parameters, see IEEE 802.15.4e-2012 */
 /* Min backoff exponent */
 #ifdef TSCH_CONF_MAC_MIN_BE
@@ -121,6 +129,9 @@ struct tsch_packet {
   uint8_t ret; /* status -- MAC return code */
   uint8_t header_len; /* length of header and header IEs (needed for link-layer security) */
   uint8_t tsch_sync_ie_offset; /* Offset within the frame used for quick update of EB ASN and join priority */
+#if TSCH_QUEUE_STATS
+  struct asn_t enqueue_asn; /* ASN at which the packet was added to the queue */
+#endif
 };
 
 /* TSCH neighbor information */
@@ -135,6 +146,10 @@ struct tsch_neighbor {
   uint8_t last_backoff_window; /* Last CSMA backoff window */
   uint8_t tx_links_count; /* How many links do we have to this neighbor? */
   uint8_t dedicated_tx_links_count; /* How many dedicated links do we have to this neighbor? */
+  struct tsch_neighbor *hash_next; /* Next neighbor with the same address hash */
+  uint8_t ready_index; /* Position in the set of neighbors ready for shared links */
+  uint8_t backoff_index; /* Position in the set of neighbors in backoff */
+  uint8_t ready_signaled; /* Was the neighbor signaled to the slot operation? */
   /* Array for the ringbuf. Contains pointers to packets.
    * Its size must be a power of two to allow for atomic put */
   struct tsch_packet *tx_array[TSCH_QUEUE_NUM_PER_NEIGHBOR];
@@ -142,12 +157,32 @@ struct tsch_neighbor {
   struct ringbufindex tx_ringbuf;
 };
 
+#if TSCH_QUEUE_STATS
+struct tsch_queue_stats {
+  /* Tx slots, and Tx slots in which a packet was sent */
+  uint32_t tx_slots;
+  uint32_t tx_slots_used;
+  /* Shared slots in which a unicast packet was looked for, and found */
+  uint32_t shared_lookups;
+  uint32_t shared_lookups_found;
+  /* Packets removed from the queues, and the slots they waited in total
+   * and at most */
+  uint32_t dequeued;
+  uint32_t wait_slots;
+  uint32_t wait_slots_max;
+};
+#endif /* TSCH_QUEUE_STATS */
+
 /***** External Variables *****/
 
 /* Broadcast and EB virtual neighbors */
 extern struct tsch_neighbor *n_broadcast;
 extern struct tsch_neighbor *n_eb;
 
+#if TSCH_QUEUE_STATS
+extern struct tsch_queue_stats tsch_queue_stats;
+#endif /* TSCH_QUEUE_STATS */
+
 /********** Functions *********/
 
 /* Add a TSCH neighbor */
@@ -180,6 +215,9 @@ struct tsch_packet *tsch_queue_get_packet_for_dest_addr(const linkaddr_t *addr,
 /* Returns the head packet of any neighbor queue with zero backoff counter.
  * Writes pointer to the neighbor in *n */
 struct tsch_packet *tsch_queue_get_unicast_packet_for_any(struct tsch_neighbor **n, struct tsch_link *link);
+/* Signals that a neighbor may have become ready to transmit over shared
+ * links, from outside of the slot operation */
+void tsch_queue_signal_nbr(struct tsch_neighbor *n);
 /* May the neighbor transmit over a share link? */
 int tsch_queue_backoff_expired(const struct tsch_neighbor *n);
 /* Reset neighbor backoff */
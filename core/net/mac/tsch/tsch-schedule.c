@@ -69,6 +69,72 @@ MEMB(slotframe_memb, struct tsch_slotframe, TSCH_SCHEDULE_MAX_SLOTFRAMES);
 /* List of slotframes (each slotframe holds its own list of links) */
 LIST(slotframe_list);
 
+#if TSCH_SCHEDULE_WITH_LINK_INDEX
+/* All links, sorted by slotframe handle then timeslot */
+static struct tsch_link *link_index[TSCH_SCHEDULE_MAX_LINKS];
+static uint16_t link_index_count;
+
+/* Returns the position of the first link at or after a given slotframe
+ * handle and timeslot */
+static uint16_t
+link_index_lookup(uint16_t slotframe_handle, uint16_t timeslot)
+{
+  uint16_t lo = 0;
+  uint16_t hi = link_index_count;
+  while(lo < hi) {
+    uint16_t mid = (lo + hi) / 2;
+    struct tsch_link *l = link_index[mid];
+    if(l->slotframe_handle < slotframe_handle
+       || (l->slotframe_handle == slotframe_handle && l->timeslot < timeslot)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+/*---------------------------------------------------------------------------*/
+static void
+link_index_add(struct tsch_link *l)
+{
+  uint16_t i = link_index_lookup(l->slotframe_handle, l->timeslot);
+  memmove(&link_index[i + 1], &link_index[i],
+          (link_index_count - i) * sizeof(link_index[0]));
+  link_index[i] = l;
+  link_index_count++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+link_index_remove(struct tsch_link *l)
+{
+  uint16_t i = link_index_lookup(l->slotframe_handle, l->timeslot);
+  while(i < link_index_count && link_index[i] != l) {
+    i++;
+  }
+  if(i < link_index_count) {
+    link_index_count--;
+    memmove(&link_index[i], &link_index[i + 1],
+            (link_index_count - i) * sizeof(link_index[0]));
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the first link of a slotframe after a given timeslot, wrapping
+ * around at the end of the slotframe */
+static struct tsch_link *
+link_index_next(struct tsch_slotframe *sf, uint16_t timeslot)
+{
+  uint16_t i = link_index_lookup(sf->handle, timeslot + 1);
+  if(i == link_index_count || link_index[i]->slotframe_handle != sf->handle) {
+    i = link_index_lookup(sf->handle, 0);
+  }
+  if(i < link_index_count && link_index[i]->slotframe_handle == sf->handle) {
+    return link_index[i];
+  }
+  return NULL;
+}
+#endif /* TSCH_SCHEDULE_WITH_LINK_INDEX */
+/*---------------------------------------------------------------------------*/
+
 /* Adds and returns a slotframe (NULL if failure) */
 struct tsch_slotframe *
 tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
@@ -209,6 +275,9 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
           address = &linkaddr_null;
         }
         linkaddr_copy(&l->addr, address);
+#if TSCH_SCHEDULE_WITH_LINK_INDEX
+        link_index_add(l);
+#endif /* TSCH_SCHEDULE_WITH_LINK_INDEX */
 
         PRINTF("TSCH-schedule: add_link %u %u %u %u %u %u\n",
                slotframe->handle, link_options, link_type, timeslot, channel_offset, TSCH_LOG_ID_FROM_LINKADDR(address));
@@ -256,6 +325,9 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
              TSCH_LOG_ID_FROM_LINKADDR(&l->addr));
 
       list_remove(slotframe->links_list, l);
+#if TSCH_SCHEDULE_WITH_LINK_INDEX
+      link_index_remove(l);
+#endif /* TSCH_SCHEDULE_WITH_LINK_INDEX */
       memb_free(&link_memb, l);
 
       /* Release the lock before we update the neighbor (will take the lock) */
@@ -269,6 +341,8 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
           if(!(link_options & LINK_OPTION_SHARED)) {
             n->dedicated_tx_links_count--;
           }
+          /* Without Tx links, the neighbor may send over any shared link */
+          tsch_queue_signal_nbr(n);
         }
       }
 
@@ -325,7 +399,13 @@ tsch_schedule_get_next_active_link(struct asn_t *asn, uint16_t *time_offset,
     while(sf != NULL) {
       /* Get timeslot from ASN, given the slotframe length */
       uint16_t timeslot = ASN_MOD(*asn, sf->size);
+#if TSCH_SCHEDULE_WITH_LINK_INDEX
+      /* There is max one link per timeslot, so only the next link of the
+       * slotframe can be the earliest occurring one */
+      struct tsch_link *l = link_index_next(sf, timeslot);
+#else /* TSCH_SCHEDULE_WITH_LINK_INDEX */
       struct tsch_link *l = list_head(sf->links_list);
+#endif /* TSCH_SCHEDULE_WITH_LINK_INDEX */
       while(l != NULL) {
         uint16_t time_to_timeslot =
           l->timeslot > timeslot ?
@@ -369,7 +449,11 @@ tsch_schedule_get_next_active_link(struct asn_t *asn, uint16_t *time_offset,
           }
         }
 
+#if TSCH_SCHEDULE_WITH_LINK_INDEX
+        l = NULL;
+#else /* TSCH_SCHEDULE_WITH_LINK_INDEX */
         l = list_item_next(l);
+#endif /* TSCH_SCHEDULE_WITH_LINK_INDEX */
       }
       sf = list_item_next(sf);
     }
@@ -391,6 +475,9 @@ tsch_schedule_init(void)
     memb_init(&link_memb);
     memb_init(&slotframe_memb);
     list_init(slotframe_list);
+#if TSCH_SCHEDULE_WITH_LINK_INDEX
+    link_index_count = 0;
+#endif /* TSCH_SCHEDULE_WITH_LINK_INDEX */
     tsch_release_lock();
     return 1;
   } else {
@@ -72,6 +72,15 @@
 #define TSCH_SCHEDULE_MAX_LINKS 32
 #endif
 
+/* Keep the links of all slotframes in an array sorted by timeslot, so that
+ * the next active link is found with a binary search per slotframe rather
+ * than by walking all links at every slot */
+#ifdef TSCH_SCHEDULE_CONF_WITH_LINK_INDEX
+#define TSCH_SCHEDULE_WITH_LINK_INDEX TSCH_SCHEDULE_CONF_WITH_LINK_INDEX
+#else
+#define TSCH_SCHEDULE_WITH_LINK_INDEX 1
+#endif
+
 /********** Constants *********/
 
 /* Link options */
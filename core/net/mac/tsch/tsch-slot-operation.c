@@ -340,6 +340,15 @@ get_packet_and_neighbor_for_link(struct tsch_link *link, struct tsch_neighbor **
     *target_neighbor = n;
   }
 
+#if TSCH_QUEUE_STATS
+  if(link->link_options & LINK_OPTION_TX) {
+    tsch_queue_stats.tx_slots++;
+    if(p != NULL) {
+      tsch_queue_stats.tx_slots_used++;
+    }
+  }
+#endif /* TSCH_QUEUE_STATS */
+
   return p;
 }
 /*---------------------------------------------------------------------------*/
@@ -498,7 +507,8 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       static uint8_t cca_status;
 #endif
 
-      /* get payload */
+      /* get payload. TSCH does not share its queuebufs, so this does not
+         copy the packet */
       packet = queuebuf_dataptr(current_packet->qb);
       packet_len = queuebuf_datalen(current_packet->qb);
       /* is this a broadcast packet? (wait for ack?) */
@@ -687,7 +697,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
     log->tx.datalen = queuebuf_datalen(current_packet->qb);
     log->tx.drift = drift_correction;
     log->tx.drift_used = is_drift_correction_used;
-    log->tx.is_data = ((((uint8_t *)(queuebuf_dataptr(current_packet->qb)))[0]) & 7) == FRAME802154_DATAFRAME;
+    log->tx.is_data = ((((const uint8_t *)(queuebuf_dataptr_const(current_packet->qb)))[0]) & 7) == FRAME802154_DATAFRAME;
 #if LLSEC802154_ENABLED
     log->tx.sec_level = queuebuf_attr(current_packet->qb, PACKETBUF_ATTR_SECURITY_LEVEL);
 #else /* LLSEC802154_ENABLED */
@@ -346,19 +346,23 @@ tsch_rx_process_pending()
 
     if(is_data) {
       /* Skip EBs and other control messages */
-      /* Copy to packetbuf for processing */
-      packetbuf_copyfrom(current_input->payload, current_input->len);
+      /* Process in place: the slot is only released once the
+       * upper layers are done with the packet */
+      packetbuf_reference(current_input->payload, current_input->len);
       packetbuf_set_attr(PACKETBUF_ATTR_RSSI, current_input->rssi);
       packetbuf_set_attr(PACKETBUF_ATTR_CHANNEL, current_input->channel);
+      /* Pass to upper layers */
+      packet_input();
+      /* Make sure the packetbuf no longer refers to the slot */
+      if(packetbuf_is_reference()) {
+        packetbuf_clear();
+      }
     }
 
     /* Remove input from ringbuf */
     ringbufindex_get(&input_ringbuf);
 
-    if(is_data) {
-      /* Pass to upper layers */
-      packet_input();
-    } else if(is_eb) {
+    if(is_eb) {
       eb_input(current_input);
     }
   }
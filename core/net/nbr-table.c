@@ -83,6 +83,37 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_WITH_HASH_INDEX
+/* Open-addressing hash index over the keys, with linear probing. The
+ * number of slots is a power of two, at least twice the number of
+ * neighbors. A slot holds the neighbor index plus one, 0 if empty. */
+#if NBR_TABLE_MAX_NEIGHBORS <= 8
+#define HASH_SLOTS 16
+#elif NBR_TABLE_MAX_NEIGHBORS <= 16
+#define HASH_SLOTS 32
+#elif NBR_TABLE_MAX_NEIGHBORS <= 32
+#define HASH_SLOTS 64
+#elif NBR_TABLE_MAX_NEIGHBORS <= 64
+#define HASH_SLOTS 128
+#elif NBR_TABLE_MAX_NEIGHBORS <= 128
+#define HASH_SLOTS 256
+#elif NBR_TABLE_MAX_NEIGHBORS <= 256
+#define HASH_SLOTS 512
+#elif NBR_TABLE_MAX_NEIGHBORS <= 512
+#define HASH_SLOTS 1024
+#elif NBR_TABLE_MAX_NEIGHBORS <= 1024
+#define HASH_SLOTS 2048
+#else
+#error "NBR_TABLE_WITH_HASH_INDEX: NBR_TABLE_MAX_NEIGHBORS too large"
+#endif
+#if NBR_TABLE_MAX_NEIGHBORS < 255
+typedef uint8_t hash_slot_t;
+#else
+typedef uint16_t hash_slot_t;
+#endif
+static hash_slot_t hash_slots[HASH_SLOTS];
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -125,17 +156,95 @@ key_from_item(nbr_table_t *table, const nbr_table_item_t *item)
 {
   return key_from_index(index_from_item(table, item));
 }
+#if NBR_TABLE_WITH_HASH_INDEX
+/*---------------------------------------------------------------------------*/
+/* Get the home slot of a link-layer address */
+static unsigned
+hash_from_lladdr(const linkaddr_t *lladdr)
+{
+  unsigned hash = 0;
+  int i;
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    hash = hash * 31 + lladdr->u8[i];
+  }
+  return (hash ^ (hash >> 7)) & (HASH_SLOTS - 1);
+}
+/*---------------------------------------------------------------------------*/
+/* Find a neighbor index in the hash index */
+static int
+hash_find(const linkaddr_t *lladdr)
+{
+  unsigned slot = hash_from_lladdr(lladdr);
+  while(hash_slots[slot] != 0) {
+    if(linkaddr_cmp(lladdr, &key_from_index(hash_slots[slot] - 1)->lladdr)) {
+      return hash_slots[slot] - 1;
+    }
+    slot = (slot + 1) & (HASH_SLOTS - 1);
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+/* Add a neighbor to the hash index, using its current link-layer address */
+static void
+hash_insert(int index)
+{
+  unsigned slot = hash_from_lladdr(&key_from_index(index)->lladdr);
+  while(hash_slots[slot] != 0) {
+    slot = (slot + 1) & (HASH_SLOTS - 1);
+  }
+  hash_slots[slot] = index + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a neighbor from the hash index. Must be called before the
+ * link-layer address of the key is modified. */
+static void
+hash_remove(int index)
+{
+  unsigned slot = hash_from_lladdr(&key_from_index(index)->lladdr);
+  unsigned next;
+  unsigned home;
+
+  while(hash_slots[slot] != index + 1) {
+    if(hash_slots[slot] == 0) {
+      return;
+    }
+    slot = (slot + 1) & (HASH_SLOTS - 1);
+  }
+
+  /* Shift back the following entries of the probe sequence, so that
+   * lookups never need tombstones */
+  next = slot;
+  while(1) {
+    next = (next + 1) & (HASH_SLOTS - 1);
+    if(hash_slots[next] == 0) {
+      break;
+    }
+    home = hash_from_lladdr(&key_from_index(hash_slots[next] - 1)->lladdr);
+    /* Move the entry unless its home slot lies cyclically in (slot, next] */
+    if(((next - home) & (HASH_SLOTS - 1)) >= ((next - slot) & (HASH_SLOTS - 1))) {
+      hash_slots[slot] = hash_slots[next];
+      slot = next;
+    }
+  }
+  hash_slots[slot] = 0;
+}
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
 /*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const linkaddr_t *lladdr)
 {
+#if !NBR_TABLE_WITH_HASH_INDEX
   nbr_table_key_t *key;
+#endif /* !NBR_TABLE_WITH_HASH_INDEX */
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by linkaddr_null. */
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
+#if NBR_TABLE_WITH_HASH_INDEX
+  return hash_find(lladdr);
+#else /* NBR_TABLE_WITH_HASH_INDEX */
   key = list_head(nbr_table_keys);
   while(key != NULL) {
     if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
@@ -144,6 +253,7 @@ index_from_lladdr(const linkaddr_t *lladdr)
     key = list_item_next(key);
   }
   return -1;
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
 }
 /*---------------------------------------------------------------------------*/
 /* Get bit from "used" or "locked" bitmap */
@@ -195,6 +305,9 @@ remove_key(nbr_table_key_t *least_used_key)
   used_map[index_from_key(least_used_key)] = 0;
   /* Remove neighbor from list */
   list_remove(nbr_table_keys, least_used_key);
+#if NBR_TABLE_WITH_HASH_INDEX
+  hash_remove(index_from_key(least_used_key));
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
 }
 /*---------------------------------------------------------------------------*/
 static nbr_table_key_t *
@@ -359,6 +472,9 @@ nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr, nbr_table_rea
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_WITH_HASH_INDEX
+    hash_insert(index);
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
   }
 
   /* Get item in the current table */
@@ -450,7 +566,13 @@ nbr_table_update_lladdr(const linkaddr_t *old_addr, const linkaddr_t *new_addr,
    * Copy the new lladdr into the key - since we know that there is no
    * conflicting entry.
    */
+#if NBR_TABLE_WITH_HASH_INDEX
+  hash_remove(index);
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
   memcpy(&key->lladdr, new_addr, sizeof(linkaddr_t));
+#if NBR_TABLE_WITH_HASH_INDEX
+  hash_insert(index);
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
   return 1;
 }
 /*---------------------------------------------------------------------------*/
@@ -46,6 +46,16 @@
 #define NBR_TABLE_MAX_NEIGHBORS 8
 #endif /* NBR_TABLE_CONF_MAX_NEIGHBORS */
 
+/* Index neighbors by a hash of their link-layer address. Makes
+ * lookups constant time instead of linear in the number of neighbors,
+ * at the cost of a small slot array (two slots per neighbor). Useful
+ * with large values of NBR_TABLE_MAX_NEIGHBORS, e.g. on border routers. */
+#ifdef NBR_TABLE_CONF_WITH_HASH_INDEX
+#define NBR_TABLE_WITH_HASH_INDEX NBR_TABLE_CONF_WITH_HASH_INDEX
+#else /* NBR_TABLE_CONF_WITH_HASH_INDEX */
+#define NBR_TABLE_WITH_HASH_INDEX 0
+#endif /* NBR_TABLE_CONF_WITH_HASH_INDEX */
+
 /* An item in a neighbor table */
 typedef void nbr_table_item_t;
 
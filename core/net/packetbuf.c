@@ -55,14 +55,27 @@ struct packetbuf_addr packetbuf_addrs[PACKETBUF_NUM_ADDRS];
 
 static uint16_t buflen, bufptr;
 static uint8_t hdrlen;
+static uint8_t is_reference;
 
 /* The declarations below ensure that the packet buffer is aligned on
    an even 32-bit boundary. On some platforms (most notably the
    msp430 or OpenRISC), having a potentially misaligned packet buffer may lead to
    problems when accessing words. */
-static uint32_t packetbuf_aligned[(PACKETBUF_SIZE + 3) / 4];
+static uint32_t packetbuf_aligned[(PACKETBUF_HDR_SIZE + PACKETBUF_SIZE + 3) / 4];
 static uint8_t *packetbuf = (uint8_t *)packetbuf_aligned;
 
+/* Start of the packet: up to PACKETBUF_HDR_SIZE bytes into packetbuf,
+   depending on how much header space has been allocated, or an
+   external buffer set with packetbuf_reference(). */
+static uint8_t *packetbufptr = (uint8_t *)packetbuf_aligned + PACKETBUF_HDR_SIZE;
+
+#if PACKETBUF_STATS
+struct packetbuf_stats packetbuf_stats;
+#define STATS_ADD(x, n) (packetbuf_stats.x += (n))
+#else /* PACKETBUF_STATS */
+#define STATS_ADD(x, n)
+#endif /* PACKETBUF_STATS */
+
 #define DEBUG 0
 #if DEBUG
 #include <stdio.h>
@@ -77,6 +90,8 @@ packetbuf_clear(void)
 {
   buflen = bufptr = 0;
   hdrlen = 0;
+  is_reference = 0;
+  packetbufptr = packetbuf + PACKETBUF_HDR_SIZE;
 
   packetbuf_attr_clear();
 }
@@ -88,22 +103,56 @@ packetbuf_copyfrom(const void *from, uint16_t len)
 
   packetbuf_clear();
   l = MIN(PACKETBUF_SIZE, len);
-  memcpy(packetbuf, from, l);
+  memcpy(packetbufptr, from, l);
   buflen = l;
+  STATS_ADD(copies, 1);
+  STATS_ADD(copied_bytes, l);
   return l;
 }
 /*---------------------------------------------------------------------------*/
 void
+packetbuf_reference(void *ptr, uint16_t len)
+{
+  packetbuf_clear();
+  packetbufptr = ptr;
+  buflen = MIN(PACKETBUF_SIZE, len);
+  is_reference = 1;
+  STATS_ADD(references, 1);
+}
+/*---------------------------------------------------------------------------*/
+int
+packetbuf_is_reference(void)
+{
+  return is_reference;
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_copy_reference(void)
+{
+  if(is_reference) {
+    memcpy(packetbuf + PACKETBUF_HDR_SIZE, packetbufptr, packetbuf_totlen());
+    packetbufptr = packetbuf + PACKETBUF_HDR_SIZE;
+    is_reference = 0;
+    STATS_ADD(reference_copies, 1);
+    STATS_ADD(copies, 1);
+    STATS_ADD(copied_bytes, packetbuf_totlen());
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
 packetbuf_compact(void)
 {
   int16_t i;
 
   if(bufptr) {
+    packetbuf_copy_reference();
     /* shift data to the left */
     for(i = 0; i < buflen; i++) {
-      packetbuf[hdrlen + i] = packetbuf[packetbuf_hdrlen() + i];
+      packetbufptr[hdrlen + i] = packetbufptr[packetbuf_hdrlen() + i];
     }
     bufptr = 0;
+    STATS_ADD(shifts, 1);
+    STATS_ADD(shifted_bytes, buflen);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -115,6 +164,8 @@ packetbuf_copyto(void *to)
   }
   memcpy(to, packetbuf_hdrptr(), hdrlen);
   memcpy((uint8_t *)to + hdrlen, packetbuf_dataptr(), buflen);
+  STATS_ADD(copies, 1);
+  STATS_ADD(copied_bytes, hdrlen + buflen);
   return hdrlen + buflen;
 }
 /*---------------------------------------------------------------------------*/
@@ -127,9 +178,17 @@ packetbuf_hdralloc(int size)
     return 0;
   }
 
-  /* shift data to the right */
-  for(i = packetbuf_totlen() - 1; i >= 0; i--) {
-    packetbuf[i + size] = packetbuf[i];
+  packetbuf_copy_reference();
+  if(packetbufptr - packetbuf >= size) {
+    /* Use the space reserved in front of the packet */
+    packetbufptr -= size;
+  } else {
+    /* shift data to the right */
+    for(i = packetbuf_totlen() - 1; i >= 0; i--) {
+      packetbufptr[i + size] = packetbufptr[i];
+    }
+    STATS_ADD(shifts, 1);
+    STATS_ADD(shifted_bytes, packetbuf_totlen());
   }
   hdrlen += size;
   return 1;
@@ -157,13 +216,13 @@ packetbuf_set_datalen(uint16_t len)
 void *
 packetbuf_dataptr(void)
 {
-  return packetbuf + packetbuf_hdrlen();
+  return packetbufptr + packetbuf_hdrlen();
 }
 /*---------------------------------------------------------------------------*/
 void *
 packetbuf_hdrptr(void)
 {
-  return packetbuf;
+  return packetbufptr;
 }
 /*---------------------------------------------------------------------------*/
 uint16_t
@@ -66,6 +66,28 @@
 #define PACKETBUF_SIZE 128
 #endif
 
+/**
+ * \brief      The number of bytes reserved in front of the packetbuf data
+ *
+ *             Headers added with packetbuf_hdralloc() are placed in
+ *             this space, so that outbound packets do not have to be
+ *             moved when lower layers add their headers.
+ */
+#ifdef PACKETBUF_CONF_HDR_SIZE
+#define PACKETBUF_HDR_SIZE PACKETBUF_CONF_HDR_SIZE
+#else
+#define PACKETBUF_HDR_SIZE 0
+#endif
+
+/**
+ * \brief      Count the packet copies made by the packetbuf
+ */
+#ifdef PACKETBUF_CONF_STATS
+#define PACKETBUF_STATS PACKETBUF_CONF_STATS
+#else
+#define PACKETBUF_STATS 0
+#endif
+
 #ifdef PACKETBUF_CONF_WITH_PACKET_TYPE
 #define PACKETBUF_WITH_PACKET_TYPE PACKETBUF_CONF_WITH_PACKET_TYPE
 #else
@@ -204,6 +226,56 @@ int packetbuf_hdralloc(int size);
  */
 int packetbuf_hdrreduce(int size);
 
+/**
+ * \brief      Point the packetbuf to external data, for inbound packets
+ * \param ptr  A pointer to the data
+ * \param len  The length of the data
+ *
+ *             This function clears the packetbuf and makes it refer
+ *             to a packet in an external buffer, typically a radio
+ *             driver's receive buffer, instead of copying it. The
+ *             buffer must remain valid and writable until the packet
+ *             has been processed or the packetbuf is cleared. The
+ *             packet is copied into the packetbuf only if a header is
+ *             allocated or the packetbuf is compacted.
+ *
+ */
+void packetbuf_reference(void *ptr, uint16_t len);
+
+/**
+ * \brief      Check if the packetbuf refers to external data
+ * \retval     Non-zero if the packetbuf refers to external data
+ */
+int packetbuf_is_reference(void);
+
+/**
+ * \brief      Copy referenced external data into the packetbuf
+ *
+ *             This function copies the packet referenced with
+ *             packetbuf_reference() into the packetbuf, after which
+ *             the external buffer may be reused.
+ *
+ */
+void packetbuf_copy_reference(void);
+
+#if PACKETBUF_STATS
+struct packetbuf_stats {
+  /* Packets copied into or out of the packetbuf, and their total size */
+  uint32_t copies;
+  uint32_t copied_bytes;
+  /* Packets moved within the packetbuf to make room for a header, or to
+     compact it */
+  uint32_t shifts;
+  uint32_t shifted_bytes;
+  /* Packets referenced in place, and how many of them had to be copied
+     into the packetbuf after all */
+  uint32_t references;
+  uint32_t reference_copies;
+};
+
+extern struct packetbuf_stats packetbuf_stats;
+#endif /* PACKETBUF_STATS */
+
 /* Packet attributes stuff below: */
 
 typedef uint16_t packetbuf_attr_t;
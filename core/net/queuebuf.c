@@ -76,6 +76,8 @@ struct queuebuf_data {
   uint16_t len;
   struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
   struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+  /* Number of queuebufs sharing this data, when in RAM */
+  uint8_t refcount;
 };
 
 MEMB(bufmem, struct queuebuf, QUEUEBUF_NUM);
@@ -124,14 +126,11 @@ LIST(queuebuf_list);
 #define PRINTF(...)
 #endif
 
-#ifdef QUEUEBUF_CONF_STATS
-#define QUEUEBUF_STATS QUEUEBUF_CONF_STATS
-#else
-#define QUEUEBUF_STATS 0
-#endif /* QUEUEBUF_CONF_STATS */
-
 #if QUEUEBUF_STATS
 uint8_t queuebuf_len, queuebuf_max_len;
+uint8_t queuebuf_ram_len, queuebuf_ram_max_len;
+uint32_t queuebuf_len_histogram[QUEUEBUF_NUM + 1];
+uint32_t queuebuf_shares, queuebuf_unshares;
 #endif /* QUEUEBUF_STATS */
 
 #if WITH_SWAP
@@ -276,6 +275,159 @@ queuebuf_load_to_ram(struct queuebuf *b)
 }
 #endif /* WITH_SWAP */
 /*---------------------------------------------------------------------------*/
+/* Allocates the data of buf, in RAM or else in the swap. The data is to be
+   filled in through the returned pointer and then stored with
+   store_data(). */
+static struct queuebuf_data *
+alloc_data(struct queuebuf *buf)
+{
+  buf->ram_ptr = memb_alloc(&buframmem);
+#if WITH_SWAP
+  if(buf->ram_ptr == NULL) {
+    buf->location = IN_CFS;
+    buf->swap_id = -1;
+    tmpdata_qbuf = buf;
+    return &tmpdata;
+  }
+  buf->location = IN_RAM;
+#endif /* WITH_SWAP */
+  if(buf->ram_ptr == NULL) {
+    return NULL;
+  }
+  buf->ram_ptr->refcount = 1;
+#if QUEUEBUF_STATS
+  if(++queuebuf_ram_len > queuebuf_ram_max_len) {
+    queuebuf_ram_max_len = queuebuf_ram_len;
+  }
+#endif /* QUEUEBUF_STATS */
+  return buf->ram_ptr;
+}
+/*---------------------------------------------------------------------------*/
+static int
+store_data(struct queuebuf *buf)
+{
+#if WITH_SWAP
+  if(buf->location == IN_CFS) {
+    return queuebuf_flush_tmpdata();
+  }
+#endif /* WITH_SWAP */
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Drops the reference of buf to its data */
+static void
+free_data(struct queuebuf *buf)
+{
+#if WITH_SWAP
+  if(buf->location == IN_CFS) {
+    queuebuf_remove_from_file(buf->swap_id);
+    return;
+  }
+#endif /* WITH_SWAP */
+  if(--buf->ram_ptr->refcount == 0) {
+    memb_free(&buframmem, buf->ram_ptr);
+#if QUEUEBUF_STATS
+    --queuebuf_ram_len;
+#endif /* QUEUEBUF_STATS */
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_shared(struct queuebuf *buf)
+{
+#if WITH_SWAP
+  if(buf->location == IN_CFS) {
+    return 0;
+  }
+#endif /* WITH_SWAP */
+  return buf->ram_ptr->refcount > 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+can_share(struct queuebuf *buf)
+{
+#if WITH_SWAP
+  if(buf->location == IN_CFS) {
+    return 0;
+  }
+#endif /* WITH_SWAP */
+  return buf->ram_ptr->refcount < 0xff;
+}
+/*---------------------------------------------------------------------------*/
+/* Gives buf its own copy of its data, before the data is modified */
+static struct queuebuf_data *
+unshare(struct queuebuf *buf)
+{
+  struct queuebuf_data *shared;
+  struct queuebuf_data *copy;
+
+  if(!is_shared(buf)) {
+    return queuebuf_load_to_ram(buf);
+  }
+  shared = buf->ram_ptr;
+  copy = alloc_data(buf);
+  if(copy == NULL) {
+    /* Keep sharing, the update is lost */
+    PRINTF("queuebuf: could not allocate data for a shared queuebuf\n");
+    buf->ram_ptr = shared;
+    return NULL;
+  }
+  memcpy(copy, shared, sizeof(struct queuebuf_data));
+  copy->refcount = 1;
+  shared->refcount--;
+#if QUEUEBUF_STATS
+  queuebuf_unshares++;
+#endif /* QUEUEBUF_STATS */
+  return copy;
+}
+/*---------------------------------------------------------------------------*/
+#if QUEUEBUF_DEBUG
+static struct queuebuf *
+alloc_buf(const char *file, int line)
+#else /* QUEUEBUF_DEBUG */
+static struct queuebuf *
+alloc_buf(void)
+#endif /* QUEUEBUF_DEBUG */
+{
+  struct queuebuf *buf;
+
+#if QUEUEBUF_STATS
+  queuebuf_len_histogram[queuebuf_len]++;
+#endif /* QUEUEBUF_STATS */
+  buf = memb_alloc(&bufmem);
+  if(buf == NULL) {
+    PRINTF("queuebuf: could not allocate a queuebuf\n");
+    return NULL;
+  }
+#if QUEUEBUF_DEBUG
+  list_add(queuebuf_list, buf);
+  buf->file = file;
+  buf->line = line;
+  buf->time = clock_time();
+#endif /* QUEUEBUF_DEBUG */
+#if QUEUEBUF_STATS
+  ++queuebuf_len;
+  PRINTF("#A q=%d\n", queuebuf_len);
+  if(queuebuf_len > queuebuf_max_len) {
+    queuebuf_max_len = queuebuf_len;
+  }
+#endif /* QUEUEBUF_STATS */
+  return buf;
+}
+/*---------------------------------------------------------------------------*/
+static void
+free_buf(struct queuebuf *buf)
+{
+  memb_free(&bufmem, buf);
+#if QUEUEBUF_STATS
+  --queuebuf_len;
+  PRINTF("#A q=%d\n", queuebuf_len);
+#endif /* QUEUEBUF_STATS */
+#if QUEUEBUF_DEBUG
+  list_remove(queuebuf_list, buf);
+#endif /* QUEUEBUF_DEBUG */
+}
+/*---------------------------------------------------------------------------*/
 void
 queuebuf_init(void)
 {
@@ -290,6 +442,9 @@ queuebuf_init(void)
   memb_init(&bufmem);
 #if QUEUEBUF_STATS
   queuebuf_max_len = 0;
+  queuebuf_ram_max_len = 0;
+  memset(queuebuf_len_histogram, 0, sizeof(queuebuf_len_histogram));
+  queuebuf_shares = queuebuf_unshares = 0;
 #endif /* QUEUEBUF_STATS */
 }
 /*---------------------------------------------------------------------------*/
@@ -308,60 +463,85 @@ queuebuf_new_from_packetbuf(void)
 #endif /* QUEUEBUF_DEBUG */
 {
   struct queuebuf *buf;
-
   struct queuebuf_data *buframptr;
-  buf = memb_alloc(&bufmem);
-  if(buf != NULL) {
+
 #if QUEUEBUF_DEBUG
-    list_add(queuebuf_list, buf);
-    buf->file = file;
-    buf->line = line;
-    buf->time = clock_time();
+  buf = alloc_buf(file, line);
+#else /* QUEUEBUF_DEBUG */
+  buf = alloc_buf();
 #endif /* QUEUEBUF_DEBUG */
-    buf->ram_ptr = memb_alloc(&buframmem);
-#if WITH_SWAP
-    /* If the allocation failed, store the qbuf in swap files */
-    if(buf->ram_ptr != NULL) {
-      buf->location = IN_RAM;
-      buframptr = buf->ram_ptr;
-    } else {
-      buf->location = IN_CFS;
-      buf->swap_id = -1;
-      tmpdata_qbuf = buf;
-      buframptr = &tmpdata;
-    }
-#else
-    if(buf->ram_ptr == NULL) {
-      PRINTF("queuebuf_new_from_packetbuf: could not queuebuf data\n");
-      memb_free(&bufmem, buf);
-      return NULL;
-    }
-    buframptr = buf->ram_ptr;
-#endif
+  if(buf == NULL) {
+    return NULL;
+  }
 
-    buframptr->len = packetbuf_copyto(buframptr->data);
-    packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
+  buframptr = alloc_data(buf);
+  if(buframptr == NULL) {
+    PRINTF("queuebuf_new_from_packetbuf: could not queuebuf data\n");
+    free_buf(buf);
+    return NULL;
+  }
 
-#if WITH_SWAP
-    if(buf->location == IN_CFS) {
-      if(queuebuf_flush_tmpdata() == -1) {
-        /* We were unable to write the data in the swap */
-        memb_free(&bufmem, buf);
-        return NULL;
-      }
-    }
-#endif
+  buframptr->len = packetbuf_copyto(buframptr->data);
+  packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
 
+  if(store_data(buf) == -1) {
+    /* We were unable to write the data in the swap */
+    free_buf(buf);
+    return NULL;
+  }
+  return buf;
+}
+/*---------------------------------------------------------------------------*/
+#if QUEUEBUF_DEBUG
+struct queuebuf *
+queuebuf_share_debug(struct queuebuf *b, const char *file, int line)
+#else /* QUEUEBUF_DEBUG */
+struct queuebuf *
+queuebuf_share(struct queuebuf *b)
+#endif /* QUEUEBUF_DEBUG */
+{
+  struct queuebuf *buf;
+  struct queuebuf_data *from;
+  struct queuebuf_data *to;
+
+  if(!memb_inmemb(&bufmem, b)) {
+    return NULL;
+  }
+#if QUEUEBUF_DEBUG
+  buf = alloc_buf(file, line);
+#else /* QUEUEBUF_DEBUG */
+  buf = alloc_buf();
+#endif /* QUEUEBUF_DEBUG */
+  if(buf == NULL) {
+    return NULL;
+  }
+
+  if(can_share(b)) {
+#if WITH_SWAP
+    buf->location = IN_RAM;
+#endif /* WITH_SWAP */
+    buf->ram_ptr = b->ram_ptr;
+    buf->ram_ptr->refcount++;
 #if QUEUEBUF_STATS
-    ++queuebuf_len;
-    PRINTF("#A q=%d\n", queuebuf_len);
-    if(queuebuf_len > queuebuf_max_len) {
-      queuebuf_max_len = queuebuf_len;
-    }
+    queuebuf_shares++;
 #endif /* QUEUEBUF_STATS */
+    return buf;
+  }
 
-  } else {
-    PRINTF("queuebuf_new_from_packetbuf: could not allocate a queuebuf\n");
+  /* Swapped out or shared too many times: copy the data */
+  from = queuebuf_load_to_ram(b);
+  to = alloc_data(buf);
+  if(to == NULL) {
+    free_buf(buf);
+    return NULL;
+  }
+  if(to != from) {
+    memcpy(to, from, sizeof(struct queuebuf_data));
+    to->refcount = 1;
+  }
+  if(store_data(buf) == -1) {
+    free_buf(buf);
+    return NULL;
   }
   return buf;
 }
@@ -370,48 +550,44 @@ void
 queuebuf_update_attr_from_packetbuf(struct queuebuf *buf)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
-  packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
-#if WITH_SWAP
-  if(buf->location == IN_CFS) {
-    queuebuf_flush_tmpdata();
+  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+
+  if(is_shared(buf)) {
+    packetbuf_attr_copyto(attrs, addrs);
+    if(memcmp(buframptr->attrs, attrs, sizeof(attrs)) == 0 &&
+       memcmp(buframptr->addrs, addrs, sizeof(addrs)) == 0) {
+      /* Nothing changed, keep sharing */
+      return;
+    }
+    buframptr = unshare(buf);
+    if(buframptr == NULL) {
+      return;
+    }
   }
-#endif
+  packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
+  store_data(buf);
 }
 /*---------------------------------------------------------------------------*/
 void
 queuebuf_update_from_packetbuf(struct queuebuf *buf)
 {
-  struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
+  struct queuebuf_data *buframptr = unshare(buf);
+
+  if(buframptr == NULL) {
+    return;
+  }
   packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
   buframptr->len = packetbuf_copyto(buframptr->data);
-#if WITH_SWAP
-  if(buf->location == IN_CFS) {
-    queuebuf_flush_tmpdata();
-  }
-#endif
+  store_data(buf);
 }
 /*---------------------------------------------------------------------------*/
 void
 queuebuf_free(struct queuebuf *buf)
 {
   if(memb_inmemb(&bufmem, buf)) {
-#if WITH_SWAP
-    if(buf->location == IN_RAM) {
-      memb_free(&buframmem, buf->ram_ptr);
-    } else {
-      queuebuf_remove_from_file(buf->swap_id);
-    }
-#else
-    memb_free(&buframmem, buf->ram_ptr);
-#endif
-    memb_free(&bufmem, buf);
-#if QUEUEBUF_STATS
-    --queuebuf_len;
-    PRINTF("#A q=%d\n", queuebuf_len);
-#endif /* QUEUEBUF_STATS */
-#if QUEUEBUF_DEBUG
-    list_remove(queuebuf_list, buf);
-#endif /* QUEUEBUF_DEBUG */
+    free_data(buf);
+    free_buf(buf);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -427,6 +603,27 @@ queuebuf_to_packetbuf(struct queuebuf *b)
 /*---------------------------------------------------------------------------*/
 void *
 queuebuf_dataptr(struct queuebuf *b)
+{
+  if(memb_inmemb(&bufmem, b)) {
+    struct queuebuf_data *buframptr;
+    if(is_shared(b)) {
+      /* The caller may write through the pointer, so b gets its own
+         copy of the packet first */
+      buframptr = unshare(b);
+      if(buframptr == NULL) {
+        return NULL;
+      }
+      store_data(b);
+    } else {
+      buframptr = queuebuf_load_to_ram(b);
+    }
+    return buframptr->data;
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+const void *
+queuebuf_dataptr_const(struct queuebuf *b)
 {
   if(memb_inmemb(&bufmem, b)) {
     struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
@@ -85,6 +85,27 @@
 #define QUEUEBUF_DEBUG 0
 #endif /* QUEUEBUF_CONF_DEBUG */
 
+#ifdef QUEUEBUF_CONF_STATS
+#define QUEUEBUF_STATS QUEUEBUF_CONF_STATS
+#else /* QUEUEBUF_CONF_STATS */
+#define QUEUEBUF_STATS 0
+#endif /* QUEUEBUF_CONF_STATS */
+
+#if QUEUEBUF_STATS
+/* Number of queuebufs in use, and the maximum so far */
+extern uint8_t queuebuf_len, queuebuf_max_len;
+/* Number of queuebuf data buffers in RAM in use, and the maximum so far.
+   Shared queuebufs use a single data buffer. */
+extern uint8_t queuebuf_ram_len, queuebuf_ram_max_len;
+/* Pool occupancy: queuebuf_len_histogram[n] is the number of allocations
+   made while n queuebufs were in use. Allocations made while all
+   QUEUEBUF_NUM were in use have failed. */
+extern uint32_t queuebuf_len_histogram[QUEUEBUF_NUM + 1];
+/* Number of queuebufs shared, and shared queuebufs that later had to be
+   copied because they were modified */
+extern uint32_t queuebuf_shares, queuebuf_unshares;
+#endif /* QUEUEBUF_STATS */
+
 struct queuebuf;
 
 void queuebuf_init(void);
@@ -95,13 +116,32 @@ struct queuebuf *queuebuf_new_from_packetbuf_debug(const char *file, int line);
 #else /* QUEUEBUF_DEBUG */
 struct queuebuf *queuebuf_new_from_packetbuf(void);
 #endif /* QUEUEBUF_DEBUG */
+
+/*
+ * Returns a new queuebuf holding the same packet as b, without copying the
+ * packet when b is in RAM. Both can be freed independently. A queuebuf
+ * that is updated gets its own copy of the packet first, unless the
+ * update does not change anything.
+ */
+#if QUEUEBUF_DEBUG
+struct queuebuf *queuebuf_share_debug(struct queuebuf *b, const char *file, int line);
+#define queuebuf_share(b) queuebuf_share_debug(b, __FILE__, __LINE__)
+#else /* QUEUEBUF_DEBUG */
+struct queuebuf *queuebuf_share(struct queuebuf *b);
+#endif /* QUEUEBUF_DEBUG */
 void queuebuf_update_attr_from_packetbuf(struct queuebuf *b);
 void queuebuf_update_from_packetbuf(struct queuebuf *b);
 
 void queuebuf_to_packetbuf(struct queuebuf *b);
 void queuebuf_free(struct queuebuf *b);
 
+/*
+ * Returns a writable pointer to the packet in b. A queuebuf that shares
+ * its packet gets its own copy first, so this returns NULL if no copy
+ * can be allocated. Use queuebuf_dataptr_const() to only read the packet.
+ */
 void *queuebuf_dataptr(struct queuebuf *b);
+const void *queuebuf_dataptr_const(struct queuebuf *b);
 int queuebuf_datalen(struct queuebuf *b);
 
 linkaddr_t *queuebuf_addr(struct queuebuf *b, uint8_t type);
@@ -64,7 +64,7 @@ recv(struct broadcast_conn *broadcast, const linkaddr_t *from)
   struct ipolite_conn *c = (struct ipolite_conn *)broadcast;
   if(c->q != NULL &&
      packetbuf_datalen() == queuebuf_datalen(c->q) &&
-     memcmp(packetbuf_dataptr(), queuebuf_dataptr(c->q),
+     memcmp(packetbuf_dataptr(), queuebuf_dataptr_const(c->q),
 	    MIN(c->hdrsize, packetbuf_datalen())) == 0) {
     /* We received a copy of our own packet, so we increase the
        duplicate counter. If it reaches its maximum, do not send out
@@ -56,7 +56,7 @@ recv(struct abc_conn *abc)
   struct polite_conn *c = (struct polite_conn *)abc;
   if(c->q != NULL &&
      packetbuf_datalen() == queuebuf_datalen(c->q) &&
-     memcmp(packetbuf_dataptr(), queuebuf_dataptr(c->q),
+     memcmp(packetbuf_dataptr(), queuebuf_dataptr_const(c->q),
 	    MIN(c->hdrsize, packetbuf_datalen())) == 0) {
     /* We received a copy of our own packet, so we do not send out
        packet. */
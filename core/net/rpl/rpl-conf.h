@@ -338,4 +338,25 @@
 #define RPL_DIS_START_DELAY             5
 #endif
 
+/*
+ * Number of source routing headers cached by a non-storing root, indexed
+ * by destination. A cached header is reused as-is until the topology
+ * changes. Zero disables the cache.
+ */
+#ifdef RPL_CONF_SRH_CACHE_SIZE
+#define RPL_SRH_CACHE_SIZE RPL_CONF_SRH_CACHE_SIZE
+#else
+#define RPL_SRH_CACHE_SIZE 0
+#endif
+
+/*
+ * Largest source routing header (in bytes) that is stored in the cache.
+ * Longer headers are built from scratch for every packet.
+ */
+#ifdef RPL_CONF_SRH_CACHE_MAX_LEN
+#define RPL_SRH_CACHE_MAX_LEN RPL_CONF_SRH_CACHE_MAX_LEN
+#else
+#define RPL_SRH_CACHE_MAX_LEN 64
+#endif
+
 #endif /* RPL_CONF_H */
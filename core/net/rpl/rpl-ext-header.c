@@ -322,11 +322,52 @@ count_matching_bytes(const void *p1, const void *p2, size_t n)
   return n;
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_SRH_CACHE_SIZE
+/* A complete routing header (RH + SRH + hops + padding) for one destination,
+ * valid as long as the topology version it was built for is current */
+struct srh_cache_entry {
+  const rpl_ns_node_t *dest;
+  /* Node whose parent is the root, used as the IPv6 destination */
+  rpl_ns_node_t *next_hop;
+  uint16_t version;
+  uint8_t len;
+  uint8_t hdr[RPL_SRH_CACHE_MAX_LEN];
+};
+static struct srh_cache_entry srh_cache[RPL_SRH_CACHE_SIZE];
+#endif /* RPL_SRH_CACHE_SIZE */
+/*---------------------------------------------------------------------------*/
+/* Make room for a routing header of ext_len bytes after the IPv6 header,
+ * fill it from hdr (or with zeros if hdr is NULL) and chain it in. The
+ * caller accounts for the header in uip_ext_len and uip_len. */
+static void
+open_srh_space(uint8_t ext_len, const uint8_t *hdr)
+{
+  uint8_t temp_len;
+
+  /* Move existing ext headers and payload uip_ext_len further */
+  memmove(uip_buf + uip_l2_l3_hdr_len + ext_len,
+      uip_buf + uip_l2_l3_hdr_len, uip_len - UIP_IPH_LEN);
+  if(hdr != NULL) {
+    memcpy(uip_buf + uip_l2_l3_hdr_len, hdr, ext_len);
+  } else {
+    memset(uip_buf + uip_l2_l3_hdr_len, 0, ext_len);
+  }
+
+  UIP_RH_BUF->next = UIP_IP_BUF->proto;
+  UIP_IP_BUF->proto = UIP_PROTO_ROUTING;
+
+  /* In-place update of IPv6 length field */
+  temp_len = UIP_IP_BUF->len[1];
+  UIP_IP_BUF->len[1] += ext_len;
+  if(UIP_IP_BUF->len[1] < temp_len) {
+    UIP_IP_BUF->len[0]++;
+  }
+}
+/*---------------------------------------------------------------------------*/
 static int
 insert_srh_header(void)
 {
   /* Implementation of RFC6554 */
-  uint8_t temp_len;
   uint8_t path_len;
   uint8_t ext_len;
   uint8_t cmpri, cmpre; /* ComprI and ComprE fields of the RPL Source Routing Header */
@@ -337,6 +378,9 @@ insert_srh_header(void)
   rpl_ns_node_t *node;
   rpl_dag_t *dag;
   uip_ipaddr_t node_addr;
+#if RPL_SRH_CACHE_SIZE
+  struct srh_cache_entry *e;
+#endif /* RPL_SRH_CACHE_SIZE */
 
   PRINTF("RPL: SRH creating source routing header with destination ");
   PRINT6ADDR(&UIP_IP_BUF->destipaddr);
@@ -358,6 +402,22 @@ insert_srh_header(void)
     return 1;
   }
 
+#if RPL_SRH_CACHE_SIZE
+  e = &srh_cache[rpl_ns_hash(dest_node->link_identifier) % RPL_SRH_CACHE_SIZE];
+  if(e->dest == dest_node && e->version == rpl_ns_topology_version()) {
+    /* The path has not changed since this header was built: reuse it */
+    if(uip_len + e->len > UIP_BUFSIZE) {
+      PRINTF("RPL: Packet too long: impossible to add source routing header (%u bytes)\n", e->len);
+      return 1;
+    }
+    open_srh_space(e->len, e->hdr);
+    rpl_ns_get_node_global_addr(&UIP_IP_BUF->destipaddr, e->next_hop);
+    uip_ext_len += e->len;
+    uip_len += e->len;
+    return 1;
+  }
+#endif /* RPL_SRH_CACHE_SIZE */
+
   root_node = rpl_ns_get_node(dag, &dag->dag_id);
   if(root_node == NULL) {
     PRINTF("RPL: SRH root node not found\n");
@@ -413,14 +473,8 @@ insert_srh_header(void)
     return 1;
   }
 
-  /* Move existing ext headers and payload uip_ext_len further */
-  memmove(uip_buf + uip_l2_l3_hdr_len + ext_len,
-      uip_buf + uip_l2_l3_hdr_len, uip_len - UIP_IPH_LEN);
-  memset(uip_buf + uip_l2_l3_hdr_len, 0, ext_len);
-
   /* Insert source routing header */
-  UIP_RH_BUF->next = UIP_IP_BUF->proto;
-  UIP_IP_BUF->proto = UIP_PROTO_ROUTING;
+  open_srh_space(ext_len, NULL);
 
   /* Initialize IPv6 Routing Header */
   UIP_RH_BUF->len = (ext_len - 8) / 8;
@@ -449,12 +503,15 @@ insert_srh_header(void)
   rpl_ns_get_node_global_addr(&node_addr, node);
   uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &node_addr);
 
-  /* In-place update of IPv6 length field */
-  temp_len = UIP_IP_BUF->len[1];
-  UIP_IP_BUF->len[1] += ext_len;
-  if(UIP_IP_BUF->len[1] < temp_len) {
-    UIP_IP_BUF->len[0]++;
+#if RPL_SRH_CACHE_SIZE
+  if(ext_len <= RPL_SRH_CACHE_MAX_LEN) {
+    e->dest = dest_node;
+    e->next_hop = node;
+    e->version = rpl_ns_topology_version();
+    e->len = ext_len;
+    memcpy(e->hdr, UIP_RH_BUF, ext_len);
   }
+#endif /* RPL_SRH_CACHE_SIZE */
 
   uip_ext_len += ext_len;
   uip_len += ext_len;
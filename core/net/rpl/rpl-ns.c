@@ -63,6 +63,12 @@ static int num_nodes;
 LIST(nodelist);
 MEMB(nodememb, rpl_ns_node_t, RPL_NS_LINK_NUM);
 
+/* Nodes hashed by link identifier, chained through hash_next */
+static rpl_ns_node_t *node_hash[RPL_NS_HASH_SIZE];
+
+/* Bumped on every change that may alter a source route */
+static uint16_t topology_version;
+
 /*---------------------------------------------------------------------------*/
 int
 rpl_ns_num_nodes(void)
@@ -70,6 +76,47 @@ rpl_ns_num_nodes(void)
   return num_nodes;
 }
 /*---------------------------------------------------------------------------*/
+uint16_t
+rpl_ns_topology_version(void)
+{
+  return topology_version;
+}
+/*---------------------------------------------------------------------------*/
+unsigned
+rpl_ns_hash(const unsigned char *link_identifier)
+{
+  unsigned h = 5381;
+  int i;
+  for(i = 0; i < 8; i++) {
+    h = ((h << 5) + h) ^ link_identifier[i];
+  }
+  return h ^ (h >> 8);
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_add(rpl_ns_node_t *node)
+{
+  rpl_ns_node_t **bucket;
+  bucket = &node_hash[rpl_ns_hash(node->link_identifier) & (RPL_NS_HASH_SIZE - 1)];
+  node->hash_next = *bucket;
+  *bucket = node;
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_remove(rpl_ns_node_t *node)
+{
+  rpl_ns_node_t **p;
+  p = &node_hash[rpl_ns_hash(node->link_identifier) & (RPL_NS_HASH_SIZE - 1)];
+  while(*p != NULL) {
+    if(*p == node) {
+      *p = node->hash_next;
+      node->hash_next = NULL;
+      return;
+    }
+    p = &(*p)->hash_next;
+  }
+}
+/*---------------------------------------------------------------------------*/
 static int
 node_matches_address(const rpl_dag_t *dag, const rpl_ns_node_t *node, const uip_ipaddr_t *addr)
 {
@@ -85,7 +132,11 @@ rpl_ns_node_t *
 rpl_ns_get_node(const rpl_dag_t *dag, const uip_ipaddr_t *addr)
 {
   rpl_ns_node_t *l;
-  for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
+  if(addr == NULL) {
+    return NULL;
+  }
+  l = node_hash[rpl_ns_hash(((const unsigned char *)addr) + 8) & (RPL_NS_HASH_SIZE - 1)];
+  for(; l != NULL; l = l->hash_next) {
     /* Compare prefix and node identifier */
     if(node_matches_address(dag, l, addr)) {
       return l;
@@ -142,14 +193,19 @@ rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child, const uip_ipaddr_t
       return NULL;
     }
     child_node->parent = NULL;
+    memcpy(child_node->link_identifier, ((const unsigned char *)child) + 8, 8);
     list_add(nodelist, child_node);
+    hash_add(child_node);
     num_nodes++;
+    topology_version++;
   }
 
   /* Initialize node */
-  child_node->dag = dag;
+  if(child_node->dag != dag) {
+    child_node->dag = dag;
+    topology_version++;
+  }
   child_node->lifetime = lifetime;
-  memcpy(child_node->link_identifier, ((const unsigned char *)child) + 8, 8);
 
   /* Is the node reachable before the update? */
   if(rpl_ns_is_node_reachable(dag, child)) {
@@ -164,9 +220,14 @@ rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child, const uip_ipaddr_t
       child_node->parent = old_parent_node;
     }
   } else {
+    old_parent_node = child_node->parent;
     child_node->parent = parent_node;
   }
 
+  if(child_node->parent != old_parent_node) {
+    topology_version++;
+  }
+
   return child_node;
 }
 /*---------------------------------------------------------------------------*/
@@ -176,6 +237,8 @@ rpl_ns_init(void)
   num_nodes = 0;
   memb_init(&nodememb);
   list_init(nodelist);
+  memset(node_hash, 0, sizeof(node_hash));
+  topology_version++;
 }
 /*---------------------------------------------------------------------------*/
 rpl_ns_node_t *
@@ -203,6 +266,7 @@ void
 rpl_ns_periodic(void)
 {
   rpl_ns_node_t *l;
+  rpl_ns_node_t *next;
   /* First pass, decrement lifetime for all nodes with non-infinite lifetime */
   for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
     /* Don't touch infinite lifetime nodes */
@@ -211,7 +275,8 @@ rpl_ns_periodic(void)
     }
   }
   /* Second pass, for all expire nodes, deallocate them iff no child points to them */
-  for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
+  for(l = list_head(nodelist); l != NULL; l = next) {
+    next = list_item_next(l);
     if(l->lifetime == 0) {
       rpl_ns_node_t *l2;
       for(l2 = list_head(nodelist); l2 != NULL; l2 = list_item_next(l2)) {
@@ -219,10 +284,14 @@ rpl_ns_periodic(void)
           break;
         }
       }
-      /* No child found, deallocate node */
-      list_remove(nodelist, l);
-      memb_free(&nodememb, l);
-      num_nodes--;
+      if(l2 == NULL) {
+        /* No child found, deallocate node */
+        list_remove(nodelist, l);
+        hash_remove(l);
+        memb_free(&nodememb, l);
+        num_nodes--;
+        topology_version++;
+      }
     }
   }
 }
@@ -49,6 +49,18 @@
 #define RPL_NS_LINK_NUM 32
 #endif /* RPL_NS_CONF_LINK_NUM */
 
+/* Number of buckets of the node table, indexed by a hash of the node's
+ * link identifier. Must be a power of two. */
+#ifdef RPL_NS_CONF_HASH_SIZE
+#define RPL_NS_HASH_SIZE RPL_NS_CONF_HASH_SIZE
+#else /* RPL_NS_CONF_HASH_SIZE */
+#define RPL_NS_HASH_SIZE 16
+#endif /* RPL_NS_CONF_HASH_SIZE */
+
+#if RPL_NS_HASH_SIZE & (RPL_NS_HASH_SIZE - 1)
+#error RPL_NS_HASH_SIZE must be a power of two
+#endif
+
 typedef struct rpl_ns_node {
   struct rpl_ns_node *next;
   uint32_t lifetime;
@@ -56,6 +68,8 @@ typedef struct rpl_ns_node {
   /* Store only IPv6 link identifiers as all nodes in the DAG share the same prefix */
   unsigned char link_identifier[8];
   struct rpl_ns_node *parent;
+  /* Next node in the same hash bucket */
+  struct rpl_ns_node *hash_next;
 } rpl_ns_node_t;
 
 int rpl_ns_num_nodes(void);
@@ -68,5 +82,10 @@ rpl_ns_node_t *rpl_ns_get_node(const rpl_dag_t *dag, const uip_ipaddr_t *addr);
 int rpl_ns_is_node_reachable(const rpl_dag_t *dag, const uip_ipaddr_t *addr);
 void rpl_ns_get_node_global_addr(uip_ipaddr_t *addr, rpl_ns_node_t *node);
 void rpl_ns_periodic(void);
+/* Hash of an 8-byte link identifier, used to index the node table */
+unsigned rpl_ns_hash(const unsigned char *link_identifier);
+/* Incremented whenever a node is added or removed or changes parent,
+ * i.e., whenever a previously computed source route may be stale */
+uint16_t rpl_ns_topology_version(void);
 
 #endif /* RPL_NS_H */
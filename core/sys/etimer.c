@@ -49,6 +49,9 @@
 #include "sys/etimer.h"
 #include "sys/process.h"
 
+/* The pending timers, sorted by expiration time. A timer that is on
+   the list always has its process set, so etimer->p == PROCESS_NONE
+   means that the timer does not need to be looked up on the list. */
 static struct etimer *timerlist;
 static clock_time_t next_expiration;
 
@@ -57,24 +60,39 @@ PROCESS(etimer_process, "Event timer");
 static void
 update_time(void)
 {
-  clock_time_t tdist;
-  clock_time_t now;
-  struct etimer *t;
-
-  if (timerlist == NULL) {
+  if(timerlist == NULL) {
     next_expiration = 0;
   } else {
-    now = clock_time();
-    t = timerlist;
-    /* Must calculate distance to next time into account due to wraps */
-    tdist = t->timer.start + t->timer.interval - now;
-    for(t = t->next; t != NULL; t = t->next) {
-      if(t->timer.start + t->timer.interval - now < tdist) {
-	tdist = t->timer.start + t->timer.interval - now;
+    next_expiration = timerlist->timer.start + timerlist->timer.interval;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Time left until the timer expires, zero if it already has. The
+   distance is computed from the timer start to take wraps into
+   account. Two timers keep their relative order as time passes. */
+static clock_time_t
+time_left(struct etimer *t, clock_time_t now)
+{
+  clock_time_t elapsed = now - t->timer.start;
+  return elapsed >= t->timer.interval ? 0 : t->timer.interval - elapsed;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a timer from the list. Returns non-zero if it was on it. */
+static int
+remove_timer(struct etimer *timer)
+{
+  struct etimer **tp;
+
+  if(timer->p != PROCESS_NONE) {
+    for(tp = &timerlist; *tp != NULL; tp = &(*tp)->next) {
+      if(*tp == timer) {
+        *tp = timer->next;
+        timer->next = NULL;
+        return 1;
       }
     }
-    next_expiration = now + tdist;
   }
+  return 0;
 }
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(etimer_process, ev, data)
@@ -92,50 +110,47 @@ PROCESS_THREAD(etimer_process, ev, data)
       struct process *p = data;
 
       while(timerlist != NULL && timerlist->p == p) {
-	timerlist = timerlist->next;
+	t = timerlist;
+	timerlist = t->next;
+	t->next = NULL;
+	t->p = PROCESS_NONE;
       }
 
       if(timerlist != NULL) {
 	t = timerlist;
 	while(t->next != NULL) {
 	  if(t->next->p == p) {
-	    t->next = t->next->next;
+	    u = t->next;
+	    t->next = u->next;
+	    u->next = NULL;
+	    u->p = PROCESS_NONE;
 	  } else
 	    t = t->next;
 	}
       }
+      update_time();
       continue;
     } else if(ev != PROCESS_EVENT_POLL) {
       continue;
     }
 
-  again:
-    
-    u = NULL;
-    
-    for(t = timerlist; t != NULL; t = t->next) {
-      if(timer_expired(&t->timer)) {
-	if(process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK) {
-	  
-	  /* Reset the process ID of the event timer, to signal that the
-	     etimer has expired. This is later checked in the
-	     etimer_expired() function. */
-	  t->p = PROCESS_NONE;
-	  if(u != NULL) {
-	    u->next = t->next;
-	  } else {
-	    timerlist = t->next;
-	  }
-	  t->next = NULL;
-	  update_time();
-	  goto again;
-	} else {
-	  etimer_request_poll();
-	}
+    /* Expired timers are at the head of the list. */
+    while(timerlist != NULL && timer_expired(&timerlist->timer)) {
+      t = timerlist;
+      if(process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK) {
+
+	/* Reset the process ID of the event timer, to signal that the
+	   etimer has expired. This is later checked in the
+	   etimer_expired() function. */
+	t->p = PROCESS_NONE;
+	timerlist = t->next;
+	t->next = NULL;
+      } else {
+	etimer_request_poll();
+	break;
       }
-      u = t;
     }
-    
+    update_time();
   }
   
   PROCESS_END();
@@ -147,35 +162,38 @@ etimer_request_poll(void)
   process_poll(&etimer_process);
 }
 /*---------------------------------------------------------------------------*/
+/* Insert a timer at its place on the list. The timer must have been
+   removed from the list before its start or interval was changed. */
 static void
-add_timer(struct etimer *timer)
+insert_timer(struct etimer *timer)
 {
-  struct etimer *t;
+  struct etimer **tp;
+  clock_time_t now;
+  clock_time_t left;
 
-  etimer_request_poll();
+  now = clock_time();
+  left = time_left(timer, now);
+  for(tp = &timerlist; *tp != NULL && time_left(*tp, now) <= left;
+      tp = &(*tp)->next);
+  timer->next = *tp;
+  *tp = timer;
 
-  if(timer->p != PROCESS_NONE) {
-    for(t = timerlist; t != NULL; t = t->next) {
-      if(t == timer) {
-	/* Timer already on list, bail out. */
-        timer->p = PROCESS_CURRENT();
-	update_time();
-	return;
-      }
-    }
-  }
+  update_time();
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_timer(struct etimer *timer)
+{
+  etimer_request_poll();
 
-  /* Timer not on list. */
   timer->p = PROCESS_CURRENT();
-  timer->next = timerlist;
-  timerlist = timer;
-
-  update_time();
+  insert_timer(timer);
 }
 /*---------------------------------------------------------------------------*/
 void
 etimer_set(struct etimer *et, clock_time_t interval)
 {
+  remove_timer(et);
   timer_set(&et->timer, interval);
   add_timer(et);
 }
@@ -183,6 +201,7 @@ etimer_set(struct etimer *et, clock_time_t interval)
 void
 etimer_reset_with_new_interval(struct etimer *et, clock_time_t interval)
 {
+  remove_timer(et);
   timer_reset(&et->timer);
   et->timer.interval = interval;
   add_timer(et);
@@ -191,6 +210,7 @@ etimer_reset_with_new_interval(struct etimer *et, clock_time_t interval)
 void
 etimer_reset(struct etimer *et)
 {
+  remove_timer(et);
   timer_reset(&et->timer);
   add_timer(et);
 }
@@ -198,6 +218,7 @@ etimer_reset(struct etimer *et)
 void
 etimer_restart(struct etimer *et)
 {
+  remove_timer(et);
   timer_restart(&et->timer);
   add_timer(et);
 }
@@ -205,8 +226,13 @@ etimer_restart(struct etimer *et)
 void
 etimer_adjust(struct etimer *et, int timediff)
 {
-  et->timer.start += timediff;
-  update_time();
+  if(remove_timer(et)) {
+    /* Move the timer to its new place on the list. */
+    et->timer.start += timediff;
+    insert_timer(et);
+  } else {
+    et->timer.start += timediff;
+  }
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -242,29 +268,11 @@ etimer_next_expiration_time(void)
 void
 etimer_stop(struct etimer *et)
 {
-  struct etimer *t;
-
-  /* First check if et is the first event timer on the list. */
-  if(et == timerlist) {
-    timerlist = timerlist->next;
+  /* Remove the timer from the list, if it is on it. */
+  if(remove_timer(et)) {
     update_time();
-  } else {
-    /* Else walk through the list and try to find the item before the
-       et timer. */
-    for(t = timerlist; t != NULL && t->next != et; t = t->next);
-
-    if(t != NULL) {
-      /* We've found the item before the event timer that we are about
-	 to remove. We point the items next pointer to the event after
-	 the removed item. */
-      t->next = et->next;
-
-      update_time();
-    }
   }
 
-  /* Remove the next pointer from the item to be removed. */
-  et->next = NULL;
   /* Set the timer as expired */
   et->p = PROCESS_NONE;
 }
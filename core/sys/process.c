@@ -68,12 +68,36 @@ struct event_data {
 static process_num_events_t nevents, fevent;
 static struct event_data events[PROCESS_CONF_NUMEVENTS];
 
+#if PROCESS_WITH_PRIORITIES
+/*
+ * Events for high priority processes. This queue is always drained
+ * before the normal one.
+ */
+static process_num_events_t nevents_high, fevent_high;
+static struct event_data events_high[PROCESS_CONF_NUMEVENTS_HIGH];
+#define NEVENTS() (nevents + nevents_high)
+#else /* PROCESS_WITH_PRIORITIES */
+#define NEVENTS() nevents
+#endif /* PROCESS_WITH_PRIORITIES */
+
 #if PROCESS_CONF_STATS
 process_num_events_t process_maxevents;
+#if PROCESS_WITH_PRIORITIES
+process_num_events_t process_maxevents_high;
+#endif /* PROCESS_WITH_PRIORITIES */
+unsigned short process_droppedevents;
 #endif
 
 static volatile unsigned char poll_requested;
 
+#if PROCESS_WITH_POLL_LIST
+/*
+ * FIFO of processes that have been polled, linked through
+ * process->pollnext. A process is on the list iff needspoll is set.
+ */
+static struct process *poll_head, *poll_tail;
+#endif /* PROCESS_WITH_POLL_LIST */
+
 #define PROCESS_STATE_NONE        0
 #define PROCESS_STATE_RUNNING     1
 #define PROCESS_STATE_CALLED      2
@@ -210,9 +234,19 @@ process_init(void)
   lastevent = PROCESS_EVENT_MAX;
 
   nevents = fevent = 0;
+#if PROCESS_WITH_PRIORITIES
+  nevents_high = fevent_high = 0;
+#endif /* PROCESS_WITH_PRIORITIES */
 #if PROCESS_CONF_STATS
   process_maxevents = 0;
+#if PROCESS_WITH_PRIORITIES
+  process_maxevents_high = 0;
+#endif /* PROCESS_WITH_PRIORITIES */
+  process_droppedevents = 0;
 #endif /* PROCESS_CONF_STATS */
+#if PROCESS_WITH_POLL_LIST
+  poll_head = poll_tail = NULL;
+#endif /* PROCESS_WITH_POLL_LIST */
 
   process_current = process_list = NULL;
 }
@@ -226,6 +260,27 @@ do_poll(void)
 {
   struct process *p;
 
+#if PROCESS_WITH_POLL_LIST
+  struct process *next;
+
+  /* Detach the current list so that processes polled from within a
+     poll handler are handled in the next round, as with the scan. */
+  PROCESS_ATOMIC_BEGIN();
+  p = poll_head;
+  poll_head = poll_tail = NULL;
+  poll_requested = 0;
+  PROCESS_ATOMIC_END();
+
+  for(; p != NULL; p = next) {
+    next = p->pollnext;
+    p->needspoll = 0;
+    /* The process may have exited after it was polled. */
+    if(process_is_running(p)) {
+      p->state = PROCESS_STATE_RUNNING;
+      call_process(p, PROCESS_EVENT_POLL, NULL);
+    }
+  }
+#else /* PROCESS_WITH_POLL_LIST */
   poll_requested = 0;
   /* Call the processes that needs to be polled. */
   for(p = process_list; p != NULL; p = p->next) {
@@ -235,6 +290,7 @@ do_poll(void)
       call_process(p, PROCESS_EVENT_POLL, NULL);
     }
   }
+#endif /* PROCESS_WITH_POLL_LIST */
 }
 /*---------------------------------------------------------------------------*/
 /*
@@ -258,6 +314,15 @@ do_event(void)
    * call the poll handlers inbetween.
    */
 
+#if PROCESS_WITH_PRIORITIES
+  if(nevents_high > 0) {
+    ev = events_high[fevent_high].ev;
+    data = events_high[fevent_high].data;
+    receiver = events_high[fevent_high].p;
+    fevent_high = (fevent_high + 1) % PROCESS_CONF_NUMEVENTS_HIGH;
+    --nevents_high;
+  } else
+#endif /* PROCESS_WITH_PRIORITIES */
   if(nevents > 0) {
     
     /* There are events that we should deliver. */
@@ -270,31 +335,33 @@ do_event(void)
        and decrease the number of events. */
     fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
     --nevents;
+  } else {
+    return;
+  }
 
-    /* If this is a broadcast event, we deliver it to all events, in
-       order of their priority. */
-    if(receiver == PROCESS_BROADCAST) {
-      for(p = process_list; p != NULL; p = p->next) {
-
-	/* If we have been requested to poll a process, we do this in
-	   between processing the broadcast event. */
-	if(poll_requested) {
-	  do_poll();
-	}
-	call_process(p, ev, data);
-      }
-    } else {
-      /* This is not a broadcast event, so we deliver it to the
-	 specified process. */
-      /* If the event was an INIT event, we should also update the
-	 state of the process. */
-      if(ev == PROCESS_EVENT_INIT) {
-	receiver->state = PROCESS_STATE_RUNNING;
-      }
+  /* If this is a broadcast event, we deliver it to all events, in
+     order of their priority. */
+  if(receiver == PROCESS_BROADCAST) {
+    for(p = process_list; p != NULL; p = p->next) {
 
-      /* Make sure that the process actually is running. */
-      call_process(receiver, ev, data);
+      /* If we have been requested to poll a process, we do this in
+         between processing the broadcast event. */
+      if(poll_requested) {
+        do_poll();
+      }
+      call_process(p, ev, data);
+    }
+  } else {
+    /* This is not a broadcast event, so we deliver it to the
+       specified process. */
+    /* If the event was an INIT event, we should also update the
+       state of the process. */
+    if(ev == PROCESS_EVENT_INIT) {
+      receiver->state = PROCESS_STATE_RUNNING;
     }
+
+    /* Make sure that the process actually is running. */
+    call_process(receiver, ev, data);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -309,13 +376,13 @@ process_run(void)
   /* Process one event from the queue */
   do_event();
 
-  return nevents + poll_requested;
+  return NEVENTS() + poll_requested;
 }
 /*---------------------------------------------------------------------------*/
 int
 process_nevents(void)
 {
-  return nevents + poll_requested;
+  return NEVENTS() + poll_requested;
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -331,6 +398,31 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
 	   PROCESS_NAME_STRING(PROCESS_CURRENT()), ev,
 	   p == PROCESS_BROADCAST? "<broadcast>": PROCESS_NAME_STRING(p), nevents);
   }
+
+#if PROCESS_WITH_PRIORITIES
+  if(p != PROCESS_BROADCAST && p->priority >= PROCESS_PRIO_HIGH) {
+    if(nevents_high == PROCESS_CONF_NUMEVENTS_HIGH) {
+      PRINTF("soft panic: high priority event queue is full when event %d was posted to %s\n", ev, PROCESS_NAME_STRING(p));
+#if PROCESS_CONF_STATS
+      process_droppedevents++;
+#endif /* PROCESS_CONF_STATS */
+      return PROCESS_ERR_FULL;
+    }
+
+    snum = (process_num_events_t)(fevent_high + nevents_high) % PROCESS_CONF_NUMEVENTS_HIGH;
+    events_high[snum].ev = ev;
+    events_high[snum].data = data;
+    events_high[snum].p = p;
+    ++nevents_high;
+
+#if PROCESS_CONF_STATS
+    if(nevents_high > process_maxevents_high) {
+      process_maxevents_high = nevents_high;
+    }
+#endif /* PROCESS_CONF_STATS */
+    return PROCESS_ERR_OK;
+  }
+#endif /* PROCESS_WITH_PRIORITIES */
   
   if(nevents == PROCESS_CONF_NUMEVENTS) {
 #if DEBUG
@@ -340,6 +432,9 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
       printf("soft panic: event queue is full when event %d was posted to %s from %s\n", ev, PROCESS_NAME_STRING(p), PROCESS_NAME_STRING(process_current));
     }
 #endif /* DEBUG */
+#if PROCESS_CONF_STATS
+    process_droppedevents++;
+#endif /* PROCESS_CONF_STATS */
     return PROCESS_ERR_FULL;
   }
   
@@ -373,8 +468,24 @@ process_poll(struct process *p)
   if(p != NULL) {
     if(p->state == PROCESS_STATE_RUNNING ||
        p->state == PROCESS_STATE_CALLED) {
+#if PROCESS_WITH_POLL_LIST
+      PROCESS_ATOMIC_BEGIN();
+      if(!p->needspoll) {
+        p->needspoll = 1;
+        p->pollnext = NULL;
+        if(poll_tail == NULL) {
+          poll_head = p;
+        } else {
+          poll_tail->pollnext = p;
+        }
+        poll_tail = p;
+      }
+      poll_requested = 1;
+      PROCESS_ATOMIC_END();
+#else /* PROCESS_WITH_POLL_LIST */
       p->needspoll = 1;
       poll_requested = 1;
+#endif /* PROCESS_WITH_POLL_LIST */
     }
   }
 }
@@ -88,6 +88,57 @@ typedef unsigned char process_num_events_t;
 #define PROCESS_CONF_NUMEVENTS 32
 #endif /* PROCESS_CONF_NUMEVENTS */
 
+/**
+ * \name Event priorities
+ *
+ * With PROCESS_CONF_WITH_PRIORITIES, events posted to a process with
+ * high priority (e.g. the tcpip process) are kept in a separate
+ * queue of PROCESS_CONF_NUMEVENTS_HIGH entries that is always
+ * drained before the normal queue. Broadcast events are always
+ * normal priority.
+ * @{
+ */
+#ifdef PROCESS_CONF_WITH_PRIORITIES
+#define PROCESS_WITH_PRIORITIES PROCESS_CONF_WITH_PRIORITIES
+#else /* PROCESS_CONF_WITH_PRIORITIES */
+#define PROCESS_WITH_PRIORITIES 0
+#endif /* PROCESS_CONF_WITH_PRIORITIES */
+
+#ifndef PROCESS_CONF_NUMEVENTS_HIGH
+#define PROCESS_CONF_NUMEVENTS_HIGH 8
+#endif /* PROCESS_CONF_NUMEVENTS_HIGH */
+
+#define PROCESS_PRIO_NORMAL 0
+#define PROCESS_PRIO_HIGH   1
+/* @} */
+
+/**
+ * \name Poll list
+ *
+ * With PROCESS_CONF_WITH_POLL_LIST, process_poll() links the process
+ * into a FIFO list so that the scheduler only visits the processes
+ * that have actually been polled instead of scanning the whole
+ * process list. On platforms that call process_poll() from interrupt
+ * handlers, PROCESS_CONF_ATOMIC_BEGIN() and PROCESS_CONF_ATOMIC_END()
+ * must be defined to disable and restore interrupts around the list
+ * updates.
+ * @{
+ */
+#ifdef PROCESS_CONF_WITH_POLL_LIST
+#define PROCESS_WITH_POLL_LIST PROCESS_CONF_WITH_POLL_LIST
+#else /* PROCESS_CONF_WITH_POLL_LIST */
+#define PROCESS_WITH_POLL_LIST 0
+#endif /* PROCESS_CONF_WITH_POLL_LIST */
+
+#ifdef PROCESS_CONF_ATOMIC_BEGIN
+#define PROCESS_ATOMIC_BEGIN() PROCESS_CONF_ATOMIC_BEGIN()
+#define PROCESS_ATOMIC_END()   PROCESS_CONF_ATOMIC_END()
+#else /* PROCESS_CONF_ATOMIC_BEGIN */
+#define PROCESS_ATOMIC_BEGIN()
+#define PROCESS_ATOMIC_END()
+#endif /* PROCESS_CONF_ATOMIC_BEGIN */
+/* @} */
+
 #define PROCESS_EVENT_NONE            0x80
 #define PROCESS_EVENT_INIT            0x81
 #define PROCESS_EVENT_POLL            0x82
@@ -323,6 +374,12 @@ struct process {
   PT_THREAD((* thread)(struct pt *, process_event_t, process_data_t));
   struct pt pt;
   unsigned char state, needspoll;
+#if PROCESS_WITH_PRIORITIES
+  unsigned char priority;
+#endif /* PROCESS_WITH_PRIORITIES */
+#if PROCESS_WITH_POLL_LIST
+  struct process *pollnext;
+#endif /* PROCESS_WITH_POLL_LIST */
 };
 
 /**
@@ -452,6 +509,21 @@ process_current = p
  */
 CCIF process_event_t process_alloc_event(void);
 
+/**
+ * \brief      Set the event priority of a process.
+ * \param p    The process.
+ * \param prio PROCESS_PRIO_NORMAL or PROCESS_PRIO_HIGH.
+ *
+ *             Events posted to a process with PROCESS_PRIO_HIGH are
+ *             delivered before any normal priority event. Without
+ *             PROCESS_CONF_WITH_PRIORITIES this does nothing.
+ */
+#if PROCESS_WITH_PRIORITIES
+#define process_set_priority(p, prio) ((p)->priority = (prio))
+#else /* PROCESS_WITH_PRIORITIES */
+#define process_set_priority(p, prio)
+#endif /* PROCESS_WITH_PRIORITIES */
+
 /** @} */
 
 /**
@@ -521,6 +593,22 @@ int process_nevents(void);
 
 /** @} */
 
+#if PROCESS_CONF_STATS
+/**
+ * \name Event queue statistics
+ * @{
+ */
+/** Maximum number of events seen in the normal priority queue. */
+extern process_num_events_t process_maxevents;
+#if PROCESS_WITH_PRIORITIES
+/** Maximum number of events seen in the high priority queue. */
+extern process_num_events_t process_maxevents_high;
+#endif /* PROCESS_WITH_PRIORITIES */
+/** Number of events dropped because their queue was full. */
+extern unsigned short process_droppedevents;
+/** @} */
+#endif /* PROCESS_CONF_STATS */
+
 CCIF extern struct process *process_list;
 
 #define PROCESS_LIST() process_list
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Helpers shared by the benchmarks: CPU time measurement,
+ *         checks and the final result line. A benchmark defines
+ *         BENCHMARK_NAME, the prefix of its output lines, before
+ *         including this file.
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include "contiki.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef BENCHMARK_NAME
+#error "BENCHMARK_NAME must be defined before including benchmark.h"
+#endif /* BENCHMARK_NAME */
+
+/* Number of failed checks */
+static unsigned long benchmark_errors;
+
+/* Counts a failure and prints why, given as a printf() format string
+   and its arguments */
+#define BENCHMARK_FAIL(...) do {                  \
+    printf(BENCHMARK_NAME ": " __VA_ARGS__);      \
+    benchmark_errors++;                           \
+  } while(0)
+
+/* Counts a failure if cond does not hold */
+#define BENCHMARK_CHECK(cond, ...) do {           \
+    if(!(cond)) {                                 \
+      BENCHMARK_FAIL(__VA_ARGS__);                \
+    }                                             \
+  } while(0)
+
+/*---------------------------------------------------------------------------*/
+/* CPU time used by the process, in microseconds. Unlike clock_time(),
+   it does not include time spent waiting for the host. */
+static inline unsigned long
+benchmark_cpu_time_us(void)
+{
+  return (unsigned long)((unsigned long long)clock() * 1000000ULL /
+                         CLOCKS_PER_SEC);
+}
+/*---------------------------------------------------------------------------*/
+/* Nanoseconds per operation for ops operations that took elapsed_us */
+static inline unsigned long
+benchmark_ns_per_op(unsigned long elapsed_us, unsigned long ops)
+{
+  return (unsigned long)((unsigned long long)elapsed_us * 1000ULL / ops);
+}
+/*---------------------------------------------------------------------------*/
+/* Prints the result line. On native, the process exits with a non-zero
+   status if a check failed, so that scripts can run the benchmark. */
+static inline void
+benchmark_done(void)
+{
+  printf(BENCHMARK_NAME ": done, %s\n",
+         benchmark_errors == 0 ? "OK" : "FAILED");
+#if CONTIKI_TARGET_NATIVE
+  exit(benchmark_errors == 0 ? 0 : 1);
+#endif /* CONTIKI_TARGET_NATIVE */
+}
+/*---------------------------------------------------------------------------*/
+
+#endif /* BENCHMARK_H_ */
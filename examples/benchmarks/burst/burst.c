@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Burst transmission benchmark. Sends packets fragmented into
+ *         several frames to a neighbor that duty cycles its radio, and
+ *         reports the goodput and the number of times the neighbor had
+ *         to be woken up.
+ */
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/rdc.h"
+#include "net/mac/frame802154.h"
+#include "dev/radio.h"
+
+#define BENCHMARK_NAME "burst"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The airtime of a frame, in clock ticks, at 250 kbit/s */
+#define AIRTIME(len)     (1 + (len) / 32)
+/* The average time it takes to wake the receiver up, i.e. half of
+   its channel check interval */
+#define WAKEUP_TIME      (CLOCK_SECOND / 64)
+#define PACKETS          20
+#define FRAGMENTS        8
+#define FRAGMENT_LEN     100
+
+PROCESS(burst_process, "Burst benchmark");
+AUTOSTART_PROCESSES(&burst_process);
+
+static const linkaddr_t receiver = {{ 1 }};
+static int receiver_awake;
+static unsigned long frames, pending_frames, wakeups;
+static unsigned sent, failed;
+/*---------------------------------------------------------------------------*/
+/* A radio that blocks for the airtime of each frame, and for the
+   wake-up time of the receiver when it is asleep. The receiver stays
+   awake after a frame that has the frame pending bit set. */
+static void
+busy_wait(clock_time_t ticks)
+{
+  clock_time_t start;
+
+  start = clock_time();
+  while(clock_time() - start < ticks);
+}
+/*---------------------------------------------------------------------------*/
+static int
+sim_send(const void *payload, unsigned short payload_len)
+{
+  const uint8_t *frame = payload;
+
+  if(!receiver_awake) {
+    busy_wait(WAKEUP_TIME);
+    wakeups++;
+  }
+  busy_wait(AIRTIME(payload_len));
+  frames++;
+  receiver_awake = (frame[0] >> 4) & 1;
+  pending_frames += receiver_awake;
+  return RADIO_TX_OK;
+}
+/*---------------------------------------------------------------------------*/
+static int
+sim_init(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+sim_prepare(const void *payload, unsigned short payload_len)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+sim_transmit(unsigned short transmit_len)
+{
+  return RADIO_TX_ERR;
+}
+/*---------------------------------------------------------------------------*/
+static int
+sim_read(void *buf, unsigned short buf_len)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+sim_channel_clear(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+sim_receiving_packet(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+sim_pending_packet(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+sim_on(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+sim_off(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+sim_get_value(radio_param_t param, radio_value_t *value)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+sim_set_value(radio_param_t param, radio_value_t value)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+sim_get_object(radio_param_t param, void *dest, size_t size)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+sim_set_object(radio_param_t param, const void *src, size_t size)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+const struct radio_driver sim_radio_driver = {
+  sim_init,
+  sim_prepare,
+  sim_transmit,
+  sim_send,
+  sim_read,
+  sim_channel_clear,
+  sim_receiving_packet,
+  sim_pending_packet,
+  sim_on,
+  sim_off,
+  sim_get_value,
+  sim_set_value,
+  sim_get_object,
+  sim_set_object
+};
+/*---------------------------------------------------------------------------*/
+static void
+packet_sent(void *ptr, int status, int num_transmissions)
+{
+  if(status == MAC_TX_OK) {
+    sent++;
+  } else {
+    failed++;
+  }
+  if(sent + failed == FRAGMENTS) {
+    process_poll(&burst_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(burst_process, ev, data)
+{
+  static clock_time_t start, queued, latency_max;
+  static unsigned long bytes;
+  static int packet;
+  clock_time_t latency;
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("burst: burst transmission %d, %d packets of %d frames\n",
+         RDC_WITH_BURST, PACKETS, FRAGMENTS);
+
+  start = clock_time();
+  for(packet = 0; packet < PACKETS; packet++) {
+    /* Queue all fragments of a packet at once, as sicslowpan does */
+    sent = failed = 0;
+    queued = clock_time();
+    for(i = 0; i < FRAGMENTS; i++) {
+      packetbuf_clear();
+      memset(packetbuf_dataptr(), i, FRAGMENT_LEN);
+      packetbuf_set_datalen(FRAGMENT_LEN);
+      packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &receiver);
+      NETSTACK_MAC.send(packet_sent, NULL);
+    }
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    latency = clock_time() - queued;
+    if(latency > latency_max) {
+      latency_max = latency;
+    }
+    bytes += sent * FRAGMENT_LEN;
+    /* The receiver goes back to sleep between packets */
+    receiver_awake = 0;
+  }
+
+  printf("burst: %lu frames, %lu with frame pending, %lu wake-ups, %u failed\n",
+         frames, pending_frames, wakeups, failed);
+  printf("burst: %lu bytes in %lu ticks, %lu bytes/s, packet latency max %lu ticks\n",
+         bytes, (unsigned long)(clock_time() - start),
+         bytes * CLOCK_SECOND / (clock_time() - start),
+         (unsigned long)latency_max);
+  BENCHMARK_CHECK(bytes == (unsigned long)PACKETS * FRAGMENTS * FRAGMENT_LEN,
+                  "%lu bytes sent\n", bytes);
+  BENCHMARK_CHECK(!RDC_WITH_BURST || wakeups == PACKETS,
+                  "%lu wake-ups in bursts\n", wakeups);
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Internet checksum benchmark. Checks uip_chksum_add() and the
+ *         incremental update functions against the original 16-bit
+ *         implementation for random lengths, alignments and partial
+ *         sums, and measures the throughput of both for typical
+ *         packet sizes.
+ */
+
+#include "contiki.h"
+#include "net/ip/uip.h"
+#include "net/ip/uip-chksum.h"
+
+#define BENCHMARK_NAME "chksum"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LEN 1280
+#define TESTS 100000UL
+/* Bytes summed per throughput run */
+#define RUN_BYTES 200000000UL
+
+PROCESS(chksum_process, "Checksum benchmark");
+AUTOSTART_PROCESSES(&chksum_process);
+
+static uint8_t buf[MAX_LEN + 16];
+static volatile uint16_t sink;
+/*---------------------------------------------------------------------------*/
+/* The 16-bit implementation uip6.c used before uip_chksum_add() */
+static uint16_t
+reference_chksum(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  uint16_t t;
+  const uint8_t *dataptr;
+  const uint8_t *last_byte;
+
+  dataptr = data;
+  last_byte = data + len - 1;
+
+  while(dataptr < last_byte) {
+    t = (dataptr[0] << 8) + dataptr[1];
+    sum += t;
+    if(sum < t) {
+      sum++;
+    }
+    dataptr += 2;
+  }
+
+  if(dataptr == last_byte) {
+    t = (dataptr[0] << 8) + 0;
+    sum += t;
+    if(sum < t) {
+      sum++;
+    }
+  }
+  return sum;
+}
+/*---------------------------------------------------------------------------*/
+/* 0x0000 and 0xffff are both zero in one's complement arithmetic */
+static int
+same_sum(uint16_t a, uint16_t b)
+{
+  return a == b || ((a == 0 || a == 0xffff) && (b == 0 || b == 0xffff));
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_sums(void)
+{
+  unsigned long i;
+  uint16_t offset, len, split, sum;
+  uint16_t expected, result;
+
+  for(i = 0; i < TESTS; i++) {
+    offset = random() % 16;
+    len = random() % (MAX_LEN + 1);
+    sum = random();
+
+    expected = reference_chksum(sum, &buf[offset], len);
+    result = uip_chksum_add(sum, &buf[offset], len);
+    BENCHMARK_CHECK(same_sum(expected, result),
+                    "sum of %u bytes at offset %u is 0x%04x, expected 0x%04x\n",
+                    len, offset, result, expected);
+
+    /* The same data in two blocks */
+    split = (len > 0 ? random() % len : 0) & ~1;
+    result = uip_chksum_add(sum, &buf[offset], split);
+    result = uip_chksum_add(result, &buf[offset + split], len - split);
+    BENCHMARK_CHECK(same_sum(expected, result),
+                    "sum of %u bytes split at %u is 0x%04x, expected 0x%04x\n",
+                    len, split, result, expected);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_updates(void)
+{
+  unsigned long i;
+  uint8_t data[MAX_LEN];
+  uint8_t old_addrs[32];
+  uint8_t new_addrs[8];
+  uint16_t len, pos, old_value, new_value;
+  uint16_t chksum, expected;
+
+  for(i = 0; i < TESTS; i++) {
+    len = 2 + (random() % (MAX_LEN - 1));
+    memcpy(data, &buf[random() % 16], len);
+    chksum = uip_htons(~reference_chksum(0, data, len));
+
+    /* Change one word, e.g. a port number */
+    pos = (random() % (len - 1)) & ~1;
+    memcpy(&old_value, &data[pos], 2);
+    new_value = random();
+    memcpy(&data[pos], &new_value, 2);
+    chksum = uip_chksum_update16(chksum, old_value, new_value);
+    expected = uip_htons(~reference_chksum(0, data, len));
+    BENCHMARK_CHECK(same_sum(~chksum, ~expected),
+                    "update of word %u of %u is 0x%04x, expected 0x%04x\n",
+                    pos, len, chksum, expected);
+
+    /* Replace an IPv6 address pair in the pseudo-header with an IPv4
+       pair, as when translating between IPv6 and IPv4 */
+    memcpy(old_addrs, &buf[random() % 16], sizeof(old_addrs));
+    memcpy(new_addrs, &buf[random() % 16], sizeof(new_addrs));
+    chksum = uip_htons(~reference_chksum(reference_chksum(0, old_addrs,
+                                                          sizeof(old_addrs)),
+                                         data, len));
+    chksum = uip_chksum_update(chksum, old_addrs, sizeof(old_addrs),
+                               new_addrs, sizeof(new_addrs));
+    expected = uip_htons(~reference_chksum(reference_chksum(0, new_addrs,
+                                                            sizeof(new_addrs)),
+                                           data, len));
+    BENCHMARK_CHECK(same_sum(~chksum, ~expected),
+                    "address update of %u bytes is 0x%04x, expected 0x%04x\n",
+                    len, chksum, expected);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+run(uint16_t len, uint16_t offset)
+{
+  unsigned long i, n;
+  uint16_t sum;
+  clock_time_t start;
+  clock_time_t reference_time, time;
+
+  n = RUN_BYTES / len;
+
+  sum = 0;
+  start = clock_time();
+  for(i = 0; i < n; i++) {
+    sum = reference_chksum(sum, &buf[offset], len);
+  }
+  reference_time = clock_time() - start;
+  sink = sum;
+
+  sum = 0;
+  start = clock_time();
+  for(i = 0; i < n; i++) {
+    sum = uip_chksum_add(sum, &buf[offset], len);
+  }
+  time = clock_time() - start;
+  sink = sum;
+
+  printf("chksum: %4u bytes at offset %u: reference %5lu MB/s, uip_chksum_add %5lu MB/s\n",
+         len, offset,
+         RUN_BYTES / 1000 / (unsigned long)(reference_time + 1),
+         RUN_BYTES / 1000 / (unsigned long)(time + 1));
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(chksum_process, ev, data)
+{
+  unsigned i;
+
+  PROCESS_BEGIN();
+
+  printf("chksum: words %u, SIMD %u\n", UIP_CHKSUM_WORDS, UIP_CHKSUM_SIMD);
+
+  srandom(1);
+  for(i = 0; i < sizeof(buf); i++) {
+    buf[i] = random();
+  }
+
+  check_sums();
+  check_updates();
+
+  run(20, 0);
+  run(40, 0);
+  run(128, 0);
+  run(1280, 0);
+  run(1280, 1);
+
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
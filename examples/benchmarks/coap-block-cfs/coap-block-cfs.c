@@ -0,0 +1,590 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         CoAP block-wise file transfer benchmark. Uploads a file with
+ *         Block1 through coap_block1_cfs_handler(), serves it with
+ *         Block2 through coap_block2_cfs_handler(), and downloads it
+ *         from a server emulated behind a link with a fixed delay, with
+ *         COAP_BLOCK2_PIPELINE requests in flight. One response of the
+ *         download is lost on the way. In between, an upload and a
+ *         download are abandoned and must expire.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "cfs/cfs.h"
+#include "net/ip/uip-chksum.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "rest-engine.h"
+#include "er-coap-engine.h"
+#include "er-coap-block-cfs.h"
+
+#define BENCHMARK_NAME "coap-block-cfs"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SOURCE_FILE "coap-block-cfs.src"
+#define UPLOAD_FILE "coap-block-cfs.up"
+
+#define FILE_SIZE 4000
+#define BLOCK_SIZE 64
+#define BLOCKS ((FILE_SIZE + BLOCK_SIZE - 1) / BLOCK_SIZE)
+#define SERVE_ROUNDS 2000
+
+#define SERVER_PORT 5684
+#define LINK_DELAY (CLOCK_SECOND * 5 / 100)
+#define LOST_BLOCK 10
+
+#define QUEUE_LEN 8
+
+PROCESS(coap_block_cfs_process, "CoAP block-wise file transfer benchmark");
+PROCESS(link_process, "Emulated link");
+AUTOSTART_PROCESSES(&coap_block_cfs_process);
+
+static COAP_CFS_STREAM(upload_stream, UPLOAD_FILE);
+static COAP_CFS_STREAM(serve_stream, SOURCE_FILE);
+static COAP_CFS_STREAM(server_stream, SOURCE_FILE);
+
+/* Responses on their way from the server */
+static struct frame {
+  clock_time_t due;
+  uint16_t len;
+  uint8_t data[COAP_MAX_PACKET_SIZE];
+} frames[QUEUE_LEN];
+static int num_frames;
+
+static uip_ipaddr_t server_addr;
+static uip_ipaddr_t our_addr;
+
+static unsigned long requests;
+static unsigned long retransmissions;
+static unsigned long repeated;
+static uint8_t requested[BLOCKS];
+static cfs_offset_t received;
+static int corrupt;
+static uint32_t upload_size1;
+/*---------------------------------------------------------------------------*/
+static uint8_t
+pattern(cfs_offset_t pos)
+{
+  return (pos * 7 + (pos >> 8)) & 0xff;
+}
+/*---------------------------------------------------------------------------*/
+static int
+matches(const uint8_t *data, cfs_offset_t pos, int len)
+{
+  int i;
+
+  for(i = 0; i < len; i++) {
+    if(data[i] != pattern(pos + i)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+write_source(cfs_offset_t size)
+{
+  uint8_t buf[BLOCK_SIZE];
+  cfs_offset_t pos;
+  int len;
+  int fd;
+  int i;
+
+  cfs_remove(SOURCE_FILE);
+  fd = cfs_open(SOURCE_FILE, CFS_WRITE);
+  if(fd < 0) {
+    return 0;
+  }
+  for(pos = 0; pos < size; pos += len) {
+    len = MIN(BLOCK_SIZE, size - pos);
+    for(i = 0; i < len; i++) {
+      buf[i] = pattern(pos + i);
+    }
+    if(cfs_write(fd, buf, len) != len) {
+      break;
+    }
+  }
+  cfs_close(fd);
+  return pos == size;
+}
+/*---------------------------------------------------------------------------*/
+/* Passes block num of the upload to the handler the way the engine would */
+static int
+upload_block(uint32_t num, cfs_offset_t max_len, int *code)
+{
+  static coap_packet_t request[1];
+  static coap_packet_t parsed[1];
+  static coap_packet_t response[1];
+  static uint8_t message[COAP_MAX_PACKET_SIZE];
+  uint8_t payload[BLOCK_SIZE];
+  cfs_offset_t pos = num * BLOCK_SIZE;
+  int len = MIN(BLOCK_SIZE, FILE_SIZE - pos);
+  int i;
+  int ret;
+
+  for(i = 0; i < len; i++) {
+    payload[i] = pattern(pos + i);
+  }
+  coap_init_message(request, COAP_TYPE_CON, COAP_PUT, num);
+  coap_set_header_uri_path(request, "file");
+  coap_set_header_block1(request, num, pos + len < FILE_SIZE, BLOCK_SIZE);
+  coap_set_payload(request, payload, len);
+  len = coap_serialize_message(request, message);
+  if(coap_parse_message(parsed, message, len) != NO_ERROR) {
+    return -2;
+  }
+
+  coap_init_message(response, COAP_TYPE_ACK, CHANGED_2_04, num);
+  erbium_status_code = NO_ERROR;
+  ret = coap_block1_cfs_handler(parsed, response, &upload_stream, max_len);
+  *code = ret < 0 ? erbium_status_code : response->code;
+  upload_size1 = 0;
+  coap_get_header_size1(response, &upload_size1);
+  erbium_status_code = NO_ERROR;
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_upload(void)
+{
+  uint8_t buf[BLOCK_SIZE];
+  cfs_offset_t pos;
+  uint32_t num;
+  int code;
+  int ret;
+  int len;
+  int fd;
+  unsigned long errors = benchmark_errors;
+
+  for(num = 0; num < BLOCKS; num++) {
+    ret = upload_block(num, FILE_SIZE, &code);
+    BENCHMARK_CHECK(ret == (num < BLOCKS - 1) &&
+                    code == (num < BLOCKS - 1 ? CONTINUE_2_31 : CHANGED_2_04),
+                    "block %lu: returned %d, code %d\n",
+                    (unsigned long)num, ret, code);
+  }
+
+  fd = cfs_open(UPLOAD_FILE, CFS_READ);
+  for(pos = 0; fd >= 0 && (len = cfs_read(fd, buf, sizeof(buf))) > 0;
+      pos += len) {
+    BENCHMARK_CHECK(matches(buf, pos, len),
+                    "uploaded data differs at %ld\n", (long)pos);
+  }
+  if(fd >= 0) {
+    cfs_close(fd);
+  }
+  BENCHMARK_CHECK(pos == FILE_SIZE,
+                  "uploaded %ld of %d bytes\n", (long)pos, FILE_SIZE);
+
+  /* a request that is too large leaves the uploaded file alone */
+  ret = upload_block(0, BLOCK_SIZE / 2, &code);
+  fd = cfs_open(UPLOAD_FILE, CFS_READ);
+  pos = fd >= 0 ? cfs_seek(fd, 0, CFS_SEEK_END) : -1;
+  BENCHMARK_CHECK(ret == -1 && code == REQUEST_ENTITY_TOO_LARGE_4_13 &&
+                  upload_size1 == BLOCK_SIZE / 2 && pos == FILE_SIZE,
+                  "too large: returned %d, code %d, size1 %lu, file size %ld\n",
+                  ret, code, (unsigned long)upload_size1, (long)pos);
+  if(fd >= 0) {
+    cfs_close(fd);
+  }
+
+  /* a gap in the transfer */
+  upload_block(0, FILE_SIZE, &code);
+  ret = upload_block(2, FILE_SIZE, &code);
+  BENCHMARK_CHECK(ret == -1 && code == REQUEST_ENTITY_INCOMPLETE_4_08,
+                  "gap: returned %d, code %d\n", ret, code);
+
+  /* a file that grows too large is removed */
+  upload_block(0, 3 * BLOCK_SIZE, &code);
+  upload_block(1, 3 * BLOCK_SIZE, &code);
+  upload_block(2, 3 * BLOCK_SIZE, &code);
+  ret = upload_block(3, 3 * BLOCK_SIZE, &code);
+  fd = cfs_open(UPLOAD_FILE, CFS_READ);
+  BENCHMARK_CHECK(ret == -1 && code == REQUEST_ENTITY_TOO_LARGE_4_13 && fd < 0,
+                  "grows too large: returned %d, code %d, file %s\n",
+                  ret, code, fd >= 0 ? "kept" : "removed");
+  if(fd >= 0) {
+    cfs_close(fd);
+  }
+
+  printf("coap-block-cfs: upload of %d blocks %s\n", BLOCKS,
+         benchmark_errors == errors ? "OK" : "FAILED");
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_serve(void)
+{
+  static coap_packet_t request[1];
+  static coap_packet_t response[1];
+  static uint8_t buffer[BLOCK_SIZE];
+  clock_time_t start, elapsed;
+  cfs_offset_t pos;
+  int32_t offset;
+  uint32_t size2;
+  int round;
+  int len;
+  unsigned long errors = benchmark_errors;
+
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  start = clock_time();
+  for(round = 0; round < SERVE_ROUNDS; round++) {
+    offset = 0;
+    do {
+      pos = offset;
+      coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, 0);
+      len = coap_block2_cfs_handler(request, response, buffer, BLOCK_SIZE,
+                                    &offset, &serve_stream);
+      if(len != MIN(BLOCK_SIZE, FILE_SIZE - pos) ||
+         response->payload != buffer || !matches(buffer, pos, len) ||
+         (pos == 0 && (!coap_get_header_size2(response, &size2) ||
+                       size2 != FILE_SIZE))) {
+        BENCHMARK_FAIL("served block at %ld is wrong\n", (long)pos);
+        break;
+      }
+    } while(offset != -1);
+  }
+  elapsed = clock_time() - start;
+  BENCHMARK_CHECK(serve_stream.fd < 0, "served file left open\n");
+
+  /* past the end */
+  offset = FILE_SIZE;
+  BENCHMARK_CHECK(coap_block2_cfs_handler(request, response, buffer,
+                                          BLOCK_SIZE, &offset,
+                                          &serve_stream) == -1 &&
+                  erbium_status_code == BAD_OPTION_4_02,
+                  "past the end: code %d\n", erbium_status_code);
+  erbium_status_code = NO_ERROR;
+  coap_cfs_stream_close(&serve_stream);
+
+  printf("coap-block-cfs: served %d x %d blocks in %lu ms, read-ahead %d bytes, %s\n",
+         SERVE_ROUNDS, BLOCKS, (unsigned long)(elapsed * 1000 / CLOCK_SECOND),
+         COAP_BLOCK_CFS_READ_AHEAD,
+         benchmark_errors == errors ? "OK" : "FAILED");
+}
+/*---------------------------------------------------------------------------*/
+/* Requests the block at offset of the file of stream, and returns the
+   response code and the Size2 option, or 0 if there is none */
+static int
+get_block(coap_cfs_stream_t *stream, int32_t offset, uint32_t *size2)
+{
+  static coap_packet_t request[1];
+  static coap_packet_t response[1];
+  static uint8_t buffer[BLOCK_SIZE];
+  int code;
+
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, 0);
+  *size2 = 0;
+  if(coap_block2_cfs_handler(request, response, buffer, BLOCK_SIZE,
+                             &offset, stream) < 0) {
+    code = erbium_status_code;
+    erbium_status_code = NO_ERROR;
+    return code;
+  }
+  coap_get_header_size2(response, size2);
+  return response->code;
+}
+/*---------------------------------------------------------------------------*/
+/* Abandons an upload and a download of a file that then shrinks */
+static void
+test_abandon(void)
+{
+  uint32_t size2;
+  int code;
+
+  upload_block(0, FILE_SIZE, &code);
+  upload_block(1, FILE_SIZE, &code);
+  code = get_block(&upload_stream, 0, &size2);
+  BENCHMARK_CHECK(code == SERVICE_UNAVAILABLE_5_03,
+                  "download during upload: code %d\n", code);
+
+  code = get_block(&serve_stream, 0, &size2);
+  BENCHMARK_CHECK(write_source(FILE_SIZE / 2), "source file not written\n");
+  code = get_block(&serve_stream, 0, &size2);
+  BENCHMARK_CHECK(code == CONTENT_2_05 && size2 == FILE_SIZE / 2,
+                  "download restarted: code %d, size %lu\n",
+                  code, (unsigned long)size2);
+}
+/*---------------------------------------------------------------------------*/
+/* Checks that the abandoned transfers have expired */
+static void
+test_expired(void)
+{
+  uint32_t size2;
+  int code;
+  int fd;
+  unsigned long errors = benchmark_errors;
+
+  /* the partial upload is removed, and downloads are served again */
+  code = get_block(&upload_stream, 0, &size2);
+  fd = cfs_open(UPLOAD_FILE, CFS_READ);
+  BENCHMARK_CHECK(code == NOT_FOUND_4_04 && fd < 0,
+                  "expired upload: code %d, file %s\n",
+                  code, fd >= 0 ? "kept" : "removed");
+  if(fd >= 0) {
+    cfs_close(fd);
+  }
+
+  code = get_block(&serve_stream, BLOCK_SIZE, &size2);
+  BENCHMARK_CHECK(code == CONTENT_2_05, "expired download: code %d\n", code);
+  coap_cfs_stream_close(&serve_stream);
+
+  printf("coap-block-cfs: abandoned transfers %s\n",
+         benchmark_errors == errors ? "OK" : "FAILED");
+}
+/*---------------------------------------------------------------------------*/
+/* Answers a request as the engine would, with the file behind it */
+static void
+server_input(coap_packet_t *request)
+{
+  static coap_packet_t response[1];
+  static int lost;
+  static uint8_t buffer[BLOCK_SIZE];
+  uint32_t block_num = 0;
+  uint16_t block_size = BLOCK_SIZE;
+  uint32_t block_offset = 0;
+  int32_t offset;
+  struct frame *f;
+
+  requests++;
+  coap_get_header_block2(request, &block_num, NULL, &block_size,
+                         &block_offset);
+  block_size = MIN(block_size, BLOCK_SIZE);
+  if(block_num < BLOCKS) {
+    repeated += requested[block_num]++ > 0;
+  }
+  if(block_num == LOST_BLOCK && !lost) {
+    lost = 1;
+    return;
+  }
+  if(num_frames == QUEUE_LEN) {
+    return;
+  }
+
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, request->mid);
+  coap_set_token(response, request->token, request->token_len);
+  offset = block_offset;
+  if(coap_block2_cfs_handler(request, response, buffer, block_size,
+                             &offset, &server_stream) < 0) {
+    coap_set_status_code(response, erbium_status_code);
+    coap_set_payload(response, coap_error_message,
+                     strlen(coap_error_message));
+    erbium_status_code = NO_ERROR;
+  } else {
+    coap_set_header_block2(response, block_num, offset != -1, block_size);
+  }
+
+  f = &frames[num_frames++];
+  f->due = clock_time() + 2 * LINK_DELAY;
+  f->len = coap_serialize_message(response, f->data);
+}
+/*---------------------------------------------------------------------------*/
+/* The output function of uIP, with the server behind it */
+static uint8_t
+output(const uip_lladdr_t *lladdr)
+{
+  static uint8_t data[UIP_BUFSIZE];
+  static coap_packet_t msg[1];
+  static uint16_t mids[2 * BLOCKS];
+  static int next;
+  uip_ds6_nbr_t *nbr;
+  uint16_t len;
+  int i;
+
+  if(UIP_IP_BUF->proto == UIP_PROTO_ICMP6) {
+    /* The server never answers neighbor solicitations; confirm it instead */
+    nbr = uip_ds6_nbr_lookup(&server_addr);
+    if(nbr != NULL) {
+      nbr->state = NBR_REACHABLE;
+      stimer_set(&nbr->reachable, UIP_ND6_REACHABLE_TIME / 1000);
+    }
+    return 1;
+  }
+  if(UIP_IP_BUF->proto != UIP_PROTO_UDP ||
+     UIP_UDP_BUF->destport != UIP_HTONS(SERVER_PORT)) {
+    return 1;
+  }
+  len = uip_len - UIP_IPUDPH_LEN;
+  memcpy(data, &uip_buf[UIP_IPUDPH_LEN], len);
+  if(coap_parse_message(msg, data, len) != NO_ERROR) {
+    return 1;
+  }
+
+  for(i = 0; i < 2 * BLOCKS; i++) {
+    if(mids[i] == msg->mid) {
+      retransmissions++;
+      break;
+    }
+  }
+  if(i == 2 * BLOCKS) {
+    mids[next] = msg->mid;
+    next = (next + 1) % (2 * BLOCKS);
+  }
+  server_input(msg);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+deliver(struct frame *f)
+{
+  uint16_t sum;
+
+  memset(uip_buf, 0, UIP_IPUDPH_LEN);
+  memcpy(&uip_buf[UIP_IPUDPH_LEN], f->data, f->len);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->len[0] = (UIP_UDPH_LEN + f->len) >> 8;
+  UIP_IP_BUF->len[1] = (UIP_UDPH_LEN + f->len) & 0xff;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &server_addr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &our_addr);
+  UIP_UDP_BUF->srcport = UIP_HTONS(SERVER_PORT);
+  UIP_UDP_BUF->destport = UIP_HTONS(COAP_DEFAULT_PORT);
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + f->len);
+
+  sum = UIP_UDPH_LEN + f->len + UIP_PROTO_UDP;
+  sum = uip_chksum_add(sum, (uint8_t *)&UIP_IP_BUF->srcipaddr,
+                       2 * sizeof(uip_ipaddr_t));
+  sum = uip_chksum_add(sum, &uip_buf[UIP_IPH_LEN], UIP_UDPH_LEN + f->len);
+  sum = ~sum;
+  UIP_UDP_BUF->udpchksum = sum == 0 ? 0xffff : uip_htons(sum);
+
+  uip_len = UIP_IPUDPH_LEN + f->len;
+  tcpip_input();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(link_process, ev, data)
+{
+  static struct etimer et;
+  static struct frame f;
+  int i;
+
+  PROCESS_BEGIN();
+
+  etimer_set(&et, 1);
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+    for(i = 0; i < num_frames;) {
+      if((long)(clock_time() - frames[i].due) < 0) {
+        i++;
+        continue;
+      }
+      /* take it off the queue first, as delivery may queue more */
+      f = frames[i];
+      memmove(&frames[i], &frames[i + 1],
+              (num_frames - i - 1) * sizeof(frames[0]));
+      num_frames--;
+      deliver(&f);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+block_handler(void *response)
+{
+  const uint8_t *payload;
+  int len = coap_get_payload(response, &payload);
+
+  if(((coap_packet_t *)response)->code != CONTENT_2_05 ||
+     !matches(payload, received, len)) {
+    corrupt++;
+  }
+  received += len;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_block_cfs_process, ev, data)
+{
+  static coap_packet_t request[1];
+  static struct etimer et;
+  static clock_time_t start;
+  uip_lladdr_t server_lladdr;
+
+  PROCESS_BEGIN();
+
+  rest_init_engine();
+
+  uip_ip6addr(&server_addr, 0xfe80, 0, 0, 0, 0, 0, 0, 2);
+  uip_ipaddr_copy(&our_addr, &uip_ds6_get_link_local(-1)->ipaddr);
+  memset(&server_lladdr, 0, sizeof(server_lladdr));
+  server_lladdr.addr[sizeof(server_lladdr.addr) - 1] = 2;
+  uip_ds6_nbr_add(&server_addr, &server_lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_UNDEFINED, NULL);
+  tcpip_set_outputfunc(output);
+  process_start(&link_process, NULL);
+
+  /* let the CoAP engine start */
+  PROCESS_PAUSE();
+
+  BENCHMARK_CHECK(write_source(FILE_SIZE), "source file not written\n");
+  test_upload();
+  test_serve();
+
+  test_abandon();
+  etimer_set(&et, COAP_BLOCK_CFS_IDLE_TIMEOUT + 1);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  test_expired();
+  BENCHMARK_CHECK(write_source(FILE_SIZE), "source file not written\n");
+
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_uri_path(request, "file");
+  start = clock_time();
+  COAP_BLOCKING_REQUEST(&server_addr, UIP_HTONS(SERVER_PORT), request,
+                        block_handler);
+
+  printf("coap-block-cfs: downloaded %ld bytes in %lu ms, %d in flight, %d ms RTT, %lu requests (%lu retransmissions, %lu repeated)\n",
+         (long)received,
+         (unsigned long)((clock_time() - start) * 1000 / CLOCK_SECOND),
+         COAP_BLOCK2_PIPELINE, (int)(2 * LINK_DELAY * 1000 / CLOCK_SECOND),
+         requests, retransmissions, repeated);
+  BENCHMARK_CHECK(received == FILE_SIZE && corrupt == 0,
+                  "downloaded %ld bytes, %d corrupt\n",
+                  (long)received, corrupt);
+
+  cfs_remove(SOURCE_FILE);
+  cfs_remove(UPLOAD_FILE);
+
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         CoAP congestion control benchmark. Sends confirmable requests
+ *         to a server emulated behind a lossy multi-hop path, first one
+ *         at a time and then with eight in flight, and reports the
+ *         completion time along with the retransmissions that were
+ *         needed and those that came too early.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "net/ip/uip-chksum.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "lib/random.h"
+#include "rest-engine.h"
+#include "er-coap-engine.h"
+
+#define BENCHMARK_NAME "coap-cocoa"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REQUESTS 30
+#define SERVER_PORT 5684
+#define RUN_TIMEOUT (180 * CLOCK_SECOND)
+
+/* One-way delay of 150 to 300 ms, as over a few 6LoWPAN hops, and 10%
+   loss in each direction */
+#define LINK_DELAY (CLOCK_SECOND * 15 / 100)
+#define LINK_JITTER (CLOCK_SECOND * 15 / 100)
+#define LOSS_PERCENT 10
+
+#define QUEUE_LEN 32
+
+PROCESS(coap_cocoa_process, "CoAP congestion control benchmark");
+AUTOSTART_PROCESSES(&coap_cocoa_process);
+
+/* Responses on their way from the server */
+static struct frame {
+  clock_time_t due;
+  uint16_t mid;
+  uint16_t len;
+  uint8_t data[32];
+} frames[QUEUE_LEN];
+static int num_frames;
+
+static uip_ipaddr_t server_addr;
+static uip_ipaddr_t our_addr;
+
+static int in_flight;
+static int completed;
+static int failed;
+static unsigned long transmissions;
+static unsigned long retransmissions;
+static unsigned long spurious;
+static unsigned long lost;
+/*---------------------------------------------------------------------------*/
+static clock_time_t
+link_delay(void)
+{
+  return LINK_DELAY + random_rand() % (LINK_JITTER + 1);
+}
+/*---------------------------------------------------------------------------*/
+static int
+link_lost(void)
+{
+  if(random_rand() % 100 < LOSS_PERCENT) {
+    lost++;
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+server_input(coap_packet_t *request)
+{
+  static coap_packet_t response[1];
+  struct frame *f;
+  clock_time_t delay;
+  int i;
+
+  transmissions++;
+  for(i = 0; i < num_frames; i++) {
+    if(frames[i].mid == request->mid) {
+      /* the response is already on its way */
+      spurious++;
+      break;
+    }
+  }
+  delay = link_delay();
+  if(link_lost() || num_frames == QUEUE_LEN) {
+    return;
+  }
+  delay += link_delay();
+  if(link_lost()) {
+    return;
+  }
+
+  f = &frames[num_frames++];
+  f->due = clock_time() + delay;
+  f->mid = request->mid;
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, request->mid);
+  coap_set_token(response, request->token, request->token_len);
+  coap_set_payload(response, "ok", 2);
+  f->len = coap_serialize_message(response, f->data);
+}
+/*---------------------------------------------------------------------------*/
+/* The output function of uIP, with the server behind it */
+static uint8_t
+output(const uip_lladdr_t *lladdr)
+{
+  static uint8_t data[UIP_BUFSIZE];
+  static coap_packet_t msg[1];
+  static uint16_t last_mid[REQUESTS];
+  static int next;
+  uip_ds6_nbr_t *nbr;
+  uint16_t len;
+  int i;
+
+  if(UIP_IP_BUF->proto == UIP_PROTO_ICMP6) {
+    /* The server never answers neighbor solicitations; confirm it instead */
+    nbr = uip_ds6_nbr_lookup(&server_addr);
+    if(nbr != NULL) {
+      nbr->state = NBR_REACHABLE;
+      stimer_set(&nbr->reachable, UIP_ND6_REACHABLE_TIME / 1000);
+    }
+    return 1;
+  }
+  if(UIP_IP_BUF->proto != UIP_PROTO_UDP ||
+     UIP_UDP_BUF->destport != UIP_HTONS(SERVER_PORT)) {
+    return 1;
+  }
+  len = uip_len - UIP_IPUDPH_LEN;
+  memcpy(data, &uip_buf[UIP_IPUDPH_LEN], len);
+  if(coap_parse_message(msg, data, len) != NO_ERROR) {
+    return 1;
+  }
+
+  /* Retransmissions carry the MID of a recent transmission */
+  for(i = 0; i < REQUESTS; i++) {
+    if(last_mid[i] == msg->mid) {
+      retransmissions++;
+      break;
+    }
+  }
+  if(i == REQUESTS) {
+    last_mid[next] = msg->mid;
+    next = (next + 1) % REQUESTS;
+  }
+  server_input(msg);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+deliver(struct frame *f)
+{
+  uint16_t sum;
+
+  memset(uip_buf, 0, UIP_IPUDPH_LEN);
+  memcpy(&uip_buf[UIP_IPUDPH_LEN], f->data, f->len);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->len[0] = (UIP_UDPH_LEN + f->len) >> 8;
+  UIP_IP_BUF->len[1] = (UIP_UDPH_LEN + f->len) & 0xff;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &server_addr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &our_addr);
+  UIP_UDP_BUF->srcport = UIP_HTONS(SERVER_PORT);
+  UIP_UDP_BUF->destport = UIP_HTONS(COAP_DEFAULT_PORT);
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + f->len);
+
+  sum = UIP_UDPH_LEN + f->len + UIP_PROTO_UDP;
+  sum = uip_chksum_add(sum, (uint8_t *)&UIP_IP_BUF->srcipaddr,
+                       2 * sizeof(uip_ipaddr_t));
+  sum = uip_chksum_add(sum, &uip_buf[UIP_IPH_LEN], UIP_UDPH_LEN + f->len);
+  sum = ~sum;
+  UIP_UDP_BUF->udpchksum = sum == 0 ? 0xffff : uip_htons(sum);
+
+  uip_len = UIP_IPUDPH_LEN + f->len;
+  tcpip_input();
+}
+/*---------------------------------------------------------------------------*/
+static void
+deliver_due(void)
+{
+  static struct frame f;
+  int i;
+
+  for(i = 0; i < num_frames;) {
+    if((long)(clock_time() - frames[i].due) < 0) {
+      i++;
+      continue;
+    }
+    /* take it off the queue first, as delivery may queue more */
+    f = frames[i];
+    frames[i] = frames[--num_frames];
+    deliver(&f);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+response_handler(void *data, void *response)
+{
+  const uint8_t *payload;
+
+  in_flight--;
+  if(response == NULL ||
+     coap_get_payload(response, &payload) != 2 ||
+     memcmp(payload, "ok", 2) != 0) {
+    failed++;
+  } else {
+    completed++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+request(void)
+{
+  static coap_packet_t msg[1];
+  coap_transaction_t *t;
+  uint16_t mid;
+
+  mid = coap_get_mid();
+  t = coap_new_transaction(mid, &server_addr, UIP_HTONS(SERVER_PORT));
+  if(t == NULL) {
+    return 0;
+  }
+  t->callback = response_handler;
+  coap_init_message(msg, COAP_TYPE_CON, COAP_GET, mid);
+  coap_set_header_uri_path(msg, "sensor");
+  coap_set_token(msg, (uint8_t *)&mid, sizeof(mid));
+  t->packet_len = coap_serialize_message(msg, t->packet);
+  in_flight++;
+  coap_send_transaction(t);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, clock_time_t elapsed)
+{
+#if COAP_CONGESTION_CONTROL
+  const coap_peer_t *p = coap_get_peer(&server_addr);
+
+  printf("coap-cocoa: %s: %d requests in %lu ms, %lu transmissions, %lu retransmissions (%lu spurious), %lu lost, %d failed, RTO %lu ms, SRTT %lu ms\n",
+         name, completed, (unsigned long)(elapsed * 1000 / CLOCK_SECOND),
+         transmissions, retransmissions, spurious, lost, failed,
+         p ? (unsigned long)(p->rto * 1000 / CLOCK_SECOND) : 0,
+         p ? (unsigned long)((p->strong_srtt >> 3) * 1000 / CLOCK_SECOND) : 0);
+#else /* COAP_CONGESTION_CONTROL */
+  printf("coap-cocoa: %s: %d requests in %lu ms, %lu transmissions, %lu retransmissions (%lu spurious), %lu lost, %d failed\n",
+         name, completed, (unsigned long)(elapsed * 1000 / CLOCK_SECOND),
+         transmissions, retransmissions, spurious, lost, failed);
+#endif /* COAP_CONGESTION_CONTROL */
+  BENCHMARK_CHECK(completed == REQUESTS && failed == 0,
+                  "%s: %d of %d requests completed\n", name, completed,
+                  REQUESTS);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_cocoa_process, ev, data)
+{
+  static const struct {
+    const char *name;
+    int window;
+  } runs[] = {
+    { "one at a time", 1 },
+    { "eight in flight", 8 },
+  };
+  static struct etimer et;
+  static clock_time_t start;
+  static int run;
+  static int issued;
+  uip_lladdr_t server_lladdr;
+
+  PROCESS_BEGIN();
+
+  random_init(1);
+  rest_init_engine();
+
+  uip_ip6addr(&server_addr, 0xfe80, 0, 0, 0, 0, 0, 0, 2);
+  uip_ipaddr_copy(&our_addr, &uip_ds6_get_link_local(-1)->ipaddr);
+  memset(&server_lladdr, 0, sizeof(server_lladdr));
+  server_lladdr.addr[sizeof(server_lladdr.addr) - 1] = 2;
+  uip_ds6_nbr_add(&server_addr, &server_lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_UNDEFINED, NULL);
+  tcpip_set_outputfunc(output);
+
+  /* let the CoAP engine start */
+  PROCESS_PAUSE();
+
+  printf("coap-cocoa: congestion control %d, NSTART %d, %d-%d ms one-way delay, %d%% loss\n",
+         COAP_CONGESTION_CONTROL, COAP_NSTART,
+         (int)(LINK_DELAY * 1000 / CLOCK_SECOND),
+         (int)((LINK_DELAY + LINK_JITTER) * 1000 / CLOCK_SECOND),
+         LOSS_PERCENT);
+
+  for(run = 0; run < sizeof(runs) / sizeof(runs[0]); run++) {
+    completed = failed = 0;
+    transmissions = retransmissions = spurious = lost = 0;
+    issued = 0;
+    start = clock_time();
+    etimer_set(&et, 1);
+    while(completed + failed < REQUESTS &&
+          clock_time() - start < RUN_TIMEOUT) {
+      while(issued < REQUESTS && in_flight < runs[run].window &&
+            request()) {
+        issued++;
+      }
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+      etimer_reset(&et);
+      deliver_due();
+    }
+    report(runs[run].name, clock_time() - start);
+  }
+
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
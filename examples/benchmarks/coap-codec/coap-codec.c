@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         CoAP parse and serialize benchmark. Parses a request with
+ *         repeated Uri-Path and Uri-Query options, walks its options in
+ *         place and serializes responses with payloads of increasing
+ *         size, both by copying the payload behind the header and in
+ *         place in front of it. The results are checked first.
+ */
+
+#include "contiki.h"
+#include "er-coap.h"
+
+#define BENCHMARK_NAME "coap-codec"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ROUNDS 1000000UL
+
+PROCESS(coap_codec_process, "CoAP codec benchmark");
+AUTOSTART_PROCESSES(&coap_codec_process);
+
+static const uint8_t token[] = { 0xde, 0xad, 0xbe, 0xef };
+
+/* the options of the request, in order */
+static const struct {
+  unsigned int number;
+  const char *value;
+} options[] = {
+  { COAP_OPTION_URI_PATH, "sensors" },
+  { COAP_OPTION_URI_PATH, "temp" },
+  { COAP_OPTION_URI_PATH, "current" },
+  { COAP_OPTION_URI_QUERY, "unit=c" },
+  { COAP_OPTION_URI_QUERY, "avg=10" },
+  { COAP_OPTION_ACCEPT, NULL },
+  { COAP_OPTION_BLOCK2, NULL },
+};
+#define OPTIONS (sizeof(options) / sizeof(options[0]))
+
+static uint8_t request[64];
+static uint16_t request_len;
+static coap_packet_t packet[1];
+static uint8_t buffer[COAP_MAX_PACKET_SIZE + 1];
+static uint8_t reference[COAP_MAX_PACKET_SIZE + 1];
+/*---------------------------------------------------------------------------*/
+static unsigned long
+ns_per_round(clock_time_t elapsed)
+{
+  return (unsigned long)((unsigned long long)elapsed * 1000000000ULL
+                         / CLOCK_SECOND / ROUNDS);
+}
+/*---------------------------------------------------------------------------*/
+static int
+walk(coap_packet_t *pkt)
+{
+  coap_option_iterator_t it;
+  unsigned int number;
+  const uint8_t *value;
+  size_t length;
+  int i;
+
+  coap_option_iterator_init(&it, pkt);
+  for(i = 0; coap_option_next(&it, &number, &value, &length); i++) {
+    if(i >= OPTIONS || number != options[i].number
+       || (options[i].value != NULL
+           && (length != strlen(options[i].value)
+               || memcmp(value, options[i].value, length) != 0))) {
+      return 0;
+    }
+  }
+  return i == OPTIONS && it.pos != NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_parse(void)
+{
+  const char *str;
+  uint16_t len;
+
+  coap_init_message(packet, COAP_TYPE_CON, COAP_GET, 0x1234);
+  coap_set_token(packet, token, sizeof(token));
+  coap_set_header_uri_path(packet, "sensors/temp/current");
+  coap_set_header_uri_query(packet, "unit=c&avg=10");
+  coap_set_header_accept(packet, APPLICATION_JSON);
+  coap_set_header_block2(packet, 0, 0, 64);
+  request_len = coap_serialize_message(packet, request);
+
+  memcpy(buffer, request, request_len);
+  if(coap_parse_message(packet, buffer, request_len) != NO_ERROR) {
+    BENCHMARK_FAIL("cannot parse the request\n");
+    return;
+  }
+  BENCHMARK_CHECK(walk(packet), "options walked wrongly\n");
+  BENCHMARK_CHECK(memcmp(buffer, request, request_len) == 0,
+                  "parsing changed the message\n");
+  BENCHMARK_CHECK(coap_get_header_uri_path(packet, &str) == 20 &&
+                  memcmp(str, "sensors/temp/current", 20) == 0 &&
+                  coap_get_header_uri_query(packet, &str) == 13 &&
+                  memcmp(str, "unit=c&avg=10", 13) == 0 &&
+                  coap_get_query_variable(packet, "avg", &str) == 2 &&
+                  memcmp(str, "10", 2) == 0,
+                  "options joined wrongly\n");
+
+  /* both repeated options are joined on the first request for one */
+  coap_init_message(packet, COAP_TYPE_ACK, CREATED_2_01, 0x1235);
+  coap_set_header_location_path(packet, "store/42?v=1&t=2");
+  len = coap_serialize_message(packet, buffer);
+  BENCHMARK_CHECK(coap_parse_message(packet, buffer, len) == NO_ERROR &&
+                  coap_get_header_location_query(packet, &str) == 7 &&
+                  memcmp(str, "v=1&t=2", 7) == 0 &&
+                  coap_get_header_location_path(packet, &str) == 8 &&
+                  memcmp(str, "store/42", 8) == 0,
+                  "location joined wrongly\n");
+
+  /* the Block2 value runs past the end */
+  memcpy(buffer, request, request_len);
+  BENCHMARK_CHECK(coap_parse_message(packet, buffer, request_len - 1)
+                  != NO_ERROR, "truncated option accepted\n");
+}
+/*---------------------------------------------------------------------------*/
+static void
+prepare_response(uint16_t size)
+{
+  uint8_t *payload = buffer + COAP_MAX_HEADER_SIZE;
+  uint16_t i;
+
+  coap_init_message(packet, COAP_TYPE_ACK, CONTENT_2_05, 0x1234);
+  coap_set_token(packet, token, sizeof(token));
+  coap_set_header_content_format(packet, APPLICATION_JSON);
+  coap_set_header_block2(packet, 1, 1, 64);
+  /* written where the engine has the resource handlers write it */
+  for(i = 0; i < size; i++) {
+    payload[i] = (uint8_t)i;
+  }
+  coap_set_payload(packet, payload, size);
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_serialize(uint16_t size)
+{
+  size_t len;
+  size_t ref_len;
+
+  prepare_response(size);
+  ref_len = coap_serialize_message(packet, reference);
+
+  prepare_response(size);
+  len = coap_serialize_message_in_place(packet, buffer);
+  if(len != ref_len || memcmp(packet->buffer, reference, len) != 0) {
+    BENCHMARK_FAIL("%u B payload serialized wrongly in place\n", size);
+    return;
+  }
+  BENCHMARK_CHECK(packet->buffer + len == buffer + COAP_MAX_HEADER_SIZE + size,
+                  "%u B payload moved\n", size);
+}
+/*---------------------------------------------------------------------------*/
+static void
+time_parse(void)
+{
+  const char *path;
+  unsigned long i;
+  clock_time_t start;
+  clock_time_t parse, iterate, join;
+
+  memcpy(buffer, request, request_len);
+  start = clock_time();
+  for(i = 0; i < ROUNDS; i++) {
+    coap_parse_message(packet, buffer, request_len);
+  }
+  parse = clock_time() - start;
+
+  start = clock_time();
+  for(i = 0; i < ROUNDS; i++) {
+    walk(packet);
+  }
+  iterate = clock_time() - start;
+
+  /* joining changes the message, so it is restored every time */
+  start = clock_time();
+  for(i = 0; i < ROUNDS; i++) {
+    memcpy(buffer, request, request_len);
+    coap_parse_message(packet, buffer, request_len);
+    coap_get_header_uri_path(packet, &path);
+  }
+  join = clock_time() - start;
+
+  printf("coap-codec: %u B request with %u options: parse %lu ns, walk %lu ns, parse and join %lu ns\n",
+         request_len, (unsigned)OPTIONS, ns_per_round(parse),
+         ns_per_round(iterate), ns_per_round(join));
+}
+/*---------------------------------------------------------------------------*/
+static void
+time_serialize(uint16_t size)
+{
+  unsigned long i;
+  clock_time_t start;
+  clock_time_t copy, in_place;
+  size_t len;
+  size_t moved;
+
+  prepare_response(size);
+  start = clock_time();
+  for(i = 0; i < ROUNDS; i++) {
+    coap_serialize_message(packet, buffer);
+  }
+  copy = clock_time() - start;
+
+  prepare_response(size);
+  start = clock_time();
+  for(i = 0; i < ROUNDS; i++) {
+    len = coap_serialize_message_in_place(packet, buffer);
+  }
+  in_place = clock_time() - start;
+
+  /* either the header or the payload was moved */
+  moved = packet->buffer != buffer ? len - 1 - size : size;
+
+  printf("coap-codec: %3u B payload: serialize %lu ns (moves %u B), in place %lu ns (moves %u B)\n",
+         size, ns_per_round(copy), size, ns_per_round(in_place),
+         (unsigned)moved);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_codec_process, ev, data)
+{
+  uint16_t size;
+
+  PROCESS_BEGIN();
+
+  check_parse();
+  for(size = 16; size <= REST_MAX_CHUNK_SIZE; size *= 2) {
+    check_serialize(size);
+  }
+
+  if(benchmark_errors == 0) {
+    time_parse();
+    for(size = 8; size <= REST_MAX_CHUNK_SIZE; size *= 4) {
+      time_serialize(size);
+    }
+  }
+
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
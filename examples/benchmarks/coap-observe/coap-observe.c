@@ -0,0 +1,368 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         CoAP observe fan-out benchmark. Registers more observers than
+ *         there are open transactions and notifies them all, with some
+ *         observers losing the first ACK of every confirmable
+ *         notification and one answering with a RST. Every notification
+ *         is checked for Token, Observe sequence and payload.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "net/ip/uip-chksum.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "rest-engine.h"
+#include "er-coap-engine.h"
+
+#define BENCHMARK_NAME "coap-observe"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OBSERVERS COAP_MAX_OBSERVERS
+#define NOTIFICATIONS 50
+#define TIMED_NOTIFICATIONS 1000
+#define PEER_PORT 5000
+#define RUN_TIMEOUT (30 * CLOCK_SECOND)
+
+/* Observers that lose the first ACK of every confirmable notification */
+#define LOSSY(i) ((i) % 8 == 1)
+/* The observer that cancels with a RST */
+#define RESETTING(i) ((i) == OBSERVERS - 1)
+
+PROCESS(coap_observe_process, "CoAP observe benchmark");
+AUTOSTART_PROCESSES(&coap_observe_process);
+
+static void get_handler(void *request, void *response, uint8_t *buffer,
+                        uint16_t preferred_size, int32_t *offset);
+
+EVENT_RESOURCE(res_obs, "obs", get_handler, NULL, NULL, NULL, NULL);
+
+static struct {
+  uint8_t registered;
+  uint8_t reset;
+  uint8_t notified;
+  uint32_t observe;
+  uint32_t value;
+  uint16_t con_mid;
+  uint16_t received;
+  uint16_t con;
+  uint16_t retransmissions;
+  uint16_t errors;
+} peers[OBSERVERS];
+
+/* ACKs and RSTs to be sent by the observers */
+static struct {
+  uint16_t port;
+  uint16_t mid;
+  coap_message_type_t type;
+} replies[2 * OBSERVERS];
+static int num_replies;
+
+static uip_ipaddr_t peer_addr;
+static uip_ipaddr_t our_addr;
+static uint32_t value;
+static uint8_t timing;
+static unsigned long sent;
+/*---------------------------------------------------------------------------*/
+static void
+get_handler(void *request, void *response, uint8_t *buffer,
+            uint16_t preferred_size, int32_t *offset)
+{
+  REST.set_header_content_type(response, REST.type.TEXT_PLAIN);
+  REST.set_response_payload(response, buffer,
+                            snprintf((char *)buffer, preferred_size,
+                                     "%lu", (unsigned long)value));
+}
+/*---------------------------------------------------------------------------*/
+static void
+queue_reply(int i, uint16_t mid, coap_message_type_t type)
+{
+  if(num_replies < sizeof(replies) / sizeof(replies[0])) {
+    replies[num_replies].port = PEER_PORT + i;
+    replies[num_replies].mid = mid;
+    replies[num_replies].type = type;
+    num_replies++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+notification_input(int i, coap_packet_t *msg)
+{
+  uint32_t observe;
+  unsigned long v;
+
+  if(!coap_get_header_observe(msg, &observe) || msg->token_len != 2 ||
+     msg->token[0] != 0xa0 || msg->token[1] != i ||
+     msg->payload_len == 0 || peers[i].reset) {
+    peers[i].errors++;
+    return;
+  }
+  v = strtoul((const char *)msg->payload, NULL, 10);
+  peers[i].received++;
+
+  if(msg->type == COAP_TYPE_CON && msg->mid == peers[i].con_mid) {
+    /* Retransmission: the representation may be newer, the Observe
+       value is the one last sent */
+    peers[i].retransmissions++;
+    if(observe != peers[i].observe || v < peers[i].value) {
+      peers[i].errors++;
+    }
+  } else if(peers[i].notified &&
+            ((observe - peers[i].observe) & 0xffffff) >= 0x800000) {
+    peers[i].errors++;
+  }
+  peers[i].notified = 1;
+  peers[i].observe = observe;
+  peers[i].value = v;
+
+  if(msg->type == COAP_TYPE_CON) {
+    peers[i].con++;
+    if(RESETTING(i)) {
+      peers[i].reset = 1;
+      queue_reply(i, msg->mid, COAP_TYPE_RST);
+    } else if(msg->mid == peers[i].con_mid || !LOSSY(i)) {
+      queue_reply(i, msg->mid, COAP_TYPE_ACK);
+    }
+    peers[i].con_mid = msg->mid;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The output function of uIP, with the observers behind it */
+static uint8_t
+output(const uip_lladdr_t *lladdr)
+{
+  static uint8_t data[UIP_BUFSIZE];
+  static coap_packet_t msg[1];
+  uint16_t len;
+  int i;
+
+  sent++;
+  if(timing || UIP_IP_BUF->proto != UIP_PROTO_UDP) {
+    return 1;
+  }
+  i = uip_ntohs(UIP_UDP_BUF->destport) - PEER_PORT;
+  if(i < 0 || i >= OBSERVERS) {
+    return 1;
+  }
+  len = uip_len - UIP_IPUDPH_LEN;
+  memcpy(data, &uip_buf[UIP_IPUDPH_LEN], len);
+  if(coap_parse_message(msg, data, len) != NO_ERROR) {
+    peers[i].errors++;
+    return 1;
+  }
+
+  if(msg->type == COAP_TYPE_ACK && !peers[i].registered) {
+    if(msg->code == CONTENT_2_05 && IS_OPTION(msg, COAP_OPTION_OBSERVE)) {
+      peers[i].registered = 1;
+    }
+  } else {
+    notification_input(i, msg);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+peer_send(int i, coap_packet_t *msg)
+{
+  uint16_t len;
+  uint16_t sum;
+
+  len = coap_serialize_message(msg, &uip_buf[UIP_IPUDPH_LEN]);
+  memset(uip_buf, 0, UIP_IPUDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->len[0] = (UIP_UDPH_LEN + len) >> 8;
+  UIP_IP_BUF->len[1] = (UIP_UDPH_LEN + len) & 0xff;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &peer_addr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &our_addr);
+  UIP_UDP_BUF->srcport = UIP_HTONS(PEER_PORT + i);
+  UIP_UDP_BUF->destport = UIP_HTONS(COAP_DEFAULT_PORT);
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + len);
+
+  sum = UIP_UDPH_LEN + len + UIP_PROTO_UDP;
+  sum = uip_chksum_add(sum, (uint8_t *)&UIP_IP_BUF->srcipaddr,
+                       2 * sizeof(uip_ipaddr_t));
+  sum = uip_chksum_add(sum, &uip_buf[UIP_IPH_LEN], UIP_UDPH_LEN + len);
+  sum = ~sum;
+  UIP_UDP_BUF->udpchksum = sum == 0 ? 0xffff : uip_htons(sum);
+
+  uip_len = UIP_IPUDPH_LEN + len;
+  tcpip_input();
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_replies(void)
+{
+  static coap_packet_t msg[1];
+  int r;
+
+  for(r = 0; r < num_replies; r++) {
+    coap_init_message(msg, replies[r].type, 0, replies[r].mid);
+    peer_send(replies[r].port - PEER_PORT, msg);
+  }
+  num_replies = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+subscribe(int i)
+{
+  static coap_packet_t msg[1];
+  uint8_t token[2] = { 0xa0, i };
+
+  coap_init_message(msg, COAP_TYPE_CON, COAP_GET, coap_get_mid());
+  coap_set_header_uri_path(msg, "obs");
+  coap_set_header_observe(msg, 0);
+  coap_set_token(msg, token, sizeof(token));
+  peer_send(i, msg);
+}
+/*---------------------------------------------------------------------------*/
+static int
+con_pending(void)
+{
+  coap_observer_t *obs;
+
+  for(obs = list_head(coap_get_observers()); obs != NULL; obs = obs->next) {
+    if(obs->con_pending) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(void)
+{
+  unsigned long received = 0;
+  unsigned long con = 0;
+  unsigned long retransmissions = 0;
+  unsigned long errors = benchmark_errors;
+  int i;
+
+  for(i = 0; i < OBSERVERS; i++) {
+    received += peers[i].received;
+    con += peers[i].con;
+    retransmissions += peers[i].retransmissions;
+    BENCHMARK_CHECK(peers[i].errors == 0,
+                    "observer %d got %u bad notifications\n", i,
+                    peers[i].errors);
+    if(!peers[i].registered) {
+      BENCHMARK_FAIL("observer %d not registered\n", i);
+    } else if(RESETTING(i)) {
+      BENCHMARK_CHECK(peers[i].reset, "observer %d not reset\n", i);
+    } else {
+      BENCHMARK_CHECK(peers[i].value == value,
+                      "observer %d has %lu, not %lu\n", i,
+                      (unsigned long)peers[i].value, (unsigned long)value);
+    }
+  }
+  printf("coap-observe: %d observers, %d notifications, %lu received (%lu CON, %lu retransmitted), %lu errors\n",
+         OBSERVERS, NOTIFICATIONS, received, con, retransmissions,
+         benchmark_errors - errors);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_observe_process, ev, data)
+{
+  static struct etimer et;
+  static clock_time_t start;
+  static int i;
+  clock_time_t elapsed;
+  uip_lladdr_t peer_lladdr;
+
+  PROCESS_BEGIN();
+
+  printf("coap-observe: observer state %u bytes, transaction %u bytes\n",
+         (unsigned)sizeof(coap_observer_t),
+         (unsigned)sizeof(coap_transaction_t));
+
+  rest_init_engine();
+  rest_activate_resource(&res_obs, "obs");
+  res_obs.flags |= IS_OBSERVABLE;
+
+  uip_ip6addr(&peer_addr, 0xfe80, 0, 0, 0, 0, 0, 0, 2);
+  uip_ipaddr_copy(&our_addr, &uip_ds6_get_link_local(-1)->ipaddr);
+  memset(&peer_lladdr, 0, sizeof(peer_lladdr));
+  peer_lladdr.addr[sizeof(peer_lladdr.addr) - 1] = 2;
+  uip_ds6_nbr_add(&peer_addr, &peer_lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_UNDEFINED, NULL);
+  tcpip_set_outputfunc(output);
+
+  /* let the CoAP engine start */
+  PROCESS_PAUSE();
+
+  for(i = 0; i < OBSERVERS; i++) {
+    subscribe(i);
+  }
+
+  /* A notification every 100 ms, then wait for the confirmable ones */
+  start = clock_time();
+  etimer_set(&et, CLOCK_SECOND / 10);
+  for(i = 0; i < NOTIFICATIONS || con_pending(); i++) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+    if(i < NOTIFICATIONS) {
+      value++;
+      REST.notify_subscribers(&res_obs);
+    }
+    send_replies();
+    if(clock_time() - start > RUN_TIMEOUT) {
+      printf("coap-observe: confirmable notifications still pending\n");
+      break;
+    }
+  }
+  report();
+
+  /* Fan-out cost, with nobody answering */
+  timing = 1;
+  sent = 0;
+  start = clock_time();
+  for(i = 0; i < TIMED_NOTIFICATIONS; i++) {
+    value++;
+    REST.notify_subscribers(&res_obs);
+  }
+  elapsed = clock_time() - start;
+  printf("coap-observe: %d notifications, %lu messages in %lu ms (%lu ns/message)\n",
+         TIMED_NOTIFICATIONS, sent, (unsigned long)elapsed,
+         sent ? (unsigned long)(elapsed * 1000000UL / sent) : 0);
+
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
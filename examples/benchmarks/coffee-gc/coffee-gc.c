@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Coffee garbage collection benchmark. Replaces files in turn,
+ *         like a rotating log, and counts the flash operations done by
+ *         file removals and reservations and by the incremental garbage
+ *         collector.
+ */
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+#include "dev/xmem.h"
+#include "lib/random.h"
+
+#define BENCHMARK_NAME "coffee-gc"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_FILES   20
+#define FILE_SIZE   16384
+#define REPLACES    2000UL
+
+/* The flash of the native platform, accessed through Coffee. */
+#define FLASH_SIZE  (1024UL * 1024UL)
+
+PROCESS(coffee_gc_bench_process, "Coffee GC benchmark");
+AUTOSTART_PROCESSES(&coffee_gc_bench_process);
+
+#if COFFEE_INCREMENTAL_GC
+PROCESS_NAME(coffee_gc_process);
+#define IN_GC()  (PROCESS_CURRENT() == &coffee_gc_process)
+#else
+#define IN_GC()  0
+#endif /* COFFEE_INCREMENTAL_GC */
+
+static unsigned char flash[FLASH_SIZE];
+static unsigned char buf[FILE_SIZE];
+static unsigned char generation[NUM_FILES];
+
+/* Flash operations in the benchmark process and in the collector. */
+static unsigned long fg_erases, fg_reads;
+static unsigned long bg_erases, bg_reads;
+/* Each time the benchmark process runs, the collector has run at most
+   one slice since the previous time. */
+static unsigned long bench_runs, slice_run;
+static unsigned long slices, slice_reads, max_slice_reads;
+static unsigned long slice_erases, max_slice_erases;
+static unsigned long op_erases, max_op_erases;
+/*---------------------------------------------------------------------------*/
+static void
+start_slice(void)
+{
+  if(slice_run != bench_runs) {
+    slice_run = bench_runs;
+    slices++;
+    slice_reads = 0;
+    slice_erases = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+count_read(void)
+{
+  if(!IN_GC()) {
+    fg_reads++;
+    return;
+  }
+  bg_reads++;
+  start_slice();
+  if(++slice_reads > max_slice_reads) {
+    max_slice_reads = slice_reads;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+xmem_init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_pread(void *p, int size, unsigned long offset)
+{
+  count_read();
+  memcpy(p, &flash[offset], size);
+  return size;
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_pwrite(const void *p, int size, unsigned long offset)
+{
+  memcpy(&flash[offset], p, size);
+  return size;
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_erase(long size, unsigned long offset)
+{
+  if(IN_GC()) {
+    bg_erases++;
+    start_slice();
+    if(++slice_erases > max_slice_erases) {
+      max_slice_erases = slice_erases;
+    }
+  } else {
+    fg_erases++;
+    op_erases++;
+  }
+  memset(&flash[offset], 0, size);
+  return size;
+}
+/*---------------------------------------------------------------------------*/
+static void
+fill(int i)
+{
+  /* Coffee finds the end of a file by its last nonzero byte. */
+  memset(buf, 1 + (i * 16 + generation[i]) % 255, sizeof(buf));
+}
+/*---------------------------------------------------------------------------*/
+static void
+replace(int i)
+{
+  char name[16];
+  int fd;
+  int ok;
+
+  snprintf(name, sizeof(name), "file-%d", i);
+  op_erases = 0;
+  cfs_remove(name);
+  generation[i] = (generation[i] + 1) & 0xf;
+  ok = cfs_coffee_reserve(name, FILE_SIZE) == 0;
+  fd = cfs_open(name, CFS_WRITE);
+  fill(i);
+  ok &= fd >= 0 && cfs_write(fd, buf, sizeof(buf)) == sizeof(buf);
+  cfs_close(fd);
+  if(op_erases > max_op_erases) {
+    max_op_erases = op_erases;
+  }
+  BENCHMARK_CHECK(ok, "failed to replace %s\n", name);
+}
+/*---------------------------------------------------------------------------*/
+static void
+verify(int i)
+{
+  static unsigned char data[FILE_SIZE];
+  char name[16];
+  int fd;
+  int ok;
+
+  snprintf(name, sizeof(name), "file-%d", i);
+  fd = cfs_open(name, CFS_READ);
+  fill(i);
+  ok = fd >= 0 && cfs_read(fd, data, sizeof(data)) == sizeof(data) &&
+    memcmp(data, buf, sizeof(data)) == 0;
+  cfs_close(fd);
+  BENCHMARK_CHECK(ok, "wrong contents in %s\n", name);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coffee_gc_bench_process, ev, data)
+{
+  static unsigned long n;
+  static unsigned long start, elapsed;
+  int i;
+
+  PROCESS_BEGIN();
+
+  random_init(1);
+  cfs_coffee_format();
+  for(i = 0; i < NUM_FILES; i++) {
+    replace(i);
+  }
+  fg_erases = fg_reads = 0;
+
+  elapsed = 0;
+  for(n = 0; benchmark_errors == 0 && n < REPLACES; n++) {
+    start = benchmark_cpu_time_us();
+    replace(n % NUM_FILES);
+    verify(random_rand() % NUM_FILES);
+    elapsed += benchmark_cpu_time_us() - start;
+
+    /* Let the collector run a slice. */
+    PROCESS_PAUSE();
+    bench_runs++;
+  }
+  for(i = 0; benchmark_errors == 0 && i < NUM_FILES; i++) {
+    verify(i);
+  }
+
+  printf("coffee-gc: incremental %d, %lu replacements of %d byte files in %lu us (%lu us/op)\n",
+         COFFEE_INCREMENTAL_GC, n, FILE_SIZE, elapsed,
+         n > 0 ? elapsed / n : 0);
+  printf("coffee-gc: in file operations %lu erases (at most %lu per replacement)\n",
+         fg_erases, max_op_erases);
+  printf("coffee-gc: in the collector %lu erases, %lu reads in %lu slices (at most %lu and %lu per slice)\n",
+         bg_erases, bg_reads, slices, max_slice_erases, max_slice_reads);
+
+#if COFFEE_INCREMENTAL_GC
+  /* The collector keeps ahead of the replacements, so that reserving a
+     file never has to erase a sector, while erasing at most one sector
+     per slice. */
+  BENCHMARK_CHECK(fg_erases == 0 && bg_erases > 0 && max_slice_erases <= 1,
+                  "collector did not keep ahead of the replacements\n");
+#endif /* COFFEE_INCREMENTAL_GC */
+
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
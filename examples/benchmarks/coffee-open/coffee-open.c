@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Coffee file open benchmark. Measures the cost of opening
+ *         existing and missing files in file systems with an
+ *         increasing number of files, and the cost of opening large
+ *         files for appending.
+ */
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+#include "lib/random.h"
+
+#define BENCHMARK_NAME "coffee-open"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FILE_SIZE 256
+#define OPENS     20000UL
+
+/* More log files than the 6 files that Coffee caches on native, so that
+   every open for appending has to find the end of the file. */
+#define LOG_FILES      8
+#define LOG_FILE_SIZE  65536UL
+#define LOG_DATA_SIZE  1000
+#define APPEND_OPENS   2000UL
+
+PROCESS(coffee_open_process, "Coffee open benchmark");
+AUTOSTART_PROCESSES(&coffee_open_process);
+
+static const int file_counts[] = { 8, 16, 32, 64, 128, 256 };
+/*---------------------------------------------------------------------------*/
+static void
+report(int files, const char *what, unsigned long ops, unsigned long elapsed_us)
+{
+  printf("coffee-open: %3d files %-8s %6lu ops in %7lu us (%lu ns/op)\n",
+         files, what, ops, elapsed_us,
+         benchmark_ns_per_op(elapsed_us, ops));
+}
+/*---------------------------------------------------------------------------*/
+static int
+run(int files)
+{
+  char name[16];
+  unsigned long start;
+  unsigned long n;
+  int fd;
+  int i;
+
+  cfs_coffee_format();
+  for(i = 0; i < files; i++) {
+    snprintf(name, sizeof(name), "file-%d", i);
+    if(cfs_coffee_reserve(name, FILE_SIZE) < 0) {
+      BENCHMARK_FAIL("failed to reserve %s\n", name);
+      return -1;
+    }
+  }
+
+  start = benchmark_cpu_time_us();
+  for(n = 0; n < OPENS; n++) {
+    snprintf(name, sizeof(name), "file-%d", (int)(random_rand() % files));
+    fd = cfs_open(name, CFS_READ);
+    if(fd < 0) {
+      BENCHMARK_FAIL("failed to open %s\n", name);
+      return -1;
+    }
+    cfs_close(fd);
+  }
+  report(files, "existing", OPENS, benchmark_cpu_time_us() - start);
+
+  start = benchmark_cpu_time_us();
+  for(n = 0; n < OPENS; n++) {
+    snprintf(name, sizeof(name), "none-%d", (int)(random_rand() % files));
+    fd = cfs_open(name, CFS_READ);
+    if(fd >= 0) {
+      BENCHMARK_FAIL("opened missing file %s\n", name);
+      return -1;
+    }
+  }
+  report(files, "missing", OPENS, benchmark_cpu_time_us() - start);
+
+  /* Remove half of the files and check that the rest can be found. */
+  for(i = 0; i < files; i += 2) {
+    snprintf(name, sizeof(name), "file-%d", i);
+    cfs_remove(name);
+  }
+  for(i = 0; i < files; i++) {
+    snprintf(name, sizeof(name), "file-%d", i);
+    fd = cfs_open(name, CFS_READ);
+    if((fd >= 0) != (i & 1)) {
+      BENCHMARK_FAIL("wrong result for %s after removal\n", name);
+      return -1;
+    }
+    if(fd >= 0) {
+      cfs_close(fd);
+    }
+  }
+
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+run_append(void)
+{
+  char name[16];
+  char buf[LOG_DATA_SIZE];
+  unsigned long start;
+  unsigned long n;
+  int fd;
+  int i;
+
+  cfs_coffee_format();
+  memset(buf, 'x', sizeof(buf));
+  for(i = 0; i < LOG_FILES; i++) {
+    snprintf(name, sizeof(name), "log-%d", i);
+    if(cfs_coffee_reserve(name, LOG_FILE_SIZE) < 0) {
+      BENCHMARK_FAIL("failed to reserve %s\n", name);
+      return -1;
+    }
+    fd = cfs_open(name, CFS_WRITE);
+    if(fd < 0 || cfs_write(fd, buf, (i + 1) * sizeof(buf) / LOG_FILES) < 0) {
+      BENCHMARK_FAIL("failed to write %s\n", name);
+      return -1;
+    }
+    cfs_close(fd);
+  }
+
+  start = benchmark_cpu_time_us();
+  for(n = 0; n < APPEND_OPENS; n++) {
+    i = n % LOG_FILES;
+    snprintf(name, sizeof(name), "log-%d", i);
+    fd = cfs_open(name, CFS_WRITE | CFS_APPEND);
+    if(fd < 0) {
+      BENCHMARK_FAIL("failed to open %s\n", name);
+      return -1;
+    }
+    if(cfs_seek(fd, 0, CFS_SEEK_CUR) != (i + 1) * sizeof(buf) / LOG_FILES) {
+      BENCHMARK_FAIL("wrong end of %s\n", name);
+      return -1;
+    }
+    cfs_close(fd);
+  }
+  report(LOG_FILES, "append", APPEND_OPENS, benchmark_cpu_time_us() - start);
+
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coffee_open_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  for(i = 0; i < sizeof(file_counts) / sizeof(file_counts[0]); i++) {
+    if(run(file_counts[i]) < 0) {
+      break;
+    }
+  }
+  run_append();
+
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
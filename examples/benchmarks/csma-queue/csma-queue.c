@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         CSMA queuing benchmark. Two neighbors are sent bulk data with
+ *         different frame sizes over a saturated simulated channel,
+ *         while a third neighbor is sent periodic control messages.
+ *         Reports the latency of the control messages and the share of
+ *         the channel that each data neighbor gets.
+ */
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/queuebuf.h"
+#include "net/mac/csma.h"
+#include "net/mac/rdc.h"
+#include "lib/list.h"
+
+#define BENCHMARK_NAME "csma-queue"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The airtime of a frame, in clock ticks, at 250 kbit/s */
+#define AIRTIME(len)     (1 + (len) / 32)
+#define DURATION         (10 * CLOCK_SECOND)
+#define DATA_INTERVAL    (CLOCK_SECOND / 50)
+#define DATA_BURST       4
+#define CONTROL_INTERVAL (CLOCK_SECOND / 10)
+
+#define ICMP6_RPL        155
+
+PROCESS(csma_queue_process, "CSMA queue benchmark");
+AUTOSTART_PROCESSES(&csma_queue_process);
+
+struct flow {
+  const char *name;
+  linkaddr_t addr;
+  int frame_len;
+  int control;
+  unsigned long sent;
+  unsigned long bytes;
+  unsigned long failed;
+  clock_time_t latency_sum;
+  clock_time_t latency_max;
+};
+
+static struct flow flows[] = {
+  { "data (100 B)", {{ 1 }}, 100, 0 },
+  { "data (40 B)", {{ 2 }}, 40, 0 },
+  { "control", {{ 3 }}, 60, 1 },
+};
+#define NUM_FLOWS (sizeof(flows) / sizeof(flows[0]))
+
+/* Transmission times are carried in the frames */
+struct frame {
+  clock_time_t queued;
+  uint8_t flow;
+};
+/*---------------------------------------------------------------------------*/
+/* A radio duty cycling layer that, like nullrdc, sends all frames of a
+   list back-to-back and blocks during the transmission of each. */
+static void
+sim_send_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *list)
+{
+  struct rdc_buf_list *next;
+  clock_time_t start;
+
+  while(list != NULL) {
+    next = list_item_next(list);
+    queuebuf_to_packetbuf(list->buf);
+    start = clock_time();
+    while(clock_time() - start < AIRTIME(packetbuf_datalen()));
+    mac_call_sent_callback(sent, ptr, MAC_TX_OK, 1);
+    list = next;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+sim_send(mac_callback_t sent, void *ptr)
+{
+  mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+sim_input(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static int
+sim_on(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+sim_off(int keep_radio_on)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+sim_channel_check_interval(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+sim_init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+const struct rdc_driver sim_rdc_driver = {
+  "sim",
+  sim_init,
+  sim_send,
+  sim_send_list,
+  sim_input,
+  sim_on,
+  sim_off,
+  sim_channel_check_interval,
+};
+/*---------------------------------------------------------------------------*/
+static void
+packet_sent(void *ptr, int status, int num_transmissions)
+{
+  struct flow *f = ptr;
+  struct frame frame;
+  clock_time_t latency;
+
+  if(status != MAC_TX_OK) {
+    f->failed++;
+    return;
+  }
+  memcpy(&frame, packetbuf_dataptr(), sizeof(frame));
+  latency = clock_time() - frame.queued;
+  f->sent++;
+  f->bytes += packetbuf_datalen();
+  f->latency_sum += latency;
+  if(latency > f->latency_max) {
+    f->latency_max = latency;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send(struct flow *f)
+{
+  struct frame frame;
+
+  packetbuf_clear();
+  memset(packetbuf_dataptr(), 0, f->frame_len);
+  frame.queued = clock_time();
+  frame.flow = f - flows;
+  memcpy(packetbuf_dataptr(), &frame, sizeof(frame));
+  packetbuf_set_datalen(f->frame_len);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &f->addr);
+  if(f->control) {
+    /* Classified as in sicslowpan */
+    packetbuf_set_attr(PACKETBUF_ATTR_NETWORK_ID, 58);
+    packetbuf_set_attr(PACKETBUF_ATTR_CHANNEL, ICMP6_RPL << 8);
+  }
+  NETSTACK_MAC.send(packet_sent, f);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(csma_queue_process, ev, data)
+{
+  static struct etimer data_timer, control_timer;
+  static clock_time_t start;
+  struct flow *f;
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("csma-queue: traffic classes %d, DRR %d\n",
+         CSMA_CONF_WITH_TRAFFIC_CLASSES, CSMA_CONF_WITH_DRR);
+
+  start = clock_time();
+  etimer_set(&data_timer, DATA_INTERVAL);
+  etimer_set(&control_timer, CONTROL_INTERVAL);
+  while(clock_time() - start < DURATION) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+    if(data == &data_timer) {
+      for(i = 0; i < DATA_BURST; i++) {
+        send(&flows[0]);
+        send(&flows[1]);
+      }
+      etimer_reset(&data_timer);
+    } else if(data == &control_timer) {
+      send(&flows[2]);
+      etimer_reset(&control_timer);
+    }
+  }
+
+  /* Let the queues drain */
+  etimer_set(&data_timer, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&data_timer));
+
+  for(f = flows; f < flows + NUM_FLOWS; f++) {
+    printf("csma-queue: %-12s %5lu sent %6lu bytes %5lu failed, latency avg %lu max %lu ticks\n",
+           f->name, f->sent, f->bytes, f->failed,
+           f->sent ? (unsigned long)(f->latency_sum / f->sent) : 0UL,
+           (unsigned long)f->latency_max);
+  }
+  printf("csma-queue: queued %u data %u control, dropped %u data %u control, evicted %u, max queued %u\n",
+         csma_stats.queued[CSMA_CLASS_DATA], csma_stats.queued[CSMA_CLASS_CONTROL],
+         csma_stats.dropped[CSMA_CLASS_DATA], csma_stats.dropped[CSMA_CLASS_CONTROL],
+         csma_stats.evicted, csma_stats.max_queued);
+  /* The control flow has its own class and is never dropped */
+  BENCHMARK_CHECK(!CSMA_CONF_WITH_TRAFFIC_CLASSES || flows[2].failed == 0,
+                  "%lu control messages failed\n", flows[2].failed);
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Event timer benchmark. Measures the cost of arming, re-arming
+ *         and dispatching a large number of concurrent event timers.
+ *         Costs are measured in CPU time, so that the time the native
+ *         main loop spends sleeping in select() is not accounted for.
+ */
+
+#include "contiki.h"
+#include "lib/random.h"
+
+#define BENCHMARK_NAME "etimer-benchmark"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_TIMERS 1000
+#define REARM_ROUNDS 20
+#define NEXT_EXPIRATION_CALLS 1000000UL
+
+PROCESS(etimer_benchmark_process, "Etimer benchmark");
+AUTOSTART_PROCESSES(&etimer_benchmark_process);
+
+static struct etimer timers[NUM_TIMERS];
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *what, unsigned long ops, unsigned long elapsed_us)
+{
+  printf("etimer-benchmark: %-18s %7lu ops in %7lu us (%lu ns/op)\n",
+         what, ops, elapsed_us,
+         benchmark_ns_per_op(elapsed_us, ops));
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(etimer_benchmark_process, ev, data)
+{
+  static unsigned long start;
+  static int fired;
+  static clock_time_t sum;
+  unsigned long n;
+  int i;
+  int round;
+
+  PROCESS_BEGIN();
+
+  printf("etimer-benchmark: %d timers\n", NUM_TIMERS);
+
+  /* Arm all timers far in the future, in random order of expiry. */
+  start = benchmark_cpu_time_us();
+  for(i = 0; i < NUM_TIMERS; i++) {
+    etimer_set(&timers[i], 10 * CLOCK_SECOND + random_rand() % (10 * CLOCK_SECOND));
+  }
+  report("arm", NUM_TIMERS, benchmark_cpu_time_us() - start);
+
+  /* Re-arm pending timers with new intervals. */
+  start = benchmark_cpu_time_us();
+  for(round = 0; round < REARM_ROUNDS; round++) {
+    for(i = 0; i < NUM_TIMERS; i++) {
+      etimer_set(&timers[i], 10 * CLOCK_SECOND + random_rand() % (10 * CLOCK_SECOND));
+    }
+  }
+  report("re-arm", (unsigned long)NUM_TIMERS * REARM_ROUNDS,
+         benchmark_cpu_time_us() - start);
+
+  start = benchmark_cpu_time_us();
+  sum = 0;
+  for(n = 0; n < NEXT_EXPIRATION_CALLS; n++) {
+    sum += etimer_next_expiration_time();
+  }
+  report("next expiration", NEXT_EXPIRATION_CALLS,
+         benchmark_cpu_time_us() - start);
+
+  /* Let all timers expire at once and measure the time it takes to
+     get all the events. */
+  for(i = 0; i < NUM_TIMERS; i++) {
+    etimer_set(&timers[i], 1);
+  }
+  start = clock_time();
+  while(clock_time() - start < 2);
+  start = benchmark_cpu_time_us();
+  fired = 0;
+  while(fired < NUM_TIMERS) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+    fired++;
+  }
+  report("dispatch", NUM_TIMERS, benchmark_cpu_time_us() - start);
+
+  for(i = 0; i < NUM_TIMERS; i++) {
+    BENCHMARK_CHECK(etimer_expired(&timers[i]), "timer %d not expired\n", i);
+  }
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
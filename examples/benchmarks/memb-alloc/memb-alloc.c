@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Memory block allocator benchmark. Checks memb_alloc() and
+ *         memb_free() on a pool that spans several bitmap words, and
+ *         measures them on a pool that is kept almost full while blocks
+ *         are freed and allocated at random. Costs are measured in CPU
+ *         time.
+ */
+
+#include "contiki.h"
+#include "lib/memb.h"
+#include "lib/random.h"
+
+#define BENCHMARK_NAME "memb-alloc"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_BLOCKS 200
+#define CHURN_OPS 1000000UL
+
+PROCESS(memb_alloc_process, "Memb allocation benchmark");
+AUTOSTART_PROCESSES(&memb_alloc_process);
+
+struct block {
+  uint32_t data[4];
+};
+
+MEMB(blocks, struct block, NUM_BLOCKS);
+
+static struct block *allocated[NUM_BLOCKS];
+/*---------------------------------------------------------------------------*/
+static void
+check(void)
+{
+  struct block *b;
+  int i;
+
+  memb_init(&blocks);
+
+  /* blocks are handed out lowest first, until the pool runs out */
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    allocated[i] = memb_alloc(&blocks);
+    BENCHMARK_CHECK(allocated[i] == (struct block *)blocks.mem + i,
+                    "block %d allocated out of order\n", i);
+  }
+  BENCHMARK_CHECK(memb_alloc(&blocks) == NULL, "allocated from a full pool\n");
+  BENCHMARK_CHECK(memb_numfree(&blocks) == 0, "free blocks in a full pool\n");
+
+  /* freed blocks are reused lowest first, across words */
+  for(i = 1; i < NUM_BLOCKS; i += 3) {
+    BENCHMARK_CHECK(memb_free(&blocks, allocated[i]) == 0,
+                    "block %d not freed\n", i);
+  }
+  for(i = 1; i < NUM_BLOCKS; i += 3) {
+    BENCHMARK_CHECK(memb_alloc(&blocks) == allocated[i],
+                    "block %d not reused\n", i);
+  }
+  BENCHMARK_CHECK(memb_alloc(&blocks) == NULL, "allocated from a full pool\n");
+
+  /* pointers that are not blocks of the pool */
+  b = allocated[5];
+  BENCHMARK_CHECK(memb_free(&blocks, (char *)b + 1) == -1,
+                  "freed a pointer inside a block\n");
+  BENCHMARK_CHECK(memb_free(&blocks, allocated[0] - 1) == -1,
+                  "freed a pointer before the pool\n");
+  BENCHMARK_CHECK(memb_inmemb(&blocks, allocated[NUM_BLOCKS - 1]),
+                  "last block not in the pool\n");
+  BENCHMARK_CHECK(!memb_inmemb(&blocks, allocated[NUM_BLOCKS - 1] + 1),
+                  "pointer after the pool in the pool\n");
+
+  /* a block that is already free stays free */
+  BENCHMARK_CHECK(memb_free(&blocks, b) == 0, "block not freed\n");
+  BENCHMARK_CHECK(memb_free(&blocks, b) == 0, "free block not freed again\n");
+  BENCHMARK_CHECK(memb_numfree(&blocks) == 1, "double free counted twice\n");
+  BENCHMARK_CHECK(memb_alloc(&blocks) == b, "freed block not reused\n");
+
+#if MEMB_WITH_STATS
+  {
+    struct memb_stats stats;
+
+    memb_free(&blocks, allocated[7]);
+    memb_get_stats(&blocks, &stats);
+    printf("memb-alloc: %u of %u used, at most %u, %u failed\n",
+           stats.used, stats.num, stats.max_used, stats.failed);
+    BENCHMARK_CHECK(stats.num == NUM_BLOCKS && stats.used == NUM_BLOCKS - 1 &&
+                    stats.max_used == NUM_BLOCKS && stats.failed == 2,
+                    "wrong statistics\n");
+    memb_init(&blocks);
+    memb_get_stats(&blocks, &stats);
+    BENCHMARK_CHECK(stats.used == 0 && stats.max_used == 0 && stats.failed == 0,
+                    "statistics not reset\n");
+  }
+#endif /* MEMB_WITH_STATS */
+}
+/*---------------------------------------------------------------------------*/
+static void
+churn(void)
+{
+  unsigned long start, elapsed;
+  unsigned long n;
+  int i;
+
+  memb_init(&blocks);
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    allocated[i] = memb_alloc(&blocks);
+  }
+
+  /* keep the pool full but for one block, freed at random */
+  start = benchmark_cpu_time_us();
+  for(n = 0; n < CHURN_OPS; n++) {
+    i = random_rand() % NUM_BLOCKS;
+    memb_free(&blocks, allocated[i]);
+    allocated[i] = memb_alloc(&blocks);
+    BENCHMARK_CHECK(allocated[i] != NULL, "allocation %lu failed\n", n);
+  }
+  elapsed = benchmark_cpu_time_us() - start;
+
+  printf("memb-alloc: bitmap %d, %lu free/alloc pairs on %d blocks in %lu us (%lu ns/pair)\n",
+         MEMB_WITH_BITMAP, CHURN_OPS, NUM_BLOCKS, elapsed,
+         benchmark_ns_per_op(elapsed, CHURN_OPS));
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(memb_alloc_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  random_init(1);
+  check();
+  churn();
+
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Packet copy benchmark. Sends UDP packets through the
+ *         6LoWPAN, CSMA and nullrdc layers to a radio that hands every
+ *         frame back as a received frame, and reports how many times
+ *         each packet was copied or moved by the packetbuf on the way
+ *         down and on the way up.
+ */
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/ip/uip.h"
+#include "net/ip/simple-udp.h"
+#include "net/ipv6/uip-ds6.h"
+#include "dev/radio.h"
+
+#define BENCHMARK_NAME "packet-copy"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef PACKET_COPY_CONF_REFERENCE
+#define PACKET_COPY_REFERENCE PACKET_COPY_CONF_REFERENCE
+#else
+#define PACKET_COPY_REFERENCE 1
+#endif
+
+#define PACKETS     20000UL
+#define PAYLOAD_LEN 60
+#define UDP_PORT    5678
+
+PROCESS(packet_copy_process, "Packet copy benchmark");
+AUTOSTART_PROCESSES(&packet_copy_process);
+
+static struct simple_udp_connection conn;
+/* The radio's receive buffer */
+static uint8_t rx_frame[PACKETBUF_SIZE];
+static uint16_t rx_len;
+static unsigned long sent_frames, received, errors;
+/*---------------------------------------------------------------------------*/
+static int
+loop_send(const void *payload, unsigned short payload_len)
+{
+  /* A frame is written to the radio, and received right back */
+  memcpy(rx_frame, payload, payload_len);
+  rx_len = payload_len;
+  sent_frames++;
+  process_poll(&packet_copy_process);
+  return RADIO_TX_OK;
+}
+/*---------------------------------------------------------------------------*/
+static int
+loop_init(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+loop_prepare(const void *payload, unsigned short payload_len)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+loop_transmit(unsigned short transmit_len)
+{
+  return RADIO_TX_ERR;
+}
+/*---------------------------------------------------------------------------*/
+static int
+loop_read(void *buf, unsigned short buf_len)
+{
+  if(rx_len > buf_len) {
+    return 0;
+  }
+  memcpy(buf, rx_frame, rx_len);
+  return rx_len;
+}
+/*---------------------------------------------------------------------------*/
+static int
+loop_channel_clear(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+loop_receiving_packet(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+loop_pending_packet(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+loop_on(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+loop_off(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+loop_get_value(radio_param_t param, radio_value_t *value)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+loop_set_value(radio_param_t param, radio_value_t value)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+loop_get_object(radio_param_t param, void *dest, size_t size)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+loop_set_object(radio_param_t param, const void *src, size_t size)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+const struct radio_driver loop_radio_driver = {
+  loop_init,
+  loop_prepare,
+  loop_transmit,
+  loop_send,
+  loop_read,
+  loop_channel_clear,
+  loop_receiving_packet,
+  loop_pending_packet,
+  loop_on,
+  loop_off,
+  loop_get_value,
+  loop_set_value,
+  loop_get_object,
+  loop_set_object
+};
+/*---------------------------------------------------------------------------*/
+static void
+receiver(struct simple_udp_connection *c,
+         const uip_ipaddr_t *sender_addr,
+         uint16_t sender_port,
+         const uip_ipaddr_t *receiver_addr,
+         uint16_t receiver_port,
+         const uint8_t *data,
+         uint16_t datalen)
+{
+  if(datalen != PAYLOAD_LEN || data[0] != (uint8_t)received
+     || data[datalen - 1] != (uint8_t)~received) {
+    errors++;
+  }
+  received++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+input_frame(void)
+{
+  /* Hand the frame to the RDC layer as a radio driver does */
+#if PACKET_COPY_REFERENCE
+  packetbuf_reference(rx_frame, rx_len);
+#else /* PACKET_COPY_REFERENCE */
+  packetbuf_copyfrom(rx_frame, rx_len);
+#endif /* PACKET_COPY_REFERENCE */
+  NETSTACK_RDC.input();
+  if(packetbuf_is_reference()) {
+    packetbuf_clear();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+print_stats(const char *dir, const struct packetbuf_stats *s)
+{
+  printf("packet-copy: %s: %lu.%02lu copies (%lu bytes), %lu.%02lu moves (%lu bytes), %lu.%02lu in place per packet\n",
+         dir,
+         (unsigned long)(s->copies * 100 / PACKETS / 100),
+         (unsigned long)(s->copies * 100 / PACKETS % 100),
+         (unsigned long)(s->copied_bytes / PACKETS),
+         (unsigned long)(s->shifts * 100 / PACKETS / 100),
+         (unsigned long)(s->shifts * 100 / PACKETS % 100),
+         (unsigned long)(s->shifted_bytes / PACKETS),
+         (unsigned long)((s->references - s->reference_copies) * 100 / PACKETS / 100),
+         (unsigned long)((s->references - s->reference_copies) * 100 / PACKETS % 100));
+}
+/*---------------------------------------------------------------------------*/
+static void
+stats_diff(struct packetbuf_stats *d, const struct packetbuf_stats *a,
+           const struct packetbuf_stats *b)
+{
+  d->copies = b->copies - a->copies;
+  d->copied_bytes = b->copied_bytes - a->copied_bytes;
+  d->shifts = b->shifts - a->shifts;
+  d->shifted_bytes = b->shifted_bytes - a->shifted_bytes;
+  d->references = b->references - a->references;
+  d->reference_copies = b->reference_copies - a->reference_copies;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(packet_copy_process, ev, data)
+{
+  static uip_ipaddr_t dest;
+  static struct packetbuf_stats before, tx, rx;
+  static unsigned long i;
+  static clock_time_t start;
+  uint8_t payload[PAYLOAD_LEN];
+
+  PROCESS_BEGIN();
+
+  printf("packet-copy: %lu packets, %u bytes of payload, header space %u, receive in place %u\n",
+         PACKETS, PAYLOAD_LEN, PACKETBUF_HDR_SIZE, PACKET_COPY_REFERENCE);
+
+  simple_udp_register(&conn, UDP_PORT, NULL, UDP_PORT, receiver);
+  uip_create_linklocal_allnodes_mcast(&dest);
+
+  start = clock_time();
+  for(i = 0; i < PACKETS; i++) {
+    memset(payload, (uint8_t)i, sizeof(payload));
+    payload[PAYLOAD_LEN - 1] = ~i;
+
+    before = packetbuf_stats;
+    simple_udp_sendto(&conn, payload, sizeof(payload), &dest);
+    /* Wait for CSMA to hand the frame to the radio */
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    stats_diff(&before, &before, &packetbuf_stats);
+    tx.copies += before.copies;
+    tx.copied_bytes += before.copied_bytes;
+    tx.shifts += before.shifts;
+    tx.shifted_bytes += before.shifted_bytes;
+
+    before = packetbuf_stats;
+    input_frame();
+    stats_diff(&before, &before, &packetbuf_stats);
+    rx.copies += before.copies;
+    rx.copied_bytes += before.copied_bytes;
+    rx.shifts += before.shifts;
+    rx.shifted_bytes += before.shifted_bytes;
+    rx.references += before.references;
+    rx.reference_copies += before.reference_copies;
+  }
+
+  print_stats("send", &tx);
+  print_stats("receive", &rx);
+  printf("packet-copy: %lu frames sent, %lu packets received in %lu ms, %lu errors\n",
+         sent_frames, received, (unsigned long)(clock_time() - start), errors);
+  BENCHMARK_CHECK(received == PACKETS && errors == 0,
+                  "%lu of %lu packets received intact\n", received - errors,
+                  PACKETS);
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
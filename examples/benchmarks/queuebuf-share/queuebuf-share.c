@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Queuebuf sharing benchmark. Queues the same packet for
+ *         several neighbors, either by sharing one queuebuf or by
+ *         copying the packet for each of them, updates the attributes
+ *         of some of the queued packets as MAC layers do for
+ *         retransmissions, and checks that every neighbor still sees
+ *         the right packet. Reports the time per packet and the
+ *         queuebuf pool usage.
+ */
+
+#include "contiki.h"
+#include "net/packetbuf.h"
+#include "net/queuebuf.h"
+
+#define BENCHMARK_NAME "queuebuf-share"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef QUEUEBUF_SHARE_CONF_ENABLED
+#define QUEUEBUF_SHARE_ENABLED QUEUEBUF_SHARE_CONF_ENABLED
+#else
+#define QUEUEBUF_SHARE_ENABLED 1
+#endif
+
+#define ROUNDS      100000UL
+#define NEIGHBORS   8
+#define PACKET_LEN  100
+
+PROCESS(queuebuf_share_process, "Queuebuf sharing benchmark");
+AUTOSTART_PROCESSES(&queuebuf_share_process);
+
+static struct queuebuf *queued[NEIGHBORS];
+/*---------------------------------------------------------------------------*/
+static void
+make_packet(unsigned long round)
+{
+  packetbuf_clear();
+  memset(packetbuf_dataptr(), (uint8_t)round, PACKET_LEN);
+  packetbuf_set_datalen(PACKET_LEN);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_SEQNO, (uint8_t)round);
+}
+/*---------------------------------------------------------------------------*/
+static int
+queue_packet(void)
+{
+  int i;
+
+  queued[0] = queuebuf_new_from_packetbuf();
+  for(i = 1; i < NEIGHBORS; i++) {
+#if QUEUEBUF_SHARE_ENABLED
+    queued[i] = queuebuf_share(queued[0]);
+#else /* QUEUEBUF_SHARE_ENABLED */
+    queued[i] = queuebuf_new_from_packetbuf();
+#endif /* QUEUEBUF_SHARE_ENABLED */
+  }
+  for(i = 0; i < NEIGHBORS; i++) {
+    if(queued[i] == NULL) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+check_packet(int i, unsigned long round)
+{
+  const uint8_t *data;
+  uint8_t transmissions;
+
+  data = queuebuf_dataptr_const(queued[i]);
+  transmissions = (i & 1) ? 2 : 0;
+  return queuebuf_datalen(queued[i]) == PACKET_LEN
+    && data[0] == (uint8_t)round && data[PACKET_LEN - 1] == (uint8_t)round
+    && data[PACKET_LEN / 2] == (uint8_t)(i == 0 ? ~round : round)
+    && queuebuf_attr(queued[i], PACKETBUF_ATTR_MAC_SEQNO) == (uint8_t)round
+    && queuebuf_attr(queued[i], PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS) == transmissions;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(queuebuf_share_process, ev, data)
+{
+  static unsigned long round;
+  static clock_time_t start;
+  uint8_t *packet;
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("queuebuf-share: sharing %u, %u neighbors, %u queuebufs (%u in RAM)\n",
+         QUEUEBUF_SHARE_ENABLED, NEIGHBORS, QUEUEBUF_NUM, QUEUEBUFRAM_NUM);
+
+  start = clock_time();
+  for(round = 0; round < ROUNDS; round++) {
+    make_packet(round);
+    if(!queue_packet()) {
+      BENCHMARK_FAIL("could not queue packet %lu\n", round);
+      break;
+    }
+
+    /* Writing to the packet of the first neighbor must not change the
+       packet of the others */
+    packet = queuebuf_dataptr(queued[0]);
+    if(packet == NULL) {
+      BENCHMARK_FAIL("could not write to packet %lu\n", round);
+      break;
+    }
+    packet[PACKET_LEN / 2] = (uint8_t)~round;
+
+    /* Every other neighbor gets a retransmission that changes the
+       attributes, the others one that changes nothing */
+    for(i = 0; i < NEIGHBORS; i++) {
+      queuebuf_to_packetbuf(queued[i]);
+      if(i & 1) {
+        packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, 2);
+      }
+      queuebuf_update_attr_from_packetbuf(queued[i]);
+    }
+
+    /* Free in an order that does not match the allocation order */
+    for(i = 0; i < NEIGHBORS; i++) {
+      int n = (i * 3 + round) % NEIGHBORS;
+      BENCHMARK_CHECK(check_packet(n, round),
+                      "packet %lu of neighbor %d is wrong\n", round, n);
+      queuebuf_free(queued[n]);
+    }
+  }
+
+  printf("queuebuf-share: %lu packets in %lu ms (%lu ns/packet)\n",
+         round, (unsigned long)(clock_time() - start),
+         (unsigned long)((clock_time() - start) * 1000000UL / ROUNDS));
+  printf("queuebuf-share: max %u queuebufs, max %u in RAM, %lu shares, %lu copied on update\n",
+         queuebuf_max_len, queuebuf_ram_max_len,
+         (unsigned long)queuebuf_shares, (unsigned long)queuebuf_unshares);
+  printf("queuebuf-share: occupancy");
+  for(i = 0; i <= QUEUEBUF_NUM; i++) {
+    printf(" %lu", (unsigned long)queuebuf_len_histogram[i]);
+  }
+  printf("\n");
+
+  BENCHMARK_CHECK(queuebuf_len == 0 && queuebuf_ram_len == 0,
+                  "%u queuebufs leaked (%u in RAM)\n",
+                  queuebuf_len, queuebuf_ram_len);
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         6LoWPAN reassembly benchmark. Feeds sicslowpan with fragmented
+ *         packets from several senders, interleaved, partly reordered and
+ *         with duplicates, and reports the reassembly cost and statistics.
+ */
+
+#include "contiki.h"
+#include "net/ip/uip.h"
+#include "net/ipv6/sicslowpan.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "lib/random.h"
+
+#define BENCHMARK_NAME "reassembly-benchmark"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SENDERS 8
+#define PACKETS_PER_SENDER 2000
+/* IPv6 header plus UDP payload; must fit in uip_buf */
+#define PACKET_LEN 376
+/* Bytes of the IPv6 packet carried in each fragment */
+#define CHUNK_LEN 96
+#define FRAGMENTS ((PACKET_LEN + CHUNK_LEN - 1) / CHUNK_LEN)
+/* Chance, in percent, of swapping the next two fragments of a sender
+   and of repeating a fragment */
+#define REORDER_PERCENT 20
+#define DUPLICATE_PERCENT 2
+
+PROCESS(reassembly_benchmark_process, "Reassembly benchmark");
+AUTOSTART_PROCESSES(&reassembly_benchmark_process);
+
+struct sender {
+  linkaddr_t addr;
+  uint16_t tag;
+  uint16_t sent;
+  uint8_t next;
+  uint8_t order[FRAGMENTS];
+};
+
+static struct sender senders[SENDERS];
+static uint8_t packet[PACKET_LEN];
+static uint8_t frame[CHUNK_LEN + 8];
+/*---------------------------------------------------------------------------*/
+static void
+init_packet(void)
+{
+  int i;
+
+  memset(packet, 0, sizeof(packet));
+  /* IPv6 header: UDP to ff02::1, which nobody listens to */
+  packet[0] = 0x60;
+  packet[4] = (PACKET_LEN - UIP_IPH_LEN) >> 8;
+  packet[5] = (PACKET_LEN - UIP_IPH_LEN) & 0xff;
+  packet[6] = UIP_PROTO_UDP;
+  packet[7] = 64;
+  packet[8] = 0xfe;
+  packet[9] = 0x80;
+  packet[23] = 1;
+  packet[24] = 0xff;
+  packet[25] = 0x02;
+  packet[39] = 1;
+  for(i = UIP_IPH_LEN; i < PACKET_LEN; i++) {
+    packet[i] = i;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_packet(struct sender *s)
+{
+  int i;
+  uint8_t tmp;
+
+  s->tag++;
+  s->next = 0;
+  for(i = 0; i < FRAGMENTS; i++) {
+    s->order[i] = i;
+  }
+  for(i = 0; i + 1 < FRAGMENTS; i++) {
+    if(random_rand() % 100 < REORDER_PERCENT) {
+      tmp = s->order[i];
+      s->order[i] = s->order[i + 1];
+      s->order[i + 1] = tmp;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_fragment(struct sender *s, int fragment)
+{
+  int offset = fragment * CHUNK_LEN;
+  int len = PACKET_LEN - offset < CHUNK_LEN ? PACKET_LEN - offset : CHUNK_LEN;
+  int hdr;
+
+  if(fragment == 0) {
+    frame[0] = SICSLOWPAN_DISPATCH_FRAG1 | (PACKET_LEN >> 8);
+    hdr = SICSLOWPAN_FRAG1_HDR_LEN;
+    /* The IPv6 header is sent uncompressed */
+    frame[hdr++] = SICSLOWPAN_DISPATCH_IPV6;
+  } else {
+    frame[0] = SICSLOWPAN_DISPATCH_FRAGN | (PACKET_LEN >> 8);
+    frame[4] = offset >> 3;
+    hdr = SICSLOWPAN_FRAGN_HDR_LEN;
+  }
+  frame[1] = PACKET_LEN & 0xff;
+  frame[2] = s->tag >> 8;
+  frame[3] = s->tag & 0xff;
+  memcpy(frame + hdr, packet + offset, len);
+
+  packetbuf_clear();
+  packetbuf_copyfrom(frame, hdr + len);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &s->addr);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &linkaddr_node_addr);
+  sicslowpan_driver.input();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(reassembly_benchmark_process, ev, data)
+{
+  static unsigned long start;
+  static unsigned long fragments;
+  struct sender *s;
+  int active;
+  int i;
+
+  PROCESS_BEGIN();
+
+  init_packet();
+  for(i = 0; i < SENDERS; i++) {
+    senders[i].addr.u8[0] = 0x02;
+    senders[i].addr.u8[LINKADDR_SIZE - 1] = i + 1;
+    senders[i].tag = random_rand();
+    start_packet(&senders[i]);
+  }
+
+  printf("reassembly-benchmark: %d senders, %d packets each, %d fragments per packet\n",
+         SENDERS, PACKETS_PER_SENDER, FRAGMENTS);
+
+  start = benchmark_cpu_time_us();
+  fragments = 0;
+  active = SENDERS;
+  while(active > 0) {
+    s = &senders[random_rand() % SENDERS];
+    if(s->sent == PACKETS_PER_SENDER) {
+      continue;
+    }
+    send_fragment(s, s->order[s->next]);
+    fragments++;
+    if(random_rand() % 100 < DUPLICATE_PERCENT) {
+      send_fragment(s, s->order[s->next]);
+      fragments++;
+    }
+    if(++s->next == FRAGMENTS) {
+      if(++s->sent == PACKETS_PER_SENDER) {
+        active--;
+      } else {
+        start_packet(s);
+      }
+    }
+  }
+  start = benchmark_cpu_time_us() - start;
+
+  printf("reassembly-benchmark: %lu fragments in %lu us (%lu ns/fragment)\n",
+         fragments, start,
+         benchmark_ns_per_op(start, fragments));
+  printf("reassembly-benchmark: reassembled %u of %u packets\n",
+         sicslowpan_frag_stats.reassembled, SENDERS * PACKETS_PER_SENDER);
+  printf("reassembly-benchmark: out of order %u, duplicates %u, evicted %u\n",
+         sicslowpan_frag_stats.out_of_order, sicslowpan_frag_stats.duplicates,
+         sicslowpan_frag_stats.evicted);
+  printf("reassembly-benchmark: dropped: no context %u, no buffer %u, quota %u, timeouts %u\n",
+         sicslowpan_frag_stats.no_context, sicslowpan_frag_stats.no_buffer,
+         sicslowpan_frag_stats.quota, sicslowpan_frag_stats.timeouts);
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         REST engine dispatch benchmark. Activates an increasing number
+ *         of resources and measures the average time taken by
+ *         rest_invoke_restful_service() to dispatch a request. Every
+ *         rest_find_resource() result is checked against a reference
+ *         first-match scan of the resource list.
+ */
+
+#include "contiki.h"
+#include "rest-engine.h"
+#include "er-coap.h"
+
+#define BENCHMARK_NAME "rest-dispatch"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_RESOURCES 512
+#define LOOKUPS 100000UL
+
+PROCESS(rest_dispatch_process, "REST dispatch benchmark");
+AUTOSTART_PROCESSES(&rest_dispatch_process);
+
+static resource_t resources[MAX_RESOURCES];
+static char paths[MAX_RESOURCES][16];
+static unsigned activated;
+static unsigned long hits;
+/*---------------------------------------------------------------------------*/
+static void
+get_handler(void *request, void *response, uint8_t *buffer,
+            uint16_t preferred_size, int32_t *offset)
+{
+  hits++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+activate(unsigned num)
+{
+  unsigned i;
+
+  /* Seven leaves per directory, followed by the directory itself as a
+     parent resource, so that requests for the leaves still go to the
+     leaves while anything else below the directory goes to the parent. */
+  for(i = activated; i < num; i++) {
+    resources[i].get_handler = get_handler;
+    if((i & 7) == 7) {
+      resources[i].flags = HAS_SUB_RESOURCES;
+      snprintf(paths[i], sizeof(paths[i]), "d%u/s%u", i >> 6, (i >> 3) & 7);
+    } else {
+      snprintf(paths[i], sizeof(paths[i]), "d%u/s%u/r%u",
+               i >> 6, (i >> 3) & 7, i & 7);
+    }
+    rest_activate_resource(&resources[i], paths[i]);
+  }
+  activated = num;
+}
+/*---------------------------------------------------------------------------*/
+static resource_t *
+reference_find(const char *url, int url_len, const char **subpath)
+{
+  resource_t *r;
+  int len;
+
+  for(r = list_head(rest_get_resources()); r != NULL; r = r->next) {
+    len = strlen(r->url);
+    if((url_len == len
+        || (url_len > len && (r->flags & HAS_SUB_RESOURCES)
+            && url[len] == '/'))
+       && memcmp(r->url, url, len) == 0) {
+      *subpath = &url[len];
+      return r;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(const char *url)
+{
+  const char *subpath;
+  const char *ref_subpath;
+  resource_t *r;
+  resource_t *ref;
+
+  subpath = ref_subpath = NULL;
+  r = rest_find_resource(url, strlen(url), &subpath);
+  ref = reference_find(url, strlen(url), &ref_subpath);
+  BENCHMARK_CHECK(r == ref && subpath == ref_subpath, "mismatch for %s\n", url);
+}
+/*---------------------------------------------------------------------------*/
+static void
+run(unsigned num)
+{
+  static coap_packet_t request[1];
+  static coap_packet_t response[1];
+  static uint8_t buffer[REST_MAX_CHUNK_SIZE];
+  char url[32];
+  unsigned long i;
+  clock_time_t start;
+  clock_time_t elapsed;
+  unsigned long errors = benchmark_errors;
+
+  activate(num);
+
+  /* Verify against the reference: exact paths, paths below a leaf or
+     a parent, paths one level up and paths that match nothing. */
+  for(i = 0; i < num; i++) {
+    check(paths[i]);
+    snprintf(url, sizeof(url), "%s/x", paths[i]);
+    check(url);
+    snprintf(url, sizeof(url), "d%lu", i >> 6);
+    check(url);
+    snprintf(url, sizeof(url), "d%lu/s%lu/r%lux", i >> 6, (i >> 3) & 7, i);
+    check(url);
+  }
+  check("");
+  check("/");
+
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, 0);
+  hits = 0;
+  start = clock_time();
+  for(i = 0; i < LOOKUPS; i++) {
+    coap_set_header_uri_path(request, paths[(i * 7919) % num]);
+    rest_invoke_restful_service(request, response, buffer,
+                                sizeof(buffer), NULL);
+  }
+  elapsed = clock_time() - start;
+  BENCHMARK_CHECK(hits == LOOKUPS, "%lu of %lu requests served\n", hits,
+                  LOOKUPS);
+
+  printf("rest-dispatch: %3u resources, %lu requests in %lu ms (%lu ns/request), %lu errors\n",
+         num, LOOKUPS, (unsigned long)elapsed,
+         (unsigned long)(elapsed * 1000000UL / LOOKUPS),
+         benchmark_errors - errors);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(rest_dispatch_process, ev, data)
+{
+  unsigned num;
+
+  PROCESS_BEGIN();
+
+  printf("rest-dispatch: trie %s\n",
+         REST_ENGINE_TRIE ? "enabled" : "disabled");
+
+  for(num = 8; num <= MAX_RESOURCES; num *= 4) {
+    run(num);
+  }
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
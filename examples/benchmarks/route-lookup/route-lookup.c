@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Routing table lookup benchmark. Fills the routing table with
+ *         an increasing number of host and /64 routes and measures the
+ *         average uip_ds6_route_lookup() time. Every lookup result is
+ *         checked against a reference longest-prefix match.
+ */
+
+#include "contiki.h"
+#include "net/ip/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-route.h"
+
+#define BENCHMARK_NAME "route-lookup"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOOKUPS 100000UL
+
+PROCESS(route_lookup_process, "Route lookup benchmark");
+AUTOSTART_PROCESSES(&route_lookup_process);
+
+static uip_ipaddr_t nexthop;
+/*---------------------------------------------------------------------------*/
+static void
+make_addr(uip_ipaddr_t *addr, unsigned i)
+{
+  /* One /64 out of every eight routes, host routes otherwise. */
+  uip_ip6addr(addr, 0xfd00, 0, 0, i >> 3, 0x0212, 0x7400, i >> 8, i & 0xff);
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+route_length(unsigned i)
+{
+  return (i & 7) == 0 ? 64 : 128;
+}
+/*---------------------------------------------------------------------------*/
+static int
+prefix_matches(const uip_ipaddr_t *addr, const uip_ipaddr_t *prefix,
+               uint8_t length)
+{
+  uint8_t mask;
+
+  if(memcmp(addr, prefix, length >> 3) != 0) {
+    return 0;
+  }
+  if((length & 7) == 0) {
+    return 1;
+  }
+  mask = 0xff << (8 - (length & 7));
+  return ((addr->u8[length >> 3] ^ prefix->u8[length >> 3]) & mask) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+reference_lookup(const uip_ipaddr_t *addr)
+{
+  uip_ds6_route_t *r;
+  uip_ds6_route_t *best;
+
+  best = NULL;
+  for(r = uip_ds6_route_head(); r != NULL; r = uip_ds6_route_next(r)) {
+    if((best == NULL || r->length > best->length) &&
+       prefix_matches(addr, &r->ipaddr, r->length)) {
+      best = r;
+    }
+  }
+  return best;
+}
+/*---------------------------------------------------------------------------*/
+static void
+run(unsigned num)
+{
+  uip_ipaddr_t addr;
+  uip_ds6_route_t *r;
+  unsigned long i;
+  clock_time_t start;
+  clock_time_t elapsed;
+  unsigned long errors = benchmark_errors;
+
+  while(uip_ds6_route_head() != NULL) {
+    uip_ds6_route_rm(uip_ds6_route_head());
+  }
+  for(i = 0; i < num; i++) {
+    make_addr(&addr, i);
+    if(uip_ds6_route_add(&addr, route_length(i), &nexthop) == NULL) {
+      BENCHMARK_FAIL("could not add route %lu\n", i);
+      return;
+    }
+  }
+
+  /* Verify against the reference, including addresses only covered
+     by a /64 and addresses with no route at all. */
+  for(i = 0; i < 2 * num; i++) {
+    make_addr(&addr, i);
+    addr.u8[15] ^= (i & 1) << 7;
+    BENCHMARK_CHECK(uip_ds6_route_lookup(&addr) == reference_lookup(&addr),
+                    "wrong route for address %lu\n", i);
+  }
+
+  start = clock_time();
+  for(i = 0; i < LOOKUPS; i++) {
+    make_addr(&addr, (i * 7919) % num);
+    r = uip_ds6_route_lookup(&addr);
+    BENCHMARK_CHECK(r != NULL, "no route for address %lu\n",
+                    (i * 7919) % num);
+  }
+  elapsed = clock_time() - start;
+
+  printf("route-lookup: %5u routes, %lu lookups in %lu ms (%lu ns/lookup), %lu errors\n",
+         num, LOOKUPS, (unsigned long)elapsed,
+         (unsigned long)(elapsed * 1000000UL / LOOKUPS),
+         benchmark_errors - errors);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(route_lookup_process, ev, data)
+{
+  static uip_lladdr_t lladdr = {{ 0x02, 0x12, 0x74, 0x01, 0x00, 0x01, 0x01, 0x01 }};
+  unsigned num;
+
+  PROCESS_BEGIN();
+
+  printf("route-lookup: trie index %s\n",
+         UIP_DS6_ROUTE_TRIE ? "enabled" : "disabled");
+
+  uip_ip6addr(&nexthop, 0xfe80, 0, 0, 0, 0x0012, 0x7401, 0x0001, 0x0101);
+  if(uip_ds6_nbr_add(&nexthop, &lladdr, 1, NBR_REACHABLE,
+                     NBR_TABLE_REASON_UNDEFINED, NULL) == NULL) {
+    BENCHMARK_FAIL("could not add neighbor\n");
+    benchmark_done();
+    PROCESS_EXIT();
+  }
+
+  for(num = 16; num <= UIP_DS6_ROUTE_NB; num *= 4) {
+    run(num);
+  }
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
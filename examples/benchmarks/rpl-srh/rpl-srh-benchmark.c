@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Source routing header insertion benchmark. Sets up a
+ *         non-storing root with a few hundred nodes arranged as a tree
+ *         and measures the average rpl_update_header() time for UDP
+ *         packets to all nodes or to a small set of active nodes, with
+ *         and without topology changes in between. Every generated
+ *         header is first decoded and checked against the tree.
+ */
+
+#include "contiki.h"
+#include "net/ip/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/rpl/rpl.h"
+#include "net/rpl/rpl-private.h"
+#include "net/rpl/rpl-ns.h"
+
+#define BENCHMARK_NAME "rpl-srh"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UIP_RH_BUF ((struct uip_routing_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+#define UIP_RPL_SRH_BUF ((struct uip_rpl_srh_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN + RPL_RH_LEN])
+
+/* Nodes besides the root; children of node i are 3i+1 .. 3i+3 */
+#define NODES (RPL_NS_LINK_NUM - 1)
+#define FANOUT 3
+#define PAYLOAD_LEN 64
+#define PACKETS 200000UL
+/* Destinations of the "active" runs */
+#define ACTIVE 32
+
+PROCESS(rpl_srh_process, "RPL SRH benchmark");
+AUTOSTART_PROCESSES(&rpl_srh_process);
+
+static rpl_dag_t *dag;
+/*---------------------------------------------------------------------------*/
+static void
+node_addr(uip_ipaddr_t *addr, unsigned i)
+{
+  /* Node 0 is the root */
+  uip_ip6addr(addr, 0xfd00, 0, 0, 0, 0x0212, 0x7400, i >> 8, i & 0xff);
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_parent(unsigned i, unsigned parent)
+{
+  uip_ipaddr_t child_addr;
+  uip_ipaddr_t parent_addr;
+
+  node_addr(&child_addr, i);
+  node_addr(&parent_addr, parent);
+  if(rpl_ns_update_node(dag, &child_addr, &parent_addr, 0xffffffff) == NULL) {
+    printf("rpl-srh: could not add node %u\n", i);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_packet(unsigned dest)
+{
+  uint16_t len = UIP_UDPH_LEN + PAYLOAD_LEN;
+
+  memset(uip_buf, 0, UIP_LLH_LEN + UIP_IPUDPH_LEN + PAYLOAD_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->len[0] = len >> 8;
+  UIP_IP_BUF->len[1] = len & 0xff;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  node_addr(&UIP_IP_BUF->srcipaddr, 0);
+  node_addr(&UIP_IP_BUF->destipaddr, dest);
+  memset(&uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN], dest & 0xff, PAYLOAD_LEN);
+  uip_ext_len = 0;
+  uip_len = UIP_IPH_LEN + len;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+packet_checksum(void)
+{
+  uint32_t sum = 5381;
+  uint16_t i;
+
+  /* The payload is only moved, covering the headers is enough */
+  for(i = 0; i < UIP_IPH_LEN + uip_ext_len; i++) {
+    sum = sum * 33 + uip_buf[UIP_LLH_LEN + i];
+  }
+  return sum ^ uip_len;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+depth(unsigned i)
+{
+  unsigned d;
+  for(d = 0; i != 0; d++) {
+    i = (i - 1) / FANOUT;
+  }
+  return d;
+}
+/*---------------------------------------------------------------------------*/
+static int
+verify(unsigned dest)
+{
+  uip_ipaddr_t addr;
+  uint8_t cmpr;
+  uint8_t *hop;
+  unsigned hops;
+  unsigned n;
+
+  make_packet(dest);
+  if(!rpl_update_header()) {
+    return 0;
+  }
+  hops = depth(dest) - 1;
+  if(hops == 0) {
+    /* One-hop destination, no routing header */
+    node_addr(&addr, dest);
+    return UIP_IP_BUF->proto == UIP_PROTO_UDP
+      && uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &addr);
+  }
+  if(UIP_IP_BUF->proto != UIP_PROTO_ROUTING
+     || UIP_RH_BUF->next != UIP_PROTO_UDP
+     || UIP_RH_BUF->routing_type != RPL_RH_TYPE_SRH
+     || UIP_RH_BUF->seg_left != hops
+     || uip_len != UIP_IPUDPH_LEN + PAYLOAD_LEN + (UIP_RH_BUF->len + 1) * 8
+     || uip_buf[UIP_LLH_LEN + uip_len - 1] != (dest & 0xff)) {
+    return 0;
+  }
+
+  /* Walk the path from the destination up: the last address is the
+     destination itself, the IPv6 destination is the root's child */
+  cmpr = UIP_RPL_SRH_BUF->cmpr >> 4;
+  hop = (uint8_t *)UIP_RPL_SRH_BUF + RPL_SRH_LEN + hops * (16 - cmpr);
+  n = dest;
+  while(hops-- > 0) {
+    node_addr(&addr, n);
+    hop -= 16 - cmpr;
+    if(memcmp(hop, &addr.u8[cmpr], 16 - cmpr) != 0) {
+      return 0;
+    }
+    n = (n - 1) / FANOUT;
+  }
+  node_addr(&addr, n);
+  return uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &addr);
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+run(const char *name, unsigned active, unsigned long churn)
+{
+  unsigned long i;
+  unsigned dest;
+  unsigned moved;
+  uint32_t sum;
+  clock_time_t start;
+  clock_time_t elapsed;
+
+  sum = 0;
+  moved = 0;
+  start = clock_time();
+  for(i = 0; i < PACKETS; i++) {
+    if(churn != 0 && i % churn == 0) {
+      /* Move a leaf between two parents at the same depth and back */
+      moved = NODES - (i / churn) % 64;
+      set_parent(moved, ((moved - 1) / FANOUT) ^ ((i / churn) & 1));
+    }
+    dest = NODES - (i * 7919) % active;
+    make_packet(dest);
+    BENCHMARK_CHECK(rpl_update_header(),
+                    "header insertion failed for node %u\n", dest);
+    sum += packet_checksum();
+  }
+  elapsed = clock_time() - start;
+
+  /* Restore the original tree */
+  for(i = NODES - 63; i <= NODES; i++) {
+    set_parent(i, (i - 1) / FANOUT);
+  }
+
+  printf("rpl-srh: %-12s %lu packets in %lu ms (%lu ns/packet), checksum %08lx\n",
+         name, PACKETS, (unsigned long)elapsed,
+         (unsigned long)(elapsed * 1000000UL / PACKETS), (unsigned long)sum);
+  return sum;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(rpl_srh_process, ev, data)
+{
+  uip_ipaddr_t root_addr;
+  unsigned i;
+
+  PROCESS_BEGIN();
+
+  printf("rpl-srh: %u nodes, SRH cache %u entries\n", NODES, RPL_SRH_CACHE_SIZE);
+
+  node_addr(&root_addr, 0);
+  dag = rpl_set_root(RPL_DEFAULT_INSTANCE, &root_addr);
+  if(dag == NULL) {
+    BENCHMARK_FAIL("could not create DAG\n");
+    benchmark_done();
+    PROCESS_EXIT();
+  }
+  rpl_set_prefix(dag, &root_addr, 64);
+
+  for(i = 1; i <= NODES; i++) {
+    set_parent(i, (i - 1) / FANOUT);
+  }
+  BENCHMARK_CHECK(rpl_ns_num_nodes() == NODES + 1,
+                  "%d nodes in the table\n", rpl_ns_num_nodes());
+
+  /* Check every node twice, so that cached headers are checked too */
+  for(i = 0; i < 2 * NODES; i++) {
+    BENCHMARK_CHECK(verify(1 + i % NODES),
+                    "wrong source route to node %u\n", 1 + i % NODES);
+  }
+
+  run("all", NODES, 0);
+  run("active", ACTIVE, 0);
+  run("active/100", ACTIVE, 100);
+  run("active/10", ACTIVE, 10);
+
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,600 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         TCP throughput benchmark. Uploads and downloads data with
+ *         tcp-socket to a peer TCP emulated by the benchmark, over an
+ *         emulated link with a long round-trip time, little bandwidth
+ *         and, optionally, loss.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "net/ip/tcp-socket.h"
+#include "net/ip/uip-chksum.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "lib/random.h"
+
+#define BENCHMARK_NAME "tcp-window"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRANSFER_LEN 16384
+/* The one-way delay, in ms, and the bandwidth, in bytes per second, of
+   the link. Frames that do not fit in the queue are dropped. */
+#define LINK_DELAY 20
+#define LINK_BANDWIDTH 25000
+#define LINK_QUEUE_LEN 16
+/* Chance, in percent, of losing a data segment that we send */
+#define LOSS_PERCENT 3
+
+#define PEER_MSS 200
+#define PEER_WINDOW 1600
+/* The peer acknowledges every second segment, and a single segment
+   after this many ms */
+#define PEER_ACK_DELAY 20
+/* The peer resends all segments in flight after this many ms */
+#define PEER_RTO 300
+/* A slow application reads this many bytes per 50 ms */
+#define SLOW_READ_LEN 250
+#define PEER_ISS 0x10000000UL
+
+#define UPLOAD_PORT 80
+#define DOWNLOAD_PORT 81
+#define RUN_TIMEOUT (120 * CLOCK_SECOND)
+
+#define TCP_HLEN 20
+#define TCP_FIN 0x01
+#define TCP_SYN 0x02
+#define TCP_PSH 0x08
+#define TCP_ACK 0x10
+
+#define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+
+PROCESS(tcp_window_process, "TCP window benchmark");
+PROCESS(link_process, "Emulated link");
+AUTOSTART_PROCESSES(&tcp_window_process);
+
+struct frame {
+  clock_time_t due;
+  uint16_t len;
+  uint8_t data[UIP_BUFSIZE];
+};
+
+struct link {
+  struct frame frames[LINK_QUEUE_LEN];
+  uint8_t head;
+  uint8_t count;
+  /* When the link is done sending the frames in the queue */
+  clock_time_t busy;
+};
+
+/* From us to the peer, and back */
+static struct link up;
+static struct link down;
+static uint8_t loss;
+static uint16_t lost;
+
+static struct {
+  uint16_t port;
+  uint16_t service;
+  uint32_t irs;
+  uint32_t rcv_nxt;
+  uint32_t snd_una;
+  uint32_t snd_nxt;
+  uint16_t wnd;
+  uint16_t mss;
+  uint8_t fin_sent;
+  uint8_t unacked;
+  uint8_t done;
+  clock_time_t ack_time;
+  clock_time_t progress;
+  clock_time_t end;
+  uint32_t received;
+  uint16_t segments;
+  uint16_t out_of_order;
+  uint16_t acks;
+  uint16_t timeouts;
+  uint16_t errors;
+} peer;
+
+static uip_ipaddr_t peer_addr;
+static uip_ipaddr_t our_addr;
+
+static struct tcp_socket socket;
+static uint8_t inputbuf[1600];
+static uint8_t outputbuf[2048];
+static uint8_t uploading;
+static uint32_t queued;
+static uint32_t downloaded;
+static uint16_t download_errors;
+static clock_time_t download_end;
+static uint8_t slow;
+static uint16_t read_len;
+/*---------------------------------------------------------------------------*/
+static uint8_t
+pattern(uint32_t offset)
+{
+  return offset ^ (offset >> 8);
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+get32(const uint8_t *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+    ((uint32_t)p[2] << 8) | p[3];
+}
+/*---------------------------------------------------------------------------*/
+static void
+put32(uint8_t *p, uint32_t value)
+{
+  p[0] = value >> 24;
+  p[1] = value >> 16;
+  p[2] = value >> 8;
+  p[3] = value;
+}
+/*---------------------------------------------------------------------------*/
+static void
+link_send(struct link *l, const uint8_t *data, uint16_t len)
+{
+  struct frame *f;
+  clock_time_t now = clock_time();
+
+  if(l->count == LINK_QUEUE_LEN) {
+    lost++;
+    return;
+  }
+  f = &l->frames[(l->head + l->count) % LINK_QUEUE_LEN];
+  l->count++;
+  if(l->busy < now) {
+    l->busy = now;
+  }
+  l->busy += (clock_time_t)len * CLOCK_SECOND / LINK_BANDWIDTH;
+  f->due = l->busy + LINK_DELAY * CLOCK_SECOND / 1000;
+  f->len = len;
+  memcpy(f->data, data, len);
+}
+/*---------------------------------------------------------------------------*/
+static struct frame *
+link_receive(struct link *l)
+{
+  struct frame *f;
+
+  if(l->count == 0 || l->frames[l->head].due > clock_time()) {
+    return NULL;
+  }
+  f = &l->frames[l->head];
+  l->head = (l->head + 1) % LINK_QUEUE_LEN;
+  l->count--;
+  return f;
+}
+/*---------------------------------------------------------------------------*/
+/* The output function of uIP */
+static uint8_t
+output(const uip_lladdr_t *lladdr)
+{
+  if(loss && UIP_IP_BUF->proto == UIP_PROTO_TCP &&
+     uip_len > UIP_IPTCPH_LEN && random_rand() % 100 < LOSS_PERCENT) {
+    lost++;
+    return 1;
+  }
+  link_send(&up, uip_buf, uip_len);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+peer_send(uint8_t flags, uint32_t seqno, const uint8_t *data, uint16_t len)
+{
+  static uint8_t packet[UIP_BUFSIZE];
+  uint8_t *tcp = &packet[UIP_IPH_LEN];
+  uint16_t hlen;
+  uint16_t sum;
+
+  hlen = (flags & TCP_SYN) ? TCP_HLEN + 4 : TCP_HLEN;
+  memset(packet, 0, UIP_IPH_LEN + hlen);
+  packet[0] = 0x60;
+  packet[4] = (hlen + len) >> 8;
+  packet[5] = (hlen + len) & 0xff;
+  packet[6] = UIP_PROTO_TCP;
+  packet[7] = 64;
+  memcpy(&packet[8], &peer_addr, sizeof(peer_addr));
+  memcpy(&packet[24], &our_addr, sizeof(our_addr));
+
+  tcp[0] = peer.service >> 8;
+  tcp[1] = peer.service & 0xff;
+  tcp[2] = peer.port >> 8;
+  tcp[3] = peer.port & 0xff;
+  put32(&tcp[4], seqno);
+  put32(&tcp[8], peer.rcv_nxt);
+  tcp[12] = (hlen / 4) << 4;
+  tcp[13] = flags;
+  tcp[14] = PEER_WINDOW >> 8;
+  tcp[15] = PEER_WINDOW & 0xff;
+  if(flags & TCP_SYN) {
+    tcp[20] = 2;
+    tcp[21] = 4;
+    tcp[22] = PEER_MSS >> 8;
+    tcp[23] = PEER_MSS & 0xff;
+  }
+  if(len > 0) {
+    memcpy(&tcp[hlen], data, len);
+  }
+
+  sum = hlen + len + UIP_PROTO_TCP;
+  sum = uip_chksum_add(sum, &packet[8], 2 * sizeof(uip_ipaddr_t));
+  sum = uip_chksum_add(sum, tcp, hlen + len);
+  sum = ~sum;
+  tcp[16] = sum >> 8;
+  tcp[17] = sum & 0xff;
+
+  link_send(&down, packet, UIP_IPH_LEN + hlen + len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+peer_ack(void)
+{
+  peer_send(TCP_ACK, peer.snd_nxt, NULL, 0);
+  peer.unacked = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Send as much of the download as the window allows */
+static void
+peer_output(void)
+{
+  static uint8_t data[PEER_MSS];
+  uint32_t end = PEER_ISS + 1 + TRANSFER_LEN;
+  uint32_t offset;
+  uint16_t wnd;
+  uint16_t len;
+  int i;
+
+  if(peer.service != DOWNLOAD_PORT || peer.snd_una == PEER_ISS) {
+    return;
+  }
+  wnd = MIN(peer.wnd, PEER_WINDOW);
+  while(peer.snd_nxt != end && !peer.fin_sent) {
+    len = MIN(peer.mss, end - peer.snd_nxt);
+    if(peer.snd_nxt + len - peer.snd_una > wnd) {
+      break;
+    }
+    offset = peer.snd_nxt - PEER_ISS - 1;
+    for(i = 0; i < len; i++) {
+      data[i] = pattern(offset + i);
+    }
+    peer_send(TCP_ACK | TCP_PSH, peer.snd_nxt, data, len);
+    peer.snd_nxt += len;
+    peer.segments++;
+  }
+  if(peer.snd_una == end && !peer.fin_sent) {
+    peer_send(TCP_FIN | TCP_ACK, end, NULL, 0);
+    peer.snd_nxt = end + 1;
+    peer.fin_sent = 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+peer_input(const uint8_t *packet, uint16_t len)
+{
+  const uint8_t *tcp = &packet[UIP_IPH_LEN];
+  uint32_t seqno;
+  uint32_t ackno;
+  uint16_t datalen;
+  uint8_t flags;
+  int i;
+
+  if(packet[6] != UIP_PROTO_TCP) {
+    /* Neighbor discovery */
+    return;
+  }
+  datalen = len - UIP_IPH_LEN - (tcp[12] >> 4) * 4;
+  flags = tcp[13];
+  seqno = get32(&tcp[4]);
+  ackno = get32(&tcp[8]);
+  peer.wnd = ((uint16_t)tcp[14] << 8) | tcp[15];
+
+  if(!(flags & TCP_SYN) &&
+     ((uint16_t)tcp[0] << 8 | tcp[1]) != peer.port) {
+    /* The last ACK of the previous connection */
+    return;
+  }
+  if(flags & TCP_SYN) {
+    peer.port = ((uint16_t)tcp[0] << 8) | tcp[1];
+    peer.service = ((uint16_t)tcp[2] << 8) | tcp[3];
+    peer.irs = seqno;
+    peer.rcv_nxt = seqno + 1;
+    peer.snd_una = PEER_ISS;
+    peer.snd_nxt = PEER_ISS + 1;
+    peer.mss = 536;
+    if(tcp[20] == 2 && tcp[21] == 4) {
+      peer.mss = MIN(PEER_MSS, ((uint16_t)tcp[22] << 8) | tcp[23]);
+    }
+    peer_send(TCP_SYN | TCP_ACK, PEER_ISS, NULL, 0);
+    return;
+  }
+
+  if(flags & TCP_ACK) {
+    if((int32_t)(ackno - peer.snd_una) > 0 &&
+       (int32_t)(ackno - peer.snd_nxt) <= 0) {
+      peer.snd_una = ackno;
+      peer.progress = clock_time();
+    }
+    if(datalen == 0 && !(flags & TCP_FIN)) {
+      peer.acks++;
+    }
+  }
+
+  if(datalen > 0) {
+    peer.segments++;
+    if(seqno == peer.rcv_nxt) {
+      for(i = 0; i < datalen; i++) {
+        if(tcp[(tcp[12] >> 4) * 4 + i] != pattern(seqno - peer.irs - 1 + i)) {
+          peer.errors++;
+          break;
+        }
+      }
+      peer.rcv_nxt += datalen;
+      peer.received += datalen;
+      if(++peer.unacked == 2) {
+        peer_ack();
+      } else {
+        peer.ack_time = clock_time() + PEER_ACK_DELAY * CLOCK_SECOND / 1000;
+      }
+    } else {
+      /* Out of order segments are dropped and acknowledged at once */
+      peer.out_of_order++;
+      peer_ack();
+    }
+  }
+
+  if((flags & TCP_FIN) && seqno + datalen == peer.rcv_nxt) {
+    peer.rcv_nxt++;
+    if(peer.fin_sent) {
+      peer_ack();
+    } else {
+      peer_send(TCP_FIN | TCP_ACK, peer.snd_nxt, NULL, 0);
+      peer.snd_nxt++;
+      peer.fin_sent = 1;
+      peer.unacked = 0;
+    }
+    peer.done = 1;
+    peer.end = clock_time();
+  }
+
+  peer_output();
+}
+/*---------------------------------------------------------------------------*/
+static void
+peer_timer(void)
+{
+  if(peer.unacked > 0 && clock_time() >= peer.ack_time) {
+    peer_ack();
+  }
+  if(peer.service == DOWNLOAD_PORT && peer.snd_una != PEER_ISS &&
+     peer.snd_una != peer.snd_nxt && !peer.done &&
+     clock_time() - peer.progress > PEER_RTO * CLOCK_SECOND / 1000) {
+    /* Go back to the first unacknowledged segment */
+    peer.timeouts++;
+    peer.snd_nxt = peer.snd_una;
+    peer.fin_sent = 0;
+    peer.progress = clock_time();
+    peer_output();
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(link_process, ev, data)
+{
+  static struct etimer et;
+  struct frame *f;
+
+  PROCESS_BEGIN();
+
+  etimer_set(&et, 1);
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+
+    while((f = link_receive(&up)) != NULL) {
+      peer_input(f->data, f->len);
+    }
+    while((f = link_receive(&down)) != NULL) {
+      memcpy(uip_buf, f->data, f->len);
+      uip_len = f->len;
+      tcpip_input();
+    }
+    peer_timer();
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+fill(struct tcp_socket *s)
+{
+  uint8_t chunk[64];
+  int len;
+  int i;
+
+  while(queued < TRANSFER_LEN && tcp_socket_max_sendlen(s) > 0) {
+    len = MIN(sizeof(chunk), TRANSFER_LEN - queued);
+    len = MIN(len, tcp_socket_max_sendlen(s));
+    for(i = 0; i < len; i++) {
+      chunk[i] = pattern(queued + i);
+    }
+    queued += tcp_socket_send(s, chunk, len);
+  }
+  if(queued == TRANSFER_LEN) {
+    tcp_socket_close(s);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+input(struct tcp_socket *s, void *ptr, const uint8_t *data, int len)
+{
+  int consumed;
+  int i;
+
+  /* A slow application leaves what it cannot read in the buffer */
+  consumed = slow ? MIN(len, read_len) : len;
+  for(i = 0; i < consumed; i++) {
+    if(data[i] != pattern(downloaded + i)) {
+      download_errors++;
+      break;
+    }
+  }
+  downloaded += consumed;
+  read_len -= slow ? consumed : 0;
+  if(downloaded == TRANSFER_LEN) {
+    download_end = clock_time();
+  }
+  return len - consumed;
+}
+/*---------------------------------------------------------------------------*/
+static void
+event(struct tcp_socket *s, void *ptr, tcp_socket_event_t ev)
+{
+  if(uploading &&
+     (ev == TCP_SOCKET_CONNECTED || ev == TCP_SOCKET_DATA_SENT)) {
+    fill(s);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_run(uint16_t service, uint8_t with_loss, uint8_t slow_read)
+{
+  memset(&peer, 0, sizeof(peer));
+  loss = with_loss;
+  lost = 0;
+  uploading = service == UPLOAD_PORT;
+  queued = 0;
+  downloaded = 0;
+  download_errors = 0;
+  slow = slow_read;
+  read_len = 0;
+  tcp_socket_connect(&socket, &peer_addr, service);
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, clock_time_t start)
+{
+  unsigned long ms;
+  int ok;
+
+  if(uploading) {
+    ok = peer.done && peer.received == TRANSFER_LEN && peer.errors == 0;
+  } else {
+    ok = peer.done && downloaded == TRANSFER_LEN && download_errors == 0;
+  }
+  if(!ok) {
+    BENCHMARK_FAIL("%s: FAILED, %lu bytes transferred\n", name,
+                   (unsigned long)(uploading ? peer.received : downloaded));
+    return;
+  }
+  ms = (unsigned long)((uploading ? peer.end : download_end) - start) *
+    1000 / CLOCK_SECOND;
+  printf("tcp-window: %s: %u bytes in %lu ms (%lu bytes/s)\n", name,
+         TRANSFER_LEN, ms, TRANSFER_LEN * 1000UL / (ms ? ms : 1));
+  if(uploading) {
+    printf("tcp-window: %s: %u segments, %u lost, %u out of order\n", name,
+           peer.segments, lost, peer.out_of_order);
+  } else {
+    printf("tcp-window: %s: %u segments, %u ACKs, %u timeouts\n", name,
+           peer.segments, peer.acks, peer.timeouts);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tcp_window_process, ev, data)
+{
+  static const struct {
+    const char *name;
+    uint16_t service;
+    uint8_t loss;
+    uint8_t slow;
+  } runs[] = {
+    { "upload", UPLOAD_PORT, 0, 0 },
+    { "upload with loss", UPLOAD_PORT, 1, 0 },
+    { "download", DOWNLOAD_PORT, 0, 0 },
+#if UIP_TCP_RCV_WND
+    /* Without a receive window, the data that the application cannot
+       read is lost */
+    { "download to a slow reader", DOWNLOAD_PORT, 0, 1 },
+#endif /* UIP_TCP_RCV_WND */
+  };
+  static struct etimer et;
+  static clock_time_t start;
+  static int run;
+  uip_lladdr_t peer_lladdr;
+
+  PROCESS_BEGIN();
+
+  random_init(1);
+  uip_ip6addr(&peer_addr, 0xfe80, 0, 0, 0, 0, 0, 0, 2);
+  uip_ipaddr_copy(&our_addr, &uip_ds6_get_link_local(-1)->ipaddr);
+  memset(&peer_lladdr, 0, sizeof(peer_lladdr));
+  peer_lladdr.addr[sizeof(peer_lladdr.addr) - 1] = 2;
+  uip_ds6_nbr_add(&peer_addr, &peer_lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_UNDEFINED, NULL);
+  tcpip_set_outputfunc(output);
+  process_start(&link_process, NULL);
+
+  tcp_socket_register(&socket, NULL, inputbuf, sizeof(inputbuf),
+                      outputbuf, sizeof(outputbuf), input, event);
+
+  printf("tcp-window: window %d, delayed ACK %d, receive window %d, MSS %d, %d ms RTT, %d bytes/s\n",
+         UIP_TCP_WINDOW, UIP_TCP_DELAYED_ACK, UIP_TCP_RCV_WND, UIP_TCP_MSS,
+         2 * LINK_DELAY, LINK_BANDWIDTH);
+
+  for(run = 0; run < sizeof(runs) / sizeof(runs[0]); run++) {
+    start_run(runs[run].service, runs[run].loss, runs[run].slow);
+    start = clock_time();
+    etimer_set(&et, CLOCK_SECOND / 20);
+    while(!(peer.done && (uploading || downloaded == TRANSFER_LEN)) &&
+          clock_time() - start < RUN_TIMEOUT) {
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+      etimer_reset(&et);
+      if(slow) {
+        read_len = SLOW_READ_LEN;
+        tcp_socket_input_resume(&socket);
+      }
+    }
+    report(runs[run].name, start);
+  }
+
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         TSCH queue benchmark. Unicast packets to many neighbors without
+ *         dedicated links are sent over a single shared link, with
+ *         collisions. Measures the time spent selecting a packet and
+ *         updating the backoff windows at every slot.
+ */
+
+#include "contiki.h"
+#include "net/packetbuf.h"
+#include "net/mac/tsch/tsch-queue.h"
+#include "net/mac/tsch/tsch-private.h"
+#include "lib/random.h"
+
+#define BENCHMARK_NAME "tsch-queue"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SLOTS            1000000UL
+#define NEIGHBORS        (NBR_TABLE_CONF_MAX_NEIGHBORS)
+/* Probability, in percent, that a packet is added in a slot, and that a
+   transmission succeeds */
+#define LOAD             40
+#define SUCCESS          70
+
+PROCESS(tsch_queue_process, "TSCH queue benchmark");
+AUTOSTART_PROCESSES(&tsch_queue_process);
+
+/* The queues are built without the rest of TSCH: stand-ins for what
+   tsch-queue.c uses from the slot operation */
+struct asn_t current_asn;
+int tsch_is_coordinator;
+const linkaddr_t tsch_broadcast_address = { { 0xff, 0xff } };
+const linkaddr_t tsch_eb_address = { { 0, 0 } };
+/*---------------------------------------------------------------------------*/
+int
+tsch_is_locked(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_get_lock(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_release_lock(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static void
+neighbor_addr(linkaddr_t *addr, int i)
+{
+  linkaddr_copy(addr, &linkaddr_null);
+  addr->u8[0] = 0x02;
+  addr->u8[LINKADDR_SIZE - 1] = i + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* A shared slot, as in get_packet_and_neighbor_for_link() and
+   update_neighbor_state() of the slot operation */
+static int
+shared_slot(struct tsch_link *link)
+{
+  struct tsch_neighbor *n = n_broadcast;
+  struct tsch_packet *p;
+  int sent = 0;
+
+  p = tsch_queue_get_packet_for_nbr(n, link);
+  if(p == NULL) {
+    p = tsch_queue_get_unicast_packet_for_any(&n, link);
+  }
+  if(p != NULL) {
+    p->transmissions++;
+    if(random_rand() % 100 < SUCCESS) {
+      tsch_queue_remove_packet_from_queue(n);
+      tsch_queue_free_packet(p);
+      tsch_queue_backoff_reset(n);
+      sent = 1;
+    } else {
+      if(p->transmissions >= TSCH_MAC_MAX_FRAME_RETRIES + 1) {
+        tsch_queue_remove_packet_from_queue(n);
+        tsch_queue_free_packet(p);
+      }
+      tsch_queue_backoff_inc(n);
+    }
+  }
+  tsch_queue_update_all_backoff_windows(&link->addr);
+  return sent;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tsch_queue_process, ev, data)
+{
+  static struct tsch_link link;
+  linkaddr_t addr;
+  unsigned long i, start, elapsed, queued, sent;
+  int j;
+
+  PROCESS_BEGIN();
+
+  tsch_queue_init();
+  for(j = 0; j < NEIGHBORS; j++) {
+    neighbor_addr(&addr, j);
+    tsch_queue_add_nbr(&addr);
+  }
+
+  link.link_options = LINK_OPTION_TX | LINK_OPTION_RX | LINK_OPTION_SHARED;
+  linkaddr_copy(&link.addr, &tsch_broadcast_address);
+
+  printf("tsch-queue: %d neighbors, %lu slots\n", NEIGHBORS, SLOTS);
+
+  queued = sent = 0;
+  start = benchmark_cpu_time_us();
+  for(i = 0; i < SLOTS; i++) {
+    ASN_INC(current_asn, 1);
+    if(random_rand() % 100 < LOAD) {
+      packetbuf_clear();
+      packetbuf_set_datalen(50);
+      neighbor_addr(&addr, random_rand() % NEIGHBORS);
+      if(tsch_queue_add_packet(&addr, NULL, NULL) != NULL) {
+        queued++;
+      }
+    }
+    sent += shared_slot(&link);
+  }
+  elapsed = benchmark_cpu_time_us() - start;
+
+  printf("tsch-queue: %lu queued, %lu sent, %lu us, %lu ns per slot\n",
+         queued, sent, elapsed, elapsed * 1000 / SLOTS);
+#if TSCH_QUEUE_STATS
+  printf("tsch-queue: shared slots used %lu/%lu, wait avg %lu max %lu slots\n",
+         (unsigned long)tsch_queue_stats.shared_lookups_found,
+         (unsigned long)tsch_queue_stats.shared_lookups,
+         (unsigned long)(tsch_queue_stats.wait_slots / tsch_queue_stats.dequeued),
+         (unsigned long)tsch_queue_stats.wait_slots_max);
+#endif /* TSCH_QUEUE_STATS */
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2026, the Contiki authors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         TSCH schedule benchmark. Builds an Orchestra-like schedule with
+ *         a dense custom slotframe and measures the time it takes to find
+ *         the next active link, as done at every slot.
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch-schedule.h"
+#include "net/mac/tsch/tsch-queue.h"
+
+#define BENCHMARK_NAME "tsch-schedule"
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LOOKUPS          1000000UL
+#define CUSTOM_LINKS     (TSCH_SCHEDULE_MAX_LINKS - 1 - 1 - 17)
+
+PROCESS(tsch_schedule_process, "TSCH schedule benchmark");
+AUTOSTART_PROCESSES(&tsch_schedule_process);
+
+/* The schedule is built without the rest of TSCH: stand-ins for what
+   tsch-schedule.c uses from the slot operation and the queues */
+struct tsch_link *current_link;
+const linkaddr_t tsch_broadcast_address = { { 0xff, 0xff } };
+/*---------------------------------------------------------------------------*/
+int
+tsch_is_locked(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_get_lock(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_release_lock(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+struct tsch_neighbor *
+tsch_queue_add_nbr(const linkaddr_t *addr)
+{
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_queue_signal_nbr(struct tsch_neighbor *n)
+{
+}
+/*---------------------------------------------------------------------------*/
+static void
+build_schedule(void)
+{
+  struct tsch_slotframe *sf;
+  linkaddr_t addr;
+  int i;
+
+  /* Orchestra: EB, common shared and receiver-based unicast slotframes */
+  sf = tsch_schedule_add_slotframe(0, 397);
+  tsch_schedule_add_link(sf, LINK_OPTION_TX, LINK_TYPE_ADVERTISING_ONLY,
+                         &tsch_broadcast_address, 0, 0);
+  sf = tsch_schedule_add_slotframe(1, 31);
+  tsch_schedule_add_link(sf, LINK_OPTION_RX | LINK_OPTION_TX | LINK_OPTION_SHARED,
+                         LINK_TYPE_ADVERTISING, &tsch_broadcast_address, 0, 1);
+  sf = tsch_schedule_add_slotframe(2, 17);
+  for(i = 0; i < 17; i++) {
+    linkaddr_copy(&addr, &linkaddr_null);
+    addr.u8[LINKADDR_SIZE - 1] = i + 1;
+    tsch_schedule_add_link(sf, LINK_OPTION_TX | LINK_OPTION_SHARED,
+                           LINK_TYPE_NORMAL, &addr, i, 2);
+  }
+  /* A dense custom slotframe, with links added in random timeslot order */
+  sf = tsch_schedule_add_slotframe(3, 211);
+  for(i = 0; i < CUSTOM_LINKS; i++) {
+    tsch_schedule_add_link(sf, LINK_OPTION_RX, LINK_TYPE_NORMAL,
+                           &linkaddr_null, (i * 37) % 211, 3);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tsch_schedule_process, ev, data)
+{
+  struct asn_t asn;
+  struct tsch_link *link, *backup;
+  uint16_t time_offset;
+  unsigned long i, start, elapsed, checksum;
+
+  PROCESS_BEGIN();
+
+  tsch_schedule_init();
+  build_schedule();
+
+  printf("tsch-schedule: link index %d, %d links\n",
+         TSCH_SCHEDULE_WITH_LINK_INDEX, CUSTOM_LINKS + 1 + 1 + 17);
+
+  /* Jump from one active slot to the next, as the slot operation does */
+  ASN_INIT(asn, 0, 0);
+  checksum = 0;
+  start = benchmark_cpu_time_us();
+  for(i = 0; i < LOOKUPS; i++) {
+    link = tsch_schedule_get_next_active_link(&asn, &time_offset, &backup);
+    if(link == NULL) {
+      break;
+    }
+    checksum = checksum * 31 + link->handle * 7 + time_offset +
+      (backup != NULL ? backup->handle : 0xffff);
+    ASN_INC(asn, time_offset);
+  }
+  elapsed = benchmark_cpu_time_us() - start;
+
+  printf("tsch-schedule: %lu lookups in %lu us, %lu ns per lookup, checksum %08lx\n",
+         i, elapsed, elapsed * 1000 / (i ? i : 1), checksum & 0xffffffffUL);
+  benchmark_done();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
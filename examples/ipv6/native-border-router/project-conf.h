@@ -49,6 +49,19 @@
 
 #define SERIALIZE_ATTRIBUTES 1
 
+#define NBR_TABLE_CONF_WITH_HASH_INDEX 1
+
+#define PROCESS_CONF_WITH_PRIORITIES 1
+#define PROCESS_CONF_WITH_POLL_LIST  1
+
+/* Reassemble packets from many children at a time, at most two per child */
+#define SICSLOWPAN_CONF_REASS_CONTEXTS        8
+#define SICSLOWPAN_CONF_FRAGMENT_BUFFERS      32
+#define SICSLOWPAN_CONF_REASS_SENDER_CONTEXTS 2
+
+/* Relay fragments between children without reassembling them */
+#define SICSLOWPAN_CONF_FRAG_FORWARDING 1
+
 #define CMD_CONF_OUTPUT border_router_cmd_output
 
 #undef NETSTACK_CONF_RDC
@@ -162,11 +162,15 @@ is_sensible_string(const unsigned char *s, int len)
 void
 slip_packet_input(unsigned char *data, int len)
 {
-  packetbuf_copyfrom(data, len);
+  /* The frame stays in the SLIP input buffer while it is processed */
+  packetbuf_reference(data, len);
   if(slip_config_verbose > 0) {
     printf("Packet input over SLIP: %d\n", len);
   }
   NETSTACK_RDC.input();
+  if(packetbuf_is_reference()) {
+    packetbuf_clear();
+  }
 }
 /*---------------------------------------------------------------------------*/
 /*
@@ -63,7 +63,7 @@
 #undef COAP_MAX_OPEN_TRANSACTIONS
 #define COAP_MAX_OPEN_TRANSACTIONS     4
 
-/* Must be <= open transactions, default is COAP_MAX_OPEN_TRANSACTIONS-1. */
+/* Independent of open transactions, default is COAP_MAX_OPEN_TRANSACTIONS-1. */
 /*
    #undef COAP_MAX_OBSERVERS
    #define COAP_MAX_OBSERVERS             2
@@ -44,9 +44,9 @@
 #define COAP_MAX_OPEN_TRANSACTIONS   2
 #endif
 
-/* Must be <= open transaction number. */
+/* Independent of open transactions, each slot costs a few bytes. */
 #ifndef COAP_MAX_OBSERVERS
-#define COAP_MAX_OBSERVERS           COAP_MAX_OPEN_TRANSACTIONS-1
+#define COAP_MAX_OBSERVERS           1
 #endif
 
 #endif /* PROJECT_RPL_WEB_CONF_H_ */
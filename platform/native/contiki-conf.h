@@ -100,6 +100,12 @@ typedef unsigned short uip_stats_t;
 
 #define NETSTACK_CONF_NETWORK sicslowpan_driver
 
+/* Room for the MAC header in front of the packetbuf data, so that
+   outbound frames are not moved when the header is added */
+#ifndef PACKETBUF_CONF_HDR_SIZE
+#define PACKETBUF_CONF_HDR_SIZE         48
+#endif /* PACKETBUF_CONF_HDR_SIZE */
+
 #define NETSTACK_CONF_LINUXRADIO_DEV "wpan0"
 
 #define UIP_CONF_ROUTER                 1